@@ -76,6 +76,7 @@ void VTM_Data_Decode(void)
             remote_control.mouse.press_right = robot_command.right_button_down;
             remote_control.mouse.press_left = robot_command.left_button_down;
             remote_control.key_code = robot_command.keyboard_value;
+            RC_Publish(RC_SOURCE_UART, &remote_control);
 
             memcpy(VTM_Data_Buf, &robot_command, 12);
             VTM_Update = 1;
@@ -1,4 +1,5 @@
 #include "chassis_task.h"
+#include "profiler.h"
 
 uint16_t outpost_HP, sentry_HP;
 
@@ -14,13 +15,15 @@ float ChassisMotionEst_F[36] = {
     0, 0, 0, 0, 1, 0,
     0, 0, 0, 0, 0, 1};
 float ChassisMotionEst_P[36];
+// 两轴之间没有初始协方差, 稠密与分块模式的模型相同
+// no initial covariance between the two axes, so the dense and block modes share one model
 float ChassisMotionEst_Pinit[36] = {
-    1000, 0.1, 0.1, 0.1, 0.1, 0.1,
-    0.1, 10000, 0.1, 0.1, 0.1, 0.1,
-    0.1, 0.1, 10000, 0.1, 0.1, 0.1,
-    0.1, 0.1, 0.1, 1000, 0.1, 0.1,
-    0.1, 0.1, 0.1, 0.1, 10000, 0.1,
-    0.1, 0.1, 0.1, 0.1, 0.1, 10000};
+    1000, 0.1, 0.1, 0, 0, 0,
+    0.1, 10000, 0.1, 0, 0, 0,
+    0.1, 0.1, 10000, 0, 0, 0,
+    0, 0, 0, 1000, 0.1, 0.1,
+    0, 0, 0, 0.1, 10000, 0.1,
+    0, 0, 0, 0.1, 0.1, 10000};
 float ChassisMotionEst_Sigma[2] = {100, 100};
 float ChassisMotionEst_Q[36] = {
     10, 0, 0, 0, 0, 0,
@@ -42,6 +45,16 @@ float ChassisMotionEst_H[24] = {
 float ChiSquare;
 float xhat_data_obsv[6];
 
+TaskPeriod_t Chassis_Period;
+DWT_Tick_t Chassis_Tick;
+
+static Chassis_Nav_t Chassis_NavSnapshot_Buf[2];
+Snapshot_t Chassis_NavSnapshot = {0, (uint8_t *)Chassis_NavSnapshot_Buf, sizeof(Chassis_Nav_t)};
+
+static float thetaHistory_Frame[FOLLOW_THETA_LEN];
+static uint64_t thetaHistory_TimeStamp[FOLLOW_THETA_LEN];
+
+static void Chassis_Get_Snapshot(void);  // 读取遥控器与导航快照
 static void Chassis_Get_Theta(void);     // 获取底盘与云台偏角
 static void Chassis_Set_Mode(void);      // 设置底盘运动模式
 static void Chassis_Get_CtrlValue(void); // 处理来自摇杆与键盘的控制数据
@@ -54,6 +67,7 @@ static void Chassis_Power_Exp(void); // 计算可能的底盘功率
 static void Velocity_MAXLimit(void); // 最大速度限制
 static void ChassisMotionEst_Init(void);
 static void ChassisMotionEst_Update(float dt);
+static void Chassis_BlackBox_Record(void);
 
 void Chassis_Init(void)
 {
@@ -82,39 +96,76 @@ void Chassis_Init(void)
             &Chassis.ChassisMotor[i].PID_Velocity, 16384, 16384, 0, 15, 30, 0, 500, 100, 0.005, 0, 1, Integral_Limit | OutputFilter);
         Chassis.ChassisMotor[i].Max_Out = 12000.0f;
     }
+#ifdef Chassis_Wheel_PID_Batch
+    PID_Batch_Init(&Chassis.WheelPID, 4, 16384, 16384, 0, 15, 30, 0, 0.005, 0, Integral_Limit | OutputFilter);
+#endif
     // 底盘跟随云台PID初始化
-    PID_Init(&Chassis.RotateFollow, 300, 100, 0, 8, 0, 0, 0,
-             0, 0, 0, 1,
-             Integral_Limit | Derivative_On_Measurement | OutputFilter | DerivativeFilter);
+    // 功能固定为 Integral_Limit | Derivative_On_Measurement | OutputFilter | DerivativeFilter (pid_static.h)
+    PID_Rotate_Init(&Chassis.RotateFollow, 300, 100, 0, 8, 0, 0, 0,
+                    0, 0, 0);
 
-    PID_Init(&Chassis.SpinningValid, 50, 30, 0, 0.1, 0, 0, 0,
-             0, 0, 0, 1,
-             Integral_Limit | Derivative_On_Measurement | OutputFilter | DerivativeFilter);
+    PID_Rotate_Init(&Chassis.SpinningValid, 50, 30, 0, 0.1, 0, 0, 0,
+                    0, 0, 0);
 
     TD_Init(&Chassis.SpinningTD, 100000, 0.001);
 
-    Matrix_Init(&Chassis.ChassisMotionEst.H, 4, 6, (float *)Chassis.ChassisMotionEst.H_data);
-    Matrix_Init(&Chassis.ChassisMotionEst.HT, 6, 4, (float *)Chassis.ChassisMotionEst.HT_data);
     ChassisMotionEst_Init();
+    History_Init_Static(&Chassis.thetaHistory, thetaHistory_Frame, thetaHistory_TimeStamp, History_Lerp_Angle_Deg);
     Chassis.IsSpining = 0;
+
+    Telem_Register_Float(TELEM_CHASSIS_POS_X, "chassis.pos_x", &Chassis.Position[X]);
+    Telem_Register_Float(TELEM_CHASSIS_POS_Y, "chassis.pos_y", &Chassis.Position[Y]);
+    Telem_Register_Float(TELEM_CHASSIS_VEL_X, "chassis.vel_x", &Chassis.Velocity[X]);
+    Telem_Register_Float(TELEM_CHASSIS_VEL_Y, "chassis.vel_y", &Chassis.Velocity[Y]);
+    Telem_Register_Float(TELEM_CHASSIS_ACC_X, "chassis.acc_x", &Chassis.Accel[X]);
+    Telem_Register_Float(TELEM_CHASSIS_ACC_Y, "chassis.acc_y", &Chassis.Accel[Y]);
+    Telem_Register_Float(TELEM_CHASSIS_ODOM_VX, "chassis.odom_vx", &Chassis.Vx_is);
+    Telem_Register_Float(TELEM_CHASSIS_ODOM_VY, "chassis.odom_vy", &Chassis.Vy_is);
+    Telem_Register_Int16(TELEM_CHASSIS_VX_SET, "chassis.vx_set", &Chassis.Vx);
+    Telem_Register_Int16(TELEM_CHASSIS_VY_SET, "chassis.vy_set", &Chassis.Vy);
+    Telem_Register_Int16(TELEM_CHASSIS_VR_SET, "chassis.vr_set", &Chassis.Vr);
+    Telem_Register_Float(TELEM_WHEEL1_RPM, "wheel1.rpm", &Chassis.ChassisMotor[0].Velocity_RPM);
+    Telem_Register_Float(TELEM_WHEEL2_RPM, "wheel2.rpm", &Chassis.ChassisMotor[1].Velocity_RPM);
+    Telem_Register_Float(TELEM_WHEEL3_RPM, "wheel3.rpm", &Chassis.ChassisMotor[2].Velocity_RPM);
+    Telem_Register_Float(TELEM_WHEEL4_RPM, "wheel4.rpm", &Chassis.ChassisMotor[3].Velocity_RPM);
+    Telem_Register_Float(TELEM_WHEEL1_OUT, "wheel1.out", &Chassis.ChassisMotor[0].Output);
+    Telem_Register_Float(TELEM_WHEEL2_OUT, "wheel2.out", &Chassis.ChassisMotor[1].Output);
+    Telem_Register_Float(TELEM_WHEEL3_OUT, "wheel3.out", &Chassis.ChassisMotor[2].Output);
+    Telem_Register_Float(TELEM_WHEEL4_OUT, "wheel4.out", &Chassis.ChassisMotor[3].Output);
+    Telem_Register_Uint32(TELEM_CHASSIS_CYCLE, "chassis.cycle", &Chassis_Period.Cycle);
+
+    // 此后 Chassis_Control() 每周期排空接收队列, 之前的电机帧不入队
+    // Chassis_Control() drains the receive queue every tick from here on, earlier motor frames are not queued
+    CAN_RxQueue_Start(&CAN_RxQueue);
 }
 
 static void ChassisMotionEst_Init(void)
 {
-    // Chassis.ChassisMotionEst.UseAutoAdjustment = TRUE;
-    Kalman_Filter_Init(&Chassis.ChassisMotionEst, 6, 0, 4);
-    Chassis.ChassisMotionEst.MeasurementMap[0] = 2;
-    Chassis.ChassisMotionEst.MeasurementMap[1] = 3;
-    Chassis.ChassisMotionEst.MeasurementMap[2] = 5;
-    Chassis.ChassisMotionEst.MeasurementMap[3] = 6;
-    Chassis.ChassisMotionEst.MeasurementDegree[0] = 1;
-    Chassis.ChassisMotionEst.MeasurementDegree[1] = 1;
-    Chassis.ChassisMotionEst.MeasurementDegree[2] = 1;
-    Chassis.ChassisMotionEst.MeasurementDegree[3] = 1;
-    // Chassis.ChassisMotionEst.MatR_DiagonalElements[0] = 100;
-    // Chassis.ChassisMotionEst.MatR_DiagonalElements[1] = 100;
-    // Chassis.ChassisMotionEst.MatR_DiagonalElements[2] = 100;
-    // Chassis.ChassisMotionEst.MatR_DiagonalElements[3] = 100;
+#ifdef ChassisMotionEst_UseBlock
+    // 各轴参数取自 6 维模型的对角块, 6 维模型在轴间没有耦合
+    // each axis takes the diagonal blocks of the 6 state model, which has no coupling between the axes
+    for (uint8_t axis = 0; axis < 2; axis++)
+    {
+        KalmanFilter3x2_Init(&Chassis.ChassisMotionEst[axis]);
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                Chassis.ChassisMotionEst[axis].F_data[i * 3 + j] = ChassisMotionEst_F[(axis * 3 + i) * 6 + axis * 3 + j];
+                Chassis.ChassisMotionEst[axis].P_data[i * 3 + j] = ChassisMotionEst_Pinit[(axis * 3 + i) * 6 + axis * 3 + j];
+                Chassis.ChassisMotionEst[axis].Q_data[i * 3 + j] = ChassisMotionEst_Q[(axis * 3 + i) * 6 + axis * 3 + j];
+            }
+        }
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            for (uint8_t j = 0; j < 3; j++)
+                Chassis.ChassisMotionEst[axis].H_data[i * 3 + j] = ChassisMotionEst_H[(axis * 2 + i) * 6 + axis * 3 + j];
+            for (uint8_t j = 0; j < 2; j++)
+                Chassis.ChassisMotionEst[axis].R_data[i * 2 + j] = ChassisMotionEst_R[(axis * 2 + i) * 4 + axis * 2 + j];
+        }
+    }
+#else
+    KalmanFilter6x4_Init(&Chassis.ChassisMotionEst);
     memcpy(Chassis.ChassisMotionEst.F_data, ChassisMotionEst_F, sizeof(ChassisMotionEst_F));
     memcpy(Chassis.ChassisMotionEst.P_data, ChassisMotionEst_Pinit, sizeof(ChassisMotionEst_Pinit));
     memcpy(Chassis.ChassisMotionEst.Q_data, ChassisMotionEst_Q, sizeof(ChassisMotionEst_Q));
@@ -122,13 +173,31 @@ static void ChassisMotionEst_Init(void)
     memcpy(Chassis.ChassisMotionEst.H_data, ChassisMotionEst_H, sizeof(ChassisMotionEst_H));
     // Chassis.ChassisMotionEst.User_Func0_f = ChassisMotionEst_Tuning;
     // Chassis.ChassisMotionEst.User_Func3_f = ChassisMotionEst_ChiSquare_Test;
+#endif
 }
 
 void Chassis_Control(void)
 {
-    dt = DWT_GetDeltaT(&Chassis_DWT_Count);
+    PROFILE_BEGIN(PROFILE_CHASSIS_CONTROL);
+
+    // 处理上一周期收到的 CAN 帧, 本周期内电机/遥控/定位数据不再变化
+    // handle the CAN frames received since the last tick, motor/RC/position data stay fixed for this tick
+    PROFILE_BEGIN(PROFILE_CHASSIS_RX);
+    CAN_RxQueue_Drain(&CAN_RxQueue);
+    Chassis_Get_Snapshot();
+    PROFILE_END(PROFILE_CHASSIS_RX);
+
+    // 本周期唯一一次读取 DWT, 以下控制器共用 Chassis_Tick 的 dt 与 1/dt
+    // the only DWT read of this tick, the controllers below share the dt and 1/dt of Chassis_Tick
+    DWT_Tick_Update(&Chassis_Tick);
+    Chassis_DWT_Count = Chassis_Tick.CYCCNT;
+    dt = Chassis_Tick.dt;
     t += dt;
+    PROFILE_BEGIN(PROFILE_CHASSIS_EST);
     ChassisMotionEst_Update(dt);
+    PROFILE_END(PROFILE_CHASSIS_EST);
+
+    PROFILE_BEGIN(PROFILE_CHASSIS_CTRL);
     // 获取底盘与云台偏角
     Chassis_Get_Theta();
     // 设置底盘运动模式
@@ -137,10 +206,61 @@ void Chassis_Control(void)
     Chassis_Get_CtrlValue();
     // 底盘运动解算以及PID计算
     Chassis_Set_Control();
+    PROFILE_END(PROFILE_CHASSIS_CTRL);
+
+    PROFILE_BEGIN(PROFILE_CHASSIS_TX);
     // 发送底盘电机控制电流
     Send_Chassis_Current();
     // 发送云台手数据
     SendAerialData(&hcan2, &TempAerialX, &TempAerialY, &map_interactivity.commd_keyboard);
+    PROFILE_END(PROFILE_CHASSIS_TX);
+
+    Chassis_BlackBox_Record();
+
+    PROFILE_END(PROFILE_CHASSIS_CONTROL);
+}
+
+// 本周期的电机/控制量/功率/离线标志写入黑匣子 this tick's motors, control values, power and offline flags go into the black box
+static void Chassis_BlackBox_Record(void)
+{
+    BlackBox_Record_t record;
+
+    record.Time_ms = HAL_GetTick();
+    record.Mode = Chassis.Mode;
+    record.Status = Chassis.status;
+    record.Offline = 0;
+    for (uint8_t i = 0; i < DETECT_LIST_LENGHT; i++)
+        if (Detect_List[i].is_Lost)
+            record.Offline |= 1 << i;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        record.Rpm[i] = (int16_t)float_constrain(Chassis.ChassisMotor[i].Velocity_RPM, INT16_MIN, INT16_MAX);
+        record.Current[i] = (int16_t)float_constrain(Chassis.ChassisMotor[i].Real_Current, INT16_MIN, INT16_MAX);
+        record.Output[i] = (int16_t)float_constrain(Chassis.ChassisMotor[i].Output, INT16_MIN, INT16_MAX);
+    }
+    record.Vx = Chassis.Vx;
+    record.Vy = Chassis.Vy;
+    record.Vr = Chassis.Vr;
+    record.Power_dW = (uint16_t)float_constrain(Chassis.PowerControl.Power_Calculation_Clipping * 10.0f, 0, UINT16_MAX);
+
+    BlackBox_Record(&record);
+}
+
+// 遥控器由串口中断写入, 导航数据可能来自其他上下文; 整体读出, 本周期内 X/Y/Z 一致
+// the remote control is written by the UART interrupt and the navigation data may come from
+// another context; read them as a whole so X/Y/Z stay consistent for this tick
+static void Chassis_Get_Snapshot(void)
+{
+    Chassis_Nav_t nav;
+
+    RC_Read(&Chassis.RC);
+
+    Snapshot_Read(&Chassis_NavSnapshot, &nav);
+    Chassis.posX1000 = nav.posX1000;
+    Chassis.posY1000 = nav.posY1000;
+    Chassis.posZ1000 = nav.posZ1000;
+    Chassis.PlanX1000 = nav.PlanX1000;
+    Chassis.PlanY1000 = nav.PlanY1000;
 }
 
 static void Chassis_Get_Theta(void)
@@ -159,7 +279,7 @@ static void Chassis_Get_Theta(void)
     }
 
     Chassis.FollowTheta = float_deadband(Chassis.Theta, -0.005f, 0.005f);
-    Insert_thetaFrame(Chassis.thetaFrame, Chassis.FollowTheta, INS_GetTimeline());
+    History_Insert(&Chassis.thetaHistory, &Chassis.FollowTheta, DWT_GetTimeline_us());
 }
 
 static void Chassis_Get_CtrlValue(void)
@@ -183,10 +303,10 @@ static void Chassis_Get_CtrlValue(void)
 
     Temp_Vx = 0;
     Temp_Vy = 0;
-    Temp_Vx += remote_control.ch3;
-    Temp_Vy += remote_control.ch4 == -660 ? 0 : remote_control.ch4; // ch4 != -660 ?
+    Temp_Vx += Chassis.RC.ch3;
+    Temp_Vy += Chassis.RC.ch4 == -660 ? 0 : Chassis.RC.ch4; // ch4 != -660 ?
 
-    if (remote_control.switch_left == Switch_Up)
+    if (Chassis.RC.switch_left == Switch_Up)
     {
         Temp_Vx *= 2;
         Temp_Vy *= 2;
@@ -239,7 +359,7 @@ static void Chassis_Set_Mode(void)
         Chassis.Mode = Silence_Mode;
 
     // 拨杆切换运动模式
-    switch (remote_control.switch_right)
+    switch (Chassis.RC.switch_right)
     {
     case Switch_Up: //
         Chassis.Mode = Spinning_Mode;
@@ -260,7 +380,7 @@ static void Chassis_Set_Mode(void)
     AerialKeyBoardCmd();
 
     last_game_status = game_status.game_progress;
-    LastKeyCode = remote_control.key_code;
+    LastKeyCode = Chassis.RC.key_code;
 }
 
 static void Chassis_Set_Control(void)
@@ -268,7 +388,7 @@ static void Chassis_Set_Control(void)
     static float tempVr, posX100, posY100;
     static float spining_distance, spinnig_center0_temp, spinnig_center1_temp, move_ratio;
     static uint32_t in_pos_count, center_count, edge_count, data_novalid_count, reach_count;
-    static uint8_t thetaFrameNum, is_velocity;
+    static uint8_t is_velocity;
 
     Chassis.PlanX = Chassis.PlanX * 0.1 / (0.1 + dt) + Chassis.PlanX1000 / 10.0f * dt / (0.1 + dt); // 0.0002
     Chassis.PlanY = Chassis.PlanY * 0.1 / (0.1 + dt) + Chassis.PlanY1000 / 10.0f * dt / (0.1 + dt);
@@ -281,15 +401,15 @@ static void Chassis_Set_Control(void)
     case Follow_Mode:
     FOLLOW:
         if (fabsf(Chassis.FollowTheta) < 0.005f) // 判断是否正对头部
-            Chassis.Vr = remote_control.ch1 * Chassis.rcStickRotateRatio;
+            Chassis.Vr = Chassis.RC.ch1 * Chassis.rcStickRotateRatio;
         else
         {
-            if (remote_control.switch_left == Switch_Up)
-                Chassis.Vr = PID_Calculate(&Chassis.RotateFollow, Chassis.FollowTheta, 0.0f);
+            if (Chassis.RC.switch_left == Switch_Up)
+                Chassis.Vr = PID_Rotate_Calculate_Tick(&Chassis.RotateFollow, &Chassis_Tick, Chassis.FollowTheta, 0.0f);
             else
             {
-                Chassis.Vr = PID_Calculate(&Chassis.RotateFollow, Chassis.FollowTheta, 0.0f) +
-                             remote_control.ch1 * Chassis.rcStickRotateRatio;
+                Chassis.Vr = PID_Rotate_Calculate_Tick(&Chassis.RotateFollow, &Chassis_Tick, Chassis.FollowTheta, 0.0f) +
+                             Chassis.RC.ch1 * Chassis.rcStickRotateRatio;
             }
         }
         Chassis.VxTransfer = user_cos(-Chassis.FollowTheta / RADIAN_COEF) * (Chassis.Vx + Chassis.FollowXVelocity * Chassis.FollowCoef * 14.0f * 10.0f / wheel_radius / 2 / (pi / 60)) +
@@ -362,11 +482,11 @@ static void Chassis_Set_Control(void)
             Chassis.Vr = Chassis.Vr * 0.2f / (0.2f + dt) + tempVr * dt / (0.2f + dt);
             Chassis.Vr = float_constrain(Chassis.Vr, 0.0f, 1000.0f);
 
-            SpinningValidVx = PID_Calculate(&Chassis.SpinningValid, Chassis.posX, Chassis.spinnig_center[0]) * is_velocity;
-            SpinningValidVy = PID_Calculate(&Chassis.SpinningValid, Chassis.posY, Chassis.spinnig_center[1]) * is_velocity;
+            SpinningValidVx = PID_Rotate_Calculate_Tick(&Chassis.SpinningValid, &Chassis_Tick, Chassis.posX, Chassis.spinnig_center[0]) * is_velocity;
+            SpinningValidVy = PID_Rotate_Calculate_Tick(&Chassis.SpinningValid, &Chassis_Tick, Chassis.posY, Chassis.spinnig_center[1]) * is_velocity;
 
-            thetaFrameNum = Find_thetaFrame(Chassis.thetaFrame, (uint32_t)(INS_GetTimeline() - debugvalue));
-            preFollowTheta = Chassis.thetaFrame[thetaFrameNum].FollowTheta / RADIAN_COEF;
+            History_Interp(&Chassis.thetaHistory, DWT_GetTimeline_us() - (uint64_t)(debugvalue * 1000), &preFollowTheta);
+            preFollowTheta /= RADIAN_COEF;
             SpinningValidTheta = STD_RADIAN(-preFollowTheta + Chassis.posZ);
 
             Chassis.VxTransfer = user_cos(SpinningValidTheta) * (Chassis.Vx + SpinningValidVx * 10.0f * 10.0f / wheel_radius / 2 / (pi / 60)) +
@@ -536,7 +656,7 @@ static void Chassis_Set_Control(void)
     }
 
     if (is_TOE_Error(GIMBAL_YAW_MOTOR_TOE)) // 如果YAW轴电机掉线（云台无法旋转），只有底盘旋转带动枪管旋转
-        Chassis.Vr = remote_control.ch1 * Chassis.rcStickRotateRatio;
+        Chassis.Vr = Chassis.RC.ch1 * Chassis.rcStickRotateRatio;
 
     // Chassis.posX1000 = int16_deadband(Chassis.posX1000, -100, 100);
     // Chassis.posY1000 = int16_deadband(Chassis.posY1000, -100, 100);
@@ -546,8 +666,8 @@ static void Chassis_Set_Control(void)
     // float SpinningValidVx = PID_Calculate(&Chassis.SpinningValid, Chassis.posX, 0.0f);
     // float SpinningValidVy = PID_Calculate(&Chassis.SpinningValid, Chassis.posY, 0.0f);
 
-    // thetaFrameNum = Find_thetaFrame(Chassis.thetaFrame, (uint32_t)(INS_GetTimeline() - debugvalue));
-    // preFollowTheta = Chassis.thetaFrame[thetaFrameNum].FollowTheta / RADIAN_COEF;
+    // History_Interp(&Chassis.thetaHistory, DWT_GetTimeline_us() - (uint64_t)(debugvalue * 1000), &preFollowTheta);
+    // preFollowTheta /= RADIAN_COEF;
     // SpinningValidTheta = STD_RADIAN(-preFollowTheta + Chassis.posZ);
 
     // Chassis.VxTransfer = user_cos(SpinningValidTheta) * (Chassis.Vx + SpinningValidVx * 10.0f * 10.0f / wheel_radius / 2 / (pi / 60)) +
@@ -566,10 +686,17 @@ static void Chassis_Set_Control(void)
 
     Velocity_MAXLimit();
 
-    Motor_Speed_Calculate(&Chassis.ChassisMotor[0], Chassis.ChassisMotor[0].Velocity_RPM, Chassis.V1);
-    Motor_Speed_Calculate(&Chassis.ChassisMotor[1], Chassis.ChassisMotor[1].Velocity_RPM, Chassis.V2);
-    Motor_Speed_Calculate(&Chassis.ChassisMotor[2], Chassis.ChassisMotor[2].Velocity_RPM, Chassis.V3);
-    Motor_Speed_Calculate(&Chassis.ChassisMotor[3], Chassis.ChassisMotor[3].Velocity_RPM, Chassis.V4);
+#ifdef Chassis_Wheel_PID_Batch
+    {
+        float wheel_speed[4] = {Chassis.V1, Chassis.V2, Chassis.V3, Chassis.V4};
+        Motor_Speed_Calculate_Batch(Chassis.ChassisMotor, &Chassis.WheelPID, &Chassis_Tick, wheel_speed);
+    }
+#else
+    Motor_Speed_Calculate_Tick(&Chassis.ChassisMotor[0], &Chassis_Tick, Chassis.ChassisMotor[0].Velocity_RPM, Chassis.V1);
+    Motor_Speed_Calculate_Tick(&Chassis.ChassisMotor[1], &Chassis_Tick, Chassis.ChassisMotor[1].Velocity_RPM, Chassis.V2);
+    Motor_Speed_Calculate_Tick(&Chassis.ChassisMotor[2], &Chassis_Tick, Chassis.ChassisMotor[2].Velocity_RPM, Chassis.V3);
+    Motor_Speed_Calculate_Tick(&Chassis.ChassisMotor[3], &Chassis_Tick, Chassis.ChassisMotor[3].Velocity_RPM, Chassis.V4);
+#endif
 
     if (!isnormal(Chassis.ChassisMotor[0].Output))
     {
@@ -604,9 +731,11 @@ static void Send_Chassis_Current(void) /*发送底盘电机控制电流*/
 {
     static uint32_t count = 0;
 
+    // HAL_BUSY 表示覆盖了未发出的同 ID 帧, 新帧已被接收, 同样喂狗
+    // HAL_BUSY means an unsent frame with the same ID was replaced and the new one accepted, so it feeds the watchdog too
     if (is_TOE_Error(RC_TOE) && is_TOE_Error(VTM_TOE)) // RC——遥控器接收器  VTM——图传
     {
-        if (Send_Motor_Current_1_4(&hcan1, 0, 0, 0, 0) == HAL_OK)
+        if (Send_Motor_Current_1_4(&hcan1, 0, 0, 0, 0) != HAL_ERROR)
             HAL_IWDG_Refresh(&hiwdg);
         ;
     }
@@ -615,7 +744,7 @@ static void Send_Chassis_Current(void) /*发送底盘电机控制电流*/
         // if (Send_Motor_Current_1_4(&hcan1,
         //                            Chassis.ChassisMotor[0].Output, Chassis.ChassisMotor[1].Output,
         //                            Chassis.ChassisMotor[2].Output, Chassis.ChassisMotor[3].Output) == HAL_OK)
-        if (Send_Motor_Current_1_4(&hcan1, 0, 0, 0, 0) == HAL_OK)
+        if (Send_Motor_Current_1_4(&hcan1, 0, 0, 0, 0) != HAL_ERROR)
             HAL_IWDG_Refresh(&hiwdg);
         ;
     }
@@ -650,12 +779,21 @@ static void ChassisMotionEst_Update(float dt)
     for (uint8_t i = 0; i < 2; i++)
         sigmaSqrt[i] = ChassisMotionEst_Sigma[i] * ChassisMotionEst_Sigma[i];
 
+#ifdef ChassisMotionEst_UseBlock
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        Chassis.ChassisMotionEst[i].F_data[1] = dt;
+        Chassis.ChassisMotionEst[i].F_data[2] = dt * dt * 0.5f;
+        Chassis.ChassisMotionEst[i].F_data[5] = dt;
+    }
+#else
     Chassis.ChassisMotionEst.F_data[1] = dt;
     Chassis.ChassisMotionEst.F_data[2] = dt * dt * 0.5f;
     Chassis.ChassisMotionEst.F_data[8] = dt;
     Chassis.ChassisMotionEst.F_data[22] = dt;
     Chassis.ChassisMotionEst.F_data[23] = dt * dt * 0.5f;
     Chassis.ChassisMotionEst.F_data[29] = dt;
+#endif
 
     ChassisMotionEst_Q[0] = dt * dt * dt * dt * dt * dt / 36.0f * sigmaSqrt[X];
     ChassisMotionEst_Q[1] = dt * dt * dt * dt * dt / 12.0f * sigmaSqrt[X];
@@ -688,12 +826,35 @@ static void ChassisMotionEst_Update(float dt)
     // Chassis.VxTransfer_is = Chassis.Vx_is * cosf(-Chassis.FollowTheta / RADIAN_COEF) + Chassis.Vy_is * sinf(-Chassis.FollowTheta / RADIAN_COEF);
     // Chassis.VyTransfer_is = Chassis.Vy_is * cosf(-Chassis.FollowTheta / RADIAN_COEF) - Chassis.Vx_is * sinf(-Chassis.FollowTheta / RADIAN_COEF);
 
+#ifdef ChassisMotionEst_UseBlock
+    Chassis.ChassisMotionEst[X].MeasuredVector[0] = Chassis.Vx_is;
+    Chassis.ChassisMotionEst[X].MeasuredVector[1] = BMI088.Accel[0] * 100.0f;
+    Chassis.ChassisMotionEst[Y].MeasuredVector[0] = Chassis.Vy_is;
+    Chassis.ChassisMotionEst[Y].MeasuredVector[1] = BMI088.Accel[1] * 100.0f;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        KalmanFilter3x2_Update(&Chassis.ChassisMotionEst[i]);
+
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            if (!isnormal(Chassis.ChassisMotionEst[i].xhat_data[j]))
+                Chassis.ChassisMotionEst[i].xhat_data[j] = 0;
+            if (!isnormal(Chassis.ChassisMotionEst[i].FilteredValue[j]))
+                Chassis.ChassisMotionEst[i].FilteredValue[j] = 0;
+        }
+
+        Chassis.Position[i] = Chassis.ChassisMotionEst[i].FilteredValue[0];
+        Chassis.Velocity[i] = Chassis.ChassisMotionEst[i].FilteredValue[1];
+        Chassis.Accel[i] = Chassis.ChassisMotionEst[i].FilteredValue[2];
+    }
+#else
     Chassis.ChassisMotionEst.MeasuredVector[0] = Chassis.Vx_is;
     Chassis.ChassisMotionEst.MeasuredVector[1] = BMI088.Accel[0] * 100.0f;
     Chassis.ChassisMotionEst.MeasuredVector[2] = Chassis.Vy_is;
     Chassis.ChassisMotionEst.MeasuredVector[3] = BMI088.Accel[1] * 100.0f;
 
-    Kalman_Filter_Update(&Chassis.ChassisMotionEst);
+    KalmanFilter6x4_Update(&Chassis.ChassisMotionEst);
 
     for (uint8_t i = 0; i < Chassis.ChassisMotionEst.xhatSize; i++)
     {
@@ -709,6 +870,7 @@ static void ChassisMotionEst_Update(float dt)
         Chassis.Velocity[i] = Chassis.ChassisMotionEst.FilteredValue[i * 3 + 1];
         Chassis.Accel[i] = Chassis.ChassisMotionEst.FilteredValue[i * 3 + 2];
     }
+#endif
 
     Chassis.V_Position[0] += Chassis.Vx_is * dt;
     Chassis.V_Position[1] += Chassis.Vy_is * dt;
@@ -743,8 +905,8 @@ void Chassis_Power_Limit(void)
         // 计算修正后的功率限制
         Chassis.PowerControl.Power_Limit = Chassis.PowerControl.Power_correction_gain * robot_state.chassis_power_limit;
 
-        // 缓冲能量充足时，可放宽限制
-        if (power_heat_data_t.chassis_power_buffer > 30)
+        // 缓冲能量充足且数据未过期时，可放宽限制
+        if (power_heat_data_t.chassis_power_buffer > 30 && JudgeCmd_Is_Fresh(POWER_HEAT_DATA_CMD_ID, POWER_HEAT_TIMEOUT_US))
             Chassis.PowerControl.Power_Limit = 1.5f * Chassis.PowerControl.Power_correction_gain * robot_state.chassis_power_limit;
     }
 
@@ -797,29 +959,6 @@ static void Velocity_MAXLimit(void)
     }
 }
 
-void Insert_thetaFrame(thetaFrame_t *theta_frame, float follow_theta, uint32_t time_stamp_ms)
-{
-    memmove(theta_frame + 1, theta_frame, (FOLLOW_THETA_LEN - 1) * sizeof(thetaFrame_t));
-    theta_frame[0].TimeStamp_ms = time_stamp_ms;
-    theta_frame[0].FollowTheta = follow_theta;
-}
-
-uint16_t Find_thetaFrame(thetaFrame_t *theta_frame, uint32_t match_time_stamp_ms)
-{
-    uint16_t num = 0;
-    float min_time_error = fabsf((float)(theta_frame[0].TimeStamp_ms) - match_time_stamp_ms);
-
-    for (uint16_t i = 0; i < FOLLOW_THETA_LEN; i++)
-    {
-        if (fabsf((float)(theta_frame[i].TimeStamp_ms) - match_time_stamp_ms) < min_time_error)
-        {
-            min_time_error = fabsf((float)(theta_frame[i].TimeStamp_ms) - match_time_stamp_ms);
-            num = i;
-        }
-    }
-    return num;
-}
-
 void AerialKeyBoardCmd(void)
 {
     switch (map_interactivity.commd_keyboard)
@@ -3,9 +3,20 @@
 
 #include "includes.h"
 #include "kalman_filter.h"
+#include "kalman_filter_static.h"
+#include "pid_static.h"
+#include "state_history.h"
+#include "snapshot.h"
+#include "remote_control.h"
+#include "task_period.h"
 #include "motor.h"
 
 // #define Chassis_Use_IMU
+// 底盘运动估计 F P Q H R 在 X/Y 间为分块对角, 按两个独立的 3 状态 2 量测滤波器计算
+// the chassis motion estimate F P Q H R are block diagonal in X/Y, so it runs as two independent 3 state 2 measurement filters
+#define ChassisMotionEst_UseBlock
+// 四个轮速环参数相同, 按一组成批计算 the four wheel velocity loops share their gains and are computed as one batch
+#define Chassis_Wheel_PID_Batch
 #define Chassis_Vr_FFC_MAXOUT 800
 #define Chassis_Vr_FCC_LPF 0.001
 #define Chassis_Vr_C0 1
@@ -20,6 +31,7 @@
 
 #define POWER_GAIN 0.95f // 功率修正系数
 #define LOWVOLTAGE_GAIN 0.7
+#define POWER_HEAT_TIMEOUT_US 200000 // 0x0202 以 50Hz 发送, 超过 200ms 未更新则不信任缓冲能量 distrust the buffer energy after 200 ms without 0x0202
 
 #define ENABLE_SPINNING
 
@@ -52,11 +64,6 @@
 
 #define FOLLOW_THETA_LEN 200
 
-typedef struct
-{
-  float FollowTheta;
-  float TimeStamp_ms;
-} thetaFrame_t;
 
 typedef struct
 {
@@ -86,6 +93,18 @@ typedef struct
   PID_t PID_Follow;
 } MiniPC_ControlFrame;
 
+// 导航板发来的定位与规划点, 由 CAN 接收处理函数整体发布
+// pose and plan point from the navigation board, published as a whole by the CAN receive handlers
+typedef struct
+{
+  int16_t posX1000;
+  int16_t posY1000;
+  int16_t posZ1000;
+  int16_t PlanX1000;
+  int16_t PlanY1000;
+  uint32_t TimeStamp; // 0x151 帧的 DWT->CYCCNT 时间戳 cycle counter stamp of the last 0x151 frame
+} Chassis_Nav_t;
+
 typedef struct _Chassis_t
 {
   int16_t Vx, Vy, Vr; /*XY轴速度与角速度 */
@@ -97,7 +116,11 @@ typedef struct _Chassis_t
   float rcStickRotateRatio; /*摇杆运动与电机间的比例系数*/
   float rcMouseRotateRatio; /*鼠标运动与电机间的比例系数*/
 
-  KalmanFilter_t ChassisMotionEst;
+#ifdef ChassisMotionEst_UseBlock
+  KalmanFilter3x2_t ChassisMotionEst[2]; /*X Y 轴独立的运动估计*/
+#else
+  KalmanFilter6x4_t ChassisMotionEst;
+#endif
   float V1, V2, V3, V4;
 
   float Vx_is_Chassis, Vy_is_Chassis; /*底盘坐标系下反解出的车速度*/
@@ -134,7 +157,10 @@ typedef struct _Chassis_t
   Chassis_PowerControl_t PowerControl;
 
   Motor_t ChassisMotor[4];
-  PID_t RotateFollow;
+#ifdef Chassis_Wheel_PID_Batch
+  PID_Batch_t WheelPID; /*四轮速度环*/
+#endif
+  PID_Rotate_t RotateFollow;
 
   TD_t ChassisVxTD;
   TD_t ChassisVyTD;
@@ -149,7 +175,9 @@ typedef struct _Chassis_t
   uint8_t FlagFollow;
   uint8_t IsSpining;
 
-  PID_t SpinningValid;
+  PID_Rotate_t SpinningValid;
+  RC_Type RC; // 本周期的遥控器快照 remote control snapshot for this tick
+  // 以下 *1000 为本周期的导航快照 the *1000 fields below are this tick's navigation snapshot
   int16_t posX1000;
   int16_t posY1000;
   int16_t posZ1000;
@@ -161,7 +189,7 @@ typedef struct _Chassis_t
   int16_t PlanY1000;
   float PlanX;
   float PlanY;
-  thetaFrame_t thetaFrame[FOLLOW_THETA_LEN];
+  History_t thetaHistory; // FollowTheta 历史, 用于延迟补偿 FollowTheta history for latency compensation
 } Chassis_t;
 
 enum
@@ -189,12 +217,13 @@ enum
 void Chassis_Control(void);
 void Chassis_Init(void);
 void Callback_Follow_Handle(MiniPC_ControlFrame *MiniPC_CtrlFrame, uint8_t *buff);
-void Insert_thetaFrame(thetaFrame_t *theta_frame, float follow_theta, uint32_t time_stamp_ms);
-uint16_t Find_thetaFrame(thetaFrame_t *theta_frame, uint32_t match_time_stamp_ms);
 void SendMapData(void);
 void AerialKeyBoardCmd(void);
 
 extern Chassis_t Chassis;
+extern Snapshot_t Chassis_NavSnapshot;
+extern TaskPeriod_t Chassis_Period;
+extern DWT_Tick_t Chassis_Tick;
 extern MiniPC_ControlFrame MiniPC_CtrlFrame;
 extern uint8_t aimassist_online;
 
@@ -1,38 +1,86 @@
 #include "ins_task.h"
 #include "QuaternionAHRS.h"
+#include "ConingIntegrator.h"
 #include "includes.h"
 #include "GravityEstimateKF.h"
+#include "QuaternionEKF.h"
+#include "pid_static.h"
 #include "tim.h"
+#include "profiler.h"
+#include "string.h"
 
-PID_t TempCtrl = {0};
+PID_Heat_t TempCtrl = {0};
 
-uint32_t INS_DWT_Count = 0;
+DWT_Tick_t INS_Tick; // 以角速度样本的采样时刻计时 timed by the gyro sample times
+TaskPeriod_t INS_Period;
+static TaskHandle_t INS_TaskHandle = NULL;
+static BMI088_Gyro_Frame_t INS_Frame[BMI088_GYRO_FRAME_RING];
+static Coning_t INS_Coning;
 static float dt = 0, t = 0;
-uint8_t ins_debug_mode = 0;
+#ifdef INS_USE_QEKF
+static float gravity[3] = {0, 0, INS_GRAVITY};
+#endif
 float RefTemp = 40;
 
 void INS_Init(void)
 {
     // 卡尔曼滤波器初始化
-    gEstimateKF_Init(0.01, 100000);
+#ifdef INS_USE_QEKF
+    IMU_QuaternionEKF_Init(INS_QEKF_Q1, INS_QEKF_Q2, INS_QEKF_R, INS_QEKF_LAMBDA, INS_QEKF_LPF);
+#else
+    gEstimateKF_Init(INS_GKF_Q, INS_GKF_R);
+#endif
+    QuaternionHistory_Init();
 
     // imu heat init
     // IMU_PWM_Init();
-    PID_Init(&TempCtrl, 2000, 1200, 0, 500, 80, 0, 0, 0, 0, 0, 0,
-             DerivativeFilter | Integral_Limit | Trapezoid_Intergral); // IMU温度控制用
+    PID_Heat_Init(&TempCtrl, 2000, 1200, 0, 500, 80, 0, 0, 0, 0, 0); // IMU温度控制用, DerivativeFilter | Integral_Limit | Trapezoid_Intergral
     HAL_TIM_PWM_Start(&htim10, TIM_CHANNEL_1);
+
+    Telem_Register_Float(TELEM_INS_YAW, "ins.yaw", &AHRS.Yaw);
+    Telem_Register_Float(TELEM_INS_PITCH, "ins.pitch", &AHRS.Pitch);
+    Telem_Register_Float(TELEM_INS_ROLL, "ins.roll", &AHRS.Roll);
+    Telem_Register_Float(TELEM_INS_GVEC_X, "ins.gvec_x", &gVec[X]);
+    Telem_Register_Float(TELEM_INS_GVEC_Y, "ins.gvec_y", &gVec[Y]);
+    Telem_Register_Float(TELEM_INS_GVEC_Z, "ins.gvec_z", &gVec[Z]);
+    Telem_Register_Float(TELEM_INS_ACCEL_X, "ins.accel_x", &BMI088.Accel[X]);
+    Telem_Register_Float(TELEM_INS_ACCEL_Y, "ins.accel_y", &BMI088.Accel[Y]);
+    Telem_Register_Float(TELEM_INS_ACCEL_Z, "ins.accel_z", &BMI088.Accel[Z]);
+    Telem_Register_Float(TELEM_INS_GYRO_X, "ins.gyro_x", &BMI088.Gyro[X]);
+    Telem_Register_Float(TELEM_INS_GYRO_Y, "ins.gyro_y", &BMI088.Gyro[Y]);
+    Telem_Register_Float(TELEM_INS_GYRO_Z, "ins.gyro_z", &BMI088.Gyro[Z]);
+    Telem_Register_Float(TELEM_IMU_TEMP, "imu.temp", &BMI088.Temperature);
+    Telem_Register_Float(TELEM_IMU_HEAT_OUT, "imu.heat_out", &TempCtrl.Output);
+
+    // 此后由数据就绪中断触发 DMA 读取, 读完角速度后通知本任务
+    // from here on data ready triggers the DMA reads, this task is notified once the gyro is read
+    INS_TaskHandle = xTaskGetCurrentTaskHandle();
+    DWT_Tick_Update(&INS_Tick);
+    BMI088_DMA_Start();
 }
 
 void INS_Task(void)
 {
     static uint32_t count = 0;
-    dt = DWT_GetDeltaT(&INS_DWT_Count);
-    t += dt;
+    uint8_t frames;
+    float gyro[3];
+    PROFILE_BEGIN(PROFILE_INS);
 
-    // ins update
-    if ((count % 1) == 0)
+    // ins update, 仅在有新的角速度样本时 only on new gyro samples
+    frames = BMI088_Read_Sample(&BMI088, INS_Frame, BMI088_GYRO_FRAME_RING);
+    if (frames)
     {
-        BMI088_Read(&BMI088);
+        // 上次更新以来的全部样本经圆锥补偿合成一次更新; 各样本的 dt 取相邻采样时刻之差, 不含任务唤醒延迟
+        // every sample since the last update goes into one coning compensated update; the dt of a
+        // sample is the spacing of the sample times, free of wake-up latency
+        Coning_Reset(&INS_Coning);
+        for (uint8_t i = 0; i < frames; i++)
+        {
+            DWT_Tick_Update_At(&INS_Tick, INS_Frame[i].CYCCNT);
+            Coning_Update(&INS_Coning, INS_Frame[i].Gyro, INS_Tick.dt);
+        }
+        dt = Coning_Get_Rate(&INS_Coning, gyro);
+        t += dt;
 
         for (uint8_t i = 0; i < 3; i++) // 姿态解算
         {
@@ -40,21 +88,19 @@ void INS_Task(void)
             AHRS.Gyro[i] = BMI088.Gyro[i];
         }
 
-        gEstimateKF_Update(BMI088.Gyro[X], BMI088.Gyro[Y], BMI088.Gyro[Z], BMI088.Accel[X], BMI088.Accel[Y], BMI088.Accel[Z], dt);
-        Quaternion_AHRS_UpdateIMU(BMI088.Gyro[X], BMI088.Gyro[Y], BMI088.Gyro[Z], gVec[X], gVec[Y], gVec[Z], dt);
-        InsertQuaternionFrame(&QuaternionBuffer, AHRS.q, USER_GetTick() / 1000.0f);
+#ifdef INS_USE_QEKF
+        // 单级: 直接融合加速度, gVec 由姿态给出以保持遥测与下游接口不变
+        // fused: accel goes straight in, gVec follows from the attitude so telemetry and users stay unchanged
+        IMU_QuaternionEKF_Update(gyro[X], gyro[Y], gyro[Z], BMI088.Accel[X], BMI088.Accel[Y], BMI088.Accel[Z], dt);
+        memcpy(AHRS.q, QEKF_INS.q, sizeof(AHRS.q));
+        EarthFrameToBodyFrame(gravity, gVec, AHRS.q);
+#else
+        gEstimateKF_Update(gyro[X], gyro[Y], gyro[Z], BMI088.Accel[X], BMI088.Accel[Y], BMI088.Accel[Z], dt);
+        Quaternion_AHRS_UpdateIMU(gyro[X], gyro[Y], gyro[Z], gVec[X], gVec[Y], gVec[Z], dt);
+#endif
+        History_Insert(&QuaternionHistory, AHRS.q, DWT_GetTimeline_us_At(INS_Frame[frames - 1].CYCCNT));
 
         Get_EulerAngle(AHRS.q);
-
-        if (GlobalDebugMode == INS_DEBUG) // DEBUG时 打印数据
-        {
-            if (ins_debug_mode == 0)
-                Serial_Debug(&huart1, 1, AHRS.Yaw, AHRS.Pitch, AHRS.Roll, 0, 0, 0);
-            if (ins_debug_mode == 1)
-                Serial_Debug(&huart1, 1, gVec[0], gVec[1], gVec[2], AHRS.Accel[X], AHRS.Accel[Y], AHRS.Accel[Z]);
-            if (ins_debug_mode == 2)
-                Serial_Debug(&huart1, 1, atan2f(gVec[0], gVec[2]) * RADIAN_COEF, atan2f(gVec[1], gVec[2]) * RADIAN_COEF, atan2f(AHRS.Accel[X], AHRS.Accel[Z]) * RADIAN_COEF, atan2f(AHRS.Accel[Y], AHRS.Accel[Z]) * RADIAN_COEF, 0, 0);
-        }
     }
 
     // temperature control
@@ -62,8 +108,6 @@ void INS_Task(void)
     {
         // 500hz
         IMU_Temperature_Ctrl();
-        if (GlobalDebugMode == IMU_HEAT_DEBUG)
-            Serial_Debug(&huart1, 1, RefTemp, BMI088.Temperature, TempCtrl.Output / 1000.0f, TempCtrl.Pout / 1000.0f, TempCtrl.Iout / 1000.0f, TempCtrl.Dout / 1000.0f);
     }
 
     if ((count % 1000) == 0)
@@ -72,11 +116,52 @@ void INS_Task(void)
     }
 
     count++;
+    PROFILE_END(PROFILE_INS);
+}
+
+/**
+ * @brief 阻塞到下一个角速度样本读出; 数据就绪丢失或传输卡住时超时, 重新触发读取
+ *        block until the next gyro sample has been read; on a timeout (lost data ready or
+ *        a hung transfer) the reads are triggered again
+ */
+void INS_Wait(void)
+{
+    if (TaskPeriod_Wait_Notify(&INS_Period, INS_SAMPLE_TIMEOUT) == 0)
+    {
+        taskENTER_CRITICAL();
+        BMI088_DMA_Restart();
+        taskEXIT_CRITICAL();
+    }
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if (GPIO_Pin == INT1_ACCEL_Pin)
+        BMI088_Accel_DRDY_IRQHandler();
+    else if (GPIO_Pin == INT1_GYRO_Pin)
+        BMI088_Gyro_DRDY_IRQHandler();
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (hspi != BMI088_SPI)
+        return;
+    if ((BMI088_DMA_Cplt_IRQHandler() & (1 << BMI088_GYRO_DATA_READY_BIT)) && INS_TaskHandle != NULL)
+        vTaskNotifyGiveFromISR(INS_TaskHandle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+    if (hspi == BMI088_SPI)
+        BMI088_DMA_Error_IRQHandler();
 }
 
 void IMU_Temperature_Ctrl(void)
 {
-    PID_Calculate(&TempCtrl, BMI088.Temperature, RefTemp);
+    PID_Heat_Calculate(&TempCtrl, BMI088.Temperature, RefTemp);
 
     TIM_Set_PWM(&htim10, TIM_CHANNEL_1, float_constrain(float_rounding(TempCtrl.Output), 0, UINT32_MAX));
 }
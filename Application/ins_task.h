@@ -3,8 +3,26 @@
 
 #include "stdint.h"
 #include "includes.h"
+#include "task_period.h"
 
 #define INS_TASK_PERIOD 1
+// 单级姿态解算: 由 QuaternionEKF 直接融合角速度与加速度 (含卡方检验与零偏估计), 取代 gEstimateKF
+// 加 Quaternion_AHRS 的两级结构; 两者的对比见 Host/ins_replay.c
+// single-stage attitude: the QuaternionEKF fuses gyro and accel directly (chi-square gate, bias
+// estimate), replacing the gEstimateKF plus Quaternion_AHRS pipeline; compared in Host/ins_replay.c
+// #define INS_USE_QEKF
+// gEstimateKF 过程/量测噪声 process/measure noise
+#define INS_GKF_Q 0.01f
+#define INS_GKF_R 100000
+// QuaternionEKF 参数, 见 IMU_QuaternionEKF_Init() parameters, see IMU_QuaternionEKF_Init()
+#define INS_QEKF_Q1 10
+#define INS_QEKF_Q2 0.001f
+#define INS_QEKF_R 1000000
+#define INS_QEKF_LAMBDA 0.9996f
+#define INS_QEKF_LPF 0
+#define INS_GRAVITY 9.8f
+// 超过该时间 (ms) 没有角速度样本时重新触发读取 re-trigger the reads when no gyro sample arrived for this long (ms)
+#define INS_SAMPLE_TIMEOUT 5
 
 #define INS_GetTimeline HAL_GetTick
 
@@ -16,9 +34,11 @@ enum
 };
 
 extern float RefTemp;
+extern TaskPeriod_t INS_Period;
 
 void INS_Init(void);
 void INS_Task(void);
+void INS_Wait(void);
 void IMU_Temperature_Ctrl(void);
 
 #endif
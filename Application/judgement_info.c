@@ -1,5 +1,6 @@
 #include "judgement_info.h"
 #include "bsp_usart_idle.h"
+#include "crc8_16.h"
 #include "string.h"
 #include "detect_task.h"
 
@@ -8,8 +9,8 @@
 
 judge_receive_t judgement_receive;
 // judgement_race_t judgement_race_data;
-static uint8_t *p_header, count;
-static uint16_t data_length;
+static uint8_t Judge_RxBuf[JUDGE_RX_BUF_LEN];
+JudgeParser_t JudgeParser;
 UART_HandleTypeDef *JudgeUSART;
 uint8_t JudgeRxValid = 0;
 uint8_t JudgeRxData[8] = {0};
@@ -42,45 +43,33 @@ ext_robot_interactive_data_t robot_interactive_data; // �������ݽ
 
 ext_map_interactivity_t map_interactivity; // С��ͼ������Ϣ��ʶ
 
+static void Judge_Frame_Handle(const uint8_t *frame, uint16_t frame_len)
+{
+    memcpy(judgement_receive.header, frame, frame_len);
+    judgement_data_decode();
+}
+
 void Judge_Control_Init(UART_HandleTypeDef *huart)
 {
     JudgeUSART = huart;
-    USART_IDLE_Init(huart, judgement_receive.buf, 100);
+    JudgeParser_Init(&JudgeParser, Judge_Frame_Handle);
+    USART_IDLE_Stream_Init(huart, Judge_RxBuf, JUDGE_RX_BUF_LEN);
 }
 
 void USER_UART_RxIdleCallback(UART_HandleTypeDef *huart)
 {
     if (huart == JudgeUSART)
     {
-        unpack_fifo_handle(judgement_receive.buf);
+        JudgeParser_Feed_Ring(&JudgeParser, Judge_RxBuf, JUDGE_RX_BUF_LEN,
+                              JUDGE_RX_BUF_LEN - __HAL_DMA_GET_COUNTER(huart->hdmarx));
         Detect_Hook(JUDGE_TOE);
     }
     else if (huart == remote_control.RC_USART)
     {
-        Callback_RC_Handle(&remote_control, sbus_rx_buf);
+        Callback_RC_Handle(&remote_control, sbus_rx_buf, RC_SOURCE_UART);
     }
 }
 
-void unpack_fifo_handle(uint8_t *prxbuf) //
-{
-    p_header = prxbuf; // �ҵ�֡ͷȻ����
-    count = 0;
-    while (count < 98)
-    {
-        if (*p_header == JUDGE_SOF)
-        {
-            memcpy(&data_length, (p_header + 1), 2);
-            if (data_length <= 32 && count + data_length + 9 < 100)
-            {
-                judgement_info_handle();
-            }
-        }
-        else
-            p_header++;
-
-        count = p_header - prxbuf;
-    }
-}
 // frame_header (5-byte) cmd_id (2-byte) data (n-byte) frame_tail (2-byte��CRC16������У��)
 // ����frame_header
 // �� 					ƫ��λ��  ��С���ֽڣ�  ��ϸ����
@@ -88,156 +77,292 @@ void unpack_fifo_handle(uint8_t *prxbuf) //
 // data_length       1 				2 						����֡�� data �ĳ���
 // seq 				3 				1 						�����
 // CRC8 				4 				1 						֡ͷ CRC8 У��
-void judgement_info_handle(void)
+void JudgeParser_Init(JudgeParser_t *parser, JudgeParser_Frame_f frame_handler)
 {
-    if ((Verify_CRC8_Check_Sum(p_header, 5) == 0) || (Verify_CRC16_Check_Sum(p_header, (9 + data_length)) == 0))
-    {
-        p_header++;
-        return;
-    }
+    memset(parser, 0, sizeof(JudgeParser_t));
+    parser->CRC16 = CRC_INIT;
+    parser->FrameHandler = frame_handler;
+}
 
-    memcpy(judgement_receive.header, p_header, (data_length + 9));
-    judgement_data_decode();
-    p_header = p_header + data_length + 9;
+// 丢弃开头 from 字节, 并将之后的下一个 SOF 移到缓冲区开头, 找不到则清空
+// drop the first from bytes and move the next SOF after them to the front, or empty the buffer if there is none
+static void JudgeParser_Resync(JudgeParser_t *parser, uint16_t from)
+{
+    uint8_t *sof = memchr(parser->Frame + from, JUDGE_SOF, parser->Index - from);
+    uint16_t skip = sof != NULL ? sof - parser->Frame : parser->Index;
+
+    parser->Stat.Skipped += skip - from;
+    parser->Index -= skip;
+    memmove(parser->Frame, parser->Frame + skip, parser->Index);
+    parser->FrameLen = 0;
+    parser->CRC16 = CRC_INIT;
+    parser->CRC16Len = 0;
 }
 
-void judgement_data_decode(void)
+/**
+ * @brief 检查已收到的字节, 解出所有完整的帧
+ *        check the collected bytes and decode every complete frame
+ * @note  校验失败时从 SOF 之后的下一个字节重新寻找帧头, 出错帧内部的正确帧不会丢失
+ *        on a checksum failure the search restarts right after the SOF, so a
+ *        good frame hidden inside a corrupted one is not lost
+ */
+static void JudgeParser_Check(JudgeParser_t *parser)
 {
-    switch (judgement_receive.cmd)
-    {
-    case GAME_STATUS_CMD_ID:
-    {
-        memcpy(&game_status, judgement_receive.data, sizeof(ext_game_status_t));
-        // game_status.game_type = judgement_receive.data[0] & 0x0f;
-        // game_status.game_progress = (judgement_receive.data[0] & 0xf0) >> 4;
-        // game_status.stage_remain_time = (uint16_t)(judgement_receive.data[2] << 8 | judgement_receive.data[1]);
-        // memcpy(&game_status.SyncTimeStamp, judgement_receive.data + 3, 8);
-    }
-    break;
-    case GAME_RESULT_CMD_ID:
-    {
-        memcpy(&game_result, judgement_receive.data, sizeof(ext_game_result_t));
-    }
-    break;
-    case GAME_ROBOT_HP_CMD_ID:
-    {
-        memcpy(&game_robot_HP, judgement_receive.data, sizeof(ext_game_robot_HP_t));
-    }
-    break;
-    case DART_STATUS_CMD_ID:
-    {
-        memcpy(&dart_status, judgement_receive.data, sizeof(ext_dart_status_t));
-    }
-    break;
-    case ICRA_BUFF_DEBUFF_ZONE_STATUS_CMD_ID:
-    {
-        memcpy(&ICRA_buff_debuff_zone_status, judgement_receive.data, sizeof(ext_ICRA_buff_debuff_zone_status_t));
-    }
-    break;
-    case EVEN_DATA_CMD_ID:
-    {
-        memcpy(&event_data, judgement_receive.data, sizeof(ext_event_data_t));
-    }
-    break;
-    case SUPPLY_PROJECTILE_ACTION_CMD_ID:
-    {
-        memcpy(&supply_projectile_action, judgement_receive.data, sizeof(ext_supply_projectile_action_t));
-    }
-    break;
-    case REFEREE_WARNING_CMD_ID:
-    {
-        memcpy(&referee_warning, judgement_receive.data, sizeof(ext_referee_warning_t));
-    }
-    break;
-    case DART_REMAINING_TIME_CMD_ID:
-    {
-        memcpy(&dart_remaining_time, judgement_receive.data, sizeof(ext_dart_remaining_time_t));
-    }
-    break;
-    case GAME_ROBOT_STATUS_CMD_ID:
-    {
-        memcpy(&robot_state, judgement_receive.data, sizeof(ext_game_robot_status_t));
-        if (robot_state.chassis_power_limit >= 10240)
-            robot_state.chassis_power_limit /= 256;
-        if (robot_state.chassis_power_limit >= 200)
-            robot_state.chassis_power_limit /= 5;
-    }
-    break;
-    case POWER_HEAT_DATA_CMD_ID:
-    {
-        memcpy(&power_heat_data_t, judgement_receive.data, sizeof(ext_power_heat_data_t));
-        Shoot_Updata = 1;
-    }
-    break;
-    case GAME_ROBOT_POS_CMD_ID:
-    {
-        memcpy(&game_robot_pos, judgement_receive.data, sizeof(ext_game_robot_pos_t));
-    }
-    break;
-    case BUFF_MUSK_CMD_ID:
-    {
-        memcpy(&buff_musk, judgement_receive.data, sizeof(ext_buff_musk_t));
-    }
-    break;
-    case ROBOT_ENERGY_CMD_ID:
-    {
-        memcpy(&robot_energy, judgement_receive.data, sizeof(aerial_robot_energy_t));
-    }
-    break;
-    case ROBOT_HURT_CMD_ID:
-    {
-        memcpy(&robot_hurt, judgement_receive.data, sizeof(ext_robot_hurt_t));
-    }
-    break;
-    case SHOOT_DATA_CMD_ID:
-    {
-        memcpy(&shoot_data, judgement_receive.data, sizeof(ext_shoot_data_t));
-        Shoot_Updata = 1;
-    }
-    break;
-    case BULLET_REMAINING_CMD_ID:
-    {
-        memcpy(&bullet_remaining, judgement_receive.data, sizeof(ext_bullet_remaining_t));
-    }
-    break;
-    case RFID_STATUS_CMD_ID:
-    {
-        memcpy(&rfid_status, judgement_receive.data, sizeof(ext_rfid_status_t));
-    }
-    break;
-    case DART_CLIENT_CMD_ID:
-    {
-        memcpy(&dart_client_cmd, judgement_receive.data, sizeof(ext_dart_client_cmd_t));
-    }
-    break;
-    case STUDENT_INTERACTIVE_HEADER_DATA_CMD_ID:
+    uint16_t data_length, crc_end;
+    uint8_t seq;
+
+    for (;;)
     {
-        memcpy(&student_interactive_header_data, judgement_receive.data, sizeof(ext_student_interactive_header_data_t));
-        switch (student_interactive_header_data.data_cmd_id)
+        if (parser->FrameLen == 0)
+        {
+            if (parser->Index < JUDGE_FRAME_HEADER_LEN)
+                return;
+            data_length = parser->Frame[1] | parser->Frame[2] << 8;
+            if (data_length > JUDGE_DATA_MAX_LEN || !Verify_CRC8_Check_Sum(parser->Frame, JUDGE_FRAME_HEADER_LEN))
+            {
+                parser->Stat.HeaderError++;
+                parser->Stat.Skipped++; // 假的 SOF a false SOF
+                JudgeParser_Resync(parser, 1);
+                continue;
+            }
+            parser->FrameLen = data_length + 9;
+        }
+
+        // CRC16 随字节到达累积, 帧尾到达时只需比较 the CRC16 is accumulated as bytes arrive, only compared once the tail is in
+        crc_end = parser->Index < parser->FrameLen - 2 ? parser->Index : parser->FrameLen - 2;
+        if (crc_end > parser->CRC16Len)
         {
-        case 0X201:
-            JudgeRxData[0] = student_interactive_header_data.data[0];
-            JudgeRxData[1] = student_interactive_header_data.data[1];
-            JudgeRxValid = 1;
-            break;
+            parser->CRC16 = CRC16_Update(parser->CRC16, parser->Frame + parser->CRC16Len, crc_end - parser->CRC16Len);
+            parser->CRC16Len = crc_end;
         }
+        if (parser->Index < parser->FrameLen)
+            return;
+
+        if (parser->CRC16 != (parser->Frame[parser->FrameLen - 2] | parser->Frame[parser->FrameLen - 1] << 8))
+        {
+            parser->Stat.CRC16Error++;
+            parser->Stat.Skipped++; // 假的 SOF a false SOF
+            JudgeParser_Resync(parser, 1);
+            continue;
+        }
+
+        seq = parser->Frame[3];
+        if (parser->Stat.Frames != 0)
+            parser->Stat.SeqLost += (uint8_t)(seq - parser->Seq - 1);
+        parser->Seq = seq;
+        parser->Stat.Frames++;
+        if (parser->FrameHandler != NULL)
+            parser->FrameHandler(parser->Frame, parser->FrameLen);
+
+        JudgeParser_Resync(parser, parser->FrameLen);
     }
-    break;
-    case INTERACTIVE_DATA_CMD_ID:
+}
+
+/**
+ * @brief 输入一段字节流, 可在任意位置切分 feed a piece of the byte stream, split anywhere
+ */
+void JudgeParser_Feed(JudgeParser_t *parser, const uint8_t *data, uint16_t len)
+{
+    const uint8_t *sof;
+    uint16_t n;
+
+    parser->Stat.Bytes += len;
+    while (len != 0)
     {
-        memcpy(&robot_interactive_data, judgement_receive.data, sizeof(ext_robot_interactive_data_t));
+        // 帧外的字节只需找 SOF outside a frame only the SOF matters
+        if (parser->Index == 0)
+        {
+            sof = memchr(data, JUDGE_SOF, len);
+            if (sof == NULL)
+            {
+                parser->Stat.Skipped += len;
+                return;
+            }
+            parser->Stat.Skipped += sof - data;
+            len -= sof - data;
+            data = sof;
+        }
+
+        // 一次拷贝到帧头或整帧结束 copy up to the end of the header or of the frame in one go
+        n = (parser->FrameLen != 0 ? parser->FrameLen : JUDGE_FRAME_HEADER_LEN) - parser->Index;
+        if (n > len)
+            n = len;
+        memcpy(parser->Frame + parser->Index, data, n);
+        parser->Index += n;
+        data += n;
+        len -= n;
+
+        JudgeParser_Check(parser);
     }
-    break;
-    case MAP_INTERACTIVITY_CMD_ID:
+}
+
+/**
+ * @brief 处理环形 DMA 缓冲区中 ReadPos 到 write_pos 之间的新数据
+ *        parse the new bytes between ReadPos and write_pos of a circular DMA buffer
+ * @param write_pos DMA 下一次写入的位置 where the DMA writes next
+ * @note  两次调用之间须少于 ring_len 字节, 整整一圈与没有新数据无法区分, 更多则被覆盖
+ *        fewer than ring_len bytes may arrive between two calls, a full lap looks
+ *        the same as no new data and anything more is overwritten
+ */
+void JudgeParser_Feed_Ring(JudgeParser_t *parser, const uint8_t *ring, uint16_t ring_len, uint16_t write_pos)
+{
+    if (write_pos >= ring_len)
+        write_pos = 0;
+
+    if (write_pos >= parser->ReadPos)
+        JudgeParser_Feed(parser, ring + parser->ReadPos, write_pos - parser->ReadPos);
+    else
     {
-        memcpy(&map_interactivity, judgement_receive.data, sizeof(ext_map_interactivity_t));
+        JudgeParser_Feed(parser, ring + parser->ReadPos, ring_len - parser->ReadPos);
+        JudgeParser_Feed(parser, ring, write_pos);
     }
-    break;
-    default:
+    parser->ReadPos = write_pos;
+}
+
+// 功率上限换算, 兼容不同版本裁判系统的单位 power limit scaling, copes with the units of older referee firmware
+static void Judge_Robot_Status_Hook(void)
+{
+    if (robot_state.chassis_power_limit >= 10240)
+        robot_state.chassis_power_limit /= 256;
+    if (robot_state.chassis_power_limit >= 200)
+        robot_state.chassis_power_limit /= 5;
+}
+
+static void Judge_Shoot_Hook(void)
+{
+    Shoot_Updata = 1;
+}
+
+static void Judge_Interactive_Hook(void)
+{
+    switch (student_interactive_header_data.data_cmd_id)
     {
+    case 0X201:
+        JudgeRxData[0] = student_interactive_header_data.data[0];
+        JudgeRxData[1] = student_interactive_header_data.data[1];
+        JudgeRxValid = 1;
         break;
     }
-    }
+}
+
+#define JUDGE_CMD(cmd, target, hook) [JUDGE_CMD_SLOT(cmd)] = {cmd, sizeof(target), &(target), hook}
+
+static const JudgeCmd_Desc_t JudgeCmd_Table[JUDGE_CMD_SLOT_NUM] = {
+    JUDGE_CMD(GAME_STATUS_CMD_ID, game_status, NULL),
+    JUDGE_CMD(GAME_RESULT_CMD_ID, game_result, NULL),
+    JUDGE_CMD(GAME_ROBOT_HP_CMD_ID, game_robot_HP, NULL),
+    JUDGE_CMD(DART_STATUS_CMD_ID, dart_status, NULL),
+    JUDGE_CMD(ICRA_BUFF_DEBUFF_ZONE_STATUS_CMD_ID, ICRA_buff_debuff_zone_status, NULL),
+    JUDGE_CMD(EVEN_DATA_CMD_ID, event_data, NULL),
+    JUDGE_CMD(SUPPLY_PROJECTILE_ACTION_CMD_ID, supply_projectile_action, NULL),
+    JUDGE_CMD(REFEREE_WARNING_CMD_ID, referee_warning, NULL),
+    JUDGE_CMD(DART_REMAINING_TIME_CMD_ID, dart_remaining_time, NULL),
+    JUDGE_CMD(GAME_ROBOT_STATUS_CMD_ID, robot_state, Judge_Robot_Status_Hook),
+    JUDGE_CMD(POWER_HEAT_DATA_CMD_ID, power_heat_data_t, Judge_Shoot_Hook),
+    JUDGE_CMD(GAME_ROBOT_POS_CMD_ID, game_robot_pos, NULL),
+    JUDGE_CMD(BUFF_MUSK_CMD_ID, buff_musk, NULL),
+    JUDGE_CMD(ROBOT_ENERGY_CMD_ID, robot_energy, NULL),
+    JUDGE_CMD(ROBOT_HURT_CMD_ID, robot_hurt, NULL),
+    JUDGE_CMD(SHOOT_DATA_CMD_ID, shoot_data, Judge_Shoot_Hook),
+    JUDGE_CMD(BULLET_REMAINING_CMD_ID, bullet_remaining, NULL),
+    JUDGE_CMD(RFID_STATUS_CMD_ID, rfid_status, NULL),
+    JUDGE_CMD(DART_CLIENT_CMD_ID, dart_client_cmd, NULL),
+    JUDGE_CMD(STUDENT_INTERACTIVE_HEADER_DATA_CMD_ID, student_interactive_header_data, Judge_Interactive_Hook),
+    JUDGE_CMD(INTERACTIVE_DATA_CMD_ID, robot_interactive_data, NULL),
+    JUDGE_CMD(MAP_INTERACTIVITY_CMD_ID, map_interactivity, NULL),
+};
+
+static JudgeCmd_State_t JudgeCmd_State[JUDGE_CMD_SLOT_NUM];
+
+const JudgeCmd_Desc_t *JudgeCmd_Find(uint16_t cmd)
+{
+    const JudgeCmd_Desc_t *desc;
+
+    if ((cmd >> 8) > 3 || (cmd & 0xF0) != 0)
+        return NULL;
+    desc = &JudgeCmd_Table[JUDGE_CMD_SLOT(cmd)];
+    return desc->Cmd == cmd ? desc : NULL;
+}
+
+/**
+ * @brief 按 cmd_id 查表拷贝数据并记录更新时刻, 在串口空闲中断中调用
+ *        look up the cmd_id, copy the data and record when it arrived, called from the UART idle interrupt
+ */
+void judgement_data_decode(void)
+{
+    const JudgeCmd_Desc_t *desc = JudgeCmd_Find(judgement_receive.cmd);
+    JudgeCmd_State_t *state;
+
+    if (desc == NULL)
+        return;
+
+    memcpy(desc->Target, judgement_receive.data, desc->Size);
+    if (desc->Hook != NULL)
+        desc->Hook();
+
+    state = &JudgeCmd_State[JUDGE_CMD_SLOT(desc->Cmd)];
+    state->TimeStamp = DWT->CYCCNT;
+    state->TimeStamp_ms = HAL_GetTick();
+    state->Seq = judgement_receive.header[3];
+    state->Count++;
+}
+
+/**
+ * @retval 更新次数, 未知命令或从未收到时为 0 number of updates, 0 for an unknown or never received command
+ */
+uint32_t JudgeCmd_Get_Count(uint16_t cmd)
+{
+    return JudgeCmd_Find(cmd) != NULL ? JudgeCmd_State[JUDGE_CMD_SLOT(cmd)].Count : 0;
+}
+
+/**
+ * @brief  距最近一次更新的时间 time since the latest update
+ * @retval 微秒, 从未收到或超过约 71 分钟时为 UINT32_MAX
+ *         microseconds, UINT32_MAX if never received or older than about 71 minutes
+ */
+uint32_t JudgeCmd_Age_us(uint16_t cmd)
+{
+    JudgeCmd_State_t *state;
+    uint32_t count, time_stamp, time_stamp_ms, age_ms;
+
+    if (JudgeCmd_Find(cmd) == NULL)
+        return UINT32_MAX;
+    state = &JudgeCmd_State[JUDGE_CMD_SLOT(cmd)];
+
+    // 读取期间被中断更新则重读 read again if the interrupt updated it meanwhile
+    do
+    {
+        count = state->Count;
+        time_stamp = state->TimeStamp;
+        time_stamp_ms = state->TimeStamp_ms;
+    } while (count != state->Count);
+    if (count == 0)
+        return UINT32_MAX;
+
+    // CYCCNT 约 25 s 溢出一次, 1 s 以上按毫秒计 CYCCNT wraps every ~25 s, ages above 1 s use milliseconds
+    age_ms = HAL_GetTick() - time_stamp_ms;
+    if (age_ms >= 1000)
+        return age_ms < UINT32_MAX / 1000 ? age_ms * 1000 : UINT32_MAX;
+    return (DWT->CYCCNT - time_stamp) / (SystemCoreClock / 1000000);
+}
+
+uint8_t JudgeCmd_Is_Fresh(uint16_t cmd, uint32_t max_age_us)
+{
+    return JudgeCmd_Age_us(cmd) <= max_age_us;
+}
+
+/**
+ * @brief  自 *seen_count 以来是否有新数据, 有则更新 *seen_count, 供任务按事件处理
+ *         whether new data arrived since *seen_count, which is then updated, lets tasks react to events
+ */
+uint8_t JudgeCmd_Updated(uint16_t cmd, uint32_t *seen_count)
+{
+    uint32_t count = JudgeCmd_Get_Count(cmd);
+
+    if (count == *seen_count)
+        return 0;
+    *seen_count = count;
+    return 1;
 }
 
 void judgement_info_updata(void)
@@ -246,310 +371,12 @@ void judgement_info_updata(void)
 
 // crc8 generator polynomial:G(x)=x8+x5+x4+1
 const uint8_t CRC8_INIT = 0xff;
-const unsigned char CRC8_TAB[256] =
-    {
-        0x00,
-        0x5e,
-        0xbc,
-        0xe2,
-        0x61,
-        0x3f,
-        0xdd,
-        0x83,
-        0xc2,
-        0x9c,
-        0x7e,
-        0x20,
-        0xa3,
-        0xfd,
-        0x1f,
-        0x41,
-        0x9d,
-        0xc3,
-        0x21,
-        0x7f,
-        0xfc,
-        0xa2,
-        0x40,
-        0x1e,
-        0x5f,
-        0x01,
-        0xe3,
-        0xbd,
-        0x3e,
-        0x60,
-        0x82,
-        0xdc,
-        0x23,
-        0x7d,
-        0x9f,
-        0xc1,
-        0x42,
-        0x1c,
-        0xfe,
-        0xa0,
-        0xe1,
-        0xbf,
-        0x5d,
-        0x03,
-        0x80,
-        0xde,
-        0x3c,
-        0x62,
-        0xbe,
-        0xe0,
-        0x02,
-        0x5c,
-        0xdf,
-        0x81,
-        0x63,
-        0x3d,
-        0x7c,
-        0x22,
-        0xc0,
-        0x9e,
-        0x1d,
-        0x43,
-        0xa1,
-        0xff,
-        0x46,
-        0x18,
-        0xfa,
-        0xa4,
-        0x27,
-        0x79,
-        0x9b,
-        0xc5,
-        0x84,
-        0xda,
-        0x38,
-        0x66,
-        0xe5,
-        0xbb,
-        0x59,
-        0x07,
-        0xdb,
-        0x85,
-        0x67,
-        0x39,
-        0xba,
-        0xe4,
-        0x06,
-        0x58,
-        0x19,
-        0x47,
-        0xa5,
-        0xfb,
-        0x78,
-        0x26,
-        0xc4,
-        0x9a,
-        0x65,
-        0x3b,
-        0xd9,
-        0x87,
-        0x04,
-        0x5a,
-        0xb8,
-        0xe6,
-        0xa7,
-        0xf9,
-        0x1b,
-        0x45,
-        0xc6,
-        0x98,
-        0x7a,
-        0x24,
-        0xf8,
-        0xa6,
-        0x44,
-        0x1a,
-        0x99,
-        0xc7,
-        0x25,
-        0x7b,
-        0x3a,
-        0x64,
-        0x86,
-        0xd8,
-        0x5b,
-        0x05,
-        0xe7,
-        0xb9,
-        0x8c,
-        0xd2,
-        0x30,
-        0x6e,
-        0xed,
-        0xb3,
-        0x51,
-        0x0f,
-        0x4e,
-        0x10,
-        0xf2,
-        0xac,
-        0x2f,
-        0x71,
-        0x93,
-        0xcd,
-        0x11,
-        0x4f,
-        0xad,
-        0xf3,
-        0x70,
-        0x2e,
-        0xcc,
-        0x92,
-        0xd3,
-        0x8d,
-        0x6f,
-        0x31,
-        0xb2,
-        0xec,
-        0x0e,
-        0x50,
-        0xaf,
-        0xf1,
-        0x13,
-        0x4d,
-        0xce,
-        0x90,
-        0x72,
-        0x2c,
-        0x6d,
-        0x33,
-        0xd1,
-        0x8f,
-        0x0c,
-        0x52,
-        0xb0,
-        0xee,
-        0x32,
-        0x6c,
-        0x8e,
-        0xd0,
-        0x53,
-        0x0d,
-        0xef,
-        0xb1,
-        0xf0,
-        0xae,
-        0x4c,
-        0x12,
-        0x91,
-        0xcf,
-        0x2d,
-        0x73,
-        0xca,
-        0x94,
-        0x76,
-        0x28,
-        0xab,
-        0xf5,
-        0x17,
-        0x49,
-        0x08,
-        0x56,
-        0xb4,
-        0xea,
-        0x69,
-        0x37,
-        0xd5,
-        0x8b,
-        0x57,
-        0x09,
-        0xeb,
-        0xb5,
-        0x36,
-        0x68,
-        0x8a,
-        0xd4,
-        0x95,
-        0xcb,
-        0x29,
-        0x77,
-        0xf4,
-        0xaa,
-        0x48,
-        0x16,
-        0xe9,
-        0xb7,
-        0x55,
-        0x0b,
-        0x88,
-        0xd6,
-        0x34,
-        0x6a,
-        0x2b,
-        0x75,
-        0x97,
-        0xc9,
-        0x4a,
-        0x14,
-        0xf6,
-        0xa8,
-        0x74,
-        0x2a,
-        0xc8,
-        0x96,
-        0x15,
-        0x4b,
-        0xa9,
-        0xf7,
-        0xb6,
-        0xe8,
-        0x0a,
-        0x54,
-        0xd7,
-        0x89,
-        0x6b,
-        0x35,
-};
-
 uint16_t CRC_INIT = 0xffff;
-const uint16_t wCRC_Table[256] = {
-    0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
-    0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
-    0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
-    0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
-    0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
-    0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
-    0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
-    0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
-    0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
-    0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
-    0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
-    0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
-    0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
-    0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
-    0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
-    0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
-    0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
-    0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
-    0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
-    0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
-    0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
-    0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
-    0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
-    0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
-    0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
-    0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
-    0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
-    0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
-    0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
-    0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
-    0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
-    0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78};
 
+// 查表与 slice-by-4 实现见 crc8_16.c table and slice-by-4 code in crc8_16.c
 unsigned char Get_CRC8_Check_Sum(unsigned char *pchMessage, unsigned int dwLength, unsigned char ucCRC8)
 {
-    unsigned char ucIndex;
-    while (dwLength--)
-    {
-        ucIndex = ucCRC8 ^ (*pchMessage++);
-        ucCRC8 = CRC8_TAB[ucIndex];
-    }
-    return (ucCRC8);
+    return CRC8_Update(ucCRC8, pchMessage, dwLength);
 }
 /*
 ** Descriptions: CRC8 Verify function
@@ -585,17 +412,11 @@ void Append_CRC8_Check_Sum(unsigned char *pchMessage, unsigned int dwLength)
 */
 uint16_t Get_CRC16_Check_Sum(uint8_t *pchMessage, uint32_t dwLength, uint16_t wCRC)
 {
-    uint8_t chData;
     if (pchMessage == NULL)
     {
         return 0xFFFF;
     }
-    while (dwLength--)
-    {
-        chData = *pchMessage++;
-        (wCRC) = ((uint16_t)(wCRC) >> 8) ^ wCRC_Table[((uint16_t)(wCRC) ^ (uint16_t)(chData)) & 0x00ff];
-    }
-    return wCRC;
+    return CRC16_Update(wCRC, pchMessage, dwLength);
 }
 
 /*
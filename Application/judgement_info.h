@@ -6,6 +6,13 @@
 #include "client_interact.h"
 
 #define JUDGE_SOF (uint8_t)0xA5
+
+#define JUDGE_RX_BUF_LEN 512                         // 环形 DMA 缓冲区, 115200bps 下约 44ms circular DMA buffer, about 44 ms at 115200 bps
+#define JUDGE_FRAME_HEADER_LEN 5                     // SOF data_length(2) seq CRC8
+#define JUDGE_DATA_MAX_LEN 119                       // 协议规定整帧不超过 128 字节 the protocol limits a frame to 128 bytes
+#define JUDGE_FRAME_MAX_LEN (JUDGE_DATA_MAX_LEN + 9) // frame_header cmd_id(2) data frame_tail(2)
+#define JUDGE_DATA_BUF_LEN 128                       // 不小于最大的数据结构 (0x0301, 124 字节) no smaller than the largest data struct
+
 #define GAME_DATA 0x0201
 #define ROBOT_STATE_DATA 0x0001
 #define POWER_HEAT_DATA 0x0202
@@ -71,13 +78,68 @@ typedef enum
 
 typedef struct __packed
 {
-    uint8_t buf[100];
     uint8_t header[5];
     uint16_t cmd;
-    uint8_t data[32];
+    uint8_t data[JUDGE_DATA_BUF_LEN];
     uint8_t tail[2];
 } judge_receive_t;
 
+typedef void (*JudgeParser_Frame_f)(const uint8_t *frame, uint16_t frame_len);
+
+// cmd_id 0x0X0Y (X<=3, Y<=0xF) 映射到 64 项表中的位置 slot of cmd_id 0x0X0Y in the 64 entry table
+#define JUDGE_CMD_SLOT(cmd) ((((cmd) >> 8) << 4) | ((cmd) & 0x0F))
+#define JUDGE_CMD_SLOT_NUM 64
+
+typedef void (*JudgeCmd_Hook_f)(void);
+
+/**
+ * @brief 裁判系统命令描述, 常量表存于 flash referee command descriptor, the table lives in flash
+ */
+typedef struct
+{
+    uint16_t Cmd; // 0 为空项 0 marks an empty slot
+    uint8_t Size; // 拷贝到 Target 的字节数 bytes copied into Target
+    void *Target;
+    JudgeCmd_Hook_f Hook; // 拷贝后调用, 可为 NULL called after the copy, may be NULL
+} JudgeCmd_Desc_t;
+
+/**
+ * @brief 每个命令的最近更新 latest update of each command
+ */
+typedef struct
+{
+    uint32_t TimeStamp;      // 解码时的 DWT->CYCCNT cycle counter when decoded
+    uint32_t TimeStamp_ms;   // 解码时的 HAL_GetTick(), 用于超过 CYCCNT 周期的时长 for ages beyond the CYCCNT period
+    volatile uint32_t Count; // 更新次数, 0 为从未收到 number of updates, 0 if never received
+    uint8_t Seq;             // 最近一帧的 seq seq of the latest frame
+} JudgeCmd_State_t;
+
+/**
+ * @brief 裁判系统数据流的增量解析器, 跨越多次空闲中断保持状态
+ *        incremental parser of the referee byte stream, keeps its state across idle interrupts
+ */
+typedef struct
+{
+    uint8_t Frame[JUDGE_FRAME_MAX_LEN];
+    uint16_t Index;    // 已收到的本帧字节数 bytes of the current frame collected so far
+    uint16_t FrameLen; // 帧头校验通过后为整帧长度, 否则为 0 whole frame length once the header checks out, else 0
+    uint16_t ReadPos;  // 环形缓冲区读位置 read position in the circular buffer
+    uint16_t CRC16;    // 随字节到达累积的 CRC16 CRC16 accumulated as the bytes arrive
+    uint16_t CRC16Len; // CRC16 已覆盖的字节数 bytes covered by CRC16
+    uint8_t Seq;
+    JudgeParser_Frame_f FrameHandler;
+
+    struct
+    {
+        uint32_t Bytes;
+        uint32_t Frames;
+        uint32_t Skipped;     // 帧外被丢弃的字节 bytes discarded outside frames
+        uint32_t HeaderError; // CRC8 错误或长度越界 CRC8 mismatch or length out of range
+        uint32_t CRC16Error;
+        uint32_t SeqLost; // 按 seq 推算的丢帧数 frames missing from the seq sequence
+    } Stat;
+} JudgeParser_t;
+
 // ����״̬���ݣ�0x0001
 typedef struct __packed
 {
@@ -349,13 +411,21 @@ extern uint8_t Shoot_Updata;
 
 extern HAL_StatusTypeDef IT_DMA_Begain(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size); // �������ж�
 extern judge_receive_t judgement_receive;
+extern JudgeParser_t JudgeParser;
 void Judge_Control_Init(UART_HandleTypeDef *huart);
-void judgement_info_handle(void);
-void unpack_fifo_handle(uint8_t *prxbuf);
+void JudgeParser_Init(JudgeParser_t *parser, JudgeParser_Frame_f frame_handler);
+void JudgeParser_Feed(JudgeParser_t *parser, const uint8_t *data, uint16_t len);
+void JudgeParser_Feed_Ring(JudgeParser_t *parser, const uint8_t *ring, uint16_t ring_len, uint16_t write_pos);
 void judgement_info_updata(void);
 unsigned int Verify_CRC8_Check_Sum(unsigned char *pchMessage, unsigned int dwLength);
 void Append_CRC8_Check_Sum(unsigned char *pchMessage, unsigned int dwLength);
 void judgement_data_decode(void);
+const JudgeCmd_Desc_t *JudgeCmd_Find(uint16_t cmd);
+uint32_t JudgeCmd_Get_Count(uint16_t cmd);
+uint32_t JudgeCmd_Age_us(uint16_t cmd);
+uint8_t JudgeCmd_Is_Fresh(uint16_t cmd, uint32_t max_age_us);
+uint8_t JudgeCmd_Updated(uint16_t cmd, uint32_t *seen_count);
+extern uint16_t CRC_INIT;
 uint16_t Get_CRC16_Check_Sum(uint8_t *pchMessage, uint32_t dwLength, uint16_t wCRC);
 uint8_t Verify_CRC16_Check_Sum(uint8_t *pchMessage, uint32_t dwLength);
 void Append_CRC16_Check_Sum(uint8_t *pchMessage, uint32_t dwLength);
@@ -365,7 +435,7 @@ extern unsigned char Get_CRC8_Check_Sum(unsigned char *pchMessage, unsigned int
 #endif
 
 /*
-1.������ȡ��DMA��������
-2.�ڻص�������UART_IdleRxCallback���е��ô���������unpack_fifo_handle��
-3.��������������judgement_race_data�ṹ���У�
+1.USART_IDLE_Stream_Init() 开启循环 DMA 接收 start circular DMA reception
+2.空闲中断回调中调用 JudgeParser_Feed_Ring() 解析新数据 parse new bytes in the idle callback
+3.judgement_data_decode() 将数据存入各结构体 decoded data is copied into the structs above
 */
\ No newline at end of file
@@ -4,11 +4,16 @@
 uint8_t RMD_data[8];
 
 float Motor_Torque_Calculate(Motor_t *motor, float torque, float target_torque)
+{
+    return Motor_Torque_Calculate_Tick(motor, NULL, torque, target_torque);
+}
+
+float Motor_Torque_Calculate_Tick(Motor_t *motor, const DWT_Tick_t *tick, float torque, float target_torque)
 {
     // 前馈控制
-    Feedforward_Calculate(&motor->FFC_Torque, target_torque);
+    Feedforward_Calculate_Tick(&motor->FFC_Torque, tick, target_torque);
     // 反馈控制
-    PID_Calculate(&motor->PID_Torque, torque, target_torque);
+    PID_Calculate_Tick(&motor->PID_Torque, tick, torque, target_torque);
 
     if (motor->TorqueCtrl_User_Func_f != NULL)
         motor->TorqueCtrl_User_Func_f(motor);
@@ -24,11 +29,16 @@ float Motor_Torque_Calculate(Motor_t *motor, float torque, float target_torque)
 }
 
 float Motor_Speed_Calculate(Motor_t *motor, float velocity, float target_speed)
+{
+    return Motor_Speed_Calculate_Tick(motor, NULL, velocity, target_speed);
+}
+
+float Motor_Speed_Calculate_Tick(Motor_t *motor, const DWT_Tick_t *tick, float velocity, float target_speed)
 {
     // 前馈控制
-    Feedforward_Calculate(&motor->FFC_Velocity, target_speed);
+    Feedforward_Calculate_Tick(&motor->FFC_Velocity, tick, target_speed);
     // 反馈控制
-    PID_Calculate(&motor->PID_Velocity, velocity, target_speed);
+    PID_Calculate_Tick(&motor->PID_Velocity, tick, velocity, target_speed);
     // 线性扰动观测器
     // LDOB_Calculate(&motor->LDOB, velocity, motor->Output);
 
@@ -43,18 +53,53 @@ float Motor_Speed_Calculate(Motor_t *motor, float velocity, float target_speed)
     return motor->Output;
 }
 
+// 共用一组速度环参数的 pid->N 个电机成批计算, 每个电机的结果与 Motor_Speed_Calculate() 相同
+// PID 状态在 pid 中, motor[i].PID_Velocity 只同步 Output
+// pid->N motors sharing one set of velocity loop gains computed as a batch, each result equals
+// Motor_Speed_Calculate(); the PID state lives in pid, motor[i].PID_Velocity only mirrors Output
+void Motor_Speed_Calculate_Batch(Motor_t *motor, PID_Batch_t *pid, const DWT_Tick_t *tick, const float *target_speed)
+{
+    float velocity[PID_BATCH_MAX];
+
+    for (uint8_t i = 0; i < pid->N; i++)
+    {
+        velocity[i] = motor[i].Velocity_RPM;
+        // 与 Motor_Speed_Calculate_Tick() 相同, 前馈总是计算以保持两者逐位一致
+        // as in Motor_Speed_Calculate_Tick(), the feedforward always runs so both stay bit-identical
+        Feedforward_Calculate_Tick(&motor[i].FFC_Velocity, tick, target_speed[i]);
+    }
+
+    PID_Batch_Calculate_Tick(pid, tick, velocity, target_speed);
+
+    for (uint8_t i = 0; i < pid->N; i++)
+    {
+        motor[i].PID_Velocity.Output = pid->Output[i];
+
+        if (motor[i].SpeedCtrl_User_Func_f != NULL)
+            motor[i].SpeedCtrl_User_Func_f(&motor[i]);
+
+        motor[i].Output = motor[i].FFC_Velocity.Output + pid->Output[i] - motor[i].LDOB.Disturbance;
+        motor[i].Output = float_constrain(motor[i].Output, -motor[i].Max_Out, motor[i].Max_Out);
+    }
+}
+
 float Motor_Angle_Calculate(Motor_t *motor, float angle, float velocity, float target_angle)
+{
+    return Motor_Angle_Calculate_Tick(motor, NULL, angle, velocity, target_angle);
+}
+
+float Motor_Angle_Calculate_Tick(Motor_t *motor, const DWT_Tick_t *tick, float angle, float velocity, float target_angle)
 {
     // 外环前馈控制
-    Feedforward_Calculate(&motor->FFC_Angle, target_angle);
+    Feedforward_Calculate_Tick(&motor->FFC_Angle, tick, target_angle);
     // 外环反馈控制
-    PID_Calculate(&motor->PID_Angle, angle, target_angle);
+    PID_Calculate_Tick(&motor->PID_Angle, tick, angle, target_angle);
 
     if (motor->AngleCtrl_User_Func_f != NULL)
         motor->AngleCtrl_User_Func_f(motor);
 
     // 内环
-    Motor_Speed_Calculate(motor, velocity, motor->FFC_Angle.Output + motor->PID_Angle.Output);
+    Motor_Speed_Calculate_Tick(motor, tick, velocity, motor->FFC_Angle.Output + motor->PID_Angle.Output);
 
     return motor->Output;
 }
@@ -170,15 +215,7 @@ void get_RMD_offset(Motor_t *ptr, uint8_t *aData)
 HAL_StatusTypeDef Send_RMD_Current(CAN_HandleTypeDef *_hcan,
                                    int16_t c1, int16_t c2, int16_t c3, int16_t c4)
 {
-    static CAN_TxHeaderTypeDef TX_MSG;
-    static uint8_t CAN_Send_Data[8];
-    uint32_t send_mail_box;
-
-    // 设置发送数据包的ID和其他属性 除ID为特定内容外均为默认（通用）情况
-    TX_MSG.StdId = 0x280;
-    TX_MSG.IDE = CAN_ID_STD;
-    TX_MSG.RTR = CAN_RTR_DATA;
-    TX_MSG.DLC = 0x08;
+    uint8_t CAN_Send_Data[8];
 
     // 根据C620电调协议设置电机电流值
     CAN_Send_Data[0] = c1;
@@ -190,37 +227,7 @@ HAL_StatusTypeDef Send_RMD_Current(CAN_HandleTypeDef *_hcan,
     CAN_Send_Data[6] = c4;
     CAN_Send_Data[7] = (c4 >> 8);
 
-    uint32_t count = 0;
-    while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    count = 0;
-    while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // 如果三个邮箱都阻塞了就等一会儿，直到其中某个邮箱空闲
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    /* Check Tx Mailbox 1 status */
-    if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX0;
-    }
-    /* Check Tx Mailbox 1 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX1;
-    }
-
-    /* Check Tx Mailbox 2 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX2;
-    }
-    return HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+    return CAN_Transmit(_hcan, 0x280, CAN_Send_Data, 8, CAN_TX_PRIO_MOTOR);
 }
 
 /**
@@ -234,15 +241,7 @@ HAL_StatusTypeDef Send_RMD_Current(CAN_HandleTypeDef *_hcan,
 HAL_StatusTypeDef Send_RMD_Current_Single(CAN_HandleTypeDef *_hcan,
                                           int8_t ID, int16_t c)
 {
-    static CAN_TxHeaderTypeDef TX_MSG;
-    static uint8_t CAN_Send_Data[8];
-    uint32_t send_mail_box;
-
-    // 设置发送数据包的ID和其他属性 除ID为特定内容外均为默认（通用）情况
-    TX_MSG.StdId = 0x141;
-    TX_MSG.IDE = CAN_ID_STD;
-    TX_MSG.RTR = CAN_RTR_DATA;
-    TX_MSG.DLC = 0x08;
+    uint8_t CAN_Send_Data[8];
 
     // 根据C620电调协议设置电机电流值
     CAN_Send_Data[0] = 0xA1;
@@ -254,37 +253,7 @@ HAL_StatusTypeDef Send_RMD_Current_Single(CAN_HandleTypeDef *_hcan,
     CAN_Send_Data[6] = 0;
     CAN_Send_Data[7] = 0;
 
-    uint32_t count = 0;
-    while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    count = 0;
-    while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // 如果三个邮箱都阻塞了就等一会儿，直到其中某个邮箱空闲
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    /* Check Tx Mailbox 1 status */
-    if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX0;
-    }
-    /* Check Tx Mailbox 1 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX1;
-    }
-
-    /* Check Tx Mailbox 2 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX2;
-    }
-    return HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+    return CAN_Transmit(_hcan, 0x141, CAN_Send_Data, 8, CAN_TX_PRIO_MOTOR);
 }
 
 /**
@@ -298,15 +267,7 @@ HAL_StatusTypeDef Send_RMD_Current_Single(CAN_HandleTypeDef *_hcan,
 HAL_StatusTypeDef Send_Motor_Current_1_4(CAN_HandleTypeDef *_hcan,
                                          int16_t c1, int16_t c2, int16_t c3, int16_t c4)
 {
-    static CAN_TxHeaderTypeDef TX_MSG;
-    static uint8_t CAN_Send_Data[8];
-    uint32_t send_mail_box;
-
-    // 设置发送数据包的ID和其他属性 除ID为特定内容外均为默认（通用）情况
-    TX_MSG.StdId = CAN_Transmit_1_4_ID;
-    TX_MSG.IDE = CAN_ID_STD;
-    TX_MSG.RTR = CAN_RTR_DATA;
-    TX_MSG.DLC = 0x08;
+    uint8_t CAN_Send_Data[8];
 
     // 根据C620电调协议设置电机电流值
     CAN_Send_Data[0] = (c1 >> 8);
@@ -318,50 +279,14 @@ HAL_StatusTypeDef Send_Motor_Current_1_4(CAN_HandleTypeDef *_hcan,
     CAN_Send_Data[6] = (c4 >> 8);
     CAN_Send_Data[7] = c4;
 
-    uint32_t count = 0;
-    while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    count = 0;
-    while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // 如果三个邮箱都阻塞了就等一会儿，直到其中某个邮箱空闲
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    /* Check Tx Mailbox 1 status */
-    if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX0;
-    }
-    /* Check Tx Mailbox 1 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX1;
-    }
-
-    /* Check Tx Mailbox 2 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX2;
-    }
-    return HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+    return CAN_Transmit(_hcan, CAN_Transmit_1_4_ID, CAN_Send_Data, 8, CAN_TX_PRIO_MOTOR);
 }
 
 HAL_StatusTypeDef Send_Motor_Current_5_8(CAN_HandleTypeDef *_hcan,
                                          int16_t c1, int16_t c2, int16_t c3, int16_t c4)
 {
-    static CAN_TxHeaderTypeDef TX_MSG;
-    static uint8_t CAN_Send_Data[8];
-    uint32_t send_mail_box;
-
-    TX_MSG.StdId = CAN_Transmit_5_8_ID;
-    TX_MSG.IDE = CAN_ID_STD;
-    TX_MSG.RTR = CAN_RTR_DATA;
-    TX_MSG.DLC = 0x08;
+    uint8_t CAN_Send_Data[8];
+
     CAN_Send_Data[0] = (c1 >> 8);
     CAN_Send_Data[1] = c1;
     CAN_Send_Data[2] = (c2 >> 8);
@@ -371,37 +296,7 @@ HAL_StatusTypeDef Send_Motor_Current_5_8(CAN_HandleTypeDef *_hcan,
     CAN_Send_Data[6] = (c4 >> 8);
     CAN_Send_Data[7] = c4;
 
-    uint32_t count = 0;
-    while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    count = 0;
-    while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // 如果三个邮箱都阻塞了就等一会儿，直到其中某个邮箱空闲
-    {
-        count++;
-        if (count > 10000)
-            break;
-    }
-    /* Check Tx Mailbox 1 status */
-    if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX0;
-    }
-    /* Check Tx Mailbox 1 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX1;
-    }
-
-    /* Check Tx Mailbox 2 status */
-    else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-    {
-        send_mail_box = CAN_TX_MAILBOX2;
-    }
-    return HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+    return CAN_Transmit(_hcan, CAN_Transmit_5_8_ID, CAN_Send_Data, 8, CAN_TX_PRIO_MOTOR);
 }
 
 /**
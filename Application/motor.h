@@ -82,6 +82,12 @@ typedef struct motor_t
 float Motor_Torque_Calculate(Motor_t *motor, float torque, float target_torque);
 float Motor_Speed_Calculate(Motor_t *motor, float velocity, float target_speed);
 float Motor_Angle_Calculate(Motor_t *motor, float angle, float velocity, float target_angle);
+// 前馈与 PID 共用周期上下文 tick 的 dt, tick 为 NULL 时各自计时
+// the feedforward and PID share the dt of the tick context; with a NULL tick each times itself
+float Motor_Torque_Calculate_Tick(Motor_t *motor, const DWT_Tick_t *tick, float torque, float target_torque);
+float Motor_Speed_Calculate_Tick(Motor_t *motor, const DWT_Tick_t *tick, float velocity, float target_speed);
+float Motor_Angle_Calculate_Tick(Motor_t *motor, const DWT_Tick_t *tick, float angle, float velocity, float target_angle);
+void Motor_Speed_Calculate_Batch(Motor_t *motor, PID_Batch_t *pid, const DWT_Tick_t *tick, const float *target_speed);
 
 void get_moto_info(Motor_t *ptr, uint8_t *aData);
 void get_moto_offset(Motor_t *ptr, uint8_t *aData);
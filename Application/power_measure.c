@@ -199,7 +199,10 @@ uint16_t INA226_Read_a_Reg(uint8_t reg, uint16_t Ina226_id)
         lost_count++;
         if (lost_count > 30)
         {
+            // 零电流帧须在复位前发出 the zero current frame has to go out before the reset
             Send_Motor_Current_1_4(&hcan1, 0, 0, 0, 0);
+            CAN_TxQueue_Flush_Motor(&hcan1, CAN_TX_FLUSH_TIMEOUT_MS);
+            BlackBox_Mark(BLACKBOX_REASON_I2C_LOST);
             HAL_NVIC_SystemReset();
         }
     }
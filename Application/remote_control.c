@@ -5,6 +5,20 @@
 #include "bsp_usart_idle.h"
 
 RC_Type remote_control = {0};
+RC_Type remote_control_can = {0};
+
+// 静态初始化, 接收中断早于 Remote_Control_Init() 到来也可发布
+// statically initialised so a publish before Remote_Control_Init() is safe
+static RC_Type RC_Snapshot_Buf[RC_SOURCE_NUM][2];
+Snapshot_t RC_Snapshot[RC_SOURCE_NUM] = {
+    {0, (uint8_t *)RC_Snapshot_Buf[RC_SOURCE_UART], sizeof(RC_Type)},
+    {0, (uint8_t *)RC_Snapshot_Buf[RC_SOURCE_CAN], sizeof(RC_Type)},
+};
+
+// 各来源最近一次发布的次序, RC_Read() 据此选择来源
+// order of the latest publish of each source, RC_Read() picks the source by it
+static volatile uint32_t RC_Publish_Order = 0;
+static volatile uint32_t RC_Source_Order[RC_SOURCE_NUM] = {0};
 
 uint8_t sbus_rx_buf[SBUS_RX_BUF_NUM];
 
@@ -23,13 +37,14 @@ void Remote_Control_Init(UART_HandleTypeDef *huart)
 }
 
 /**
- * @Func		void Callback_RC_Handle(RC_Type* rc, uint8_t* buff)
+ * @Func		void Callback_RC_Handle(RC_Type* rc, uint8_t* buff, uint8_t source)
  * @Brief  	DR16���ջ�Э�������� ���DT7��ң�������ջ����ֲ�
  * @Param		RC_Type* rc���洢ң�������ݵĽṹ�塡��uint8_t* buff�����ڽ���Ļ���
+ *              uint8_t source: 数据来源 RC_Source_e, 每个来源须使用各自的 rc data source RC_Source_e, each source needs its own rc
  * @Retval		None
  * @Date
  */
-void Callback_RC_Handle(RC_Type *rc, uint8_t *buff)
+void Callback_RC_Handle(RC_Type *rc, uint8_t *buff, uint8_t source)
 {
     if (buff == NULL || rc == NULL)
     {
@@ -81,11 +96,44 @@ void Callback_RC_Handle(RC_Type *rc, uint8_t *buff)
 
     // if (resetCount < 2000)
     //     Send_RC_Data(&hcan1, buff);
+    RC_Publish(source, rc);
     RC_Update = 1;
 
     Detect_Hook(RC_TOE);
 }
 
+/**
+ * @brief 发布来源 source 的一帧遥控器数据 publish a remote control frame of source
+ * @note  同一来源只能在一个上下文中发布: UART 来源在 USART3 中断 (图传链路仅在 DR16 丢失时发布),
+ *        CAN 来源在 CAN 接收中断
+ *        (CAN1/CAN2 同一优先级, 互不嵌套)
+ *        each source publishes from one context only: the UART source in the USART3 interrupt
+ *        (the VTM link only while the DR16 is lost), the CAN source in the CAN receive interrupts
+ *        (CAN1/CAN2 share one priority and never nest)
+ */
+void RC_Publish(uint8_t source, const RC_Type *rc)
+{
+    Snapshot_Publish(&RC_Snapshot[source], rc);
+    // 自增可能被另一来源打断而得到相同次序, 此时 RC_Read() 取 UART 来源
+    // the increment may be preempted by the other source and yield the same order, RC_Read() then takes the UART source
+    RC_Source_Order[source] = ++RC_Publish_Order;
+}
+
+/**
+ * @brief 读取最近一帧完整的遥控器数据 read the latest complete remote control frame
+ * @note  remote_control 由接收中断逐字段改写, 其他任务应通过本函数读取;
+ *        两个来源均在发布时取最近发布的一个
+ *        remote_control is rewritten field by field in the receive interrupt,
+ *        other tasks should read it through this function; when both sources
+ *        publish, the one that published last is read
+ */
+void RC_Read(RC_Type *rc)
+{
+    uint8_t source = RC_Source_Order[RC_SOURCE_CAN] > RC_Source_Order[RC_SOURCE_UART] ? RC_SOURCE_CAN : RC_SOURCE_UART;
+
+    Snapshot_Read(&RC_Snapshot[source], rc);
+}
+
 void Solve_RC_Lost(void)
 {
     USART_IDLE_Init(remote_control.RC_USART, sbus_rx_buf, SBUS_RX_BUF_NUM);
@@ -4,6 +4,7 @@
 #include "usart.h"
 #include "stdint.h"
 #include "string.h"
+#include "snapshot.h"
 
 #define RCFILTER_TASK_PERIOD 2
 
@@ -75,7 +76,18 @@ enum
     Connected = 1,
 };
 
+// 遥控器数据来源, 每个来源一个快照以保证各快照只有一个写者
+// remote control data sources, one snapshot each so that every snapshot has a single writer
+typedef enum
+{
+    RC_SOURCE_UART = 0, // DR16 接收机 (USART3 中断), 丢失时由图传链路代替 DR16 receiver (USART3 interrupt), or the VTM link when it is lost
+    RC_SOURCE_CAN,      // 云台控制板经 CAN 转发 forwarded by the gimbal board over CAN
+    RC_SOURCE_NUM,
+} RC_Source_e;
+
 extern RC_Type remote_control;
+extern RC_Type remote_control_can;
+extern Snapshot_t RC_Snapshot[RC_SOURCE_NUM];
 
 extern uint8_t sbus_rx_buf[SBUS_RX_BUF_NUM];
 extern uint8_t RC_Data_Buffer[16];
@@ -86,7 +98,9 @@ extern uint64_t Latest_Remote_Control_Pack_Time;
 extern float ch1_buf;
 
 void Remote_Control_Init(UART_HandleTypeDef *huart);
-void Callback_RC_Handle(RC_Type *rc, uint8_t *buff);
+void Callback_RC_Handle(RC_Type *rc, uint8_t *buff, uint8_t source);
+void RC_Publish(uint8_t source, const RC_Type *rc);
+void RC_Read(RC_Type *rc);
 void Solve_RC_Lost(void);
 void Solve_RC_Data_Error(void);
 uint8_t RC_Data_is_Error(void);
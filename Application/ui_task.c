@@ -17,8 +17,7 @@ client_char_t Char2;
 client_frame_t Char3;
 client_frame_t Char4;
 static float dt = 0, t = 0;
-float uiCostTime = 0, uiTimeStamp = 0;
-uint32_t UI_DWT_Count = 0, ui_DWT_Cost = 0;
+uint32_t UI_DWT_Count = 0;
 
 int8_t flg = 0;
 
@@ -136,11 +135,10 @@ uint16_t Radius_30[5] = {3, 3, 3, 3, 3}; // 3
 
 void UI_Task(void)
 {
+	static uint8_t state = 0;
+
 	dt = DWT_GetDeltaT(&UI_DWT_Count);
 	t += dt;
-	uiTimeStamp = DWT_GetDeltaT(&ui_DWT_Cost);
-
-	static uint8_t state = 0;
 
 	switch (state)
 	{
@@ -158,9 +156,6 @@ void UI_Task(void)
 		state = 0;
 		break;
 	}
-
-	uiTimeStamp = DWT_GetDeltaT(&ui_DWT_Cost);
-	uiCostTime = uiTimeStamp;
 }
 
 static void Show_UI_Init(void)
@@ -393,6 +388,7 @@ static void Layer3(uint8_t operate)
 {
 	uint8_t
 		lens[3];
+	RC_Type rc;
 
 	memset(client_send_buff, 0, sizeof(client_send_buff));
 
@@ -465,9 +461,10 @@ static void Layer3(uint8_t operate)
 		lens[2] = strlen("No\n");
 		memcpy(client_send_buff + lens[0] + lens[1], "No\n", strlen("No\n"));
 	}
+	RC_Read(&rc);
 	if ((Chassis.Mode == Spinning_Mode) &&
-		((remote_control.key_code & Key_SHIFT) || (remote_control.key_code & Key_CTRL)) &&
-		((remote_control.key_code & Key_W) || (remote_control.key_code & Key_A) || (remote_control.key_code & Key_S) || (remote_control.key_code & Key_D)))
+		((rc.key_code & Key_SHIFT) || (rc.key_code & Key_CTRL)) &&
+		((rc.key_code & Key_W) || (rc.key_code & Key_A) || (rc.key_code & Key_S) || (rc.key_code & Key_D)))
 		client_draw_char(JudgeUSART, &Char2, 3, operate, 600, 580, 20, robot_state.robot_id, robot_state.robot_id + 256, client_send_buff, 30, CLIENT_Amaranth);
 	else
 		client_draw_char(JudgeUSART, &Char2, 3, operate, 600, 580, 20, robot_state.robot_id, robot_state.robot_id + 256, client_send_buff, 30, CLIENT_RedOrBlue);
@@ -13,11 +13,29 @@
 #include "bsp_CAN.h"
 #include "VTM_info.h"
 #include "bsp_dwt.h"
+#include "profiler.h"
+#include <string.h>
 
 uint8_t tempBuff[16] = {0};
 int16_t TempPlanX1000;
 int16_t TempPlanY1000;
 
+static CAN_TxQueue_t CAN_TxQueue[2];
+
+typedef struct
+{
+	uint16_t StdId;
+	CAN_Rx_Handler_f Handler; // 为 NULL 表示空位 NULL marks an empty slot
+	void *Arg;
+	CAN_RxQueue_t *Queue;
+} CAN_RxEntry_t;
+
+static CAN_RxEntry_t CAN_RxTable[2][CAN_RX_DISPATCH_LEN];
+static void CAN_Rx_Register_Default(void);
+
+CAN_RxQueue_t CAN_RxQueue;
+CAN_RxStat_t CAN_RxStat[2];
+
 /**
  * @Func		CAN_Device_Init
  * @Brief
@@ -70,12 +88,13 @@ void CAN_Device_Init(void)
 	while (HAL_CAN_ConfigFilter(&hcan1, &can_filter_st) != HAL_OK)
 	{
 	}
+	CAN_Rx_Register_Default();
 	// ����CAN
 	while (HAL_CAN_Start(&hcan1) != HAL_OK)
 	{
 	}
 	// ����֪ͨ
-	while (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK)
+	while (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING | CAN_IT_TX_MAILBOX_EMPTY) != HAL_OK)
 	{
 	}
 
@@ -90,297 +109,489 @@ void CAN_Device_Init(void)
 	{
 	}
 	// ����֪ͨ
-	while (HAL_CAN_ActivateNotification(&hcan2, CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK)
+	while (HAL_CAN_ActivateNotification(&hcan2, CAN_IT_RX_FIFO0_MSG_PENDING | CAN_IT_TX_MAILBOX_EMPTY) != HAL_OK)
 	{
 	}
 }
 
+CAN_TxQueue_t *CAN_Get_TxQueue(CAN_HandleTypeDef *_hcan)
+{
+	return &CAN_TxQueue[_hcan == &hcan2];
+}
+
 /**
- * @Func	    void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef* _hcan)
- * @Brief      CAN���߽��ջص����� ���ڽ��յ������
- * @Param	    CAN_HandleTypeDef* _hcan
- * @Retval	    None
- * @Date       2019/11/4
- **/
-void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *_hcan)
+ * @brief      将一帧放入发送队列, 有空闲邮箱时立即发出
+ *             queue a frame and start it right away if a mailbox is free
+ * @param      priority: 高优先级队列先于低优先级发送 higher priority queues drain first
+ * @retval     HAL_OK    已入队 queued
+ *             HAL_BUSY  已入队, 覆盖了同 ID 尚未发出的电机帧 queued, replaced an unsent motor frame with the same ID
+ *             HAL_ERROR 队列满, 丢弃 queue full, frame dropped
+ * @note       仅在任务中调用, 不会阻塞 task context only, never blocks
+ */
+HAL_StatusTypeDef CAN_Transmit(CAN_HandleTypeDef *_hcan, uint32_t std_id, const uint8_t *data, uint8_t dlc, CAN_TxPriority_e priority)
 {
-	CAN_RxHeaderTypeDef rx_header;
-	uint8_t rx_data[8];
-	static uint8_t RC_Data_Buf[16];
-	static uint8_t Follow_Data_Buf[8];
-	static uint8_t MiniPC_CtrlFrame_Buf[8];
-	static int16_t CAP_vol;
+	CAN_TxQueue_t *queue = CAN_Get_TxQueue(_hcan);
+	CAN_TxFrame_t *frame = NULL;
+	HAL_StatusTypeDef status = HAL_OK;
+
+	if (dlc > 8)
+		dlc = 8;
 
-	HAL_CAN_GetRxMessage(_hcan, CAN_RX_FIFO0, &rx_header, rx_data);
+	taskENTER_CRITICAL();
+	queue->Stat.Enqueued[priority]++;
 
-	if (_hcan == &hcan1)
+	// 电机电流只需最新值, 旧帧尚未发出说明总线已拥堵
+	// only the latest motor current matters, an unsent older frame means the bus is congested
+	if (priority == CAN_TX_PRIO_MOTOR)
 	{
-		if (rx_header.StdId >= 0x201 && rx_header.StdId <= 0x204)
+		for (uint8_t i = 0; i < queue->Count[priority]; i++)
 		{
-			if (Chassis.ChassisMotor[rx_header.StdId - 0x201].msg_cnt++ <= 50)
-			{
-				get_moto_offset(&Chassis.ChassisMotor[rx_header.StdId - 0x201], rx_data);
-			}
-			else
-			{
-				get_moto_info(&Chassis.ChassisMotor[rx_header.StdId - 0x201], rx_data);
-			}
-			switch (rx_header.StdId)
-			{
-			case 0x201:
-			{
-				Detect_Hook(CHASSIS_MOTOR1_TOE);
-				break;
-			}
-			case 0x202:
-			{
-				Detect_Hook(CHASSIS_MOTOR2_TOE);
-				break;
-			}
-			case 0x203:
-			{
-				Detect_Hook(CHASSIS_MOTOR3_TOE);
-				break;
-			}
-			case 0x204:
+			if (queue->Frame[priority][(queue->Head[priority] + i) & (CAN_TX_QUEUE_LEN - 1)].StdId == std_id)
 			{
-				Detect_Hook(CHASSIS_MOTOR4_TOE);
+				frame = &queue->Frame[priority][(queue->Head[priority] + i) & (CAN_TX_QUEUE_LEN - 1)];
+				queue->Stat.Replaced++;
+				status = HAL_BUSY;
 				break;
 			}
-			}
 		}
 	}
-	if (_hcan == &hcan2)
+
+	if (frame == NULL)
 	{
-		switch (rx_header.StdId)
+		if (queue->Count[priority] == CAN_TX_QUEUE_LEN)
 		{
-		// �����������ư巢����ң��������
-		case CAN_RC_DATA_Frame_0:
-			RC_Data_Buf[0] = rx_data[0];
-			RC_Data_Buf[1] = rx_data[1];
-			RC_Data_Buf[2] = rx_data[2];
-			RC_Data_Buf[3] = rx_data[3];
-			RC_Data_Buf[4] = rx_data[4];
-			RC_Data_Buf[5] = rx_data[5];
-			RC_Data_Buf[6] = rx_data[6];
-			RC_Data_Buf[7] = rx_data[7];
-			break;
-		case CAN_RC_DATA_Frame_1:
-			RC_Data_Buf[8] = rx_data[0];
-			RC_Data_Buf[9] = rx_data[1];
-			RC_Data_Buf[10] = rx_data[2];
-			RC_Data_Buf[11] = rx_data[3];
-			RC_Data_Buf[12] = rx_data[4];
-			RC_Data_Buf[13] = rx_data[5];
-			RC_Data_Buf[14] = rx_data[6];
-			RC_Data_Buf[15] = rx_data[7];
-			Callback_RC_Handle(&remote_control, RC_Data_Buf);
-			break;
-		case YAW_MOTOR_ID:
-			Detect_Hook(GIMBAL_YAW_MOTOR_TOE);
-			if (rx_data[6] != 0 && rx_data[7] != 0)
-				get_RMD_info(&Gimbal.YawMotor, rx_data);
-			break;
-		case 0x151:
-			tempBuff[0] = rx_data[0]; // CF_SOF
-			tempBuff[1] = rx_data[1]; // POSX
-			tempBuff[2] = rx_data[2]; // POSX
-			tempBuff[3] = rx_data[3]; // POSY
-			tempBuff[4] = rx_data[4]; // POSY
-			tempBuff[5] = rx_data[5]; // YAW
-			tempBuff[6] = rx_data[6]; // YAW
-			tempBuff[7] = rx_data[7]; // planX 1
-			// if (tempBuff[0] == 0x66 && tempBuff[7] == 0x88)
-			// {
-			Chassis.posX1000 = (int16_t)((rx_data[2] << 8) | rx_data[1]);
-			Chassis.posY1000 = (int16_t)((rx_data[4] << 8) | rx_data[3]);
-			Chassis.posZ1000 = (int16_t)((rx_data[6] << 8) | rx_data[5]);
-			// }
-			break;
-		case 0x150:
-			tempBuff[8] = rx_data[0];  // planX 1
-			tempBuff[9] = rx_data[1];  // planY 1
-			tempBuff[10] = rx_data[2]; // planY 1
-			tempBuff[11] = rx_data[3]; // planX 2
-			tempBuff[12] = rx_data[4]; // planX 2
-			tempBuff[13] = rx_data[5]; // planY 2
-			tempBuff[14] = rx_data[6]; // planY 2
-			tempBuff[15] = rx_data[7]; // CF_EOF
-
-			TempPlanX1000 = (int16_t)((tempBuff[8] << 8) | (tempBuff[7]));
-			TempPlanY1000 = (int16_t)((tempBuff[10] << 8) | (tempBuff[9]));
-			Chassis.PlanX1000 = (int16_t)((tempBuff[12] << 8) | (tempBuff[11]));
-			Chassis.PlanY1000 = (int16_t)((tempBuff[14] << 8) | (tempBuff[13]));
-			break;
+			queue->Stat.Dropped[priority]++;
+			taskEXIT_CRITICAL();
+			return HAL_ERROR;
 		}
+		frame = &queue->Frame[priority][(queue->Head[priority] + queue->Count[priority]) & (CAN_TX_QUEUE_LEN - 1)];
+		queue->Count[priority]++;
+		if (queue->Count[priority] > queue->Stat.HighWater[priority])
+			queue->Stat.HighWater[priority] = queue->Count[priority];
 	}
+
+	frame->StdId = std_id;
+	frame->DLC = dlc;
+	memset(frame->Data, 0, sizeof(frame->Data));
+	memcpy(frame->Data, data, dlc);
+
+	CAN_TxQueue_Drain(_hcan);
+	taskEXIT_CRITICAL();
+
+	return status;
 }
 
-// ͨ��CAN���߷���ң������Ϣ ��������δʹ��
-void Send_RC_Data(CAN_HandleTypeDef *_hcan, uint8_t *rc_data)
+/**
+ * @brief      将队列中的帧写入空闲邮箱, 入队后及邮箱空中断中调用
+ *             move queued frames into free mailboxes, called after enqueue and from the mailbox-empty interrupt
+ * @note       只剩 CAN_TX_RESERVED_MAILBOX 个空邮箱时只发电机帧, 电机帧无需等待低优先级帧占满的邮箱;
+ *             电机帧在邮箱中等待时不再装入其他帧, 以免 ID 较小的遥测帧 (0x133) 在仲裁中持续抢先
+ *             with only CAN_TX_RESERVED_MAILBOX mailboxes left only motor frames go out,
+ *             so a motor frame never waits behind mailboxes full of lower priority frames;
+ *             while a motor frame is in a mailbox no other frame is loaded, so telemetry
+ *             with a lower ID (0x133) cannot keep winning arbitration against it
+ */
+void CAN_TxQueue_Drain(CAN_HandleTypeDef *_hcan)
 {
-	static CAN_TxHeaderTypeDef TX_MSG;
-	static uint8_t CAN_Send_Data[8];
-	uint32_t send_mail_box;
-
-	TX_MSG.StdId = CAN_RC_DATA_Frame_0;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
-	CAN_Send_Data[0] = rc_data[0];
-	CAN_Send_Data[1] = rc_data[1];
-	CAN_Send_Data[2] = rc_data[2];
-	CAN_Send_Data[3] = rc_data[3];
-	CAN_Send_Data[4] = rc_data[4];
-	CAN_Send_Data[5] = rc_data[5];
-	CAN_Send_Data[6] = rc_data[6];
-	CAN_Send_Data[7] = rc_data[7];
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
+	CAN_TxQueue_t *queue = CAN_Get_TxQueue(_hcan);
+	CAN_TxHeaderTypeDef tx_header;
+	CAN_TxFrame_t *frame;
+	uint32_t free_level, tx_mailbox;
+	uint8_t priority, mailbox;
 
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
+	tx_header.IDE = CAN_ID_STD;
+	tx_header.RTR = CAN_RTR_DATA;
+	tx_header.TransmitGlobalTime = DISABLE;
+
+	queue->MotorMailbox &= ~((_hcan->Instance->TSR & CAN_TSR_TME) >> CAN_TSR_TME0_Pos);
+
+	while ((free_level = HAL_CAN_GetTxMailboxesFreeLevel(_hcan)) != 0)
 	{
-		send_mail_box = CAN_TX_MAILBOX2;
+		for (priority = 0; priority < CAN_TX_PRIO_NUM; priority++)
+			if (queue->Count[priority] != 0)
+				break;
+		if (priority == CAN_TX_PRIO_NUM)
+			return;
+		if (priority != CAN_TX_PRIO_MOTOR && (free_level <= CAN_TX_RESERVED_MAILBOX || queue->MotorMailbox))
+			return;
+
+		frame = &queue->Frame[priority][queue->Head[priority]];
+		// 同 ID 的旧电机帧仍在邮箱中时新帧留在队列里, 以便继续被覆盖
+		// keep a motor frame queued while an older one with the same ID is in a mailbox, so it can still be replaced
+		if (priority == CAN_TX_PRIO_MOTOR)
+			for (mailbox = 0; mailbox < 3; mailbox++)
+				if ((queue->MotorMailbox & (1 << mailbox)) && queue->MailboxStdId[mailbox] == frame->StdId)
+					return;
+
+		tx_header.StdId = frame->StdId;
+		tx_header.DLC = frame->DLC;
+		if (HAL_CAN_AddTxMessage(_hcan, &tx_header, frame->Data, &tx_mailbox) != HAL_OK)
+			return;
+
+		if (priority == CAN_TX_PRIO_MOTOR)
+		{
+			mailbox = tx_mailbox == CAN_TX_MAILBOX0 ? 0 : (tx_mailbox == CAN_TX_MAILBOX1 ? 1 : 2);
+			queue->MotorMailbox |= tx_mailbox;
+			queue->MailboxStdId[mailbox] = frame->StdId;
+		}
+		queue->Head[priority] = (queue->Head[priority] + 1) & (CAN_TX_QUEUE_LEN - 1);
+		queue->Count[priority]--;
+		queue->Stat.Sent++;
 	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
-
-	TX_MSG.StdId = CAN_RC_DATA_Frame_1;
-	CAN_Send_Data[0] = rc_data[8];
-	CAN_Send_Data[1] = rc_data[9];
-	CAN_Send_Data[2] = rc_data[10];
-	CAN_Send_Data[3] = rc_data[11];
-	CAN_Send_Data[4] = rc_data[12];
-	CAN_Send_Data[5] = rc_data[13];
-	CAN_Send_Data[6] = rc_data[14];
-	CAN_Send_Data[7] = rc_data[15];
-
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
+}
+
+/**
+ * @brief      等待队列与邮箱中的电机帧全部发出, 用于复位前确保最后的电流指令已上总线
+ *             wait until every queued and mailbox motor frame has left, so the last
+ *             current command is on the bus before a reset
+ * @retval     HAL_OK      电机帧已全部发出 all motor frames sent
+ *             HAL_TIMEOUT 超时 timed out
+ * @note       仅在任务中调用, 会阻塞 task context only, blocks
+ */
+HAL_StatusTypeDef CAN_TxQueue_Flush_Motor(CAN_HandleTypeDef *_hcan, uint32_t timeout_ms)
+{
+	CAN_TxQueue_t *queue = CAN_Get_TxQueue(_hcan);
+	uint32_t tickstart = HAL_GetTick();
+	uint8_t pending;
+
+	for (;;)
 	{
+		// 同 ID 的旧帧发完后新帧才会进入邮箱 a newer frame enters a mailbox only after the older one with its ID has gone
+		taskENTER_CRITICAL();
+		CAN_TxQueue_Drain(_hcan);
+		pending = queue->Count[CAN_TX_PRIO_MOTOR] != 0 || queue->MotorMailbox != 0;
+		taskEXIT_CRITICAL();
+
+		if (!pending)
+			return HAL_OK;
+		if (HAL_GetTick() - tickstart >= timeout_ms)
+			return HAL_TIMEOUT;
+		HAL_Delay(1);
 	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
+}
+
+// 邮箱空中断 (发送完成/中止/失败) 中继续发送队列
+// keep draining from the mailbox-empty interrupt (complete, abort or failure)
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *_hcan)
+{
+	CAN_TxQueue_Drain(_hcan);
+}
+
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *_hcan)
+{
+	CAN_TxQueue_Drain(_hcan);
+}
+
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *_hcan)
+{
+	CAN_TxQueue_Drain(_hcan);
+}
+
+void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *_hcan)
+{
+	CAN_TxQueue_Drain(_hcan);
+}
+
+void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *_hcan)
+{
+	CAN_TxQueue_Drain(_hcan);
+}
+
+void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *_hcan)
+{
+	CAN_TxQueue_Drain(_hcan);
+}
+
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *_hcan)
+{
+	if (_hcan->ErrorCode & (HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_TERR0 |
+							HAL_CAN_ERROR_TX_ALST1 | HAL_CAN_ERROR_TX_TERR1 |
+							HAL_CAN_ERROR_TX_ALST2 | HAL_CAN_ERROR_TX_TERR2))
+		CAN_Get_TxQueue(_hcan)->Stat.TxError++;
+	HAL_CAN_ResetError(_hcan);
+	CAN_TxQueue_Drain(_hcan);
+}
+
+/**
+ * @brief      按 ID 查找分发表 look up the dispatch table by ID
+ * @retval     表中位置, 未注册时为 -1 slot in the table, -1 if the ID is not registered
+ * @note       开放寻址线性探测, 表项只增不删, 遇到空位即可结束
+ *             open addressing with linear probing, entries are never removed so an empty slot ends the search
+ */
+static int16_t CAN_Rx_Find(uint8_t bus, uint16_t std_id)
+{
+	uint16_t slot = (std_id ^ (std_id >> 5)) & (CAN_RX_DISPATCH_LEN - 1);
+
+	for (uint16_t i = 0; i < CAN_RX_DISPATCH_LEN; i++)
 	{
-		send_mail_box = CAN_TX_MAILBOX0;
+		if (CAN_RxTable[bus][slot].Handler == NULL)
+			return -1;
+		if (CAN_RxTable[bus][slot].StdId == std_id)
+			return slot;
+		slot = (slot + 1) & (CAN_RX_DISPATCH_LEN - 1);
 	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
+	return -1;
+}
+
+/**
+ * @brief      注册一个 ID 的接收处理函数 register the receive handler of an ID
+ * @param      queue: 处理函数在排空该队列的任务中执行; 为 NULL 时在接收中断中直接执行,
+ *                    仅用于耗时短且经快照发布结果的处理函数
+ *                    the handler runs in the task that drains this queue; with NULL it runs
+ *                    in the receive interrupt, only for short handlers that publish through a snapshot
+ * @retval     HAL_ERROR 已注册或表满 already registered or table full
+ * @note       在初始化时调用; 表项最后写入 Handler, 中断不会用到未填完的表项
+ *             call during initialisation; Handler is written last so the interrupt never uses a half written entry
+ */
+HAL_StatusTypeDef CAN_Rx_Register(CAN_HandleTypeDef *_hcan, uint16_t std_id, CAN_Rx_Handler_f handler, void *arg, CAN_RxQueue_t *queue)
+{
+	uint8_t bus = _hcan == &hcan2;
+	uint16_t slot = (std_id ^ (std_id >> 5)) & (CAN_RX_DISPATCH_LEN - 1);
+
+	if (handler == NULL || CAN_Rx_Find(bus, std_id) >= 0)
+		return HAL_ERROR;
+
+	for (uint16_t i = 0; i < CAN_RX_DISPATCH_LEN; i++)
 	{
-		send_mail_box = CAN_TX_MAILBOX1;
+		if (CAN_RxTable[bus][slot].Handler == NULL)
+		{
+			CAN_RxTable[bus][slot].StdId = std_id;
+			CAN_RxTable[bus][slot].Arg = arg;
+			CAN_RxTable[bus][slot].Queue = queue;
+			__DMB();
+			CAN_RxTable[bus][slot].Handler = handler;
+			return HAL_OK;
+		}
+		slot = (slot + 1) & (CAN_RX_DISPATCH_LEN - 1);
 	}
+	return HAL_ERROR;
+}
 
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
+/**
+ * @brief      开始接收入队, 由消费者任务在进入排空循环前调用
+ *             start queueing, called by the consumer task before it enters its drain loop
+ * @note       此前到达的帧直接丢弃并计入 NotRunning, 任务启动延时期间队列不会溢出
+ *             frames arriving before are dropped and counted in NotRunning, so the queue
+ *             does not overflow during the start-up delay of the task
+ */
+void CAN_RxQueue_Start(CAN_RxQueue_t *queue)
+{
+	queue->Tail = queue->Head;
+	__DMB();
+	queue->Running = 1;
+}
+
+/**
+ * @brief      在任务中执行队列中各帧的处理函数, 每个周期开始时调用一次
+ *             run the handlers of the queued frames in task context, call once at the start of each tick
+ * @note       只处理调用时已在队列中的帧, 本周期内读到的数据不会被中断改写
+ *             only frames already queued on entry are handled, so the data seen
+ *             during the rest of the tick is not rewritten by the interrupt
+ * @retval     处理的帧数 number of frames handled
+ */
+uint16_t CAN_RxQueue_Drain(CAN_RxQueue_t *queue)
+{
+	uint16_t head = queue->Head, tail = queue->Tail, count = 0;
+	CAN_RxFrame_t *frame;
+	CAN_RxEntry_t *entry;
+
+	__DMB(); // 先读 Head 再读帧 read Head before the frames
+
+	while (tail != head)
 	{
-		send_mail_box = CAN_TX_MAILBOX2;
+		frame = &queue->Frame[tail & (CAN_RX_QUEUE_LEN - 1)];
+		entry = &CAN_RxTable[frame->Bus][frame->Slot];
+		entry->Handler(frame, entry->Arg);
+		tail++;
+		count++;
 	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+
+	__DMB(); // 帧处理完毕后才释放空间 release the space only after the frames are handled
+	queue->Tail = tail;
+
+	return count;
 }
 
-void Send_VTM_Data(CAN_HandleTypeDef *_hcan, uint8_t *vtm_data)
+/**
+ * @Func	    void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef* _hcan)
+ * @Brief      CAN 接收中断: 仅查表, 打时间戳并放入对应任务的队列, 解码在任务中进行;
+ *             未指定队列的 ID 在此直接处理
+ *             CAN receive interrupt: look up the ID, timestamp the frame and queue it
+ *             for its task, decoding happens in the task; IDs registered without a
+ *             queue are handled right here
+ * @Param	    CAN_HandleTypeDef* _hcan
+ * @Retval	    None
+ **/
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *_hcan)
 {
-	static CAN_TxHeaderTypeDef TX_MSG;
-	static uint8_t CAN_Send_Data[8];
-	uint32_t send_mail_box;
-
-	TX_MSG.StdId = CAN_VTM_DATA_Frame_0;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
-	CAN_Send_Data[0] = vtm_data[0];
-	CAN_Send_Data[1] = vtm_data[1];
-	CAN_Send_Data[2] = vtm_data[2];
-	CAN_Send_Data[3] = vtm_data[3];
-	CAN_Send_Data[4] = vtm_data[4];
-	CAN_Send_Data[5] = vtm_data[5];
-	CAN_Send_Data[6] = vtm_data[6];
-	CAN_Send_Data[7] = vtm_data[7];
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
+	CAN_RxHeaderTypeDef rx_header;
+	uint8_t rx_data[8];
+	uint8_t bus = _hcan == &hcan2;
+	uint32_t time_stamp = DWT->CYCCNT;
+	int16_t slot;
+	CAN_RxEntry_t *entry;
+	CAN_RxQueue_t *queue;
+	CAN_RxFrame_t *frame, direct;
+	uint16_t head = 0, used;
+	PROFILE_BEGIN(PROFILE_CAN_RX_ISR);
+
+	if (HAL_CAN_GetRxMessage(_hcan, CAN_RX_FIFO0, &rx_header, rx_data) != HAL_OK)
 	{
+		PROFILE_END(PROFILE_CAN_RX_ISR);
+		return;
 	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
+	CAN_RxStat[bus].Received++;
+
+	slot = rx_header.IDE == CAN_ID_STD ? CAN_Rx_Find(bus, rx_header.StdId) : -1;
+	if (slot < 0)
 	{
+		CAN_RxStat[bus].Unhandled++;
+		PROFILE_END(PROFILE_CAN_RX_ISR);
+		return;
 	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
+
+	entry = &CAN_RxTable[bus][slot];
+	queue = entry->Queue;
+	if (queue == NULL)
+		frame = &direct;
+	else
 	{
-		send_mail_box = CAN_TX_MAILBOX0;
+		if (!queue->Running)
+		{
+			queue->NotRunning++;
+			PROFILE_END(PROFILE_CAN_RX_ISR);
+			return;
+		}
+		head = queue->Head;
+		used = (uint16_t)(head - queue->Tail);
+		if (used >= CAN_RX_QUEUE_LEN)
+		{
+			queue->Overflow++;
+			PROFILE_END(PROFILE_CAN_RX_ISR);
+			return;
+		}
+		if (used + 1 > queue->HighWater)
+			queue->HighWater = used + 1;
+		frame = &queue->Frame[head & (CAN_RX_QUEUE_LEN - 1)];
 	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
+
+	frame->TimeStamp = time_stamp;
+	frame->StdId = rx_header.StdId;
+	frame->DLC = rx_header.DLC;
+	frame->Bus = bus;
+	frame->Slot = slot;
+	memcpy(frame->Data, rx_data, sizeof(frame->Data));
+
+	if (queue == NULL)
+		entry->Handler(frame, entry->Arg);
+	else
 	{
-		send_mail_box = CAN_TX_MAILBOX1;
+		__DMB(); // 帧写完后才发布 publish only after the frame is written
+		queue->Head = head + 1;
 	}
+	PROFILE_END(PROFILE_CAN_RX_ISR);
+}
+
+/*************************** receive handlers ***************************/
+static void CAN_Rx_ChassisMotor(CAN_RxFrame_t *frame, void *arg)
+{
+	static const uint8_t ChassisMotor_TOE[4] = {CHASSIS_MOTOR1_TOE, CHASSIS_MOTOR2_TOE, CHASSIS_MOTOR3_TOE, CHASSIS_MOTOR4_TOE};
+	Motor_t *motor = (Motor_t *)arg;
+
+	if (motor->msg_cnt++ <= 50)
+		get_moto_offset(motor, frame->Data);
+	else
+		get_moto_info(motor, frame->Data);
+	Detect_Hook(ChassisMotor_TOE[frame->StdId - 0x201]);
+}
+
+// 来自云台控制板的遥控器数据, 分两帧发送, 在接收中断中解码, 不依赖底盘任务
+// remote control data from the gimbal board, sent in two frames and decoded in the
+// receive interrupt so it does not depend on the chassis task
+static void CAN_Rx_RC(CAN_RxFrame_t *frame, void *arg)
+{
+	static uint8_t RC_Data_Buf[16];
 
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
+	if (frame->StdId == CAN_RC_DATA_Frame_0)
+		memcpy(RC_Data_Buf, frame->Data, 8);
+	else
 	{
-		send_mail_box = CAN_TX_MAILBOX2;
+		memcpy(RC_Data_Buf + 8, frame->Data, 8);
+		Callback_RC_Handle(&remote_control_can, RC_Data_Buf, RC_SOURCE_CAN);
 	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+}
+
+static void CAN_Rx_YawMotor(CAN_RxFrame_t *frame, void *arg)
+{
+	Detect_Hook(GIMBAL_YAW_MOTOR_TOE);
+	if (frame->Data[6] != 0 && frame->Data[7] != 0)
+		get_RMD_info(&Gimbal.YawMotor, frame->Data);
+}
+
+// 定位与规划点在接收中断中整体发布到 Chassis_NavSnapshot, 由底盘任务在周期开始时读取
+// pose and plan point are published to Chassis_NavSnapshot as a whole from the receive
+// interrupt and read by the chassis task at the start of its tick
+static Chassis_Nav_t CAN_Rx_Nav;
+
+static void CAN_Rx_ChassisPos(CAN_RxFrame_t *frame, void *arg)
+{
+	memcpy(tempBuff, frame->Data, 8); // CF_SOF POSX POSY YAW planX 1
+	CAN_Rx_Nav.posX1000 = (int16_t)((frame->Data[2] << 8) | frame->Data[1]);
+	CAN_Rx_Nav.posY1000 = (int16_t)((frame->Data[4] << 8) | frame->Data[3]);
+	CAN_Rx_Nav.posZ1000 = (int16_t)((frame->Data[6] << 8) | frame->Data[5]);
+	CAN_Rx_Nav.TimeStamp = frame->TimeStamp;
+	Snapshot_Publish(&Chassis_NavSnapshot, &CAN_Rx_Nav);
+}
+
+static void CAN_Rx_ChassisPlan(CAN_RxFrame_t *frame, void *arg)
+{
+	memcpy(tempBuff + 8, frame->Data, 8); // planX 1 planY 1 planX 2 planY 2 CF_EOF
+	TempPlanX1000 = (int16_t)((tempBuff[8] << 8) | (tempBuff[7]));
+	TempPlanY1000 = (int16_t)((tempBuff[10] << 8) | (tempBuff[9]));
+	CAN_Rx_Nav.PlanX1000 = (int16_t)((tempBuff[12] << 8) | (tempBuff[11]));
+	CAN_Rx_Nav.PlanY1000 = (int16_t)((tempBuff[14] << 8) | (tempBuff[13]));
+	Snapshot_Publish(&Chassis_NavSnapshot, &CAN_Rx_Nav);
+}
+
+// 电机反馈只由底盘任务使用, 在其周期开始时处理; 遥控器与定位帧经快照发布, 在中断中处理
+// motor feedback is used by the chassis task only and handled at the start of its tick;
+// RC and navigation frames publish through snapshots and are handled in the interrupt
+static void CAN_Rx_Register_Default(void)
+{
+	for (uint8_t i = 0; i < 4; i++)
+		CAN_Rx_Register(&hcan1, CAN_Receive_1_ID + i, CAN_Rx_ChassisMotor, &Chassis.ChassisMotor[i], &CAN_RxQueue);
+	CAN_Rx_Register(&hcan2, CAN_RC_DATA_Frame_0, CAN_Rx_RC, NULL, NULL);
+	CAN_Rx_Register(&hcan2, CAN_RC_DATA_Frame_1, CAN_Rx_RC, NULL, NULL);
+	CAN_Rx_Register(&hcan2, YAW_MOTOR_ID, CAN_Rx_YawMotor, NULL, &CAN_RxQueue);
+	CAN_Rx_Register(&hcan2, 0x151, CAN_Rx_ChassisPos, NULL, NULL);
+	CAN_Rx_Register(&hcan2, 0x150, CAN_Rx_ChassisPlan, NULL, NULL);
+}
+
+// ͨ��CAN���߷���ң������Ϣ ��������δʹ��
+void Send_RC_Data(CAN_HandleTypeDef *_hcan, uint8_t *rc_data)
+{
+	CAN_Transmit(_hcan, CAN_RC_DATA_Frame_0, rc_data, 8, CAN_TX_PRIO_CONTROL);
+	CAN_Transmit(_hcan, CAN_RC_DATA_Frame_1, rc_data + 8, 8, CAN_TX_PRIO_CONTROL);
+}
+
+void Send_VTM_Data(CAN_HandleTypeDef *_hcan, uint8_t *vtm_data)
+{
+	uint8_t CAN_Send_Data[8] = {0};
+
+	CAN_Transmit(_hcan, CAN_VTM_DATA_Frame_0, vtm_data, 8, CAN_TX_PRIO_CONTROL);
 
-	TX_MSG.StdId = CAN_VTM_DATA_Frame_1;
 	CAN_Send_Data[0] = vtm_data[8];
 	CAN_Send_Data[1] = vtm_data[9];
 	CAN_Send_Data[2] = vtm_data[10];
 	CAN_Send_Data[3] = vtm_data[11];
-	CAN_Send_Data[4] = 0;
-	CAN_Send_Data[5] = 0;
-	CAN_Send_Data[6] = 0;
-	CAN_Send_Data[7] = 0;
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
-
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+	CAN_Transmit(_hcan, CAN_VTM_DATA_Frame_1, CAN_Send_Data, 8, CAN_TX_PRIO_CONTROL);
 }
 
 void Send_Robot_Info(CAN_HandleTypeDef *_hcan, int8_t ID, uint16_t heatLimit, uint16_t heat, uint16_t bulletSpeed, uint16_t speed_limit,
 					 uint16_t heatLimit2, uint16_t heat2, uint16_t speed_limit2, uint8_t gameStatus, uint16_t outpost_HP)
 {
-	static CAN_TxHeaderTypeDef TX_MSG;
-	static uint8_t CAN_Send_Data[8];
-	uint32_t send_mail_box;
+	uint8_t CAN_Send_Data[8];
 
-	TX_MSG.StdId = 0x133;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
 	CAN_Send_Data[0] = ID;
 	CAN_Send_Data[1] = (heatLimit >> 8) & 0xFF;
 	CAN_Send_Data[2] = heatLimit & 0xFF;
@@ -389,34 +600,7 @@ void Send_Robot_Info(CAN_HandleTypeDef *_hcan, int8_t ID, uint16_t heatLimit, ui
 	CAN_Send_Data[5] = (bulletSpeed >> 8) & 0xFF;
 	CAN_Send_Data[6] = bulletSpeed & 0xFF;
 	CAN_Send_Data[7] = speed_limit & 0xFF;
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
-
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
-	TX_MSG.StdId = 0x134;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
+	CAN_Transmit(_hcan, 0x133, CAN_Send_Data, 8, CAN_TX_PRIO_TELEMETRY);
 
 	CAN_Send_Data[0] = (heatLimit2 >> 8) & 0xFF;
 	CAN_Send_Data[1] = heatLimit2 & 0xFF;
@@ -426,238 +610,49 @@ void Send_Robot_Info(CAN_HandleTypeDef *_hcan, int8_t ID, uint16_t heatLimit, ui
 	CAN_Send_Data[5] = gameStatus;
 	CAN_Send_Data[6] = (outpost_HP >> 8) & 0xFF;
 	CAN_Send_Data[7] = outpost_HP & 0xFF;
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
-
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+	CAN_Transmit(_hcan, 0x134, CAN_Send_Data, 8, CAN_TX_PRIO_TELEMETRY);
 }
 
 void Send_JudgeRxData(CAN_HandleTypeDef *_hcan, uint8_t *data)
 {
-	static CAN_TxHeaderTypeDef TX_MSG;
-	static uint8_t CAN_Send_Data[8];
-	uint32_t send_mail_box;
-
-	TX_MSG.StdId = 0x235;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
-	for (uint8_t i = 0; i < 8; i++)
-		CAN_Send_Data[i] = data[i];
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
-
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+	CAN_Transmit(_hcan, 0x235, data, 8, CAN_TX_PRIO_TELEMETRY);
 }
 
 void Send_Reset_Command(CAN_HandleTypeDef *_hcan)
 {
-	static CAN_TxHeaderTypeDef TX_MSG;
-	static uint8_t CAN_Send_Data[8];
-	uint32_t send_mail_box;
+	uint8_t CAN_Send_Data[8] = {0};
 
-	TX_MSG.StdId = CAN_SYSTEM_RESET_CMD;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
-
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+	CAN_Transmit(_hcan, CAN_SYSTEM_RESET_CMD, CAN_Send_Data, 8, CAN_TX_PRIO_CONTROL);
 }
 
 void Send_Power_Data(CAN_HandleTypeDef *_hcan, uint16_t Chassis_power_buffer, uint16_t Chassis_power_limit)
 {
+	uint8_t CAN_Send_Data[8] = {0};
+
 	if (Chassis_power_limit >= 10240)
 		Chassis_power_limit /= 256;
 	if (Chassis_power_limit >= 200)
 		Chassis_power_limit /= 5;
-	static CAN_TxHeaderTypeDef TX_MSG;
-	static uint8_t CAN_Send_Data[8];
-	uint32_t send_mail_box;
-
-	TX_MSG.StdId = 0x302;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
+
 	CAN_Send_Data[0] = Chassis_power_buffer >> 8;
 	CAN_Send_Data[1] = Chassis_power_buffer;
 	CAN_Send_Data[2] = Chassis_power_limit >> 8;
 	CAN_Send_Data[3] = Chassis_power_limit;
-	CAN_Send_Data[4] = 0;
-	CAN_Send_Data[5] = 0;
-	CAN_Send_Data[6] = 0;
-	CAN_Send_Data[7] = 0;
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
-
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+	CAN_Transmit(_hcan, 0x302, CAN_Send_Data, 8, CAN_TX_PRIO_CONTROL);
 }
 
 void SendAerialData(CAN_HandleTypeDef *_hcan, float *X, float *Y, uint8_t *KeyBoard)
 {
-	static CAN_TxHeaderTypeDef TX_MSG;
-	static uint8_t CAN_Send_Data[8];
-	uint32_t send_mail_box;
-	static uint8_t XData[4];
-	static uint8_t YData[4];
-
-	float2u8array(X, XData, TRUE);
-	float2u8array(Y, YData, TRUE);
-
-	TX_MSG.StdId = CAN_AERIAL_DATA_1;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
-	CAN_Send_Data[0] = XData[0];
-	CAN_Send_Data[1] = XData[1];
-	CAN_Send_Data[2] = XData[2];
-	CAN_Send_Data[3] = XData[3];
-	CAN_Send_Data[4] = YData[0];
-	CAN_Send_Data[5] = YData[1];
-	CAN_Send_Data[6] = YData[2];
-	CAN_Send_Data[7] = YData[3];
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0)
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
+	uint8_t CAN_Send_Data[8] = {0};
 
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+	float2u8array(X, CAN_Send_Data, TRUE);
+	float2u8array(Y, CAN_Send_Data + 4, TRUE);
+	CAN_Transmit(_hcan, CAN_AERIAL_DATA_1, CAN_Send_Data, 8, CAN_TX_PRIO_TELEMETRY);
 
-	TX_MSG.StdId = CAN_AERIAL_DATA_2;
-	TX_MSG.IDE = CAN_ID_STD;
-	TX_MSG.RTR = CAN_RTR_DATA;
-	TX_MSG.DLC = 0x08;
+	memset(CAN_Send_Data, 0, sizeof(CAN_Send_Data));
 	CAN_Send_Data[0] = map_interactivity.commd_keyboard;
-	CAN_Send_Data[1] = 0;
-	CAN_Send_Data[2] = 0;
-	CAN_Send_Data[3] = 0;
-	CAN_Send_Data[4] = 0;
-	CAN_Send_Data[5] = 0;
-	CAN_Send_Data[6] = 0;
 	CAN_Send_Data[7] = 77;
-
-	while (!((_hcan->State == HAL_CAN_STATE_READY) || (_hcan->State == HAL_CAN_STATE_LISTENING)))
-	{
-	}
-	while (HAL_CAN_GetTxMailboxesFreeLevel(_hcan) == 0) // ����������䶼�����˾͵�һ�����ֱ������ĳ���������
-	{
-	}
-	/* Check Tx Mailbox 1 status */
-	if ((_hcan->Instance->TSR & CAN_TSR_TME0) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX0;
-	}
-	/* Check Tx Mailbox 1 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME1) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX1;
-	}
-
-	/* Check Tx Mailbox 2 status */
-	else if ((_hcan->Instance->TSR & CAN_TSR_TME2) != 0U)
-	{
-		send_mail_box = CAN_TX_MAILBOX2;
-	}
-	HAL_CAN_AddTxMessage(_hcan, &TX_MSG, CAN_Send_Data, &send_mail_box);
+	CAN_Transmit(_hcan, CAN_AERIAL_DATA_2, CAN_Send_Data, 8, CAN_TX_PRIO_TELEMETRY);
 }
 
 void float2u8array(float *FloatData, uint8_t *u8Array, uint8_t Key)
@@ -27,8 +27,95 @@
 
 #define CAN_AERIAL_DATA_1 0x501
 #define CAN_AERIAL_DATA_2 0x502
+
+// 发送队列 transmit queue
+#define CAN_TX_QUEUE_LEN 8		  // 每个优先级的队列长度, 须为 2 的幂 per priority, power of two
+#define CAN_TX_RESERVED_MAILBOX 1 // 为电机帧保留的邮箱数 mailboxes kept free for motor frames
+#define CAN_TX_FLUSH_TIMEOUT_MS 5 // 复位前等待电机帧发出的上限 longest wait for motor frames before a reset
+
+typedef enum
+{
+	CAN_TX_PRIO_MOTOR = 0, // 电机电流, 同 ID 未发出的旧帧被新帧覆盖 motor current, a newer frame replaces an unsent one with the same ID
+	CAN_TX_PRIO_CONTROL,   // 遥控/复位/功率等控制数据 remote control, reset, power data
+	CAN_TX_PRIO_TELEMETRY, // 裁判系统/云台手等遥测数据 referee and aerial telemetry
+	CAN_TX_PRIO_NUM,
+} CAN_TxPriority_e;
+
+typedef struct
+{
+	uint32_t StdId;
+	uint8_t DLC;
+	uint8_t Data[8];
+} CAN_TxFrame_t;
+
+typedef struct
+{
+	uint32_t Enqueued[CAN_TX_PRIO_NUM];
+	uint32_t Dropped[CAN_TX_PRIO_NUM]; // 队列满丢弃 dropped because the queue was full
+	uint32_t Replaced;				   // 电机帧被覆盖 motor frames replaced before they were sent
+	uint32_t Sent;					   // 写入邮箱 moved into a mailbox
+	uint32_t TxError;				   // 邮箱发送失败 mailbox transmissions that failed
+	uint8_t HighWater[CAN_TX_PRIO_NUM];
+} CAN_TxStat_t;
+
+typedef struct
+{
+	CAN_TxFrame_t Frame[CAN_TX_PRIO_NUM][CAN_TX_QUEUE_LEN];
+	uint8_t Head[CAN_TX_PRIO_NUM];
+	uint8_t Count[CAN_TX_PRIO_NUM];
+	uint8_t MotorMailbox; // 放有未发出电机帧的邮箱, 位同 CAN_TX_MAILBOXx mailboxes holding an unsent motor frame
+	uint16_t MailboxStdId[3];
+	CAN_TxStat_t Stat;
+} CAN_TxQueue_t;
 // void CAN_Device_Init(CAN_HandleTypeDef *_hcan);
 void CAN_Device_Init(void);
+HAL_StatusTypeDef CAN_Transmit(CAN_HandleTypeDef *_hcan, uint32_t std_id, const uint8_t *data, uint8_t dlc, CAN_TxPriority_e priority);
+void CAN_TxQueue_Drain(CAN_HandleTypeDef *_hcan);
+HAL_StatusTypeDef CAN_TxQueue_Flush_Motor(CAN_HandleTypeDef *_hcan, uint32_t timeout_ms);
+CAN_TxQueue_t *CAN_Get_TxQueue(CAN_HandleTypeDef *_hcan);
+
+// 接收分发 receive dispatch
+#define CAN_RX_DISPATCH_LEN 32 // 每路总线的 ID 散列表长度, 须为 2 的幂 ID hash table per bus, power of two
+#define CAN_RX_QUEUE_LEN 64	   // 须为 2 的幂 power of two
+
+typedef struct
+{
+	uint32_t TimeStamp; // 进入中断时的 DWT->CYCCNT cycle counter when the frame was taken from the FIFO
+	uint16_t StdId;
+	uint8_t DLC;
+	uint8_t Bus;  // 0: CAN1 1: CAN2
+	uint8_t Slot; // 分发表位置 dispatch table slot
+	uint8_t Data[8];
+} CAN_RxFrame_t;
+
+typedef void (*CAN_Rx_Handler_f)(CAN_RxFrame_t *frame, void *arg);
+
+// 单生产者 (CAN1/CAN2 接收中断, 同一优先级互不嵌套) 单消费者 (注册时指定的任务) 无锁环形队列
+// single producer (CAN1/CAN2 RX interrupts, same priority so they never nest),
+// single consumer (the task the IDs were registered for) lock-free ring
+typedef struct
+{
+	CAN_RxFrame_t Frame[CAN_RX_QUEUE_LEN];
+	volatile uint16_t Head; // 仅中断写 written by the ISR only
+	volatile uint16_t Tail; // 仅任务写 written by the task only
+	volatile uint8_t Running; // 消费者开始排空前中断不入队 the interrupt queues nothing until the consumer starts draining
+	uint32_t Overflow;		// 队列满丢弃的帧数 frames dropped because the queue was full
+	uint32_t NotRunning;	// 消费者启动前丢弃的帧数 frames dropped before the consumer started
+	uint16_t HighWater;
+} CAN_RxQueue_t;
+
+typedef struct
+{
+	uint32_t Received;
+	uint32_t Unhandled; // 未注册的 ID unregistered IDs
+} CAN_RxStat_t;
+
+extern CAN_RxQueue_t CAN_RxQueue;
+extern CAN_RxStat_t CAN_RxStat[2];
+
+HAL_StatusTypeDef CAN_Rx_Register(CAN_HandleTypeDef *_hcan, uint16_t std_id, CAN_Rx_Handler_f handler, void *arg, CAN_RxQueue_t *queue);
+void CAN_RxQueue_Start(CAN_RxQueue_t *queue);
+uint16_t CAN_RxQueue_Drain(CAN_RxQueue_t *queue);
 
 void Send_Gimbal_Control_1(CAN_HandleTypeDef *hcan, int16_t Yaw, int16_t Pitch, int16_t Stir, int8_t ifFricOn);
 void Send_Gimbal_Control_2(CAN_HandleTypeDef *_hcan, int16_t Mouse_X, int16_t Mouse_Y, int16_t KeyCode, int16_t MouseLeft, int16_t MouseRight);
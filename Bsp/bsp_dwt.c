@@ -4,8 +4,7 @@ DWT_Time_t SysTime;
 static uint32_t CPU_FREQ_Hz, CPU_FREQ_Hz_ms, CPU_FREQ_Hz_us;
 static uint32_t CYCCNT_RountCount;
 static uint32_t CYCCNT_LAST;
-uint64_t CYCCNT64;
-static void DWT_CNT_Update(void);
+static uint64_t DWT_CNT_Update(void);
 
 void DWT_Init(uint32_t CPU_Freq_mHz)
 {
@@ -46,69 +45,139 @@ double DWT_GetDeltaT64(uint32_t *cnt_last)
     return dt;
 }
 
-void DWT_SysTimeUpdate(void)
+/**
+ * @brief 开始新的控制周期, 只读一次 DWT->CYCCNT, 只做一次除法
+ *        start a new control tick, reading DWT->CYCCNT once with a single divide
+ */
+void DWT_Tick_Update(DWT_Tick_t *tick)
 {
-    volatile uint32_t cnt_now = DWT->CYCCNT;
-    static uint64_t CNT_TEMP1, CNT_TEMP2, CNT_TEMP3;
+    tick->dt = DWT_GetDeltaT(&tick->CYCCNT);
+    tick->inv_dt = tick->dt > 0 ? 1.0f / tick->dt : 0;
+    tick->Index++;
+}
+
+void DWT_Tick_Update_At(DWT_Tick_t *tick, uint32_t cyccnt)
+{
+    tick->dt = ((uint32_t)(cyccnt - tick->CYCCNT)) / ((float)(CPU_FREQ_Hz));
+    tick->inv_dt = tick->dt > 0 ? 1.0f / tick->dt : 0;
+    tick->CYCCNT = cyccnt;
+    tick->Index++;
 
     DWT_CNT_Update();
+}
 
-    CYCCNT64 = (uint64_t)CYCCNT_RountCount * (uint64_t)UINT32_MAX + (uint64_t)cnt_now;
-    CNT_TEMP1 = CYCCNT64 / CPU_FREQ_Hz;
-    CNT_TEMP2 = CYCCNT64 - CNT_TEMP1 * CPU_FREQ_Hz;
-    SysTime.s = CNT_TEMP1;
-    SysTime.ms = CNT_TEMP2 / CPU_FREQ_Hz_ms;
-    CNT_TEMP3 = CNT_TEMP2 - SysTime.ms * CPU_FREQ_Hz_ms;
-    SysTime.us = CNT_TEMP3 / CPU_FREQ_Hz_us;
+const DWT_Tick_t *DWT_Tick_Or_Self(const DWT_Tick_t *tick, DWT_Tick_t *self, uint32_t *cnt_last)
+{
+    if (tick != NULL)
+    {
+        // 之后改回自计时也能得到正确的 dt a later self-timed call still gets the right dt
+        *cnt_last = tick->CYCCNT;
+        return tick;
+    }
+
+    self->CYCCNT = *cnt_last;
+    self->Index = 0;
+    DWT_Tick_Update(self);
+    *cnt_last = self->CYCCNT;
+    return self;
+}
+
+/**
+ * @brief 将 64 位周期数拆分为 s/ms/us, 结果只写入调用者的结构体
+ *        split a 64 bit cycle count into s/ms/us, writing only the caller's struct
+ */
+static void DWT_Time_Split(uint64_t cyccnt64, DWT_Time_t *time)
+{
+    uint64_t s = cyccnt64 / CPU_FREQ_Hz;
+    uint32_t rem = (uint32_t)(cyccnt64 - s * CPU_FREQ_Hz);
+
+    time->s = (uint32_t)s;
+    time->ms = rem / CPU_FREQ_Hz_ms;
+    time->us = (rem - time->ms * CPU_FREQ_Hz_ms) / CPU_FREQ_Hz_us;
+}
+
+void DWT_SysTimeUpdate(void)
+{
+    DWT_Time_t time;
+
+    DWT_Time_Split(DWT_CNT_Update(), &time);
+    SysTime = time;
 }
 
 float DWT_GetTimeline_s(void)
 {
-    DWT_SysTimeUpdate();
+    DWT_Time_t time;
+    DWT_Time_Split(DWT_CNT_Update(), &time);
 
-    float DWT_Timelinef32 = SysTime.s + SysTime.ms * 0.001f + SysTime.us * 0.000001f;
+    float DWT_Timelinef32 = time.s + time.ms * 0.001f + time.us * 0.000001f;
 
     return DWT_Timelinef32;
 }
 
 float DWT_GetTimeline_ms(void)
 {
-    DWT_SysTimeUpdate();
+    DWT_Time_t time;
+    DWT_Time_Split(DWT_CNT_Update(), &time);
 
-    float DWT_Timelinef32 = SysTime.s * 1000 + SysTime.ms + SysTime.us * 0.001f;
+    float DWT_Timelinef32 = time.s * 1000 + time.ms + time.us * 0.001f;
 
     return DWT_Timelinef32;
 }
 
 uint32_t DWT_GetTimeline_ms_int32(void)
 {
-    DWT_SysTimeUpdate();
+    DWT_Time_t time;
+    DWT_Time_Split(DWT_CNT_Update(), &time);
     uint32_t DWT_Timelinef32;
-    if (SysTime.us >= 500)
-        DWT_Timelinef32 = SysTime.s * 1000 + SysTime.ms + 1;
+    if (time.us >= 500)
+        DWT_Timelinef32 = time.s * 1000 + time.ms + 1;
     else
-        DWT_Timelinef32 = SysTime.s * 1000 + SysTime.ms;
+        DWT_Timelinef32 = time.s * 1000 + time.ms;
 
     return DWT_Timelinef32;
 }
 
 uint64_t DWT_GetTimeline_us(void)
 {
-    DWT_SysTimeUpdate();
+    return DWT_CNT_Update() / CPU_FREQ_Hz_us;
+}
 
-    uint64_t DWT_Timelinef32 = SysTime.s * 1000000 + SysTime.ms * 1000 + SysTime.us;
+/**
+ * @brief 此前某一 DWT->CYCCNT 对应的时间轴, 须在其后一个计数周期 (25 s) 内调用
+ *        timeline of an earlier DWT->CYCCNT, call within one counter period (25 s) of it
+ */
+uint64_t DWT_GetTimeline_us_At(uint32_t cyccnt)
+{
+    // 年龄取自同一次 CYCCNT 读数的低 32 位 the age comes from the low 32 bits of the same CYCCNT read
+    uint64_t cnt64 = DWT_CNT_Update();
+    uint32_t age = (uint32_t)cnt64 - cyccnt;
 
-    return DWT_Timelinef32;
+    return (cnt64 - age) / CPU_FREQ_Hz_us;
 }
 
-static void DWT_CNT_Update(void)
+/**
+ * @brief 在临界区内只读一次 CYCCNT 并维护回绕计数, 返回 64 位周期数
+ *        任务与中断都会调用, 结果经局部变量返回, 不经共享的静态量
+ *        read CYCCNT once and keep the wrap count inside a critical section, returning the
+ *        64 bit cycle count; tasks and interrupts both call it, so the result goes through
+ *        locals and never through shared statics
+ */
+static uint64_t DWT_CNT_Update(void)
 {
-    volatile uint32_t cnt_now = DWT->CYCCNT;
+    uint32_t primask = __get_PRIMASK();
+    uint32_t cnt_now;
+    uint32_t round;
 
+    __disable_irq();
+    cnt_now = DWT->CYCCNT;
     if (cnt_now < CYCCNT_LAST)
         CYCCNT_RountCount++;
-
     CYCCNT_LAST = cnt_now;
+    round = CYCCNT_RountCount;
+    __set_PRIMASK(primask);
+
+    // 每次回绕为 2^32 个周期 each wrap is 2^32 cycles
+    return ((uint64_t)round << 32) | cnt_now;
 }
 
 void DWT_Delay(float Delay)
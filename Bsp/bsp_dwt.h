@@ -11,6 +11,18 @@ typedef struct
     uint16_t us;
 } DWT_Time_t;
 
+// 控制周期上下文: 任务每周期读一次 DWT, 本周期内的控制器与滤波器共用同一 dt 与 1/dt
+// control tick context: the task reads the DWT once per tick, and every controller and filter
+// of that tick shares the same dt and 1/dt
+// 全零即可使用, 第一次 DWT_Tick_Update() 的 dt 为自上电起的时间 ready when zeroed, the first dt is the time since power-up
+typedef struct
+{
+    uint32_t CYCCNT; // 本周期开始时的 DWT->CYCCNT timestamp of this tick
+    uint32_t Index;  // 周期序号 tick index
+    float dt;        // 与上一周期的间隔 time since the last tick, s
+    float inv_dt;    // 1/dt, dt 为 0 时为 0 1/dt, 0 when dt is 0
+} DWT_Tick_t;
+
 void DWT_Init(uint32_t CPU_Freq_mHz);
 float DWT_GetDeltaT(uint32_t *cnt_last);
 double DWT_GetDeltaT64(uint32_t *cnt_last);
@@ -18,9 +30,18 @@ float DWT_GetTimeline_s(void);
 float DWT_GetTimeline_ms(void);
 uint32_t DWT_GetTimeline_ms_int32(void);
 uint64_t DWT_GetTimeline_us(void);
+uint64_t DWT_GetTimeline_us_At(uint32_t cyccnt);
 void DWT_Delay(float Delay);
 void DWT_SysTimeUpdate(void);
 
+void DWT_Tick_Update(DWT_Tick_t *tick);
+// 以此前记下的 DWT->CYCCNT (如中断中的采样时刻) 开始新的周期 start a new tick at an earlier DWT->CYCCNT, e.g. a sample time taken in an interrupt
+void DWT_Tick_Update_At(DWT_Tick_t *tick, uint32_t cyccnt);
+// 自计时接口用: tick 非空时将 *cnt_last 对齐到 tick 并返回 tick; 为空时以 *cnt_last 计时写入 self 并返回 self
+// for the self-timing APIs: with a tick, aligns *cnt_last to it and returns it; without one, times
+// from *cnt_last into self and returns self
+const DWT_Tick_t *DWT_Tick_Or_Self(const DWT_Tick_t *tick, DWT_Tick_t *self, uint32_t *cnt_last);
+
 extern DWT_Time_t SysTime;
 
 #endif /* BSP_DWT_H_ */
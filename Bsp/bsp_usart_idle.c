@@ -1,4 +1,18 @@
 #include "bsp_usart_idle.h"
+#include "profiler.h"
+
+// 以环形 DMA 连续接收的串口, 空闲中断中不重启 DMA, 由使用者按 NDTR 跟踪写位置
+// UARTs streaming into a circular DMA buffer, the idle interrupt leaves their DMA
+// running and the user tracks the write position from NDTR
+static UART_HandleTypeDef *USART_IDLE_Stream[3];
+
+static uint8_t USART_IDLE_Is_Stream(UART_HandleTypeDef *huart)
+{
+    for (uint8_t i = 0; i < sizeof(USART_IDLE_Stream) / sizeof(USART_IDLE_Stream[0]); i++)
+        if (USART_IDLE_Stream[i] == huart)
+            return 1;
+    return 0;
+}
 
 void USART_IDLE_Init(UART_HandleTypeDef *huart, uint8_t *rx_buf, uint16_t dma_buf_num)
 {
@@ -31,8 +45,38 @@ void USART_IDLE_Init(UART_HandleTypeDef *huart, uint8_t *rx_buf, uint16_t dma_bu
     __HAL_DMA_ENABLE(huart->hdmarx);
 }
 
+/**
+ * @brief  以环形 DMA 连续接收, 数据不会因帧跨越缓冲区末尾或背靠背到达而丢失
+ *         stream into a circular DMA buffer, frames that straddle the end of the
+ *         buffer or arrive back to back are kept
+ * @note   写位置为 dma_buf_num - __HAL_DMA_GET_COUNTER(huart->hdmarx)
+ *         the write position is dma_buf_num - __HAL_DMA_GET_COUNTER(huart->hdmarx)
+ */
+void USART_IDLE_Stream_Init(UART_HandleTypeDef *huart, uint8_t *rx_buf, uint16_t dma_buf_num)
+{
+    for (uint8_t i = 0; i < sizeof(USART_IDLE_Stream) / sizeof(USART_IDLE_Stream[0]); i++)
+    {
+        if (USART_IDLE_Stream[i] == NULL || USART_IDLE_Stream[i] == huart)
+        {
+            USART_IDLE_Stream[i] = huart;
+            break;
+        }
+    }
+
+    USART_IDLE_Init(huart, rx_buf, dma_buf_num);
+
+    __HAL_DMA_DISABLE(huart->hdmarx);
+    while (huart->hdmarx->Instance->CR & DMA_SxCR_EN)
+    {
+        __HAL_DMA_DISABLE(huart->hdmarx);
+    }
+    SET_BIT(huart->hdmarx->Instance->CR, DMA_SxCR_CIRC);
+    __HAL_DMA_ENABLE(huart->hdmarx);
+}
+
 void USART_IDLE_IRQHandler(UART_HandleTypeDef *huart)
 {
+    PROFILE_BEGIN(PROFILE_UART_IDLE_ISR);
     // �����
     uint32_t isrflags = READ_REG(huart->Instance->SR);
     uint32_t cr1its = READ_REG(huart->Instance->CR1);
@@ -46,9 +90,12 @@ void USART_IDLE_IRQHandler(UART_HandleTypeDef *huart)
     {
         __HAL_UART_CLEAR_PEFLAG(huart);
 
-        __HAL_DMA_DISABLE(huart->hdmarx);
+        if (!USART_IDLE_Is_Stream(huart))
+        {
+            __HAL_DMA_DISABLE(huart->hdmarx);
 
-        __HAL_DMA_ENABLE(huart->hdmarx);
+            __HAL_DMA_ENABLE(huart->hdmarx);
+        }
 
         USER_UART_RxIdleCallback(huart);
     }
@@ -70,6 +117,7 @@ void USART_IDLE_IRQHandler(UART_HandleTypeDef *huart)
         HAL_UART_TxCpltCallback(huart);
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS */
     }
+    PROFILE_END(PROFILE_UART_IDLE_ISR);
 }
 
 /**
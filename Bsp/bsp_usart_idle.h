@@ -7,6 +7,7 @@
 #include "string.h"
 
 void USART_IDLE_Init(UART_HandleTypeDef *huart, uint8_t *rx_buf, uint16_t dma_buf_num);
+void USART_IDLE_Stream_Init(UART_HandleTypeDef *huart, uint8_t *rx_buf, uint16_t dma_buf_num);
 void USART_IDLE_IRQHandler(UART_HandleTypeDef *huart);
 void RC_Restart(uint16_t dma_buf_num);
 
@@ -0,0 +1,91 @@
+/**
+ ******************************************************************************
+ * @file    ConingIntegrator.c
+ * @brief   角速度样本的圆锥补偿积分 coning compensated integration of gyro samples
+ ******************************************************************************
+ * @attention
+ * 递推式 recursion (Savage, Strapdown Analytics 7.1.1.1):
+ *   beta_m  = beta_m-1 + 1/2 (alpha_m-1 + 1/6 dtheta_m-1) x dtheta_m
+ *   alpha_m = alpha_m-1 + dtheta_m
+ *   phi     = alpha + beta
+ ******************************************************************************
+ */
+#include "ConingIntegrator.h"
+#include <math.h>
+
+/**
+ * @brief 开始新的姿态更新周期, 保留上一样本的角增量 start a new attitude update, keeping the last angle increment
+ */
+void Coning_Reset(Coning_t *coning)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        coning->Alpha[i] = 0;
+        coning->Beta[i] = 0;
+    }
+    coning->dt = 0;
+    coning->Count = 0;
+}
+
+/**
+ * @brief 加入一个角速度样本 add one gyro sample
+ * @param[in] 角速度 rad/s gyro in rad/s
+ * @param[in] 样本时长 s sample period in s
+ */
+void Coning_Update(Coning_t *coning, const float gyro[3], float dt)
+{
+    float d[3], a[3];
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        d[i] = gyro[i] * dt;
+        a[i] = coning->Alpha[i] + coning->dThetaLast[i] * (1.0f / 6.0f);
+    }
+    coning->Beta[0] += 0.5f * (a[1] * d[2] - a[2] * d[1]);
+    coning->Beta[1] += 0.5f * (a[2] * d[0] - a[0] * d[2]);
+    coning->Beta[2] += 0.5f * (a[0] * d[1] - a[1] * d[0]);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        coning->Alpha[i] += d[i];
+        coning->dThetaLast[i] = d[i];
+    }
+    coning->dt += dt;
+    coning->Count++;
+}
+
+/**
+ * @brief 本周期的等效旋转矢量 rotation vector of this update
+ */
+void Coning_Get_Rotation(const Coning_t *coning, float phi[3])
+{
+    for (uint8_t i = 0; i < 3; i++)
+        phi[i] = coning->Alpha[i] + coning->Beta[i];
+}
+
+/**
+ * @brief  本周期的等效角速度 equivalent rate of this update
+ *         姿态解算以一阶 q += 1/2 q*(w dt) 再归一化积分, 转过的角度为 2 atan(|w| dt / 2);
+ *         取 |w| dt = 2 tan(|phi| / 2) 使其恰好转过 phi, 高速自旋时不再逐周期少转
+ *         the attitude filters integrate first order, q += 1/2 q*(w dt), then normalise, which
+ *         turns by 2 atan(|w| dt / 2); |w| dt = 2 tan(|phi| / 2) makes that exactly phi, so a
+ *         fast spin no longer falls behind every update
+ * @param[out] 等效角速度 rad/s equivalent rate in rad/s
+ * @retval 本周期时长 s, 没有样本时为 0 the update period in s, 0 without samples
+ */
+float Coning_Get_Rate(const Coning_t *coning, float rate[3])
+{
+    float phi[3], angle, scale;
+
+    Coning_Get_Rotation(coning, phi);
+    if (coning->dt <= 0)
+    {
+        rate[0] = rate[1] = rate[2] = 0;
+        return 0;
+    }
+    angle = sqrtf(phi[0] * phi[0] + phi[1] * phi[1] + phi[2] * phi[2]);
+    scale = angle > 1e-4f ? 2.0f * tanf(0.5f * angle) / angle : 1.0f;
+    scale /= coning->dt;
+    for (uint8_t i = 0; i < 3; i++)
+        rate[i] = phi[i] * scale;
+    return coning->dt;
+}
@@ -0,0 +1,38 @@
+/**
+ ******************************************************************************
+ * @file    ConingIntegrator.h
+ * @brief   角速度样本的圆锥补偿积分 coning compensated integration of gyro samples
+ *          一个姿态更新周期内有多个角速度样本时, 将其合成为该周期的等效旋转矢量
+ *          phi = alpha + beta (Savage 二子样递推形式), 再换算为可直接交给
+ *          Quaternion_AHRS_UpdateIMU()/IMU_QuaternionEKF_Update() 的等效角速度
+ *          with several gyro samples per attitude update, combines them into the
+ *          rotation vector of the update phi = alpha + beta (Savage's recursive
+ *          two-sample form), then into an equivalent rate that can be handed to
+ *          Quaternion_AHRS_UpdateIMU()/IMU_QuaternionEKF_Update() unchanged
+ ******************************************************************************
+ * @attention
+ *  样本视为各自采样周期内的平均角速度; 周期之间保留上一样本的角增量
+ *  samples are taken as the mean rate over their sample period; the angle increment
+ *  of the last sample is kept across updates
+ ******************************************************************************
+ */
+#ifndef _CONING_INTEGRATOR_H
+#define _CONING_INTEGRATOR_H
+
+#include "stdint.h"
+
+typedef struct
+{
+    float Alpha[3];      // 本周期角增量之和 sum of the angle increments of this update, rad
+    float Beta[3];       // 圆锥补偿项 coning correction, rad
+    float dThetaLast[3]; // 上一样本的角增量 angle increment of the last sample, rad
+    float dt;            // 本周期的样本时长之和 total sample time of this update, s
+    uint16_t Count;      // 本周期的样本数 samples in this update
+} Coning_t;
+
+void Coning_Reset(Coning_t *coning);
+void Coning_Update(Coning_t *coning, const float gyro[3], float dt);
+void Coning_Get_Rotation(const Coning_t *coning, float phi[3]);
+float Coning_Get_Rate(const Coning_t *coning, float rate[3]);
+
+#endif
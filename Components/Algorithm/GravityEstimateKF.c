@@ -1,6 +1,6 @@
 #include "GravityEstimateKF.h"
 
-KalmanFilter_t gEstimateKF;
+KalmanFilter3x3_t gEstimateKF;
 float gVec[3];
 
 float gEstimateKF_F[9] = {1, 0, 0,
@@ -20,7 +20,7 @@ const float gEstimateKF_H[9] = {1, 0, 0,
                                 0, 1, 0,
                                 0, 0, 1};
 
-static void gEstimateKF_Tuning(KalmanFilter_t *kf);
+static void gEstimateKF_Tuning(KalmanFilter3x3_t *kf);
 
 void gEstimateKF_Init(float process_noise, float measure_noise)
 {
@@ -30,7 +30,7 @@ void gEstimateKF_Init(float process_noise, float measure_noise)
         gEstimateKF_R[i] = measure_noise;
     }
 
-    Kalman_Filter_Init(&gEstimateKF, 3, 0, 3);
+    KalmanFilter3x3_Init(&gEstimateKF);
     gEstimateKF.User_Func0_f = gEstimateKF_Tuning;
     memcpy(gEstimateKF.F_data, gEstimateKF_F, sizeof(gEstimateKF_F));
     memcpy(gEstimateKF.P_data, gEstimateKF_P, sizeof(gEstimateKF_P));
@@ -60,7 +60,7 @@ void gEstimateKF_Update(float gx, float gy, float gz, float ax, float ay, float
     gEstimateKF.MeasuredVector[1] = ay;
     gEstimateKF.MeasuredVector[2] = az;
 
-    Kalman_Filter_Update(&gEstimateKF);
+    KalmanFilter3x3_Update(&gEstimateKF);
 
     for (uint8_t i = 0; i < 3; i++)
     {
@@ -77,7 +77,7 @@ void gEstimateKF_SetQR(float process_noise, float measure_noise)
     }
 }
 
-static void gEstimateKF_Tuning(KalmanFilter_t *kf)
+static void gEstimateKF_Tuning(KalmanFilter3x3_t *kf)
 {
     memcpy(gEstimateKF_F, kf->F_data, sizeof(gEstimateKF_F));
     memcpy(gEstimateKF_P, kf->P_data, sizeof(gEstimateKF_P));
@@ -1,6 +1,6 @@
 #ifndef _gEstimateKF_H
 #define _gEstimateKF_H
-#include "kalman_filter.h"
+#include "kalman_filter_static.h"
 
 /* boolean type definitions */
 #ifndef TRUE
@@ -1,8 +1,13 @@
 #include "QuaternionAHRS.h"
+#include "profiler.h"
 #include <math.h>
+#include <string.h>
 
 AHRS_t AHRS = {0};
-QuaternionBuf_t QuaternionBuffer;
+History_t QuaternionHistory;
+
+static float QuaternionHistory_Frame[Q_FRAME_LEN][4];
+static uint64_t QuaternionHistory_TimeStamp[Q_FRAME_LEN];
 
 volatile float twoKp = twoKpDef; // 2 * proportional gain (Kp)
 volatile float twoKi = twoKiDef; // 2 * integral gain (Ki)
@@ -145,6 +150,7 @@ void Quaternion_AHRS_UpdateIMU(float gx, float gy, float gz, float ax, float ay,
     static float halfvx, halfvy, halfvz;
     static float halfex, halfey, halfez;
     static float qa, qb, qc;
+    PROFILE_BEGIN(PROFILE_AHRS);
     // static float dt, last_time_stamp;
     // dt = (float)(time_stamp - last_time_stamp);
     // last_time_stamp = time_stamp;
@@ -215,6 +221,7 @@ void Quaternion_AHRS_UpdateIMU(float gx, float gy, float gz, float ax, float ay,
     AHRS.q[1] = q1;
     AHRS.q[2] = q2;
     AHRS.q[3] = q3;
+    PROFILE_END(PROFILE_AHRS);
 }
 
 /**
@@ -249,31 +256,12 @@ void Get_EulerAngle(float *q)
     Pitch_Angle_Last = AHRS.Pitch;
 }
 
-void InsertQuaternionFrame(QuaternionBuf_t *qBuf, float *q, float time_stamp)
+/**
+ * @brief          Quaternion history for time matching, slerp between frames
+ */
+void QuaternionHistory_Init(void)
 {
-    if (qBuf->LatestNum == Q_FRAME_LEN - 1)
-        qBuf->LatestNum = 0;
-    else
-        qBuf->LatestNum++;
-
-    qBuf->qFrame[qBuf->LatestNum].TimeStamp = time_stamp;
-    for (uint16_t i = 0; i < 4; i++)
-        qBuf->qFrame[qBuf->LatestNum].q[i] = q[i];
-}
-
-uint16_t FindTimeMatchFrame(QuaternionBuf_t *qBuf, float match_time_stamp)
-{
-    float min_time_error = fabsf(qBuf->qFrame[0].TimeStamp - match_time_stamp);
-    uint16_t num = 0;
-    for (uint16_t i = 0; i < Q_FRAME_LEN; i++)
-    {
-        if (fabsf(qBuf->qFrame[i].TimeStamp - match_time_stamp) < min_time_error)
-        {
-            min_time_error = fabsf(qBuf->qFrame[i].TimeStamp - match_time_stamp);
-            num = i;
-        }
-    }
-    return num;
+    History_Init_Static(&QuaternionHistory, QuaternionHistory_Frame, QuaternionHistory_TimeStamp, History_Slerp_Quaternion);
 }
 
 /**
@@ -322,9 +310,12 @@ static float invSqrt(float x)
 {
     float halfx = 0.5f * x;
     float y = x;
-    long i = *(long *)&y;
+    int32_t i;
+
+    // 以 memcpy 重解释位模式, 不违反严格别名规则 reinterpret the bits by memcpy, within strict aliasing
+    memcpy(&i, &y, sizeof(i));
     i = 0x5f375a86 - (i >> 1);
-    y = *(float *)&i;
+    memcpy(&y, &i, sizeof(y));
     y = y * (1.5f - (halfx * y * y));
     return y;
 }
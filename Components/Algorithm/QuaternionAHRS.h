@@ -2,6 +2,7 @@
 #define QUAT_AHRS_H
 
 #include "stdint.h"
+#include "state_history.h"
 
 // algorithm parameter ---------------------------------------------------------------
 #define twoKpDef (2.0f * 2.2f)   // 2 * proportional gain
@@ -24,30 +25,18 @@ typedef struct
     float PitchTotalAngle;
 } AHRS_t;
 
-typedef struct
-{
-    float q[4];
-    float TimeStamp;
-} QuaternionFrame_t;
-
 #define Q_FRAME_LEN 50
-typedef struct
-{
-    QuaternionFrame_t qFrame[Q_FRAME_LEN];
-    uint16_t LatestNum;
-} QuaternionBuf_t;
 
 extern volatile float twoKp;          // 2 * proportional gain (Kp)
 extern volatile float twoKi;          // 2 * integral gain (Ki)
 extern volatile float q0, q1, q2, q3; // quaternion of sensor frame relative to auxiliary frame
 extern AHRS_t AHRS;
-extern QuaternionBuf_t QuaternionBuffer;
+extern History_t QuaternionHistory;
 
 void Quaternion_AHRS_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt);
 void Quaternion_AHRS_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt);
 void Get_EulerAngle(float *q);
-void InsertQuaternionFrame(QuaternionBuf_t *qBuf, float *q, float time_stamp);
-uint16_t FindTimeMatchFrame(QuaternionBuf_t *qBuf, float match_time_stamp);
+void QuaternionHistory_Init(void);
 void BodyFrameToEarthFrame(float *vecBF, float *vecEF, float *q);
 void EarthFrameToBodyFrame(float *vecEF, float *vecBF, float *q);
 
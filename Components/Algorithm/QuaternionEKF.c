@@ -11,9 +11,21 @@
  *        1
  * —————————————————
  *  as² + 2√as + 1
+ *
+ * 状态 state x = [q0 q1 q2 q3 bx by], 分块 blocks:
+ *  F = | A  B |  A = I + W (4x4), W 为 1/2 (w - b) dt 的反对称阵 the skew matrix of 1/2 (w - b) dt
+ *      | 0  I |  B (4x2) 为四元数对零偏的耦合 the coupling of the quaternion to the bias
+ *  H = | Hq 0 |  Hq (3x4)
+ * 稀疏展开 sparsity expanded:
+ *  FP = F·P 只有前四行需要计算 only the first four rows need computing
+ *  P' = F·P·FT + Q: 四元数块 quaternion block FP·FT, 交叉块 cross block FP 的后两列 last two
+ *       columns of FP, 零偏块 bias block 不变 unchanged, Q 只加对角 Q only on the diagonal
+ *  H·P' 只用 P' 的前四行 uses the first four rows of P' only, S = H·P'·HT + R 对称 symmetric,
+ *  inv(S) 以伴随矩阵求得 from the adjugate, P = P' - K·H·P' 对称 symmetric
  ******************************************************************************
  */
 #include "QuaternionEKF.h"
+#include "profiler.h"
 
 QEKF_INS_t QEKF_INS;
 
@@ -33,10 +45,13 @@ float IMU_QuaternionEKF_K[18];
 float IMU_QuaternionEKF_H[18];
 
 static float invSqrt(float x);
-static void IMU_QuaternionEKF_Observe(KalmanFilter_t *kf);
-static void IMU_QuaternionEKF_User_Func1(KalmanFilter_t *kf);
-static void IMU_QuaternionEKF_SetH(KalmanFilter_t *kf);
-static void IMU_QuaternionEKF_xhatUpdate(KalmanFilter_t *kf);
+static void IMU_QuaternionEKF_Observe(KalmanFilter6x3_t *kf);
+static void IMU_QuaternionEKF_User_Func1(KalmanFilter6x3_t *kf);
+static void IMU_QuaternionEKF_SetH(KalmanFilter6x3_t *kf);
+static void IMU_QuaternionEKF_xhatUpdate(KalmanFilter6x3_t *kf);
+static void IMU_QuaternionEKF_Normalize(KalmanFilter6x3_t *kf);
+static void IMU_QuaternionEKF_Correct(KalmanFilter6x3_t *kf);
+static void IMU_QuaternionEKF_Closed_Form_Update(KalmanFilter6x3_t *kf);
 
 /**
  * @brief Quaternion EKF initialization
@@ -49,6 +64,7 @@ static void IMU_QuaternionEKF_xhatUpdate(KalmanFilter_t *kf);
 void IMU_QuaternionEKF_Init(float process_noise1, float process_noise2, float measure_noise, float lambda, float lpf)
 {
     QEKF_INS.Initialized = 1;
+    QEKF_INS.UseClosedForm = TRUE;
     QEKF_INS.Q1 = process_noise1;
     QEKF_INS.Q2 = process_noise2;
     QEKF_INS.R = measure_noise;
@@ -60,7 +76,7 @@ void IMU_QuaternionEKF_Init(float process_noise1, float process_noise2, float me
         lambda = 1;
     QEKF_INS.lambda = lambda;
     QEKF_INS.accLPFcoef = lpf;
-    Kalman_Filter_Init(&QEKF_INS.IMU_QuaternionEKF, 6, 0, 3);
+    KalmanFilter6x3_Init(&QEKF_INS.IMU_QuaternionEKF);
     QEKF_INS.IMU_QuaternionEKF.xhat_data[0] = 1;
     QEKF_INS.IMU_QuaternionEKF.xhat_data[1] = 0;
     QEKF_INS.IMU_QuaternionEKF.xhat_data[2] = 0;
@@ -85,17 +101,17 @@ void IMU_QuaternionEKF_Update(float gx, float gy, float gz, float ax, float ay,
 {
     static float halfgxdt, halfgydt, halfgzdt;
     static float accelInvNorm, dtSq, tempSqrt, tempVal1, tempVal2;
-    static float last_ax[2], last_ay[2], last_az[2];
+    float accel[3] = {ax, ay, az};
     if (!QEKF_INS.Initialized)
         IMU_QuaternionEKF_Init(10, 0.001, 1000000, 0.9996, 0.0001);
+    PROFILE_BEGIN(PROFILE_QEKF);
     if (QEKF_INS.UpdateCount == 0)
     {
-        last_ax[1] = ax;
-        last_ay[1] = ay;
-        last_az[1] = az;
-        last_ax[0] = ax;
-        last_ay[0] = ay;
-        last_az[0] = az;
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            QEKF_INS.AccelLPF[1][i] = accel[i];
+            QEKF_INS.AccelLPF[0][i] = accel[i];
+        }
     }
     /*
      0     1     2     3     4     5
@@ -111,42 +127,43 @@ void IMU_QuaternionEKF_Update(float gx, float gy, float gz, float ax, float ay,
     QEKF_INS.Gyro[1] = gy - QEKF_INS.GyroBias[1];
     QEKF_INS.Gyro[2] = gz - QEKF_INS.GyroBias[2];
 
-    // set F
-    halfgxdt = 0.5f * QEKF_INS.Gyro[0] * dt;
-    halfgydt = 0.5f * QEKF_INS.Gyro[1] * dt;
-    halfgzdt = 0.5f * QEKF_INS.Gyro[2] * dt;
-    memcpy(QEKF_INS.IMU_QuaternionEKF.F_data, IMU_QuaternionEKF_F, sizeof(IMU_QuaternionEKF_F));
-    QEKF_INS.IMU_QuaternionEKF.F_data[1] = -halfgxdt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[2] = -halfgydt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[3] = -halfgzdt;
-
-    QEKF_INS.IMU_QuaternionEKF.F_data[6] = halfgxdt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[8] = halfgzdt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[9] = -halfgydt;
-
-    QEKF_INS.IMU_QuaternionEKF.F_data[12] = halfgydt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[13] = -halfgzdt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[15] = halfgxdt;
-
-    QEKF_INS.IMU_QuaternionEKF.F_data[18] = halfgzdt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[19] = halfgydt;
-    QEKF_INS.IMU_QuaternionEKF.F_data[20] = -halfgxdt;
+    // set F, 稀疏展开时不需要 not needed when sparsity expanded
+    if (!QEKF_INS.UseClosedForm)
+    {
+        halfgxdt = 0.5f * QEKF_INS.Gyro[0] * dt;
+        halfgydt = 0.5f * QEKF_INS.Gyro[1] * dt;
+        halfgzdt = 0.5f * QEKF_INS.Gyro[2] * dt;
+        memcpy(QEKF_INS.IMU_QuaternionEKF.F_data, IMU_QuaternionEKF_F, sizeof(IMU_QuaternionEKF_F));
+        QEKF_INS.IMU_QuaternionEKF.F_data[1] = -halfgxdt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[2] = -halfgydt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[3] = -halfgzdt;
+
+        QEKF_INS.IMU_QuaternionEKF.F_data[6] = halfgxdt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[8] = halfgzdt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[9] = -halfgydt;
+
+        QEKF_INS.IMU_QuaternionEKF.F_data[12] = halfgydt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[13] = -halfgzdt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[15] = halfgxdt;
+
+        QEKF_INS.IMU_QuaternionEKF.F_data[18] = halfgzdt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[19] = halfgydt;
+        QEKF_INS.IMU_QuaternionEKF.F_data[20] = -halfgxdt;
+    }
 
     // accel low pass filter
     dtSq = QEKF_INS.dt * QEKF_INS.dt;
     tempSqrt = sqrtf(QEKF_INS.accLPFcoef);
     tempVal1 = QEKF_INS.accLPFcoef + 2 * QEKF_INS.dt * tempSqrt + dtSq;
     tempVal2 = QEKF_INS.accLPFcoef + QEKF_INS.dt * tempSqrt;
-    QEKF_INS.Accel[0] = ax * dtSq / tempVal1 + last_ax[0] * 2 * tempVal2 / tempVal1 - last_ax[1] * QEKF_INS.accLPFcoef / tempVal1;
-    QEKF_INS.Accel[1] = ay * dtSq / tempVal1 + last_ay[0] * 2 * tempVal2 / tempVal1 - last_ay[1] * QEKF_INS.accLPFcoef / tempVal1;
-    QEKF_INS.Accel[2] = az * dtSq / tempVal1 + last_az[0] * 2 * tempVal2 / tempVal1 - last_az[1] * QEKF_INS.accLPFcoef / tempVal1;
+    for (uint8_t i = 0; i < 3; i++)
+        QEKF_INS.Accel[i] = accel[i] * dtSq / tempVal1 + QEKF_INS.AccelLPF[0][i] * 2 * tempVal2 / tempVal1 - QEKF_INS.AccelLPF[1][i] * QEKF_INS.accLPFcoef / tempVal1;
     accelInvNorm = invSqrt(QEKF_INS.Accel[0] * QEKF_INS.Accel[0] + QEKF_INS.Accel[1] * QEKF_INS.Accel[1] + QEKF_INS.Accel[2] * QEKF_INS.Accel[2]);
-    last_ax[1] = last_ax[0];
-    last_ay[1] = last_ay[0];
-    last_az[1] = last_az[0];
-    last_ax[0] = QEKF_INS.Accel[0];
-    last_ay[0] = QEKF_INS.Accel[1];
-    last_az[0] = QEKF_INS.Accel[2];
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        QEKF_INS.AccelLPF[1][i] = QEKF_INS.AccelLPF[0][i];
+        QEKF_INS.AccelLPF[0][i] = QEKF_INS.Accel[i];
+    }
 
     // set z
     for (uint8_t i = 0; i < 3; i++)
@@ -173,7 +190,10 @@ void IMU_QuaternionEKF_Update(float gx, float gy, float gz, float ax, float ay,
     QEKF_INS.IMU_QuaternionEKF.R_data[4] = QEKF_INS.R;
     QEKF_INS.IMU_QuaternionEKF.R_data[8] = QEKF_INS.R;
 
-    Kalman_Filter_Update(&QEKF_INS.IMU_QuaternionEKF);
+    if (QEKF_INS.UseClosedForm)
+        IMU_QuaternionEKF_Closed_Form_Update(&QEKF_INS.IMU_QuaternionEKF);
+    else
+        KalmanFilter6x3_Update(&QEKF_INS.IMU_QuaternionEKF);
 
     QEKF_INS.q[0] = QEKF_INS.IMU_QuaternionEKF.FilteredValue[0];
     QEKF_INS.q[1] = QEKF_INS.IMU_QuaternionEKF.FilteredValue[1];
@@ -195,28 +215,19 @@ void IMU_QuaternionEKF_Update(float gx, float gy, float gz, float ax, float ay,
         QEKF_INS.YawRoundCount++;
     QEKF_INS.YawTotalAngle = 360.0f * QEKF_INS.YawRoundCount + QEKF_INS.Yaw;
     QEKF_INS.YawAngleLast = QEKF_INS.Yaw;
+    PROFILE_END(PROFILE_QEKF);
 }
 
-static void IMU_QuaternionEKF_User_Func1(KalmanFilter_t *kf)
+static void IMU_QuaternionEKF_User_Func1(KalmanFilter6x3_t *kf)
 {
     static float q0, q1, q2, q3;
-    static float qInvNorm;
 
     q0 = kf->xhatminus_data[0];
     q1 = kf->xhatminus_data[1];
     q2 = kf->xhatminus_data[2];
     q3 = kf->xhatminus_data[3];
 
-    // quaternion normalize
-    qInvNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-    for (uint8_t i = 0; i < 4; i++)
-    {
-        kf->xhatminus_data[i] *= qInvNorm;
-    }
-
-    // fading filter
-    kf->P_data[28] /= QEKF_INS.lambda;
-    kf->P_data[35] /= QEKF_INS.lambda;
+    IMU_QuaternionEKF_Normalize(kf);
     /*
      0     1     2     3     4     5
      6     7     8     9    10    11
@@ -239,7 +250,35 @@ static void IMU_QuaternionEKF_User_Func1(KalmanFilter_t *kf)
     kf->F_data[23] = -q1 * QEKF_INS.dt / 2;
 }
 
-static void IMU_QuaternionEKF_SetH(KalmanFilter_t *kf)
+/**
+ * @brief 先验四元数归一化与零偏方差渐消 normalise the predicted quaternion and fade the bias variance
+ */
+static void IMU_QuaternionEKF_Normalize(KalmanFilter6x3_t *kf)
+{
+    static float qInvNorm;
+
+    // quaternion normalize
+    qInvNorm = invSqrt(kf->xhatminus_data[0] * kf->xhatminus_data[0] + kf->xhatminus_data[1] * kf->xhatminus_data[1] +
+                       kf->xhatminus_data[2] * kf->xhatminus_data[2] + kf->xhatminus_data[3] * kf->xhatminus_data[3]);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        kf->xhatminus_data[i] *= qInvNorm;
+    }
+
+    // fading filter
+    kf->P_data[28] /= QEKF_INS.lambda;
+    kf->P_data[35] /= QEKF_INS.lambda;
+
+    // 限幅至初值, 卡方检验持续未通过时渐消因子会使其无限增长, 下一次通过的量测随之把零偏推到很远
+    // limit to the initial value: while the chi-square test keeps failing the fading factor grows
+    // it without bound, and the next accepted measurement then throws the bias far off
+    if (kf->P_data[28] > 10000)
+        kf->P_data[28] = 10000;
+    if (kf->P_data[35] > 10000)
+        kf->P_data[35] = 10000;
+}
+
+static void IMU_QuaternionEKF_SetH(KalmanFilter6x3_t *kf)
 {
     static float doubleq0, doubleq1, doubleq2, doubleq3;
     /*
@@ -253,7 +292,7 @@ static void IMU_QuaternionEKF_SetH(KalmanFilter_t *kf)
     doubleq1 = 2 * kf->xhatminus_data[1];
     doubleq2 = 2 * kf->xhatminus_data[2];
     doubleq3 = 2 * kf->xhatminus_data[3];
-    memset(kf->H_data, 0, sizeof_float * kf->zSize * kf->xhatSize);
+    memset(kf->H_data, 0, sizeof(kf->H_data));
 
     kf->H_data[0] = -doubleq2;
     kf->H_data[1] = doubleq3;
@@ -270,49 +309,43 @@ static void IMU_QuaternionEKF_SetH(KalmanFilter_t *kf)
     kf->H_data[14] = -doubleq2;
     kf->H_data[15] = doubleq3;
 }
-static void IMU_QuaternionEKF_xhatUpdate(KalmanFilter_t *kf)
+static void IMU_QuaternionEKF_xhatUpdate(KalmanFilter6x3_t *kf)
 {
-    static float q0, q1, q2, q3;
+    KF_Mat_Mult(kf->H_data, kf->Pminus_data, kf->HP_data, 3, 6, 6); // HP_data = H·P'(k)
+    KF_Mat_Mult_ABT(kf->HP_data, kf->H_data, kf->S_data, 3, 6, 3); // S_data = H·P'(k)·HT
+    for (uint8_t i = 0; i < 9; i++)
+        kf->S_data[i] += kf->R_data[i];                            // S = H P'(k) HT + R
+    kf->MatStatus = KF_Mat_Inverse(kf->S_data, kf->Sinv_data, 3); // Sinv_data = inv(H·P'(k)·HT + R)
+
+    IMU_QuaternionEKF_Correct(kf);
+}
 
-    kf->MatStatus = Matrix_Transpose(&kf->H, &kf->HT); // z|x => x|z
-    kf->temp_matrix.numRows = kf->H.numRows;
-    kf->temp_matrix.numCols = kf->Pminus.numCols;
-    kf->MatStatus = Matrix_Multiply(&kf->H, &kf->Pminus, &kf->temp_matrix); // temp_matrix = H·P'(k)
-    kf->temp_matrix1.numRows = kf->temp_matrix.numRows;
-    kf->temp_matrix1.numCols = kf->HT.numCols;
-    kf->MatStatus = Matrix_Multiply(&kf->temp_matrix, &kf->HT, &kf->temp_matrix1); // temp_matrix1 = H·P'(k)·HT
-    kf->S.numRows = kf->R.numRows;
-    kf->S.numCols = kf->R.numCols;
-    kf->MatStatus = Matrix_Add(&kf->temp_matrix1, &kf->R, &kf->S); // S = H P'(k) HT + R
-    kf->MatStatus = Matrix_Inverse(&kf->S, &kf->temp_matrix1);     // temp_matrix1 = inv(H·P'(k)·HT + R)
+/**
+ * @brief 卡方检验与后验状态 chi-square test and posterior state
+ *        需已算出 H·P'(k) 与 inv(S) needs H·P'(k) and inv(S); 未通过检验时 P(k) = P'(k) 并置 SkipEq5
+ *        on a failed test P(k) = P'(k) and SkipEq5 is set
+ */
+static void IMU_QuaternionEKF_Correct(KalmanFilter6x3_t *kf)
+{
+    static float q0, q1, q2, q3;
 
     q0 = kf->xhatminus_data[0];
     q1 = kf->xhatminus_data[1];
     q2 = kf->xhatminus_data[2];
     q3 = kf->xhatminus_data[3];
 
-    kf->temp_vector.numRows = kf->H.numRows;
-    kf->temp_vector.numCols = 1;
     kf->temp_vector_data[0] = 2 * (q1 * q3 - q0 * q2);
     kf->temp_vector_data[1] = 2 * (q0 * q1 + q2 * q3);
     kf->temp_vector_data[2] = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3; // temp_vector = h(xhat'(k))
 
-    kf->temp_vector1.numRows = kf->z.numRows;
-    kf->temp_vector1.numCols = 1;
-    kf->MatStatus = Matrix_Subtract(&kf->z, &kf->temp_vector, &kf->temp_vector1); // temp_vector1 = z(k) - h(xhat'(k))
+    for (uint8_t i = 0; i < 3; i++)
+        kf->temp_vector_data1[i] = kf->z_data[i] - kf->temp_vector_data[i]; // temp_vector1 = z(k) - h(xhat'(k))
 
     // chi-square test
-    kf->temp_matrix.numRows = kf->temp_vector1.numRows;
-    kf->temp_matrix.numCols = 1;
-    kf->MatStatus = Matrix_Multiply(&kf->temp_matrix1, &kf->temp_vector1, &kf->temp_matrix); // temp_matrix = inv(H·P'(k)·HT + R)·(z(k) - h(xhat'(k)))
-    kf->temp_vector.numRows = 1;
-    kf->temp_vector.numCols = kf->temp_vector1.numRows;
-    kf->MatStatus = Matrix_Transpose(&kf->temp_vector1, &kf->temp_vector); // temp_vector = z(k) - h(xhat'(k))'
-    kf->temp_matrix.numRows = 1;
-    kf->temp_matrix.numCols = 1;
-    kf->MatStatus = Matrix_Multiply(&kf->temp_vector, &kf->temp_vector1, &kf->temp_matrix);
-
-    QEKF_INS.ChiSquare = kf->temp_matrix.pData[0];
+    // 与原 arm_mat 实现一致, 检验量为残差平方和 (未乘 inv(S))
+    QEKF_INS.ChiSquare = kf->temp_vector_data1[0] * kf->temp_vector_data1[0] +
+                         kf->temp_vector_data1[1] * kf->temp_vector_data1[1] +
+                         kf->temp_vector_data1[2] * kf->temp_vector_data1[2];
     if (QEKF_INS.ChiSquare < 0.5f * QEKF_INS.ChiSquareTestThreshold)
         QEKF_INS.ConvergeFlag = 1;
 
@@ -334,8 +367,8 @@ static void IMU_QuaternionEKF_xhatUpdate(KalmanFilter_t *kf)
             //  残差未通过卡方检验 仅预测
             //  xhat(k) = xhat'(k)
             //  P(k) = P'(k)
-            memcpy(kf->xhat_data, kf->xhatminus_data, sizeof_float * kf->xhatSize);
-            memcpy(kf->P_data, kf->Pminus_data, sizeof_float * kf->xhatSize * kf->xhatSize);
+            memcpy(kf->xhat_data, kf->xhatminus_data, sizeof(kf->xhat_data));
+            memcpy(kf->P_data, kf->Pminus_data, sizeof(kf->P_data));
             kf->SkipEq5 = TRUE;
             return;
         }
@@ -355,36 +388,221 @@ static void IMU_QuaternionEKF_xhatUpdate(KalmanFilter_t *kf)
         kf->SkipEq5 = FALSE;
     }
 
-    kf->temp_matrix.numRows = kf->Pminus.numRows;
-    kf->temp_matrix.numCols = kf->HT.numCols;
-    kf->MatStatus = Matrix_Multiply(&kf->Pminus, &kf->HT, &kf->temp_matrix); // temp_matrix = P'(k)·HT
-    kf->MatStatus = Matrix_Multiply(&kf->temp_matrix, &kf->temp_matrix1, &kf->K);
+    KF_Mat_Mult_ATB(kf->HP_data, kf->Sinv_data, kf->K_data, 6, 3, 3); // K = P'(k)·HT·inv(S)
 
     // implement adaptive
-    for (uint8_t i = 0; i < kf->K.numRows * kf->K.numCols; i++)
+    for (uint8_t i = 0; i < 18; i++)
         kf->K_data[i] *= QEKF_INS.AdaptiveGainScale;
 
-    kf->temp_vector.numRows = kf->K.numRows;
-    kf->temp_vector.numCols = 1;
-    kf->MatStatus = Matrix_Multiply(&kf->K, &kf->temp_vector1, &kf->temp_vector); // temp_vector = K(k)·(z(k) - H·xhat'(k))
+    KF_Mat_Mult_Vec(kf->K_data, kf->temp_vector_data1, kf->temp_vector_data, 6, 3); // temp_vector = K(k)·(z(k) - H·xhat'(k))
     if (QEKF_INS.ConvergeFlag)
     {
-        if (kf->temp_vector.pData[4] > 1e-2f * QEKF_INS.dt)
-            kf->temp_vector.pData[4] = 1e-2f * QEKF_INS.dt;
-        if (kf->temp_vector.pData[4] < -1e-2f * QEKF_INS.dt)
-            kf->temp_vector.pData[4] = -1e-2f * QEKF_INS.dt;
-        if (kf->temp_vector.pData[5] > 1e-2f * QEKF_INS.dt)
-            kf->temp_vector.pData[5] = 1e-2f * QEKF_INS.dt;
-        if (kf->temp_vector.pData[5] < -1e-2f * QEKF_INS.dt)
-            kf->temp_vector.pData[5] = -1e-2f * QEKF_INS.dt;
+        if (kf->temp_vector_data[4] > 1e-2f * QEKF_INS.dt)
+            kf->temp_vector_data[4] = 1e-2f * QEKF_INS.dt;
+        if (kf->temp_vector_data[4] < -1e-2f * QEKF_INS.dt)
+            kf->temp_vector_data[4] = -1e-2f * QEKF_INS.dt;
+        if (kf->temp_vector_data[5] > 1e-2f * QEKF_INS.dt)
+            kf->temp_vector_data[5] = 1e-2f * QEKF_INS.dt;
+        if (kf->temp_vector_data[5] < -1e-2f * QEKF_INS.dt)
+            kf->temp_vector_data[5] = -1e-2f * QEKF_INS.dt;
+    }
+    QEKF_INS.BiasCompensation[0] = kf->temp_vector_data[4];
+    QEKF_INS.BiasCompensation[1] = kf->temp_vector_data[5];
+    // 加速度不含航向信息, 去掉修正量中绕世界系 z 轴转动的分量 d = (0,0,0,1)⊗q, 使修正不改变航向;
+    // 原先只将 q3 的修正置零, 仅在航向为 0 附近如此
+    // accel carries no heading, so remove the part of the correction that rotates about the world
+    // z axis, d = (0,0,0,1)⊗q, leaving the heading alone; zeroing the q3 correction, as before,
+    // only does that near zero heading
+    {
+        float d[4] = {-q3, -q2, q1, q0}, dot = 0;
+
+        for (uint8_t i = 0; i < 4; i++)
+            dot += kf->temp_vector_data[i] * d[i];
+        for (uint8_t i = 0; i < 4; i++)
+            kf->temp_vector_data[i] -= dot * d[i];
+    }
+    for (uint8_t i = 0; i < 6; i++)
+        kf->xhat_data[i] = kf->xhatminus_data[i] + kf->temp_vector_data[i];
+}
+
+/**
+ * @brief 按 F/H 的稀疏结构展开的一次滤波, 取代 KalmanFilter6x3_Update() 与 F 的构造
+ *        步骤与用户函数的顺序与通用路径相同, 结果仅有浮点舍入上的差别; 要求 Q, R 为对角阵
+ *        one filter step expanded over the sparsity of F and H, replacing KalmanFilter6x3_Update()
+ *        and the construction of F; same steps and user function order as the generic path, so
+ *        results differ by float rounding only; Q and R must be diagonal
+ */
+static KF_STATIC_OPTIMIZE void IMU_QuaternionEKF_Closed_Form_Update(KalmanFilter6x3_t *kf)
+{
+    float h[3], W[4][4], B[4][2], FP[4][6], q[4], det;
+    float *x = kf->xhat_data, *xm = kf->xhatminus_data;
+    float *P = kf->P_data, *Pm = kf->Pminus_data, *H = kf->H_data, *HP = kf->HP_data, *S = kf->S_data;
+
+    memcpy(kf->z_data, kf->MeasuredVector, sizeof(kf->z_data));
+    memset(kf->MeasuredVector, 0, sizeof(kf->MeasuredVector));
+    IMU_QuaternionEKF_Observe(kf);
+
+    // W = A - I
+    for (uint8_t i = 0; i < 3; i++)
+        h[i] = 0.5f * QEKF_INS.Gyro[i] * QEKF_INS.dt;
+    W[0][0] = 0, W[0][1] = -h[0], W[0][2] = -h[1], W[0][3] = -h[2];
+    W[1][0] = h[0], W[1][1] = 0, W[1][2] = h[2], W[1][3] = -h[1];
+    W[2][0] = h[1], W[2][1] = -h[2], W[2][2] = 0, W[2][3] = h[0];
+    W[3][0] = h[2], W[3][1] = h[1], W[3][2] = -h[0], W[3][3] = 0;
+
+    // 1. xhat'(k) = F·xhat(k-1), 此时 F 的耦合块为 0 (与通用路径一致) the coupling block is 0 here, as in the generic path
+    KF_STATIC_UNROLL
+    for (int i = 0; i < 4; i++)
+    {
+        float sum = x[i];
+        KF_STATIC_UNROLL
+        for (int k = 0; k < 4; k++)
+            if (k != i)
+                sum += W[i][k] * x[k];
+        xm[i] = sum;
+        q[i] = sum;
+    }
+    xm[4] = x[4];
+    xm[5] = x[5];
+
+    IMU_QuaternionEKF_Normalize(kf);
+
+    // 耦合块取归一化前的先验四元数, 同 IMU_QuaternionEKF_User_Func1() taken from the predicted quaternion before normalising
+    B[0][0] = q[1] * QEKF_INS.dt / 2, B[0][1] = q[2] * QEKF_INS.dt / 2;
+    B[1][0] = -q[0] * QEKF_INS.dt / 2, B[1][1] = q[3] * QEKF_INS.dt / 2;
+    B[2][0] = -q[3] * QEKF_INS.dt / 2, B[2][1] = -q[0] * QEKF_INS.dt / 2;
+    B[3][0] = q[2] * QEKF_INS.dt / 2, B[3][1] = -q[1] * QEKF_INS.dt / 2;
+
+    // 2. P'(k) = F·P(k-1)·FT + Q
+    // FP 的前四行 first four rows of F·P: P + W·Pq + B·Pb
+    KF_STATIC_UNROLL
+    for (int i = 0; i < 4; i++)
+    {
+        KF_STATIC_UNROLL
+        for (int j = 0; j < 6; j++)
+        {
+            float sum = P[i * 6 + j] + B[i][0] * P[24 + j] + B[i][1] * P[30 + j];
+            KF_STATIC_UNROLL
+            for (int k = 0; k < 4; k++)
+                if (k != i)
+                    sum += W[i][k] * P[k * 6 + j];
+            FP[i][j] = sum;
+        }
+    }
+    // 四元数块 quaternion block FP·FT, 只算上三角 upper triangle only
+    KF_STATIC_UNROLL
+    for (int i = 0; i < 4; i++)
+    {
+        KF_STATIC_UNROLL
+        for (int j = i; j < 4; j++)
+        {
+            float sum = FP[i][j] + FP[i][4] * B[j][0] + FP[i][5] * B[j][1];
+            KF_STATIC_UNROLL
+            for (int k = 0; k < 4; k++)
+                if (k != j)
+                    sum += FP[i][k] * W[j][k];
+            Pm[i * 6 + j] = sum;
+            Pm[j * 6 + i] = sum;
+        }
+        // 交叉块 cross block
+        Pm[i * 6 + 4] = Pm[24 + i] = FP[i][4];
+        Pm[i * 6 + 5] = Pm[30 + i] = FP[i][5];
+    }
+    // 零偏块 bias block
+    Pm[28] = P[28];
+    Pm[29] = Pm[34] = P[29];
+    Pm[35] = P[35];
+    KF_STATIC_UNROLL
+    for (int i = 0; i < 6; i++)
+        Pm[i * 7] += kf->Q_data[i * 7];
+
+    IMU_QuaternionEKF_SetH(kf);
+
+    // 3. H·P'(k) 与 S, H 的后两列为 0 the last two columns of H are 0
+    KF_STATIC_UNROLL
+    for (int r = 0; r < 3; r++)
+    {
+        KF_STATIC_UNROLL
+        for (int j = 0; j < 6; j++)
+        {
+            float sum = 0;
+            KF_STATIC_UNROLL
+            for (int k = 0; k < 4; k++)
+                sum += H[r * 6 + k] * Pm[k * 6 + j];
+            HP[r * 6 + j] = sum;
+        }
+        KF_STATIC_UNROLL
+        for (int s = r; s < 3; s++)
+        {
+            float sum = 0;
+            KF_STATIC_UNROLL
+            for (int k = 0; k < 4; k++)
+                sum += HP[r * 6 + k] * H[s * 6 + k];
+            S[r * 3 + s] = sum;
+            S[s * 3 + r] = sum;
+        }
+        S[r * 4] += kf->R_data[r * 4];
     }
-    QEKF_INS.BiasCompensation[0] = kf->temp_vector.pData[4];
-    QEKF_INS.BiasCompensation[1] = kf->temp_vector.pData[5];
-    kf->temp_vector.pData[3] = 0;
-    kf->MatStatus = Matrix_Add(&kf->xhatminus, &kf->temp_vector, &kf->xhat);
+
+    // inv(S) = adj(S) / det(S), S 对称 symmetric
+    kf->Sinv_data[0] = S[4] * S[8] - S[5] * S[5];
+    kf->Sinv_data[1] = S[2] * S[5] - S[1] * S[8];
+    kf->Sinv_data[2] = S[1] * S[5] - S[2] * S[4];
+    kf->Sinv_data[4] = S[0] * S[8] - S[2] * S[2];
+    kf->Sinv_data[5] = S[1] * S[2] - S[0] * S[5];
+    kf->Sinv_data[8] = S[0] * S[4] - S[1] * S[1];
+    det = S[0] * kf->Sinv_data[0] + S[1] * kf->Sinv_data[1] + S[2] * kf->Sinv_data[2];
+    if (det != 0.0f)
+    {
+        kf->MatStatus = KF_STATIC_SUCCESS;
+        det = 1.0f / det;
+    }
+    else
+        kf->MatStatus = KF_STATIC_SINGULAR; // K = 0, 本次仅预测 predict only
+    kf->Sinv_data[0] *= det;
+    kf->Sinv_data[1] *= det;
+    kf->Sinv_data[2] *= det;
+    kf->Sinv_data[4] *= det;
+    kf->Sinv_data[5] *= det;
+    kf->Sinv_data[8] *= det;
+    kf->Sinv_data[3] = kf->Sinv_data[1];
+    kf->Sinv_data[6] = kf->Sinv_data[2];
+    kf->Sinv_data[7] = kf->Sinv_data[5];
+
+    // 4. 卡方检验, K 与 xhat(k) chi-square test, K and xhat(k)
+    IMU_QuaternionEKF_Correct(kf);
+
+    // 5. P(k) = P'(k) - K(k)·H·P'(k), K·H·P' = HPT·inv(S)·HP 对称 symmetric
+    if (!kf->SkipEq5)
+    {
+        KF_STATIC_UNROLL
+        for (int i = 0; i < 6; i++)
+        {
+            KF_STATIC_UNROLL
+            for (int j = i; j < 6; j++)
+            {
+                float sum = Pm[i * 6 + j];
+                KF_STATIC_UNROLL
+                for (int r = 0; r < 3; r++)
+                    sum -= kf->K_data[i * 3 + r] * HP[r * 6 + j];
+                P[i * 6 + j] = sum;
+                P[j * 6 + i] = sum;
+            }
+        }
+    }
+
+    // suppress filter excessive convergence
+    KF_STATIC_UNROLL
+    for (int i = 0; i < 6; i++)
+    {
+        if (P[i * 7] < kf->StateMinVariance[i])
+            P[i * 7] = kf->StateMinVariance[i];
+    }
+
+    memcpy(kf->FilteredValue, kf->xhat_data, sizeof(kf->FilteredValue));
 }
 
-static void IMU_QuaternionEKF_Observe(KalmanFilter_t *kf)
+static void IMU_QuaternionEKF_Observe(KalmanFilter6x3_t *kf)
 {
     memcpy(IMU_QuaternionEKF_P, kf->P_data, sizeof(IMU_QuaternionEKF_P));
     memcpy(IMU_QuaternionEKF_K, kf->K_data, sizeof(IMU_QuaternionEKF_K));
@@ -395,9 +613,12 @@ static float invSqrt(float x)
 {
     float halfx = 0.5f * x;
     float y = x;
-    long i = *(long *)&y;
+    int32_t i;
+
+    // 以 memcpy 重解释位模式, 不违反严格别名规则 reinterpret the bits by memcpy, within strict aliasing
+    memcpy(&i, &y, sizeof(i));
     i = 0x5f375a86 - (i >> 1);
-    y = *(float *)&i;
+    memcpy(&y, &i, sizeof(y));
     y = y * (1.5f - (halfx * y * y));
     return y;
 }
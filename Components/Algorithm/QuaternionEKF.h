@@ -7,12 +7,16 @@
  * @brief   attitude update with gyro bias estimate and chi-square test
  ******************************************************************************
  * @attention
- *
+ *  UseClosedForm 置 1 (默认) 时, 一次更新由按 F/H 稀疏结构手工展开的运算完成, 不再构造 F,
+ *  也不调用 KalmanFilter6x3_Update(); 置 0 时走原有的通用矩阵路径, 作为对照
+ *  with UseClosedForm set (the default) an update runs hand-expanded over the sparsity of
+ *  F and H, without building F or calling KalmanFilter6x3_Update(); cleared, it takes the
+ *  original generic matrix path, kept as the reference
  ******************************************************************************
  */
 #ifndef _QUAT_EKF_H
 #define _QUAT_EKF_H
-#include "kalman filter.h"
+#include "kalman_filter_static.h"
 
 /* boolean type definitions */
 #ifndef TRUE
@@ -26,7 +30,8 @@
 typedef struct
 {
     uint8_t Initialized;
-    KalmanFilter_t IMU_QuaternionEKF;
+    uint8_t UseClosedForm; // 稀疏展开的更新 sparsity-expanded update
+    KalmanFilter6x3_t IMU_QuaternionEKF;
     uint8_t ConvergeFlag;
     uint8_t StableFlag;
     uint64_t ErrorCount;
@@ -39,6 +44,7 @@ typedef struct
     float Accel[3];
 
     float accLPFcoef;
+    float AccelLPF[2][3]; // 加速度低通的前两次输出 last two outputs of the accel low pass
     float gyro_norm;
     float accl_norm;
     float AdaptiveGainScale;
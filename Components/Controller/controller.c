@@ -1,4 +1,6 @@
 #include "controller.h"
+#include "profiler.h"
+#include <float.h>
 
 /******************************** FUZZY PID **********************************/
 // static float FuzzyRuleKpRAW[7][7] = {
@@ -128,7 +130,7 @@ void Fuzzy_Rule_Implementation(FuzzyRule_t *fuzzyRule, float measure, float ref)
 // PID??????????????
 static void f_Trapezoid_Intergral(PID_t *pid);
 static void f_Integral_Limit(PID_t *pid);
-static void f_Derivative_On_Measurement(PID_t *pid);
+static void f_Derivative_On_Measurement(PID_t *pid, float inv_dt);
 static void f_Changing_Integration_Rate(PID_t *pid);
 static void f_Output_Filter(PID_t *pid);
 static void f_Derivative_Filter(PID_t *pid);
@@ -209,10 +211,22 @@ void PID_Init(
  */
 float PID_Calculate(PID_t *pid, float measure, float ref)
 {
+    return PID_Calculate_Tick(pid, NULL, measure, ref);
+}
+
+float PID_Calculate_Tick(PID_t *pid, const DWT_Tick_t *tick, float measure, float ref)
+{
+    DWT_Tick_t self;
+    float inv_dt;
+
+    PROFILE_BEGIN(PROFILE_PID);
+
     if (pid->Improve & ErrorHandle)
         f_PID_ErrorHandle(pid);
 
-    pid->dt = DWT_GetDeltaT((void *)&pid->DWT_CNT);
+    tick = DWT_Tick_Or_Self(tick, &self, &pid->DWT_CNT);
+    pid->dt = tick->dt;
+    inv_dt = tick->inv_dt;
 
     pid->Measure = measure;
     pid->Ref = ref;
@@ -234,7 +248,7 @@ float PID_Calculate(PID_t *pid, float measure, float ref)
             // if (pid->OLS_Order > 2)
             //     pid->Dout = pid->Kd * OLS_Derivative(&pid->OLS, pid->dt, pid->Err);
             // else
-            pid->Dout = pid->Kd * (pid->Err - pid->Last_Err) / pid->dt;
+            pid->Dout = pid->Kd * (pid->Err - pid->Last_Err) * inv_dt;
         }
         else
         {
@@ -243,7 +257,7 @@ float PID_Calculate(PID_t *pid, float measure, float ref)
             // if (pid->OLS_Order > 2)
             //     pid->Dout = (pid->Kd + pid->FuzzyRule->KdFuzzy) * OLS_Derivative(&pid->OLS, pid->dt, pid->Err);
             // else
-            pid->Dout = (pid->Kd + pid->FuzzyRule->KdFuzzy) * (pid->Err - pid->Last_Err) / pid->dt;
+            pid->Dout = (pid->Kd + pid->FuzzyRule->KdFuzzy) * (pid->Err - pid->Last_Err) * inv_dt;
         }
 
         if (pid->User_Func2_f != NULL)
@@ -257,7 +271,7 @@ float PID_Calculate(PID_t *pid, float measure, float ref)
             f_Changing_Integration_Rate(pid);
         // ???????
         if (pid->Improve & Derivative_On_Measurement)
-            f_Derivative_On_Measurement(pid);
+            f_Derivative_On_Measurement(pid, inv_dt);
         // ????????
         if (pid->Improve & DerivativeFilter)
             f_Derivative_Filter(pid);
@@ -296,6 +310,7 @@ float PID_Calculate(PID_t *pid, float measure, float ref)
     pid->Last_Err = pid->Err;
     pid->Last_ITerm = pid->ITerm;
 
+    PROFILE_END(PROFILE_PID);
     return pid->Output;
 }
 static void f_Trapezoid_Intergral(PID_t *pid)
@@ -348,21 +363,21 @@ static void f_Integral_Limit(PID_t *pid)
     }
 }
 
-static void f_Derivative_On_Measurement(PID_t *pid)
+static void f_Derivative_On_Measurement(PID_t *pid, float inv_dt)
 {
     if (pid->FuzzyRule == NULL)
     {
         // if (pid->OLS_Order > 2)
         //     pid->Dout = pid->Kd * OLS_Derivative(&pid->OLS, pid->dt, -pid->Measure);
         // else
-        pid->Dout = pid->Kd * (pid->Last_Measure - pid->Measure) / pid->dt;
+        pid->Dout = pid->Kd * (pid->Last_Measure - pid->Measure) * inv_dt;
     }
     else
     {
         // if (pid->OLS_Order > 2)
         //     pid->Dout = (pid->Kd + pid->FuzzyRule->KdFuzzy) * OLS_Derivative(&pid->OLS, pid->dt, -pid->Measure);
         // else
-        pid->Dout = (pid->Kd + pid->FuzzyRule->KdFuzzy) * (pid->Last_Measure - pid->Measure) / pid->dt;
+        pid->Dout = (pid->Kd + pid->FuzzyRule->KdFuzzy) * (pid->Last_Measure - pid->Measure) * inv_dt;
     }
 }
 
@@ -426,6 +441,170 @@ static void f_PID_ErrorHandle(PID_t *pid)
     }
 }
 
+/**************************** BATCHED PID CONTROL ******************************/
+// 条件为真时全 1 all ones when the condition holds
+#define PID_BATCH_MASK(cond) (-(uint32_t)((cond) != 0))
+
+// 按掩码逐位选择 a 或 b; 用整数位运算而非 ?:, 编译器不会把浮点运算或读内存挪进分支, 循环可整体向量化
+// picks a or b bit by bit by the mask; integer bit operations instead of ?: keep the compiler from
+// moving float operations or loads into branches, so the whole loop vectorises
+static inline float PID_Batch_Select(uint32_t mask, float a, float b)
+{
+    uint32_t ua, ub;
+
+    memcpy(&ua, &a, sizeof(float));
+    memcpy(&ub, &b, sizeof(float));
+    ua = (ua & mask) | (ub & ~mask);
+    memcpy(&a, &ua, sizeof(float));
+    return a;
+}
+
+// 与 isnormal() 判断相同, 非正规数 (含 0/inf/nan) 取 0 same test as isnormal(), anything not normal (0/inf/nan included) becomes 0
+static inline float PID_Batch_Normal(float x)
+{
+    float a = fabsf(x);
+    return PID_Batch_Select(PID_BATCH_MASK((a >= FLT_MIN) & (a <= FLT_MAX)), x, 0.0f);
+}
+
+void PID_Batch_Init(
+    PID_Batch_t *pid,
+    uint8_t n,
+    float max_out,
+    float intergral_limit,
+    float deadband,
+
+    float kp,
+    float ki,
+    float kd,
+
+    float output_lpf_rc,
+    float derivative_lpf_rc,
+
+    uint8_t improve)
+{
+    memset(pid, 0, sizeof(PID_Batch_t));
+
+    pid->N = n < PID_BATCH_MAX ? n : PID_BATCH_MAX;
+    pid->MaxOut = max_out;
+    pid->IntegralLimit = intergral_limit;
+    pid->DeadBand = deadband;
+
+    pid->Kp = kp;
+    pid->Ki = ki;
+    pid->Kd = kd;
+
+    pid->Output_LPF_RC = output_lpf_rc;
+    pid->Derivative_LPF_RC = derivative_lpf_rc;
+
+    pid->Improve = improve & PID_BATCH_IMPROVE;
+}
+
+/**
+ * @brief          成批 PID 计算, 各步与 PID_Calculate() 的运算顺序相同, 逐位一致
+ *                 batched PID, every step in the same order as PID_Calculate(), so the results are bit for bit equal
+ * @param[in]      成批 PID 结构体 batched PID structure
+ * @param[in]      N 路测量值 N measured values
+ * @param[in]      N 路期望值 N references
+ */
+void PID_Batch_Calculate(PID_Batch_t *pid, const float *measure, const float *ref)
+{
+    PID_Batch_Calculate_Tick(pid, NULL, measure, ref);
+}
+
+void PID_Batch_Calculate_Tick(PID_Batch_t *pid, const DWT_Tick_t *tick, const float *measure, const float *ref)
+{
+    // 功能位在循环外取出, 循环内只有条件选择 the feature bits are read outside the loop, inside there are only selects
+    const uint32_t trapezoid = PID_BATCH_MASK(pid->Improve & Trapezoid_Intergral);
+    const uint32_t on_measurement = PID_BATCH_MASK(pid->Improve & Derivative_On_Measurement);
+    const uint32_t derivative_filter = PID_BATCH_MASK(pid->Improve & DerivativeFilter);
+    const uint32_t integral_limit = PID_BATCH_MASK(pid->Improve & Integral_Limit);
+    const uint32_t output_filter = PID_BATCH_MASK(pid->Improve & OutputFilter);
+    const float kp = pid->Kp, ki = pid->Ki, kd = pid->Kd;
+    const float max_out = pid->MaxOut, i_limit = pid->IntegralLimit, deadband = pid->DeadBand;
+    const float o_rc = pid->Output_LPF_RC, d_rc = pid->Derivative_LPF_RC;
+    float in_measure[PID_BATCH_MAX] = {0}, in_ref[PID_BATCH_MAX] = {0};
+    float dt, inv_dt;
+    DWT_Tick_t self;
+
+    PROFILE_BEGIN(PROFILE_PID_BATCH);
+
+    tick = DWT_Tick_Or_Self(tick, &self, &pid->DWT_CNT);
+    dt = pid->dt = tick->dt;
+    inv_dt = tick->inv_dt;
+
+    // 输入先拷入局部数组, 循环固定为 PID_BATCH_MAX 路, 编译器无需检查别名或处理余数;
+    // 多出的路输入为 0, 误差不超过死区, 状态不变
+    // the inputs are copied to local arrays and the loop always runs PID_BATCH_MAX channels, so the
+    // compiler needs no alias checks or remainder loop; spare channels get 0, never leave the deadband
+    // and keep their state
+    for (uint8_t i = 0; i < pid->N; i++)
+    {
+        in_measure[i] = measure[i];
+        in_ref[i] = ref[i];
+    }
+
+    for (uint8_t i = 0; i < PID_BATCH_MAX; i++)
+    {
+        float m = PID_Batch_Normal(in_measure[i]);
+        float r = PID_Batch_Normal(in_ref[i]);
+        float err = r - m;
+        uint32_t active = PID_BATCH_MASK(fabsf(err) > deadband);
+        float pout, iterm, dout, iout, output, filtered, temp_iout, temp_output;
+        uint32_t saturated, above, below;
+
+        // 各功能的两种算法都算出再选择 both variants of every feature are computed, then one is selected
+        pout = kp * err;
+        iterm = ki * err * dt;
+        filtered = ki * ((err + pid->Last_Err[i]) / 2) * dt;
+        iterm = PID_Batch_Select(trapezoid, filtered, iterm);
+        dout = kd * (err - pid->Last_Err[i]) * inv_dt;
+        filtered = kd * (pid->Last_Measure[i] - m) * inv_dt;
+        dout = PID_Batch_Select(on_measurement, filtered, dout);
+        filtered = dout * dt / (d_rc + dt) + pid->Last_Dout[i] * d_rc / (d_rc + dt);
+        dout = PID_Batch_Select(derivative_filter, filtered, dout);
+
+        iout = pid->Iout[i];
+        temp_iout = iout + iterm;
+        temp_output = pout + iout + dout;
+        saturated = integral_limit & PID_BATCH_MASK((fabsf(temp_output) > max_out) & (err * iout > 0));
+        above = integral_limit & PID_BATCH_MASK(temp_iout > i_limit);
+        below = integral_limit & PID_BATCH_MASK(temp_iout < -i_limit);
+        iterm = PID_Batch_Select(saturated | above | below, 0.0f, iterm);
+        iout = PID_Batch_Select(above, i_limit, iout);
+        iout = PID_Batch_Select(below, -i_limit, iout);
+
+        iterm = PID_Batch_Normal(iterm);
+        iout = PID_Batch_Normal(iout + iterm);
+        pout = PID_Batch_Normal(pout);
+        dout = PID_Batch_Normal(dout);
+
+        output = pout + iout + dout;
+        filtered = output * dt / (o_rc + dt) + pid->Last_Output[i] * o_rc / (o_rc + dt);
+        output = PID_Batch_Select(output_filter, filtered, output);
+        output = PID_Batch_Select(PID_BATCH_MASK(output > max_out), max_out, output);
+        output = PID_Batch_Select(PID_BATCH_MASK(output < -max_out), -max_out, output);
+        pout = PID_Batch_Select(PID_BATCH_MASK(pout > max_out), max_out, pout);
+        pout = PID_Batch_Select(PID_BATCH_MASK(pout < -max_out), -max_out, pout);
+
+        // 死区内保持上一周期的输出 inside the deadband the last outputs are kept
+        pid->Pout[i] = PID_Batch_Select(active, pout, pid->Pout[i]);
+        pid->Iout[i] = PID_Batch_Select(active, iout, pid->Iout[i]);
+        pid->Dout[i] = PID_Batch_Select(active, dout, pid->Dout[i]);
+        pid->ITerm[i] = PID_Batch_Select(active, iterm, pid->ITerm[i]);
+        pid->Output[i] = PID_Batch_Select(active, output, pid->Output[i]);
+
+        pid->Measure[i] = m;
+        pid->Ref[i] = r;
+        pid->Err[i] = err;
+        pid->Last_Measure[i] = m;
+        pid->Last_Err[i] = err;
+        pid->Last_Output[i] = pid->Output[i];
+        pid->Last_Dout[i] = pid->Dout[i];
+    }
+
+    PROFILE_END(PROFILE_PID_BATCH);
+}
+
 /*************************** FEEDFORWARD CONTROL *****************************/
 /**
  * @brief          ???????????
@@ -484,7 +663,15 @@ void Feedforward_Init(
  */
 float Feedforward_Calculate(Feedforward_t *ffc, float ref)
 {
-    ffc->dt = DWT_GetDeltaT((void *)&ffc->DWT_CNT);
+    return Feedforward_Calculate_Tick(ffc, NULL, ref);
+}
+
+float Feedforward_Calculate_Tick(Feedforward_t *ffc, const DWT_Tick_t *tick, float ref)
+{
+    DWT_Tick_t self;
+
+    tick = DWT_Tick_Or_Self(tick, &self, &ffc->DWT_CNT);
+    ffc->dt = tick->dt;
 
     ffc->Ref = ref * ffc->dt / (ffc->LPF_RC + ffc->dt) +
                ffc->Ref * ffc->LPF_RC / (ffc->LPF_RC + ffc->dt);
@@ -496,7 +683,7 @@ float Feedforward_Calculate(Feedforward_t *ffc, float ref)
     // if (ffc->Ref_dot_OLS_Order > 2)
     //     ffc->Ref_dot = OLS_Derivative(&ffc->Ref_dot_OLS, ffc->dt, ffc->Ref);
     // else
-    ffc->Ref_dot = (ffc->Ref - ffc->Last_Ref) / ffc->dt;
+    ffc->Ref_dot = (ffc->Ref - ffc->Last_Ref) * tick->inv_dt;
 
     if (!isnormal(ffc->Ref_dot))
         ffc->Ref_dot = 0;
@@ -506,7 +693,7 @@ float Feedforward_Calculate(Feedforward_t *ffc, float ref)
     // if (ffc->Ref_ddot_OLS_Order > 2)
     //     ffc->Ref_ddot = OLS_Derivative(&ffc->Ref_ddot_OLS, ffc->dt, ffc->Ref_dot);
     // else
-    ffc->Ref_ddot = (ffc->Ref_dot - ffc->Last_Ref_dot) / ffc->dt;
+    ffc->Ref_ddot = (ffc->Ref_dot - ffc->Last_Ref_dot) * tick->inv_dt;
 
     if (!isnormal(ffc->Ref_ddot))
         ffc->Ref_ddot = 0;
@@ -576,7 +763,15 @@ void LDOB_Init(
 
 float LDOB_Calculate(LDOB_t *ldob, float measure, float u)
 {
-    ldob->dt = DWT_GetDeltaT((void *)&ldob->DWT_CNT);
+    return LDOB_Calculate_Tick(ldob, NULL, measure, u);
+}
+
+float LDOB_Calculate_Tick(LDOB_t *ldob, const DWT_Tick_t *tick, float measure, float u)
+{
+    DWT_Tick_t self;
+
+    tick = DWT_Tick_Or_Self(tick, &self, &ldob->DWT_CNT);
+    ldob->dt = tick->dt;
 
     ldob->Measure = measure;
 
@@ -587,14 +782,14 @@ float LDOB_Calculate(LDOB_t *ldob, float measure, float u)
     // if (ldob->Measure_dot_OLS_Order > 2)
     //     ldob->Measure_dot = OLS_Derivative(&ldob->Measure_dot_OLS, ldob->dt, ldob->Measure);
     // else
-    ldob->Measure_dot = (ldob->Measure - ldob->Last_Measure) / ldob->dt;
+    ldob->Measure_dot = (ldob->Measure - ldob->Last_Measure) * tick->inv_dt;
 
     // ??????????
     // calculate second derivative
     // if (ldob->Measure_ddot_OLS_Order > 2)
     //     ldob->Measure_ddot = OLS_Derivative(&ldob->Measure_ddot_OLS, ldob->dt, ldob->Measure_dot);
     // else
-    ldob->Measure_ddot = (ldob->Measure_dot - ldob->Last_Measure_dot) / ldob->dt;
+    ldob->Measure_ddot = (ldob->Measure_dot - ldob->Last_Measure_dot) * tick->inv_dt;
 
     // ?????????
     // estimate external disturbances and internal disturbances caused by model uncertainties
@@ -631,10 +826,16 @@ void TD_Init(TD_t *td, float r, float h0)
     td->last_ddx = 0;
 }
 float TD_Calculate(TD_t *td, float input)
+{
+    return TD_Calculate_Tick(td, NULL, input);
+}
+
+float TD_Calculate_Tick(TD_t *td, const DWT_Tick_t *tick, float input)
 {
     static float d, a0, y, a1, a2, a, fhan;
+    DWT_Tick_t self;
 
-    td->dt = DWT_GetDeltaT((void *)&td->DWT_CNT);
+    td->dt = DWT_Tick_Or_Self(tick, &self, &td->DWT_CNT)->dt;
 
     if (td->dt > 0.5f)
         return 0;
@@ -675,7 +876,14 @@ void ThirdOrder_TD_Init(ThirdOrderTD_t *td, float omega)
 
 float ThirdOrder_TD_Calculate(ThirdOrderTD_t *td, float input)
 {
-    td->dt = DWT_GetDeltaT((void *)&td->DWT_CNT);
+    return ThirdOrder_TD_Calculate_Tick(td, NULL, input);
+}
+
+float ThirdOrder_TD_Calculate_Tick(ThirdOrderTD_t *td, const DWT_Tick_t *tick, float input)
+{
+    DWT_Tick_t self;
+
+    td->dt = DWT_Tick_Or_Self(tick, &self, &td->DWT_CNT)->dt;
 
     td->Input = input;
 
@@ -190,6 +190,71 @@ void PID_Init(
 
     uint8_t improve);
 float PID_Calculate(PID_t *pid, float measure, float ref);
+// 以周期上下文的 dt 计算, tick 为 NULL 时与 PID_Calculate() 相同自行计时
+// computes with the dt of the tick context; a NULL tick times itself like PID_Calculate()
+float PID_Calculate_Tick(PID_t *pid, const DWT_Tick_t *tick, float measure, float ref);
+
+/**************************** BATCHED PID CONTROL ******************************/
+// N 路参数相同的 PID 成批计算: 状态按数组结构 (SoA) 存放, 共用一次 dt, 各路在同一遍循环中
+// 以条件选择代替分支计算, 主机上可向量化; 结果与逐路调用 PID_Calculate() 一致
+// N PIDs sharing one set of parameters, computed as a batch: the state is a struct of arrays,
+// one dt is shared, and every channel goes through the same loop with selects instead of
+// branches, which vectorises on the host; results match calling PID_Calculate() per channel
+// 支持 supported: Integral_Limit, Derivative_On_Measurement, Trapezoid_Intergral, OutputFilter, DerivativeFilter
+// 不支持 not supported: ChangingIntegrationRate, ErrorHandle, FuzzyRule, User_Func
+#define PID_BATCH_MAX 4
+#define PID_BATCH_IMPROVE (Integral_Limit | Derivative_On_Measurement | Trapezoid_Intergral | OutputFilter | DerivativeFilter)
+
+typedef struct
+{
+    float Kp;
+    float Ki;
+    float Kd;
+    float MaxOut;
+    float IntegralLimit;
+    float DeadBand;
+    float Output_LPF_RC;
+    float Derivative_LPF_RC;
+    uint8_t Improve;
+    uint8_t N;
+
+    uint32_t DWT_CNT;
+    float dt;
+
+    float Measure[PID_BATCH_MAX];
+    float Ref[PID_BATCH_MAX];
+    float Err[PID_BATCH_MAX];
+    float Pout[PID_BATCH_MAX];
+    float Iout[PID_BATCH_MAX];
+    float Dout[PID_BATCH_MAX];
+    float ITerm[PID_BATCH_MAX];
+    float Output[PID_BATCH_MAX];
+
+    float Last_Measure[PID_BATCH_MAX];
+    float Last_Err[PID_BATCH_MAX];
+    float Last_Output[PID_BATCH_MAX];
+    float Last_Dout[PID_BATCH_MAX];
+} PID_Batch_t;
+
+// 参数含义同 PID_Init(), 不支持的 improve 位被忽略 parameters as in PID_Init(), unsupported improve bits are ignored
+void PID_Batch_Init(
+    PID_Batch_t *pid,
+    uint8_t n,
+    float max_out,
+    float intergral_limit,
+    float deadband,
+
+    float kp,
+    float ki,
+    float kd,
+
+    float output_lpf_rc,
+    float derivative_lpf_rc,
+
+    uint8_t improve);
+// measure/ref 各 n 个, 结果在 pid->Output[] n values each in measure/ref, results in pid->Output[]
+void PID_Batch_Calculate(PID_Batch_t *pid, const float *measure, const float *ref);
+void PID_Batch_Calculate_Tick(PID_Batch_t *pid, const DWT_Tick_t *tick, const float *measure, const float *ref);
 
 /*************************** FEEDFORWARD CONTROL *****************************/
 typedef __packed struct
@@ -229,6 +294,7 @@ void Feedforward_Init(
     uint16_t ref_ddot_ols_order);
 
 float Feedforward_Calculate(Feedforward_t *ffc, float ref);
+float Feedforward_Calculate_Tick(Feedforward_t *ffc, const DWT_Tick_t *tick, float ref);
 
 /************************* LINEAR DISTURBANCE OBSERVER *************************/
 typedef __packed struct
@@ -272,6 +338,7 @@ void LDOB_Init(
     uint16_t measure_ddot_ols_order);
 
 float LDOB_Calculate(LDOB_t *ldob, float measure, float u);
+float LDOB_Calculate_Tick(LDOB_t *ldob, const DWT_Tick_t *tick, float measure, float u);
 
 /*************************** Tracking Differentiator ***************************/
 typedef __packed struct
@@ -294,6 +361,7 @@ typedef __packed struct
 
 void TD_Init(TD_t *td, float r, float h0);
 float TD_Calculate(TD_t *td, float input);
+float TD_Calculate_Tick(TD_t *td, const DWT_Tick_t *tick, float input);
 
 /************** Second Order System based Tracking Differentiator **************/
 typedef __packed struct
@@ -317,6 +385,7 @@ typedef __packed struct
 
 void ThirdOrder_TD_Init(ThirdOrderTD_t *tf, float omega);
 float ThirdOrder_TD_Calculate(ThirdOrderTD_t *tf, float input);
+float ThirdOrder_TD_Calculate_Tick(ThirdOrderTD_t *tf, const DWT_Tick_t *tick, float input);
 
 /**************************** SYSTEM IDENTIFICATION ****************************/
 // �ݶ��½����� ������ ��д������С���˷�
@@ -0,0 +1,13 @@
+/**
+ ******************************************************************************
+ * @file    pid_static.c
+ * @brief   编译期定功能 PID 实例 fixed-feature PID instances
+ ******************************************************************************
+ * @attention
+ * 新增功能组合时在 pid_static.h 中 DECLARE, 并在此处 DEFINE
+ ******************************************************************************
+ */
+#include "pid_static.h"
+
+PID_STATIC_DEFINE(PID_Rotate, 1, 1, 0, 1, 0, 1, 0)
+PID_STATIC_DEFINE(PID_Heat, 1, 0, 1, 0, 0, 1, 0)
@@ -0,0 +1,274 @@
+/**
+ ******************************************************************************
+ * @file    pid_static.h
+ * @brief   编译期定功能 PID fixed-feature PID
+ ******************************************************************************
+ * @attention
+ * 与 controller.c 的 PID_t 使用相同的算法与运算顺序, 结果逐位一致,
+ * 区别在于改进功能 (PID_Improvement_e) 在编译期确定:
+ * 1. 未启用的功能在预处理阶段即被删去, 不产生指令, 也不占结构体字节
+ * 2. 计算中不再逐项判断 Improve 位, 不再检查模糊规则与用户函数
+ * 不支持模糊 PID (FuzzyRule), 用户函数 (User_Func1_f/User_Func2_f) 与运行时修改功能,
+ * 需要时仍使用 PID_t; Proportional_On_Measurement 在 PID_t 中亦未实现, 此处没有对应参数
+ *
+ * Same algorithm and operation order as PID_t in controller.c, bit for bit,
+ * but the improvements (PID_Improvement_e) are fixed at compile time: the
+ * preprocessor drops every disabled feature, so it costs no instructions and
+ * no struct bytes, and the calculation tests no Improve bits. Fuzzy rules,
+ * user functions and changing the features at run time need PID_t.
+ *
+ * 功能参数依次为 feature arguments in order, 0 或 or 1:
+ *   IL   Integral_Limit
+ *   DOM  Derivative_On_Measurement
+ *   TRAP Trapezoid_Intergral
+ *   OF   OutputFilter
+ *   CIR  ChangingIntegrationRate
+ *   DF   DerivativeFilter
+ *   EH   ErrorHandle
+ *
+ * @example:
+ * // 头文件中声明类型与函数 declare in header
+ * //                 name       IL DOM TRAP OF CIR DF EH
+ * PID_STATIC_DECLARE(PID_Rotate, 1, 1,  0,   1, 0,  1, 0)
+ * // 在唯一的源文件中生成实现 define in exactly one source file
+ * PID_STATIC_DEFINE(PID_Rotate, 1, 1, 0, 1, 0, 1, 0)
+ *
+ * PID_Rotate_t RotateFollow;
+ * PID_Rotate_Init(&RotateFollow, 300, 100, 0, 8, 0, 0, 0, 0, 0, 0);
+ * ...
+ * Vr = PID_Rotate_Calculate_Tick(&RotateFollow, &Chassis_Tick, FollowTheta, 0.0f);
+ ******************************************************************************
+ */
+#ifndef __PID_STATIC_H
+#define __PID_STATIC_H
+
+#include "controller.h"
+#include "profiler.h"
+
+// flag 为 0 时删去其余参数, 为 1 时原样保留 drops the rest when flag is 0, keeps it as is when 1
+#define PID_STATIC_IF(flag, ...) PID_STATIC_IF_(flag, __VA_ARGS__)
+#define PID_STATIC_IF_(flag, ...) PID_STATIC_IF_##flag(__VA_ARGS__)
+#define PID_STATIC_IF_0(...)
+#define PID_STATIC_IF_1(...) __VA_ARGS__
+
+// flag 为 1 时取 a, 为 0 时取 b; a/b 内不能有顶层逗号 a when flag is 1, b when 0; no top level commas in a/b
+#define PID_STATIC_IF_ELSE(flag, a, b) PID_STATIC_IF_ELSE_(flag, a, b)
+#define PID_STATIC_IF_ELSE_(flag, a, b) PID_STATIC_IF_ELSE_##flag(a, b)
+#define PID_STATIC_IF_ELSE_0(a, b) b
+#define PID_STATIC_IF_ELSE_1(a, b) a
+
+#define PID_STATIC_INLINE static inline
+
+/*************************** features ***************************/
+// 与 controller.c 中同名的 f_ 函数相同 same as the f_ functions of the same name in controller.c
+
+PID_STATIC_INLINE void PID_Static_Changing_Integration_Rate(float *iterm, float err, float iout, float A, float B)
+{
+    if (err * iout > 0)
+    {
+        // 积分呈累积趋势 Integral still increasing
+        if (abs(err) <= B)
+            return; // Full integral
+        if (abs(err) <= (A + B))
+            *iterm *= (A - abs(err) + B) / A;
+        else
+            *iterm = 0;
+    }
+}
+
+PID_STATIC_INLINE void PID_Static_Integral_Limit(float *iterm, float *iout, float pout, float dout,
+                                                 float err, float max_out, float integral_limit)
+{
+    float temp_Iout = *iout + *iterm;
+    float temp_Output = pout + *iout + dout;
+
+    if (abs(temp_Output) > max_out)
+    {
+        if (err * *iout > 0)
+        {
+            // 积分呈累积趋势 Integral still increasing
+            *iterm = 0;
+        }
+    }
+
+    if (temp_Iout > integral_limit)
+    {
+        *iterm = 0;
+        *iout = integral_limit;
+    }
+    if (temp_Iout < -integral_limit)
+    {
+        *iterm = 0;
+        *iout = -integral_limit;
+    }
+}
+
+PID_STATIC_INLINE void PID_Static_Error_Handle(PID_ErrorHandler_t *handler, float output, float max_out, float ref, float measure)
+{
+    /*Motor Blocked Handle*/
+    if (output < max_out * 0.001f || fabsf(ref) < 0.0001f)
+        return;
+
+    if ((fabsf(ref - measure) / fabsf(ref)) > 0.95f)
+        handler->ERRORCount++;
+    else
+        handler->ERRORCount = 0;
+
+    if (handler->ERRORCount > 500)
+        handler->ERRORType = Motor_Blocked;
+}
+
+/*************************** pid type ***************************/
+#define PID_STATIC_DECLARE(name, IL, DOM, TRAP, OF, CIR, DF, EH)                                 \
+    typedef struct name##_s                                                                       \
+    {                                                                                             \
+        float Ref;                                                                                \
+        float Kp;                                                                                 \
+        float Ki;                                                                                 \
+        float Kd;                                                                                 \
+                                                                                                  \
+        float Measure;                                                                            \
+        PID_STATIC_IF(DOM, float Last_Measure;)                                                   \
+        float Err;                                                                                \
+        float Last_Err;                                                                           \
+                                                                                                  \
+        float Pout;                                                                               \
+        float Iout;                                                                               \
+        float Dout;                                                                               \
+        float ITerm;                                                                              \
+                                                                                                  \
+        float Output;                                                                             \
+        PID_STATIC_IF(OF, float Last_Output;)                                                     \
+        PID_STATIC_IF(DF, float Last_Dout;)                                                       \
+                                                                                                  \
+        float MaxOut;                                                                             \
+        PID_STATIC_IF(IL, float IntegralLimit;)                                                   \
+        float DeadBand;                                                                           \
+        PID_STATIC_IF(CIR, float CoefA; float CoefB;)                                             \
+        PID_STATIC_IF(OF, float Output_LPF_RC;)                                                   \
+        PID_STATIC_IF(DF, float Derivative_LPF_RC;)                                               \
+                                                                                                  \
+        uint32_t DWT_CNT;                                                                         \
+        float dt;                                                                                 \
+                                                                                                  \
+        PID_STATIC_IF(EH, PID_ErrorHandler_t ERRORHandler;)                                       \
+    } name##_t;                                                                                   \
+    /* 等价的 PID_t 功能位 the equivalent PID_t improve bits */                                         \
+    enum                                                                                          \
+    {                                                                                             \
+        name##_IMPROVE = (IL ? Integral_Limit : 0) | (DOM ? Derivative_On_Measurement : 0) |      \
+                         (TRAP ? Trapezoid_Intergral : 0) | (OF ? OutputFilter : 0) |             \
+                         (CIR ? ChangingIntegrationRate : 0) | (DF ? DerivativeFilter : 0) |      \
+                         (EH ? ErrorHandle : 0)                                                   \
+    };                                                                                            \
+    /* 参数含义同 PID_Init(), 未启用功能的参数被忽略 parameters as in PID_Init(), ignored for disabled features */ \
+    void name##_Init(name##_t *pid, float max_out, float intergral_limit, float deadband,           \
+                     float kp, float ki, float kd, float A, float B,                              \
+                     float output_lpf_rc, float derivative_lpf_rc);                               \
+    float name##_Calculate(name##_t *pid, float measure, float ref);                              \
+    /* tick 为 NULL 时自行计时 a NULL tick times itself */                                                  \
+    float name##_Calculate_Tick(name##_t *pid, const DWT_Tick_t *tick, float measure, float ref);
+
+#define PID_STATIC_DEFINE(name, IL, DOM, TRAP, OF, CIR, DF, EH)                                  \
+    void name##_Init(name##_t *pid, float max_out, float intergral_limit, float deadband,           \
+                     float kp, float ki, float kd, float A, float B,                              \
+                     float output_lpf_rc, float derivative_lpf_rc)                                \
+    {                                                                                             \
+        memset(pid, 0, sizeof(name##_t));                                                         \
+        pid->MaxOut = max_out;                                                                    \
+        pid->DeadBand = deadband;                                                                 \
+        pid->Kp = kp;                                                                             \
+        pid->Ki = ki;                                                                             \
+        pid->Kd = kd;                                                                             \
+        PID_STATIC_IF(IL, pid->IntegralLimit = intergral_limit;)                                  \
+        PID_STATIC_IF(CIR, pid->CoefA = A; pid->CoefB = B;)                                       \
+        PID_STATIC_IF(OF, pid->Output_LPF_RC = output_lpf_rc;)                                    \
+        PID_STATIC_IF(DF, pid->Derivative_LPF_RC = derivative_lpf_rc;)                            \
+    }                                                                                             \
+                                                                                                  \
+    float name##_Calculate(name##_t *pid, float measure, float ref)                               \
+    {                                                                                             \
+        return name##_Calculate_Tick(pid, NULL, measure, ref);                                    \
+    }                                                                                             \
+                                                                                                  \
+    float name##_Calculate_Tick(name##_t *pid, const DWT_Tick_t *tick, float measure, float ref)  \
+    {                                                                                             \
+        DWT_Tick_t self;                                                                          \
+        PROFILE_BEGIN(PROFILE_PID);                                                               \
+                                                                                                  \
+        PID_STATIC_IF(EH, PID_Static_Error_Handle(&pid->ERRORHandler, pid->Output, pid->MaxOut,   \
+                                                  pid->Ref, pid->Measure);)                       \
+                                                                                                  \
+        tick = DWT_Tick_Or_Self(tick, &self, &pid->DWT_CNT);                                      \
+        pid->dt = tick->dt;                                                                       \
+                                                                                                  \
+        pid->Measure = measure;                                                                   \
+        pid->Ref = ref;                                                                           \
+        if (!isnormal(pid->Measure))                                                              \
+            pid->Measure = 0;                                                                     \
+        if (!isnormal(pid->Ref))                                                                  \
+            pid->Ref = 0;                                                                         \
+        pid->Err = pid->Ref - pid->Measure;                                                       \
+                                                                                                  \
+        if (abs(pid->Err) > pid->DeadBand)                                                        \
+        {                                                                                         \
+            pid->Pout = pid->Kp * pid->Err;                                                       \
+            pid->ITerm = PID_STATIC_IF_ELSE(TRAP,                                                 \
+                                            pid->Ki * ((pid->Err + pid->Last_Err) / 2) * pid->dt, \
+                                            pid->Ki * pid->Err * pid->dt);                        \
+            PID_STATIC_IF(CIR, PID_Static_Changing_Integration_Rate(&pid->ITerm, pid->Err,         \
+                                                                    pid->Iout, pid->CoefA,        \
+                                                                    pid->CoefB);)                 \
+            pid->Dout = PID_STATIC_IF_ELSE(DOM,                                                   \
+                                           pid->Kd * (pid->Last_Measure - pid->Measure) * tick->inv_dt, \
+                                           pid->Kd * (pid->Err - pid->Last_Err) * tick->inv_dt);  \
+            PID_STATIC_IF(DF, pid->Dout = pid->Dout * pid->dt / (pid->Derivative_LPF_RC + pid->dt) + \
+                                          pid->Last_Dout * pid->Derivative_LPF_RC /               \
+                                              (pid->Derivative_LPF_RC + pid->dt);)                \
+            PID_STATIC_IF(IL, PID_Static_Integral_Limit(&pid->ITerm, &pid->Iout, pid->Pout,        \
+                                                        pid->Dout, pid->Err, pid->MaxOut,         \
+                                                        pid->IntegralLimit);)                     \
+                                                                                                  \
+            if (!isnormal(pid->ITerm))                                                            \
+                pid->ITerm = 0;                                                                   \
+                                                                                                  \
+            pid->Iout += pid->ITerm;                                                              \
+                                                                                                  \
+            if (!isnormal(pid->Pout))                                                             \
+                pid->Pout = 0;                                                                    \
+            if (!isnormal(pid->Iout))                                                             \
+                pid->Iout = 0;                                                                    \
+            if (!isnormal(pid->Dout))                                                             \
+                pid->Dout = 0;                                                                    \
+                                                                                                  \
+            pid->Output = pid->Pout + pid->Iout + pid->Dout;                                      \
+                                                                                                  \
+            PID_STATIC_IF(OF, pid->Output = pid->Output * pid->dt / (pid->Output_LPF_RC + pid->dt) + \
+                                            pid->Last_Output * pid->Output_LPF_RC /               \
+                                                (pid->Output_LPF_RC + pid->dt);)                  \
+                                                                                                  \
+            if (pid->Output > pid->MaxOut)                                                        \
+                pid->Output = pid->MaxOut;                                                        \
+            if (pid->Output < -(pid->MaxOut))                                                     \
+                pid->Output = -(pid->MaxOut);                                                     \
+            if (pid->Pout > pid->MaxOut)                                                          \
+                pid->Pout = pid->MaxOut;                                                          \
+            if (pid->Pout < -(pid->MaxOut))                                                       \
+                pid->Pout = -(pid->MaxOut);                                                       \
+        }                                                                                         \
+                                                                                                  \
+        PID_STATIC_IF(DOM, pid->Last_Measure = pid->Measure;)                                     \
+        PID_STATIC_IF(OF, pid->Last_Output = pid->Output;)                                        \
+        PID_STATIC_IF(DF, pid->Last_Dout = pid->Dout;)                                            \
+        pid->Last_Err = pid->Err;                                                                 \
+                                                                                                  \
+        PROFILE_END(PROFILE_PID);                                                                 \
+        return pid->Output;                                                                       \
+    }
+
+/*************************** instances ***************************/
+//                 name        IL DOM TRAP OF CIR DF EH
+PID_STATIC_DECLARE(PID_Rotate, 1, 1,  0,   1, 0,  1, 0) // Chassis.RotateFollow, Chassis.SpinningValid
+PID_STATIC_DECLARE(PID_Heat,   1, 0,  1,   0, 0,  1, 0) // INS TempCtrl
+
+#endif // __PID_STATIC_H
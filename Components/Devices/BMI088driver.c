@@ -2,6 +2,7 @@
 #include "BMI088reg.h"
 #include "BMI088Middleware.h"
 #include "bsp_dwt.h"
+#include <string.h>
 
 float BMI088_ACCEL_SEN = BMI088_ACCEL_6G_SEN;
 float BMI088_GYRO_SEN = BMI088_GYRO_2000_SEN;
@@ -80,6 +81,22 @@ static uint8_t write_BMI088_accel_reg_data_error[BMI088_WRITE_ACCEL_REG_NUM][3]
 
 };
 
+#if BMI088_USE_GYRO_FIFO
+// 流模式 FIFO, 达到水位时经 INT3 中断 stream mode FIFO, interrupting on INT3 at the watermark
+static uint8_t write_BMI088_gyro_reg_data_error[BMI088_WRITE_GYRO_REG_NUM][3] =
+    {
+        {BMI088_GYRO_RANGE, BMI088_GYRO_2000, BMI088_GYRO_RANGE_ERROR},
+        {BMI088_GYRO_BANDWIDTH, BMI088_GYRO_2000_230_HZ | BMI088_GYRO_BANDWIDTH_MUST_Set, BMI088_GYRO_BANDWIDTH_ERROR},
+        {BMI088_GYRO_LPM1, BMI088_GYRO_NORMAL_MODE, BMI088_GYRO_LPM1_ERROR},
+        {BMI088_GYRO_FIFO_CONFIG_0, BMI088_GYRO_FIFO_WATERMARK, BMI088_GYRO_FIFO_CONFIG_ERROR},
+        {BMI088_GYRO_FIFO_CONFIG_1, BMI088_GYRO_FIFO_MODE_STREAM, BMI088_GYRO_FIFO_CONFIG_ERROR},
+        {BMI088_GYRO_FIFO_WM_ENABLE, BMI088_GYRO_FIFO_WM_ON, BMI088_GYRO_FIFO_CONFIG_ERROR},
+        {BMI088_GYRO_CTRL, BMI088_FIFO_INT_ON, BMI088_GYRO_CTRL_ERROR},
+        {BMI088_GYRO_INT3_INT4_IO_CONF, BMI088_GYRO_INT3_GPIO_PP | BMI088_GYRO_INT3_GPIO_LOW, BMI088_GYRO_INT3_INT4_IO_CONF_ERROR},
+        {BMI088_GYRO_INT3_INT4_IO_MAP, BMI088_GYRO_FIFO_IO_INT3, BMI088_GYRO_INT3_INT4_IO_MAP_ERROR}
+
+};
+#else
 static uint8_t write_BMI088_gyro_reg_data_error[BMI088_WRITE_GYRO_REG_NUM][3] =
     {
         {BMI088_GYRO_RANGE, BMI088_GYRO_2000, BMI088_GYRO_RANGE_ERROR},
@@ -90,6 +107,7 @@ static uint8_t write_BMI088_gyro_reg_data_error[BMI088_WRITE_GYRO_REG_NUM][3] =
         {BMI088_GYRO_INT3_INT4_IO_MAP, BMI088_GYRO_DRDY_IO_INT3, BMI088_GYRO_INT3_INT4_IO_MAP_ERROR}
 
 };
+#endif
 
 static void Calibrate_MPU_Offset(IMU_Data_t *bmi088);
 
@@ -114,7 +132,7 @@ uint8_t BMI088_init(SPI_HandleTypeDef *bmi088_SPI)
     return error;
 }
 
-//׼Ʈ
+//较准零飘
 void Calibrate_MPU_Offset(IMU_Data_t *bmi088)
 {
     static uint8_t buf[8] = {0, 0, 0, 0, 0, 0};
@@ -232,12 +250,9 @@ uint8_t bmi088_gyro_init(void)
     return BMI088_NO_ERROR;
 }
 
-void BMI088_Read(IMU_Data_t *bmi088)
+static void BMI088_Accel_Decode(IMU_Data_t *bmi088, const uint8_t *buf)
 {
-    static uint8_t buf[8] = {0, 0, 0, 0, 0, 0};
-    static int16_t bmi088_raw_temp;
-
-    BMI088_accel_read_muli_reg(BMI088_ACCEL_XOUT_L, buf, 6);
+    int16_t bmi088_raw_temp;
 
     bmi088_raw_temp = (int16_t)((buf[1]) << 8) | buf[0];
     bmi088->Accel[0] = bmi088_raw_temp * BMI088_ACCEL_SEN;
@@ -245,30 +260,33 @@ void BMI088_Read(IMU_Data_t *bmi088)
     bmi088->Accel[1] = bmi088_raw_temp * BMI088_ACCEL_SEN;
     bmi088_raw_temp = (int16_t)((buf[5]) << 8) | buf[4];
     bmi088->Accel[2] = bmi088_raw_temp * BMI088_ACCEL_SEN;
+}
 
-    BMI088_gyro_read_muli_reg(BMI088_GYRO_CHIP_ID, buf, 8);
-    if (buf[0] == BMI088_GYRO_CHIP_ID_VALUE)
+// buf 为 x/y/z 的 6 字节, 数据寄存器与 FIFO 帧相同 buf holds the 6 bytes of x/y/z, the same for the data registers and a FIFO frame
+static void BMI088_Gyro_Frame_Decode(const IMU_Data_t *bmi088, float gyro[3], const uint8_t *buf)
+{
+    int16_t bmi088_raw_temp;
+
+    for (uint8_t i = 0; i < 3; i++)
     {
+        bmi088_raw_temp = (int16_t)((buf[2 * i + 1]) << 8) | buf[2 * i];
         if (caliOffset)
-        {
-            bmi088_raw_temp = (int16_t)((buf[3]) << 8) | buf[2];
-            bmi088->Gyro[0] = bmi088_raw_temp * BMI088_GYRO_SEN - bmi088->GyroOffset[0];
-            bmi088_raw_temp = (int16_t)((buf[5]) << 8) | buf[4];
-            bmi088->Gyro[1] = bmi088_raw_temp * BMI088_GYRO_SEN - bmi088->GyroOffset[1];
-            bmi088_raw_temp = (int16_t)((buf[7]) << 8) | buf[6];
-            bmi088->Gyro[2] = bmi088_raw_temp * BMI088_GYRO_SEN - bmi088->GyroOffset[2];
-        }
+            gyro[i] = bmi088_raw_temp * BMI088_GYRO_SEN - bmi088->GyroOffset[i];
         else
-        {
-            bmi088_raw_temp = (int16_t)((buf[3]) << 8) | buf[2];
-            bmi088->Gyro[0] = bmi088_raw_temp * BMI088_GYRO_SEN;
-            bmi088_raw_temp = (int16_t)((buf[5]) << 8) | buf[4];
-            bmi088->Gyro[1] = bmi088_raw_temp * BMI088_GYRO_SEN;
-            bmi088_raw_temp = (int16_t)((buf[7]) << 8) | buf[6];
-            bmi088->Gyro[2] = bmi088_raw_temp * BMI088_GYRO_SEN;
-        }
+            gyro[i] = bmi088_raw_temp * BMI088_GYRO_SEN;
     }
-    BMI088_accel_read_muli_reg(BMI088_TEMP_M, buf, 2);
+}
+
+// buf 从 BMI088_GYRO_CHIP_ID 开始, 芯片 ID 不符时不更新 buf starts at BMI088_GYRO_CHIP_ID, nothing is updated on a wrong chip ID
+static void BMI088_Gyro_Decode(IMU_Data_t *bmi088, const uint8_t *buf)
+{
+    if (buf[0] == BMI088_GYRO_CHIP_ID_VALUE)
+        BMI088_Gyro_Frame_Decode(bmi088, bmi088->Gyro, &buf[2]);
+}
+
+static void BMI088_Temp_Decode(IMU_Data_t *bmi088, const uint8_t *buf)
+{
+    int16_t bmi088_raw_temp;
 
     bmi088_raw_temp = (int16_t)((buf[0] << 3) | (buf[1] >> 5));
 
@@ -280,6 +298,360 @@ void BMI088_Read(IMU_Data_t *bmi088)
     bmi088->Temperature = bmi088_raw_temp * BMI088_TEMP_FACTOR + BMI088_TEMP_OFFSET;
 }
 
+void BMI088_Read(IMU_Data_t *bmi088)
+{
+    static uint8_t buf[8] = {0, 0, 0, 0, 0, 0};
+
+    BMI088_accel_read_muli_reg(BMI088_ACCEL_XOUT_L, buf, 6);
+    BMI088_Accel_Decode(bmi088, buf);
+
+    BMI088_gyro_read_muli_reg(BMI088_GYRO_CHIP_ID, buf, 8);
+    BMI088_Gyro_Decode(bmi088, buf);
+
+    BMI088_accel_read_muli_reg(BMI088_TEMP_M, buf, 2);
+    BMI088_Temp_Decode(bmi088, buf);
+}
+
+/*************************** 数据就绪触发的 DMA 读取 data ready triggered DMA reads ***************************/
+#define BMI088_DMA_IDLE 0xFF
+#define BMI088_BURST_NUM 4
+// 最长的一次读取为地址字节加 FIFO 帧 the longest burst is the address byte plus the FIFO frames
+#define BMI088_DMA_BUF_LEN (1 + BMI088_GYRO_FIFO_FRAME_LEN * BMI088_GYRO_FIFO_READ_MAX)
+
+// 一次突发读: 地址字节 (+ 加速度计的空字节) 后接数据 one burst: the address byte (+ the accelerometer dummy byte), then the data
+typedef struct
+{
+    void (*Select)(void);
+    void (*Deselect)(void);
+    uint8_t Skip; // 数据前的字节数 bytes before the data
+    uint8_t Len;  // 数据字节数 data bytes
+    uint8_t Tx[BMI088_DMA_BUF_LEN];
+} BMI088_Burst_t;
+
+// 按 BMI088_xxx_DATA_READY_BIT 编号 indexed by BMI088_xxx_DATA_READY_BIT
+static BMI088_Burst_t BMI088_Burst[BMI088_BURST_NUM] = {
+#if BMI088_USE_GYRO_FIFO
+    [BMI088_GYRO_DATA_READY_BIT] = {BMI088_GYRO_NS_L, BMI088_GYRO_NS_H, 1, 1, {BMI088_GYRO_FIFO_STATUS | 0x80}},
+#else
+    [BMI088_GYRO_DATA_READY_BIT] = {BMI088_GYRO_NS_L, BMI088_GYRO_NS_H, 1, 8, {BMI088_GYRO_CHIP_ID | 0x80}},
+#endif
+    [BMI088_ACCEL_DATA_READY_BIT] = {BMI088_ACCEL_NS_L, BMI088_ACCEL_NS_H, 2, 6, {BMI088_ACCEL_XOUT_L | 0x80}},
+    [BMI088_ACCEL_TEMP_DATA_READY_BIT] = {BMI088_ACCEL_NS_L, BMI088_ACCEL_NS_H, 2, 2, {BMI088_TEMP_M | 0x80}},
+    // 长度按 FIFO 状态中的帧数设置 the length is set from the frame count in the FIFO status
+    [BMI088_GYRO_FIFO_DATA_BIT] = {BMI088_GYRO_NS_L, BMI088_GYRO_NS_H, 1, 0, {BMI088_GYRO_FIFO_DATA | 0x80}},
+};
+
+// 总线空闲时的读取顺序 the order reads get the bus in
+static const uint8_t BMI088_Burst_Priority[BMI088_BURST_NUM] = {
+    BMI088_GYRO_DATA_READY_BIT,
+    BMI088_GYRO_FIFO_DATA_BIT,
+    BMI088_ACCEL_DATA_READY_BIT,
+    BMI088_ACCEL_TEMP_DATA_READY_BIT,
+};
+
+// 中断写入, 任务经 Seq 取一致的副本; 角速度样本按 Gyro_Count 存入环形缓冲区
+// written by the interrupts, the task takes a consistent copy through Seq; gyro samples go to a ring by Gyro_Count
+typedef struct
+{
+    uint8_t Accel[6];
+    uint8_t Temp[2];
+    uint8_t Gyro[BMI088_GYRO_FRAME_RING][BMI088_GYRO_FIFO_FRAME_LEN];
+    uint32_t Gyro_CYCCNT[BMI088_GYRO_FRAME_RING]; // 采样时刻 sample times
+    uint32_t Gyro_Count;
+} BMI088_Sample_t;
+
+static volatile BMI088_Sample_t BMI088_Sample;
+static volatile uint32_t BMI088_Sample_Seq;
+
+static uint8_t BMI088_DMA_Rx[BMI088_DMA_BUF_LEN];
+static uint8_t BMI088_DMA_Enabled = 0;
+static uint8_t BMI088_DMA_Pending = 0;                       // 等待总线的读取 reads waiting for the bus
+static uint8_t BMI088_DMA_Busy = BMI088_DMA_IDLE;            // 正在传输的读取 the read in flight
+static uint32_t BMI088_DMA_Request_CYCCNT[BMI088_BURST_NUM]; // 数据就绪时刻 data ready times
+static uint32_t BMI088_DMA_Busy_CYCCNT;
+
+#if BMI088_USE_GYRO_FIFO
+static uint32_t BMI088_FIFO_Frame_Cycles; // 帧间隔 (DWT 周期) frame spacing in DWT cycles
+static uint8_t BMI088_FIFO_Left;          // 本次读取后仍在 FIFO 中的帧 frames still queued after this read
+#endif
+
+BMI088_DMA_Stat_t BMI088_DMA_Stat;
+
+// 总线空闲时开始下一个读取, 角速度优先; 也在完成中断中调用
+// start the next read when the bus is idle, the gyro first; also called from the completion interrupt
+static void BMI088_DMA_Next(void)
+{
+    uint8_t burst = BMI088_DMA_IDLE;
+    BMI088_Burst_t *b;
+
+    if (BMI088_DMA_Busy != BMI088_DMA_IDLE || BMI088_DMA_Pending == 0)
+        return;
+
+    for (uint8_t i = 0; i < BMI088_BURST_NUM && burst == BMI088_DMA_IDLE; i++)
+        if (BMI088_DMA_Pending & (1 << BMI088_Burst_Priority[i]))
+            burst = BMI088_Burst_Priority[i];
+    b = &BMI088_Burst[burst];
+
+    BMI088_DMA_Pending &= ~(1 << burst);
+    BMI088_DMA_Busy = burst;
+    BMI088_DMA_Busy_CYCCNT = BMI088_DMA_Request_CYCCNT[burst];
+
+    b->Select();
+    if (HAL_SPI_TransmitReceive_DMA(BMI088_SPI, b->Tx, BMI088_DMA_Rx, b->Skip + b->Len) != HAL_OK)
+    {
+        b->Deselect();
+        BMI088_DMA_Busy = BMI088_DMA_IDLE;
+        BMI088_DMA_Stat.Error++;
+    }
+}
+
+static void BMI088_DMA_Request(uint8_t burst, uint32_t cyccnt)
+{
+    if (BMI088_DMA_Pending & (1 << burst))
+        BMI088_DMA_Stat.Overrun++;
+    BMI088_DMA_Pending |= 1 << burst;
+    BMI088_DMA_Request_CYCCNT[burst] = cyccnt;
+    BMI088_DMA_Next();
+}
+
+// 在完成中断中存入一个角速度样本 store one gyro sample, from the completion interrupt
+static void BMI088_Gyro_Push(const uint8_t *frame, uint32_t cyccnt)
+{
+    uint32_t index = BMI088_Sample.Gyro_Count % BMI088_GYRO_FRAME_RING;
+
+    for (uint8_t i = 0; i < BMI088_GYRO_FIFO_FRAME_LEN; i++)
+        BMI088_Sample.Gyro[index][i] = frame[i];
+    BMI088_Sample.Gyro_CYCCNT[index] = cyccnt;
+    BMI088_Sample.Gyro_Count++;
+    BMI088_DMA_Stat.Gyro++;
+}
+
+#if BMI088_USE_GYRO_FIFO
+/**
+ * @brief 由 FIFO 状态安排读取 FIFO 数据 schedule the FIFO data read from the FIFO status
+ *        角速度计没有传感器时间, 各帧时刻由水位中断推出: 中断由本次第 WATERMARK 帧触发, 其余帧按 ODR 间隔
+ *        the gyro has no sensor time, the frame times come from the watermark interrupt: it was
+ *        raised by frame WATERMARK of this read, the other frames are spaced by the ODR
+ * @param[in] FIFO_STATUS
+ * @param[in] 水位中断时刻 time of the watermark interrupt
+ */
+static void BMI088_FIFO_Status(uint8_t status, uint32_t cyccnt)
+{
+    uint8_t frames = status & BMI088_GYRO_FIFO_FRAME_COUNT, read;
+
+    if (status & BMI088_GYRO_FIFO_OVERRUN)
+        BMI088_DMA_Stat.Overrun++;
+    if (frames == 0)
+        return;
+    read = frames < BMI088_GYRO_FIFO_READ_MAX ? frames : BMI088_GYRO_FIFO_READ_MAX;
+    BMI088_FIFO_Left = frames - read;
+    BMI088_Burst[BMI088_GYRO_FIFO_DATA_BIT].Len = read * BMI088_GYRO_FIFO_FRAME_LEN;
+    // 以第一帧的时刻请求 requested with the time of the first frame
+    BMI088_DMA_Request(BMI088_GYRO_FIFO_DATA_BIT, cyccnt - (BMI088_GYRO_FIFO_WATERMARK - 1) * BMI088_FIFO_Frame_Cycles);
+}
+
+static void BMI088_FIFO_Data(const uint8_t *rx, uint8_t len, uint32_t cyccnt)
+{
+    uint8_t frames = len / BMI088_GYRO_FIFO_FRAME_LEN;
+
+    for (uint8_t i = 0; i < frames; i++)
+        BMI088_Gyro_Push(&rx[i * BMI088_GYRO_FIFO_FRAME_LEN], cyccnt + i * BMI088_FIFO_Frame_Cycles);
+    // 一次读不完时接着读, 时刻顺延使下一次的第一帧紧接本次最后一帧
+    // read on when one burst was not enough, the time is moved on so the next first frame follows this last one
+    if (BMI088_FIFO_Left)
+        BMI088_DMA_Request(BMI088_GYRO_DATA_READY_BIT, cyccnt + (frames + BMI088_GYRO_FIFO_WATERMARK - 1) * BMI088_FIFO_Frame_Cycles);
+}
+#endif
+
+/**
+ * @brief 初始化与零偏校准之后开始响应数据就绪中断 respond to data ready after init and the offset calibration
+ */
+void BMI088_DMA_Start(void)
+{
+    for (uint8_t i = 0; i < BMI088_BURST_NUM; i++)
+        memset(&BMI088_Burst[i].Tx[1], 0x55, sizeof(BMI088_Burst[i].Tx) - 1);
+#if BMI088_USE_GYRO_FIFO
+    BMI088_FIFO_Frame_Cycles = SystemCoreClock / BMI088_GYRO_ODR;
+    // 写 FIFO_CONFIG_1 清空校准期间积下的帧, 之后的水位中断对应新的帧
+    // writing FIFO_CONFIG_1 clears the frames queued during the calibration, the next watermark is for new ones
+    BMI088_gyro_write_single_reg(BMI088_GYRO_FIFO_CONFIG_1, BMI088_GYRO_FIFO_MODE_STREAM);
+#endif
+    BMI088_DMA_Enabled = 1;
+}
+
+/**
+ * @brief 放弃正在进行的读取并立即重新读取两个传感器, 在数据就绪超时时由任务在临界区中调用
+ *        drop the read in flight and read both dies again at once, called by the task inside
+ *        a critical section when data ready timed out
+ */
+void BMI088_DMA_Restart(void)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    if (BMI088_DMA_Busy != BMI088_DMA_IDLE)
+    {
+        HAL_SPI_DMAStop(BMI088_SPI);
+        BMI088_Burst[BMI088_DMA_Busy].Deselect();
+        BMI088_DMA_Busy = BMI088_DMA_IDLE;
+    }
+    BMI088_DMA_Stat.Error++;
+    BMI088_DMA_Request(BMI088_GYRO_DATA_READY_BIT, now);
+    BMI088_DMA_Request(BMI088_ACCEL_DATA_READY_BIT, now);
+}
+
+// 外部中断回调中调用, 先记下数据就绪时刻 called from the EXTI callback, the data ready time is taken first
+void BMI088_Accel_DRDY_IRQHandler(void)
+{
+    static uint8_t temp_decimation = 0;
+    uint32_t now = DWT->CYCCNT;
+
+    if (!BMI088_DMA_Enabled)
+        return;
+    BMI088_DMA_Request(BMI088_ACCEL_DATA_READY_BIT, now);
+    if (++temp_decimation >= BMI088_TEMP_DECIMATION)
+    {
+        temp_decimation = 0;
+        BMI088_DMA_Request(BMI088_ACCEL_TEMP_DATA_READY_BIT, now);
+    }
+}
+
+// FIFO 模式下为水位中断, 不抽取 the watermark interrupt in FIFO mode, not decimated
+void BMI088_Gyro_DRDY_IRQHandler(void)
+{
+#if !BMI088_USE_GYRO_FIFO
+    static uint8_t gyro_decimation = 0;
+#endif
+    uint32_t now = DWT->CYCCNT;
+
+#if BMI088_USE_GYRO_FIFO
+    if (!BMI088_DMA_Enabled)
+        return;
+#else
+    if (!BMI088_DMA_Enabled || ++gyro_decimation < BMI088_GYRO_DECIMATION)
+        return;
+    gyro_decimation = 0;
+#endif
+    BMI088_DMA_Request(BMI088_GYRO_DATA_READY_BIT, now);
+}
+
+/**
+ * @brief  SPI 收发完成回调中调用 called from the SPI transfer complete callback
+ * @retval 读到的新数据, 按 BMI088_xxx_DATA_READY_BIT 置位; 存入角速度样本时置 BMI088_GYRO_DATA_READY_BIT
+ *         the new data read, bit BMI088_xxx_DATA_READY_BIT set; BMI088_GYRO_DATA_READY_BIT once gyro samples were stored
+ */
+uint8_t BMI088_DMA_Cplt_IRQHandler(void)
+{
+    uint8_t burst = BMI088_DMA_Busy, ret = 0;
+    const uint8_t *rx;
+
+    if (burst == BMI088_DMA_IDLE)
+        return 0;
+    BMI088_Burst[burst].Deselect();
+    BMI088_DMA_Busy = BMI088_DMA_IDLE;
+    rx = &BMI088_DMA_Rx[BMI088_Burst[burst].Skip];
+
+    switch (burst)
+    {
+    case BMI088_GYRO_DATA_READY_BIT:
+#if BMI088_USE_GYRO_FIFO
+        BMI088_FIFO_Status(rx[0], BMI088_DMA_Busy_CYCCNT);
+#else
+        // 从芯片 ID 开始读, 不符时丢弃 read from the chip ID, dropped when it is wrong
+        if (rx[0] == BMI088_GYRO_CHIP_ID_VALUE)
+        {
+            BMI088_Gyro_Push(&rx[2], BMI088_DMA_Busy_CYCCNT);
+            ret = 1 << BMI088_GYRO_DATA_READY_BIT;
+        }
+        else
+            BMI088_DMA_Stat.Error++;
+#endif
+        break;
+#if BMI088_USE_GYRO_FIFO
+    case BMI088_GYRO_FIFO_DATA_BIT:
+        BMI088_FIFO_Data(rx, BMI088_Burst[burst].Len, BMI088_DMA_Busy_CYCCNT);
+        ret = 1 << BMI088_GYRO_DATA_READY_BIT;
+        break;
+#endif
+    case BMI088_ACCEL_DATA_READY_BIT:
+        for (uint8_t i = 0; i < sizeof(BMI088_Sample.Accel); i++)
+            BMI088_Sample.Accel[i] = rx[i];
+        BMI088_DMA_Stat.Accel++;
+        ret = 1 << burst;
+        break;
+    default:
+        for (uint8_t i = 0; i < sizeof(BMI088_Sample.Temp); i++)
+            BMI088_Sample.Temp[i] = rx[i];
+        BMI088_DMA_Stat.Temp++;
+        ret = 1 << burst;
+        break;
+    }
+    BMI088_Sample_Seq++;
+
+    BMI088_DMA_Next();
+    return ret;
+}
+
+void BMI088_DMA_Error_IRQHandler(void)
+{
+    if (BMI088_DMA_Busy == BMI088_DMA_IDLE)
+        return;
+    BMI088_Burst[BMI088_DMA_Busy].Deselect();
+    BMI088_DMA_Busy = BMI088_DMA_IDLE;
+    BMI088_DMA_Stat.Error++;
+    BMI088_DMA_Next();
+}
+
+/**
+ * @brief  在任务中取上次调用以来的角速度样本与最近的加速度/温度 take the gyro samples since the last call and the latest accelerometer/temperature, from a task
+ * @param[out] 角速度样本, 按时间先后; 多于 max 个时只取最新的 max 个
+ *             the gyro samples, oldest first; only the newest max when there are more
+ * @param[in]  frame 的容量, 不大于 BMI088_GYRO_FRAME_RING capacity of frame, at most BMI088_GYRO_FRAME_RING
+ * @retval 新样本数, bmi088->Gyro 为其中最新的一个 the number of new samples, bmi088->Gyro is the newest
+ */
+uint8_t BMI088_Read_Sample(IMU_Data_t *bmi088, BMI088_Gyro_Frame_t *frame, uint8_t max)
+{
+    static uint32_t gyro_count_last = 0;
+    static uint8_t gyro[BMI088_GYRO_FRAME_RING][BMI088_GYRO_FIFO_FRAME_LEN];
+    uint8_t accel[6], temp[2];
+    uint32_t seq, count, n;
+
+    if (max > BMI088_GYRO_FRAME_RING)
+        max = BMI088_GYRO_FRAME_RING;
+
+    // 复制期间有读取完成则重新复制 copy again if a read completed meanwhile
+    do
+    {
+        seq = BMI088_Sample_Seq;
+        for (uint8_t i = 0; i < sizeof(accel); i++)
+            accel[i] = BMI088_Sample.Accel[i];
+        for (uint8_t i = 0; i < sizeof(temp); i++)
+            temp[i] = BMI088_Sample.Temp[i];
+        count = BMI088_Sample.Gyro_Count;
+        n = count - gyro_count_last;
+        if (n > max)
+            n = max;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint32_t index = (count - n + i) % BMI088_GYRO_FRAME_RING;
+
+            for (uint8_t j = 0; j < BMI088_GYRO_FIFO_FRAME_LEN; j++)
+                gyro[i][j] = BMI088_Sample.Gyro[index][j];
+            frame[i].CYCCNT = BMI088_Sample.Gyro_CYCCNT[index];
+        }
+    } while (seq != BMI088_Sample_Seq);
+
+    BMI088_Accel_Decode(bmi088, accel);
+    if (BMI088_DMA_Stat.Temp)
+        BMI088_Temp_Decode(bmi088, temp);
+    for (uint32_t i = 0; i < n; i++)
+        BMI088_Gyro_Frame_Decode(bmi088, frame[i].Gyro, gyro[i]);
+    if (n)
+        memcpy(bmi088->Gyro, frame[n - 1].Gyro, sizeof(bmi088->Gyro));
+
+    gyro_count_last = count;
+    return n;
+}
+
 #if defined(BMI088_USE_SPI)
 
 static void BMI088_write_single_reg(uint8_t reg, uint8_t data)
@@ -7,12 +7,37 @@
 #define BMI088_TEMP_FACTOR 0.125f
 #define BMI088_TEMP_OFFSET 23.0f
 
+// 角速度计 FIFO: 为 1 时 INT3 改为 FIFO 水位中断, 每次读出 FIFO 中排队的全部样本; 为 0 时按数据就绪抽取读取
+// gyro FIFO: with 1, INT3 becomes the FIFO watermark interrupt and every read drains all queued
+// samples; with 0 the gyro is read on data ready, decimated
+#define BMI088_USE_GYRO_FIFO 1
+
 #define BMI088_WRITE_ACCEL_REG_NUM 6
+#if BMI088_USE_GYRO_FIFO
+#define BMI088_WRITE_GYRO_REG_NUM 9
+#else
 #define BMI088_WRITE_GYRO_REG_NUM 6
+#endif
 
 #define BMI088_GYRO_DATA_READY_BIT 0
 #define BMI088_ACCEL_DATA_READY_BIT 1
 #define BMI088_ACCEL_TEMP_DATA_READY_BIT 2
+#define BMI088_GYRO_FIFO_DATA_BIT 3 // FIFO 模式下角速度位读 FIFO 状态, 此位读 FIFO 数据 in FIFO mode the gyro bit reads the FIFO status, this one the FIFO data
+
+// 数据就绪触发读取的抽取: 角速度计 2 kHz 中每 2 个样本读 1 个, 与 INS 的 1 kHz 一致;
+// 温度每 1.28 s 才更新, 每 40 个加速度计样本 (800 Hz) 读一次即可
+// decimation of the data ready triggered reads: every 2nd sample of the 2 kHz gyro, matching the 1 kHz INS;
+// the temperature only updates every 1.28 s, reading it every 40th accelerometer sample (800 Hz) is plenty
+#define BMI088_GYRO_DECIMATION 2
+#define BMI088_TEMP_DECIMATION 40
+
+// 角速度计输出 2 kHz; FIFO 积满 2 帧 (1 ms, 与 INS 一致) 时中断, 一次最多读 8 帧, 任务侧保留最近 16 帧
+// the gyro outputs at 2 kHz; the FIFO interrupts at 2 frames (1 ms, matching the INS), a read takes
+// at most 8 frames, the task side keeps the latest 16
+#define BMI088_GYRO_ODR 2000
+#define BMI088_GYRO_FIFO_WATERMARK 2
+#define BMI088_GYRO_FIFO_READ_MAX 8
+#define BMI088_GYRO_FRAME_RING 16
 
 #define BMI088_LONG_DELAY_TIME 80
 #define BMI088_COM_WAIT_SENSOR_TIME 150
@@ -43,6 +68,22 @@ typedef struct
 
 } IMU_Data_t;
 
+// 一个角速度样本及其采样时刻 one gyro sample and its sample time
+typedef struct
+{
+    float Gyro[3];
+    uint32_t CYCCNT; // DWT->CYCCNT
+} BMI088_Gyro_Frame_t;
+
+typedef struct
+{
+    uint32_t Gyro;    // 读出的角速度样本 gyro samples read
+    uint32_t Accel;   // 完成的加速度读取 completed accelerometer bursts
+    uint32_t Temp;    // 完成的温度读取 completed temperature bursts
+    uint32_t Overrun; // 上一次读取尚未开始又来数据就绪, 或 FIFO 溢出, 旧样本丢失 data ready while the last read had not started, or a FIFO overflow, older samples are lost
+    uint32_t Error;   // SPI/DMA 错误与超时重启 SPI/DMA errors and timeout restarts
+} BMI088_DMA_Stat_t;
+
 enum
 {
     BMI088_NO_ERROR = 0x00,
@@ -59,6 +100,7 @@ enum
     BMI088_GYRO_CTRL_ERROR = 0x0B,
     BMI088_GYRO_INT3_INT4_IO_CONF_ERROR = 0x0C,
     BMI088_GYRO_INT3_INT4_IO_MAP_ERROR = 0x0D,
+    BMI088_GYRO_FIFO_CONFIG_ERROR = 0x0E,
 
     BMI088_SELF_TEST_ACCEL_ERROR = 0x80,
     BMI088_SELF_TEST_GYRO_ERROR = 0x40,
@@ -72,6 +114,20 @@ extern uint8_t bmi088_gyro_init(void);
 
 extern IMU_Data_t BMI088;
 
+extern BMI088_DMA_Stat_t BMI088_DMA_Stat;
+
+// 阻塞读取, 仅可在 BMI088_DMA_Start() 之前使用 blocking read, only before BMI088_DMA_Start()
 extern void BMI088_Read(IMU_Data_t *bmi088);
 
+// 数据就绪 (角速度计 FIFO 模式下为 FIFO 水位) 中断触发的 DMA 读取: 两个传感器共用 SPI, 读取请求排队, 角速度优先
+// data ready (the FIFO watermark for the gyro in FIFO mode) triggered DMA reads: both dies share the SPI,
+// requests queue up with the gyro first
+extern void BMI088_DMA_Start(void);
+extern void BMI088_DMA_Restart(void);
+extern void BMI088_Accel_DRDY_IRQHandler(void);
+extern void BMI088_Gyro_DRDY_IRQHandler(void);
+extern uint8_t BMI088_DMA_Cplt_IRQHandler(void);
+extern void BMI088_DMA_Error_IRQHandler(void);
+extern uint8_t BMI088_Read_Sample(IMU_Data_t *bmi088, BMI088_Gyro_Frame_t *frame, uint8_t max);
+
 #endif
@@ -114,6 +114,11 @@
 #define BMI088_GYRO_DYDR_SHFITS 0x7
 #define BMI088_GYRO_DYDR (0x1 << BMI088_GYRO_DYDR_SHFITS)
 
+#define BMI088_GYRO_FIFO_STATUS 0x0E
+#define BMI088_GYRO_FIFO_FRAME_COUNT 0x7F
+#define BMI088_GYRO_FIFO_OVERRUN_SHFITS 0x7
+#define BMI088_GYRO_FIFO_OVERRUN (0x1 << BMI088_GYRO_FIFO_OVERRUN_SHFITS)
+
 #define BMI088_GYRO_RANGE 0x0F
 #define BMI088_GYRO_RANGE_SHFITS 0x0
 #define BMI088_GYRO_2000 (0x0 << BMI088_GYRO_RANGE_SHFITS)
@@ -145,6 +150,7 @@
 #define BMI088_GYRO_CTRL 0x15
 #define BMI088_DRDY_OFF 0x00
 #define BMI088_DRDY_ON 0x80
+#define BMI088_FIFO_INT_ON 0x40
 
 #define BMI088_GYRO_INT3_INT4_IO_CONF 0x16
 #define BMI088_GYRO_INT4_GPIO_MODE_SHFITS 0x3
@@ -166,6 +172,12 @@
 #define BMI088_GYRO_DRDY_IO_INT3 0x01
 #define BMI088_GYRO_DRDY_IO_INT4 0x80
 #define BMI088_GYRO_DRDY_IO_BOTH (BMI088_GYRO_DRDY_IO_INT3 | BMI088_GYRO_DRDY_IO_INT4)
+#define BMI088_GYRO_FIFO_IO_INT3 0x04
+#define BMI088_GYRO_FIFO_IO_INT4 0x20
+
+#define BMI088_GYRO_FIFO_WM_ENABLE 0x1E
+#define BMI088_GYRO_FIFO_WM_OFF 0x08
+#define BMI088_GYRO_FIFO_WM_ON 0x88
 
 #define BMI088_GYRO_SELF_TEST 0x3C
 #define BMI088_GYRO_RATE_OK_SHFITS 0x4
@@ -177,4 +189,15 @@
 #define BMI088_GYRO_TRIG_BIST_SHFITS 0x0
 #define BMI088_GYRO_TRIG_BIST (0x1 << BMI088_GYRO_TRIG_BIST_SHFITS)
 
+#define BMI088_GYRO_FIFO_CONFIG_0 0x3D
+#define BMI088_GYRO_FIFO_WATERMARK_LEVEL 0x7F
+
+#define BMI088_GYRO_FIFO_CONFIG_1 0x3E
+#define BMI088_GYRO_FIFO_MODE_SHFITS 0x6
+#define BMI088_GYRO_FIFO_MODE_FIFO (0x1 << BMI088_GYRO_FIFO_MODE_SHFITS)
+#define BMI088_GYRO_FIFO_MODE_STREAM (0x2 << BMI088_GYRO_FIFO_MODE_SHFITS)
+
+#define BMI088_GYRO_FIFO_DATA 0x3F
+#define BMI088_GYRO_FIFO_FRAME_LEN 6
+
 #endif
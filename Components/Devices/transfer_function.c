@@ -15,7 +15,14 @@ void Second_Order_TF_Init(Second_Order_TF_t *tf, float *c)
 
 double Second_Order_TF_Calculate(Second_Order_TF_t *tf, double input)
 {
-    tf->dt = DWT_GetDeltaT(&tf->DWT_CNT);
+    return Second_Order_TF_Calculate_Tick(tf, NULL, input);
+}
+
+double Second_Order_TF_Calculate_Tick(Second_Order_TF_t *tf, const DWT_Tick_t *tick, double input)
+{
+    DWT_Tick_t self;
+
+    tf->dt = DWT_Tick_Or_Self(tick, &self, &tf->DWT_CNT)->dt;
 
     tf->u = input;
 
@@ -38,6 +38,8 @@ typedef struct
 
 void Second_Order_TF_Init(Second_Order_TF_t *tf, float *c);
 double Second_Order_TF_Calculate(Second_Order_TF_t *tf, double input);
+// 以周期上下文的 dt 计算, tick 为 NULL 时自行计时 computes with the dt of the tick context, a NULL tick times itself
+double Second_Order_TF_Calculate_Tick(Second_Order_TF_t *tf, const DWT_Tick_t *tick, double input);
 double Gauss_Rand(void);
 
 #endif
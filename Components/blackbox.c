@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ * @file    blackbox.c
+ * @brief   黑匣子 black-box recorder
+ ******************************************************************************
+ * @attention
+ * 环形缓冲区放在固定地址而非链接器分配的变量中, 启动代码不会将其清零, 两种工具链均适用
+ * the ring sits at a fixed address instead of in a linker allocated variable, so the
+ * startup code never clears it, with either toolchain
+ ******************************************************************************
+ */
+#include "blackbox.h"
+#include "crc8_16.h"
+#include <string.h>
+
+#define BlackBox_Ram ((BlackBox_Ram_t *)BLACKBOX_RAM_ADDR)
+
+typedef char BlackBox_Ram_Size_Check[sizeof(BlackBox_Ram_t) <= BLACKBOX_RAM_SIZE ? 1 : -1];
+typedef char BlackBox_Flash_Size_Check[sizeof(BlackBox_Header_t) + sizeof(BlackBox_Record_t) * BLACKBOX_RECORDS <= BLACKBOX_FLASH_SIZE ? 1 : -1];
+typedef char BlackBox_Record_Size_Check[sizeof(BlackBox_Record_t) % 4 == 0 ? 1 : -1];
+
+static HAL_StatusTypeDef BlackBox_Program(uint32_t addr, const void *data, uint32_t size)
+{
+    HAL_StatusTypeDef ret = HAL_OK;
+    uint32_t word;
+
+    // memcpy 而非强制转换, 避免违反严格别名时编译器将结构体的写入挪到读取之后
+    // memcpy instead of a cast, so strict aliasing cannot move the struct stores past the reads
+    for (uint32_t i = 0; i < size / 4 && ret == HAL_OK; i++)
+    {
+        memcpy(&word, (const uint8_t *)data + i * 4, 4);
+        ret = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + i * 4, word);
+    }
+    return ret;
+}
+
+// 按时间顺序写出环形缓冲区, 最后写 Magic write out the ring in time order, Magic last
+static void BlackBox_Dump(BlackBox_Reason_e reason, uint32_t reset_flags)
+{
+    BlackBox_Ram_t *ram = BlackBox_Ram;
+    FLASH_EraseInitTypeDef erase = {0};
+    BlackBox_Header_t header = {0};
+    uint32_t first, error, addr = BLACKBOX_FLASH_ADDR + sizeof(BlackBox_Header_t);
+    uint16_t crc = 0xFFFF;
+
+    header.Version = BLACKBOX_VERSION;
+    header.RecordSize = sizeof(BlackBox_Record_t);
+    header.Reason = reason;
+    header.ResetFlags = reset_flags;
+    header.Total = ram->Head;
+    header.Count = ram->Head < BLACKBOX_RECORDS ? ram->Head : BLACKBOX_RECORDS;
+    header.Period_us = ram->Period_us;
+    first = ram->Head - header.Count;
+
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = BLACKBOX_FLASH_SECTOR;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    HAL_FLASH_Unlock();
+    if (HAL_FLASHEx_Erase(&erase, &error) != HAL_OK)
+    {
+        HAL_FLASH_Lock();
+        return;
+    }
+    for (uint32_t i = 0; i < header.Count; i++)
+    {
+        const BlackBox_Record_t *record = &ram->Record[(first + i) % BLACKBOX_RECORDS];
+        crc = CRC16_Update(crc, (const uint8_t *)record, sizeof(*record));
+        if (BlackBox_Program(addr, record, sizeof(*record)) != HAL_OK)
+        {
+            HAL_FLASH_Lock();
+            return;
+        }
+        addr += sizeof(*record);
+    }
+    header.Crc = crc;
+    if (BlackBox_Program(BLACKBOX_FLASH_ADDR + 4, (const uint8_t *)&header + 4, sizeof(header) - 4) == HAL_OK)
+        HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, BLACKBOX_FLASH_ADDR, BLACKBOX_MAGIC);
+    HAL_FLASH_Lock();
+}
+
+void BlackBox_Boot(uint32_t reset_flags, uint32_t period_us)
+{
+    BlackBox_Ram_t *ram = BlackBox_Ram;
+    BlackBox_Reason_e reason = (BlackBox_Reason_e)ram->Reason;
+
+    // 上电/掉电复位后 RAM 内容无效 RAM contents are garbage after a power-on or brown-out reset
+    if (ram->Magic == BLACKBOX_MAGIC && !(reset_flags & (RCC_CSR_PORRSTF | RCC_CSR_BORRSTF)) && ram->Head > 0)
+    {
+        if (reason == BLACKBOX_REASON_NONE && (reset_flags & (RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF)))
+            reason = BLACKBOX_REASON_WATCHDOG;
+        if (reason != BLACKBOX_REASON_NONE)
+            BlackBox_Dump(reason, reset_flags);
+    }
+
+    ram->Head = 0;
+    ram->Reason = BLACKBOX_REASON_NONE;
+    ram->Period_us = period_us;
+    ram->Magic = BLACKBOX_MAGIC;
+}
+
+void BlackBox_Record(const BlackBox_Record_t *record)
+{
+    BlackBox_Ram_t *ram = BlackBox_Ram;
+    uint32_t head = ram->Head;
+
+    ram->Record[head % BLACKBOX_RECORDS] = *record;
+    ram->Head = head + 1;
+}
+
+void BlackBox_Mark(BlackBox_Reason_e reason)
+{
+    BlackBox_Ram_t *ram = BlackBox_Ram;
+
+    if (ram->Reason == BLACKBOX_REASON_NONE)
+        ram->Reason = reason;
+}
@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ * @file    blackbox.h
+ * @brief   黑匣子 black-box recorder
+ *          每个底盘周期的紧凑记录写入 CCM 中复位后保留的环形缓冲区, 写入只是一次拷贝, 不会阻塞;
+ *          故障/复位请求只在 RAM 中记下原因. 复位后启动时若记有原因或由看门狗复位,
+ *          在外设与任务初始化之前将最近的记录按时间顺序转存到 flash 扇区 11, 由 Host/blackbox_decode 解出
+ *          a compact record of every chassis tick goes into a ring in CCM that survives resets,
+ *          writing is a plain copy and never blocks; faults and reset requests only note the reason
+ *          in RAM. On the next boot, if a reason was noted or the watchdog fired, the latest records
+ *          are copied in time order to flash sector 11 before any peripheral or task starts, and
+ *          Host/blackbox_decode reads them back
+ ******************************************************************************
+ * @attention
+ * CCM 前 56 KB 与 flash 扇区 11 (0x080E0000, 128 KB) 由链接脚本保留, 不得另作他用
+ * the first 56 KB of CCM and flash sector 11 (0x080E0000, 128 KB) are reserved in the linker script
+ * 上电/掉电复位后 RAM 内容无效, 不转存; 转存需擦除扇区, 启动延迟 1~2 s
+ * RAM contents are lost on power-on/brown-out resets, nothing is dumped then; a dump erases the
+ * sector, which delays the boot by 1 to 2 s
+ ******************************************************************************
+ */
+#ifndef _BLACKBOX_H
+#define _BLACKBOX_H
+
+#include "main.h"
+#include "stdint.h"
+
+#define BLACKBOX_MAGIC 0x58424B42 // "BKBX"
+#define BLACKBOX_VERSION 1
+#define BLACKBOX_RECORDS 1400 // 500 Hz 下 2.8 s 2.8 s at 500 Hz
+#define BLACKBOX_RAM_SIZE (56 * 1024)
+#define BLACKBOX_FLASH_SECTOR FLASH_SECTOR_11
+#define BLACKBOX_FLASH_SIZE (128 * 1024)
+
+#ifndef BLACKBOX_RAM_ADDR
+#define BLACKBOX_RAM_ADDR CCMDATARAM_BASE
+#endif
+#ifndef BLACKBOX_FLASH_ADDR
+#define BLACKBOX_FLASH_ADDR 0x080E0000
+#endif
+
+typedef enum
+{
+    BLACKBOX_REASON_NONE = 0,
+    BLACKBOX_REASON_WATCHDOG,    // 独立/窗口看门狗复位 independent or window watchdog reset
+    BLACKBOX_REASON_HARDFAULT,   // HardFault_Handler()
+    BLACKBOX_REASON_KEY_RESET,   // 操作手 F+E 复位 F+E reset by the operator
+    BLACKBOX_REASON_I2C_LOST,    // INA226 通信丢失后复位 reset after losing the INA226
+    BLACKBOX_REASON_REQUEST,     // BlackBox_Mark() 的其他调用者 other callers of BlackBox_Mark()
+} BlackBox_Reason_e;
+
+// 40 字节 bytes
+typedef struct
+{
+    uint32_t Time_ms; // HAL_GetTick()
+    uint8_t Mode;     // Chassis.Mode
+    uint8_t Status;   // Chassis.status
+    uint16_t Offline; // 第 i 位为 Detect_List[i] 离线 bit i: Detect_List[i] is lost
+    int16_t Rpm[4];
+    int16_t Current[4]; // 电调反馈 ESC feedback
+    int16_t Output[4];  // 速度环输出 velocity loop output
+    int16_t Vx, Vy, Vr;
+    uint16_t Power_dW; // 功率估计, 0.1 W power estimate in 0.1 W
+} BlackBox_Record_t;
+
+// flash 中的转存头, 其后为按时间顺序排列的 Count 条记录; Magic 最后写入, 未写完的转存 Magic 为 0xFFFFFFFF
+// dump header in flash, followed by Count records in time order; Magic is written last, so an
+// unfinished dump reads 0xFFFFFFFF
+typedef struct
+{
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t RecordSize;
+    uint32_t Reason;     // BlackBox_Reason_e
+    uint32_t ResetFlags; // 启动时的 RCC->CSR RCC->CSR at boot
+    uint32_t Total;      // 复位前写入的记录总数 records written before the reset
+    uint16_t Count;
+    uint16_t Crc;        // 记录的 CRC16 (crc8_16.h) CRC16 of the records
+    uint32_t Period_us;  // 记录间隔 record interval
+    uint32_t Reserved;
+} BlackBox_Header_t;
+
+// 复位后保留的环形缓冲区 ring kept across resets
+typedef struct
+{
+    uint32_t Magic;
+    volatile uint32_t Head; // 已写入的记录总数 records written so far
+    volatile uint32_t Reason;
+    uint32_t Period_us;
+    BlackBox_Record_t Record[BLACKBOX_RECORDS];
+} BlackBox_Ram_t;
+
+// 启动时在外设初始化之前调用, 传入 RCC->CSR; 需要时转存, 之后清空环形缓冲区
+// call at boot before the peripheral init with RCC->CSR; dumps if needed, then clears the ring
+void BlackBox_Boot(uint32_t reset_flags, uint32_t period_us);
+// 由控制任务每周期调用一次 called by the control task once per tick
+void BlackBox_Record(const BlackBox_Record_t *record);
+// 记下复位原因, 只保留第一个; 可在故障处理函数中调用 note the reset reason, the first one is kept; safe in fault handlers
+void BlackBox_Mark(BlackBox_Reason_e reason);
+
+#endif
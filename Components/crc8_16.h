@@ -0,0 +1,41 @@
+/**
+ ******************************************************************************
+ * @file    crc8_16.h
+ * @brief   裁判系统/图传链路 CRC8 与 CRC16 referee and VTM link CRC8 and CRC16
+ *          CRC8:  G(x)=x8+x5+x4+1, 反射 reflected, 初值 init 0xFF
+ *          CRC16: G(x)=x16+x12+x5+1, 反射 reflected, 初值 init 0xFFFF
+ *          增量接口, 数据可分段输入: crc = CRCx_Update(crc, data, len)
+ *          incremental, data may be fed in pieces: crc = CRCx_Update(crc, data, len)
+ ******************************************************************************
+ * @attention
+ * STM32F407 的 CRC 外设固定为 CRC-32 (0x04C11DB7), 不能用于这两种多项式, 故为纯软件实现
+ * the STM32F407 CRC unit is fixed to CRC-32 (0x04C11DB7) and cannot compute
+ * these polynomials, so both are done in software
+ ******************************************************************************
+ */
+#ifndef _CRC8_16_H
+#define _CRC8_16_H
+
+#include "stdint.h"
+
+// 1: slice-by-4, 每次查 4 张表处理 4 字节, 表占 3 KB flash
+// 0: 逐字节查表, 表占 768 B flash
+// 1: slice-by-4, four table lookups per 4 bytes, 3 KB of tables in flash
+// 0: one lookup per byte, 768 B of tables
+#define CRC_SLICE_BY_4 1
+
+#if CRC_SLICE_BY_4
+#define CRC_SLICES 4
+#else
+#define CRC_SLICES 1
+#endif
+
+// [0] 为逐字节表, [k] 为该字节后接 k 个零字节的余数
+// [0] is the byte-wise table, [k] the remainder of the byte followed by k zero bytes
+extern const uint8_t CRC8_Table[CRC_SLICES][256];
+extern const uint16_t CRC16_Table[CRC_SLICES][256];
+
+uint8_t CRC8_Update(uint8_t crc, const uint8_t *data, uint32_t len);
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint32_t len);
+
+#endif
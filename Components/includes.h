@@ -48,7 +48,8 @@
 #include "QuaternionAHRS.h"
 #include "judgement_info.h"
 #include "remote_control.h"
-#include "SerialDebug.h"
+#include "telemetry.h"
+#include "blackbox.h"
 #include "VTM_info.h"
 #include "power_measure.h"
 #include "ui_task.h"
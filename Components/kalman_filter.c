@@ -127,10 +127,12 @@
  */
 
 #include "kalman_filter.h"
+#include "profiler.h"
 
 uint16_t sizeof_float, sizeof_double;
 
 static void H_K_R_Adjustment(KalmanFilter_t *kf);
+static void Sequential_Update(KalmanFilter_t *kf);
 
 void Kalman_Filter_Init(KalmanFilter_t *kf, uint8_t xhatSize, uint8_t uSize, uint8_t zSize)
 {
@@ -255,6 +257,8 @@ void Kalman_Filter_Init(KalmanFilter_t *kf, uint8_t xhatSize, uint8_t uSize, uin
 
 float *Kalman_Filter_Update(KalmanFilter_t *kf)
 {
+    PROFILE_BEGIN(PROFILE_KF_UPDATE);
+
     // ����H K R������������Զ�����
     // matrix H K R auto adjustment
     if (kf->UseAutoAdjustment != 0)
@@ -305,7 +309,18 @@ float *Kalman_Filter_Update(KalmanFilter_t *kf)
     if (kf->User_Func2_f != NULL)
         kf->User_Func2_f(kf);
 
-    if (kf->MeasurementValidNum != 0 || kf->UseAutoAdjustment == 0)
+    // User_Func3_f/User_Func4_f 须在式 3/4/5 之间运行, 逐个量测更新没有这样的时机, 设置时仍走矩阵求逆更新
+    // User_Func3_f/User_Func4_f run between equations 3/4/5, which the sequential update has no point
+    // for, so a filter that sets them keeps the inverse update
+    if ((kf->MeasurementValidNum != 0 || kf->UseAutoAdjustment == 0) &&
+        kf->UseSequentialUpdate && !kf->SkipEq3 && !kf->SkipEq4 && !kf->SkipEq5 &&
+        kf->User_Func3_f == NULL && kf->User_Func4_f == NULL)
+    {
+        // 3~5. 逐个量测标量更新, 无需求逆
+        // equations 3~5 as one scalar update per measurement, no matrix inverse
+        Sequential_Update(kf);
+    }
+    else if (kf->MeasurementValidNum != 0 || kf->UseAutoAdjustment == 0)
     {
         // �������
         // 3. K(k) = P'(k)��HT / (H��P'(k)��HT + R)
@@ -392,6 +407,7 @@ float *Kalman_Filter_Update(KalmanFilter_t *kf)
     if (kf->User_Func6_f != NULL)
         kf->User_Func6_f(kf);
 
+    PROFILE_END(PROFILE_KF_UPDATE);
     return kf->FilteredValue;
 }
 
@@ -437,3 +453,63 @@ static void H_K_R_Adjustment(KalmanFilter_t *kf)
     kf->K.numCols = kf->MeasurementValidNum;
     kf->z.numRows = kf->MeasurementValidNum;
 }
+
+/**
+ * @brief 序贯标量更新 sequential scalar measurement update
+ *        R 为对角阵时各量测噪声互不相关, 逐个处理与一次性更新结果相同:
+ *        For a diagonal R the measurements are uncorrelated, so processing
+ *        them one at a time gives the same result as the batch update:
+ *        P·hT => s = h·P·hT + r => k = P·hT / s
+ *        xhat = xhat + k·(z - h·xhat), P = P - k·(P·hT)T
+ *        R 的非对角元素被忽略, K 的各列为对应量测的标量增益
+ *        off-diagonal elements of R are ignored, column i of K holds the
+ *        gain of measurement i
+ */
+static void Sequential_Update(KalmanFilter_t *kf)
+{
+    uint8_t n = kf->xhatSize;
+    uint8_t m = kf->z.numRows; // 自动调整时为有效量测数 valid measurements under auto adjustment
+    float *Ph = kf->temp_vector_data;
+    float *h, s, innovation;
+
+    memcpy(kf->xhat_data, kf->xhatminus_data, sizeof_float * n);
+    memcpy(kf->P_data, kf->Pminus_data, sizeof_float * n * n);
+
+    for (uint8_t i = 0; i < m; i++)
+    {
+        h = &kf->H_data[i * n];
+
+        // Ph = P·hT, s = h·P·hT + r, innovation = z - h·xhat
+        s = kf->R_data[i * m + i];
+        innovation = kf->z_data[i];
+        for (uint8_t r = 0; r < n; r++)
+        {
+            Ph[r] = 0;
+            for (uint8_t c = 0; c < n; c++)
+                Ph[r] += kf->P_data[r * n + c] * h[c];
+            s += h[r] * Ph[r];
+            innovation -= h[r] * kf->xhat_data[r];
+        }
+
+        if (s <= 0)
+        {
+            for (uint8_t r = 0; r < n; r++)
+                kf->K_data[r * m + i] = 0;
+            continue;
+        }
+
+        s = 1.0f / s;
+        for (uint8_t r = 0; r < n; r++)
+        {
+            kf->K_data[r * m + i] = Ph[r] * s;
+            kf->xhat_data[r] += kf->K_data[r * m + i] * innovation;
+        }
+        // P = P - K·PhT, 只算上三角再镜像, 保持 P 严格对称 keep P exactly symmetric
+        for (uint8_t r = 0; r < n; r++)
+            for (uint8_t c = r; c < n; c++)
+            {
+                kf->P_data[r * n + c] -= kf->K_data[r * m + i] * Ph[c];
+                kf->P_data[c * n + r] = kf->P_data[r * n + c];
+            }
+    }
+}
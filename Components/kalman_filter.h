@@ -61,6 +61,8 @@ typedef struct kf_t
   uint8_t zSize;
 
   uint8_t UseAutoAdjustment;
+  uint8_t UseSequentialUpdate; // 逐个量测标量更新, 要求 R 为对角阵 sequential scalar update, R must be diagonal;
+                               // 设置 User_Func3_f/User_Func4_f 时不生效 ignored while User_Func3_f/User_Func4_f are set
   uint8_t MeasurementValidNum;
 
   uint8_t *MeasurementMap;      // ������״̬�Ĺ�ϵ how measurement relates to the state
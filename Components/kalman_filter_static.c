@@ -0,0 +1,15 @@
+/**
+ ******************************************************************************
+ * @file    kalman_filter_static.c
+ * @brief   编译期定维卡尔曼滤波器实例 fixed-size kalman filter instances
+ ******************************************************************************
+ * @attention
+ * 新增维度时在 kalman_filter_static.h 中 DECLARE, 并在此处 DEFINE
+ ******************************************************************************
+ */
+#include "kalman_filter_static.h"
+
+KALMAN_FILTER_STATIC_DEFINE(KalmanFilter6x4, 6, 4)
+KALMAN_FILTER_STATIC_DEFINE(KalmanFilter6x3, 6, 3)
+KALMAN_FILTER_STATIC_DEFINE(KalmanFilter3x3, 3, 3)
+KALMAN_FILTER_STATIC_DEFINE(KalmanFilter3x2, 3, 2)
@@ -0,0 +1,369 @@
+/**
+ ******************************************************************************
+ * @file    kalman_filter_static.h
+ * @brief   编译期定维卡尔曼滤波器 fixed-size kalman filter
+ ******************************************************************************
+ * @attention
+ * 与 kalman_filter.c 的 KalmanFilter_t 使用相同的更新方程与用户函数接口,
+ * 区别在于维度在编译期确定:
+ * 1. 所有矩阵为结构体内的定长数组, 不调用 pvPortMalloc
+ * 2. 矩阵运算为常量维度的内联循环, 由编译器完全展开, 无运行时维度检查
+ * 3. K = P'·HT·inv(S) 中的 H·P' 在式5中复用, P'·HT 不再单独计算
+ * 不支持控制量 u 与量测自动调整 (UseAutoAdjustment), 需要时仍使用 KalmanFilter_t
+ *
+ * Same equations and user function hooks as KalmanFilter_t, but the
+ * dimensions are fixed at compile time: buffers live inside the struct and
+ * the matrix kernels are constant-bound loops the compiler fully unrolls.
+ * Control vector and measurement auto adjustment are not supported.
+ *
+ * @example:
+ * // 头文件中声明类型与函数 declare in header
+ * KALMAN_FILTER_STATIC_DECLARE(KalmanFilter6x4, 6, 4)
+ * // 在唯一的源文件中生成实现 define in exactly one source file
+ * KALMAN_FILTER_STATIC_DEFINE(KalmanFilter6x4, 6, 4)
+ *
+ * KalmanFilter6x4_t ChassisKF;
+ * KalmanFilter6x4_Init(&ChassisKF);
+ * memcpy(ChassisKF.F_data, F_Init, sizeof(ChassisKF.F_data));
+ * ...
+ * KalmanFilter6x4_Update(&ChassisKF);
+ ******************************************************************************
+ */
+#ifndef __KALMAN_FILTER_STATIC_H
+#define __KALMAN_FILTER_STATIC_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "profiler.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define KF_STATIC_SUCCESS 0
+#define KF_STATIC_SINGULAR -5 // 与 ARM_MATH_SINGULAR 一致
+
+// 固件默认以 -Og 编译, 不会展开循环, 此处对滤波器单独开启优化
+#if defined(__GNUC__) && !defined(__clang__)
+#define KF_STATIC_OPTIMIZE __attribute__((optimize("O2")))
+#define KF_STATIC_UNROLL _Pragma("GCC unroll 36")
+#else
+#define KF_STATIC_OPTIMIZE
+#define KF_STATIC_UNROLL
+#endif
+
+#define KF_STATIC_INLINE static inline __attribute__((always_inline))
+
+/*************************** kernels ***************************/
+// 行优先存储, 维度参数在调用处均为常量
+
+// C(m*p) = A(m*n)·B(n*p)
+KF_STATIC_INLINE void KF_Mat_Mult(const float *A, const float *B, float *C, int m, int n, int p)
+{
+    KF_STATIC_UNROLL
+    for (int i = 0; i < m; i++)
+    {
+        KF_STATIC_UNROLL
+        for (int j = 0; j < p; j++)
+        {
+            float sum = 0;
+            KF_STATIC_UNROLL
+            for (int k = 0; k < n; k++)
+                sum += A[i * n + k] * B[k * p + j];
+            C[i * p + j] = sum;
+        }
+    }
+}
+
+// C(m*p) = A(m*n)·BT, B 为 p*n
+KF_STATIC_INLINE void KF_Mat_Mult_ABT(const float *A, const float *B, float *C, int m, int n, int p)
+{
+    KF_STATIC_UNROLL
+    for (int i = 0; i < m; i++)
+    {
+        KF_STATIC_UNROLL
+        for (int j = 0; j < p; j++)
+        {
+            float sum = 0;
+            KF_STATIC_UNROLL
+            for (int k = 0; k < n; k++)
+                sum += A[i * n + k] * B[j * n + k];
+            C[i * p + j] = sum;
+        }
+    }
+}
+
+// C(m*m) = A(m*n)·BT, B 为 m*n, 已知结果对称时只计算上三角
+KF_STATIC_INLINE void KF_Mat_Mult_ABT_Sym(const float *A, const float *B, float *C, int m, int n)
+{
+    KF_STATIC_UNROLL
+    for (int i = 0; i < m; i++)
+    {
+        KF_STATIC_UNROLL
+        for (int j = i; j < m; j++)
+        {
+            float sum = 0;
+            KF_STATIC_UNROLL
+            for (int k = 0; k < n; k++)
+                sum += A[i * n + k] * B[j * n + k];
+            C[i * m + j] = sum;
+            C[j * m + i] = sum;
+        }
+    }
+}
+
+// C(m*p) = AT·B, A 为 n*m
+KF_STATIC_INLINE void KF_Mat_Mult_ATB(const float *A, const float *B, float *C, int m, int n, int p)
+{
+    KF_STATIC_UNROLL
+    for (int i = 0; i < m; i++)
+    {
+        KF_STATIC_UNROLL
+        for (int j = 0; j < p; j++)
+        {
+            float sum = 0;
+            KF_STATIC_UNROLL
+            for (int k = 0; k < n; k++)
+                sum += A[k * m + i] * B[k * p + j];
+            C[i * p + j] = sum;
+        }
+    }
+}
+
+// y(m) = A(m*n)·x(n)
+KF_STATIC_INLINE void KF_Mat_Mult_Vec(const float *A, const float *x, float *y, int m, int n)
+{
+    KF_STATIC_UNROLL
+    for (int i = 0; i < m; i++)
+    {
+        float sum = 0;
+        KF_STATIC_UNROLL
+        for (int k = 0; k < n; k++)
+            sum += A[i * n + k] * x[k];
+        y[i] = sum;
+    }
+}
+
+/**
+ * @brief 对称正定矩阵求逆 Gauss-Jordan without pivoting
+ *        S = H·P'·HT + R 为对称正定阵, 主元恒为正, 无需选主元
+ * @param[in,out]   S 被消元, 调用后内容不再有意义
+ * @param[out]      Sinv
+ * @retval          KF_STATIC_SUCCESS / KF_STATIC_SINGULAR
+ */
+KF_STATIC_INLINE int8_t KF_Mat_Inverse(float *S, float *Sinv, int n)
+{
+    if (n == 1)
+    {
+        if (S[0] == 0.0f)
+            return KF_STATIC_SINGULAR;
+        Sinv[0] = 1.0f / S[0];
+        return KF_STATIC_SUCCESS;
+    }
+    if (n == 2)
+    {
+        float det = S[0] * S[3] - S[1] * S[2];
+        if (det == 0.0f)
+            return KF_STATIC_SINGULAR;
+        det = 1.0f / det;
+        Sinv[0] = S[3] * det;
+        Sinv[1] = -S[1] * det;
+        Sinv[2] = -S[2] * det;
+        Sinv[3] = S[0] * det;
+        return KF_STATIC_SUCCESS;
+    }
+
+    KF_STATIC_UNROLL
+    for (int i = 0; i < n * n; i++)
+        Sinv[i] = (i % (n + 1) == 0) ? 1.0f : 0.0f;
+
+    KF_STATIC_UNROLL
+    for (int c = 0; c < n; c++)
+    {
+        float pivot = S[c * n + c];
+        if (pivot == 0.0f)
+            return KF_STATIC_SINGULAR;
+        pivot = 1.0f / pivot;
+        KF_STATIC_UNROLL
+        for (int j = 0; j < n; j++)
+        {
+            S[c * n + j] *= pivot;
+            Sinv[c * n + j] *= pivot;
+        }
+        KF_STATIC_UNROLL
+        for (int r = 0; r < n; r++)
+        {
+            if (r == c)
+                continue;
+            float factor = S[r * n + c];
+            KF_STATIC_UNROLL
+            for (int j = 0; j < n; j++)
+            {
+                S[r * n + j] -= factor * S[c * n + j];
+                Sinv[r * n + j] -= factor * Sinv[c * n + j];
+            }
+        }
+    }
+    return KF_STATIC_SUCCESS;
+}
+
+/*************************** filter type ***************************/
+#define KALMAN_FILTER_STATIC_DECLARE(name, XSIZE, ZSIZE)     \
+    typedef struct name##_s                                  \
+    {                                                        \
+        float FilteredValue[XSIZE];                          \
+        float MeasuredVector[ZSIZE];                         \
+                                                             \
+        uint8_t xhatSize;                                    \
+        uint8_t zSize;                                       \
+                                                             \
+        float StateMinVariance[XSIZE];                       \
+        uint8_t SkipEq1, SkipEq2, SkipEq3, SkipEq4, SkipEq5; \
+                                                             \
+        float xhat_data[XSIZE];      /* x(k|k) */            \
+        float xhatminus_data[XSIZE]; /* x(k|k-1) */          \
+        float z_data[ZSIZE];                                 \
+        float P_data[XSIZE * XSIZE];      /* P(k|k) */       \
+        float Pminus_data[XSIZE * XSIZE]; /* P(k|k-1) */     \
+        float F_data[XSIZE * XSIZE];                         \
+        float H_data[ZSIZE * XSIZE];                         \
+        float Q_data[XSIZE * XSIZE];                         \
+        float R_data[ZSIZE * ZSIZE];                         \
+        float K_data[XSIZE * ZSIZE];                         \
+        float HP_data[ZSIZE * XSIZE]; /* H·P'(k) */          \
+        float S_data[ZSIZE * ZSIZE];  /* H·P'(k)·HT + R */   \
+        float Sinv_data[ZSIZE * ZSIZE];                      \
+        float temp_matrix_data[XSIZE * XSIZE];               \
+        float temp_vector_data[XSIZE];                       \
+        float temp_vector_data1[XSIZE];                      \
+                                                             \
+        int8_t MatStatus;                                    \
+                                                             \
+        void (*User_Func0_f)(struct name##_s * kf);          \
+        void (*User_Func1_f)(struct name##_s * kf);          \
+        void (*User_Func2_f)(struct name##_s * kf);          \
+        void (*User_Func3_f)(struct name##_s * kf);          \
+        void (*User_Func4_f)(struct name##_s * kf);          \
+        void (*User_Func5_f)(struct name##_s * kf);          \
+        void (*User_Func6_f)(struct name##_s * kf);          \
+    } name##_t;                                              \
+    void name##_Init(name##_t *kf);                          \
+    float *name##_Update(name##_t *kf);
+
+#define KALMAN_FILTER_STATIC_DEFINE(name, XSIZE, ZSIZE)                                             \
+    void name##_Init(name##_t *kf)                                                                  \
+    {                                                                                               \
+        memset(kf, 0, sizeof(name##_t));                                                            \
+        kf->xhatSize = XSIZE;                                                                       \
+        kf->zSize = ZSIZE;                                                                          \
+    }                                                                                               \
+                                                                                                    \
+    KF_STATIC_OPTIMIZE float *name##_Update(name##_t *kf)                                           \
+    {                                                                                               \
+        uint8_t HP_Valid = 0;                                                                       \
+        PROFILE_BEGIN(PROFILE_KF_UPDATE);                                                           \
+                                                                                                    \
+        memcpy(kf->z_data, kf->MeasuredVector, sizeof(kf->z_data));                                 \
+        memset(kf->MeasuredVector, 0, sizeof(kf->MeasuredVector));                                  \
+                                                                                                    \
+        if (kf->User_Func0_f != NULL)                                                               \
+            kf->User_Func0_f(kf);                                                                   \
+                                                                                                    \
+        /* 1. xhat'(k)= F·xhat(k-1) */                                                              \
+        if (!kf->SkipEq1)                                                                           \
+            KF_Mat_Mult_Vec(kf->F_data, kf->xhat_data, kf->xhatminus_data, XSIZE, XSIZE);           \
+                                                                                                    \
+        if (kf->User_Func1_f != NULL)                                                               \
+            kf->User_Func1_f(kf);                                                                   \
+                                                                                                    \
+        /* 2. P'(k) = F·P(k-1)·FT + Q */                                                            \
+        /* 只算上三角并镜像, P' 严格对称, 式3可用 (H·P')T 代替 P'·HT 而不累积非对称误差 */                                    \
+        if (!kf->SkipEq2)                                                                           \
+        {                                                                                           \
+            KF_Mat_Mult(kf->F_data, kf->P_data, kf->temp_matrix_data, XSIZE, XSIZE, XSIZE);         \
+            KF_Mat_Mult_ABT_Sym(kf->temp_matrix_data, kf->F_data, kf->Pminus_data, XSIZE, XSIZE);   \
+            KF_STATIC_UNROLL                                                                        \
+            for (int i = 0; i < XSIZE * XSIZE; i++)                                                 \
+                kf->Pminus_data[i] += kf->Q_data[i];                                                \
+        }                                                                                           \
+                                                                                                    \
+        if (kf->User_Func2_f != NULL)                                                               \
+            kf->User_Func2_f(kf);                                                                   \
+                                                                                                    \
+        /* 3. K(k) = P'(k)·HT / (H·P'(k)·HT + R), P'(k)·HT = (H·P'(k))T */                          \
+        if (!kf->SkipEq3)                                                                           \
+        {                                                                                           \
+            KF_Mat_Mult(kf->H_data, kf->Pminus_data, kf->HP_data, ZSIZE, XSIZE, XSIZE);             \
+            HP_Valid = 1;                                                                           \
+            KF_Mat_Mult_ABT_Sym(kf->HP_data, kf->H_data, kf->S_data, ZSIZE, XSIZE);                 \
+            KF_STATIC_UNROLL                                                                        \
+            for (int i = 0; i < ZSIZE * ZSIZE; i++)                                                 \
+                kf->S_data[i] += kf->R_data[i];                                                     \
+            kf->MatStatus = KF_Mat_Inverse(kf->S_data, kf->Sinv_data, ZSIZE);                       \
+            if (kf->MatStatus == KF_STATIC_SUCCESS)                                                 \
+                KF_Mat_Mult_ATB(kf->HP_data, kf->Sinv_data, kf->K_data, XSIZE, ZSIZE, ZSIZE);       \
+            else                                                                                    \
+                memset(kf->K_data, 0, sizeof(kf->K_data)); /* S 奇异 本次仅预测 */                         \
+        }                                                                                           \
+                                                                                                    \
+        if (kf->User_Func3_f != NULL)                                                               \
+            kf->User_Func3_f(kf);                                                                   \
+                                                                                                    \
+        /* 4. xhat(k) = xhat'(k) + K(k)·(z(k) - H·xhat'(k)) */                                      \
+        if (!kf->SkipEq4)                                                                           \
+        {                                                                                           \
+            KF_Mat_Mult_Vec(kf->H_data, kf->xhatminus_data, kf->temp_vector_data, ZSIZE, XSIZE);    \
+            KF_STATIC_UNROLL                                                                        \
+            for (int i = 0; i < ZSIZE; i++)                                                         \
+                kf->temp_vector_data1[i] = kf->z_data[i] - kf->temp_vector_data[i];                 \
+            KF_Mat_Mult_Vec(kf->K_data, kf->temp_vector_data1, kf->temp_vector_data, XSIZE, ZSIZE); \
+            KF_STATIC_UNROLL                                                                        \
+            for (int i = 0; i < XSIZE; i++)                                                         \
+                kf->xhat_data[i] = kf->xhatminus_data[i] + kf->temp_vector_data[i];                 \
+        }                                                                                           \
+                                                                                                    \
+        if (kf->User_Func4_f != NULL)                                                               \
+            kf->User_Func4_f(kf);                                                                   \
+                                                                                                    \
+        /* 5. P(k) = P'(k) - K(k)·H·P'(k) */                                                        \
+        if (!kf->SkipEq5)                                                                           \
+        {                                                                                           \
+            if (!HP_Valid)                                                                          \
+                KF_Mat_Mult(kf->H_data, kf->Pminus_data, kf->HP_data, ZSIZE, XSIZE, XSIZE);         \
+            KF_Mat_Mult(kf->K_data, kf->HP_data, kf->temp_matrix_data, XSIZE, ZSIZE, XSIZE);        \
+            KF_STATIC_UNROLL                                                                        \
+            for (int i = 0; i < XSIZE * XSIZE; i++)                                                 \
+                kf->P_data[i] = kf->Pminus_data[i] - kf->temp_matrix_data[i];                       \
+        }                                                                                           \
+                                                                                                    \
+        if (kf->User_Func5_f != NULL)                                                               \
+            kf->User_Func5_f(kf);                                                                   \
+                                                                                                    \
+        /* suppress filter excessive convergence */                                                 \
+        KF_STATIC_UNROLL                                                                            \
+        for (int i = 0; i < XSIZE; i++)                                                             \
+        {                                                                                           \
+            if (kf->P_data[i * XSIZE + i] < kf->StateMinVariance[i])                                \
+                kf->P_data[i * XSIZE + i] = kf->StateMinVariance[i];                                \
+        }                                                                                           \
+                                                                                                    \
+        memcpy(kf->FilteredValue, kf->xhat_data, sizeof(kf->FilteredValue));                        \
+                                                                                                    \
+        if (kf->User_Func6_f != NULL)                                                               \
+            kf->User_Func6_f(kf);                                                                   \
+                                                                                                    \
+        PROFILE_END(PROFILE_KF_UPDATE);                                                             \
+        return kf->FilteredValue;                                                                   \
+    }
+
+/*************************** instances ***************************/
+KALMAN_FILTER_STATIC_DECLARE(KalmanFilter6x4, 6, 4) // ChassisMotionEst
+KALMAN_FILTER_STATIC_DECLARE(KalmanFilter6x3, 6, 3) // QEKF_INS
+KALMAN_FILTER_STATIC_DECLARE(KalmanFilter3x3, 3, 3) // gEstimateKF
+KALMAN_FILTER_STATIC_DECLARE(KalmanFilter3x2, 3, 2) // ChassisMotionEst 单轴 single axis
+
+#endif // __KALMAN_FILTER_STATIC_H
@@ -0,0 +1,178 @@
+/**
+ ******************************************************************************
+ * @file    profiler.c
+ * @brief   命名探针计时 named-probe profiler
+ ******************************************************************************
+ * @attention
+ * CAN 导出: 每个探针 6 帧, Data[0] 为探针号, Data[1] 为帧序号, 时间单位 0.1 us, 小端, 超出 65535 时饱和
+ * CAN dump: 6 frames per probe, Data[0] is the probe, Data[1] the frame index,
+ * times in 0.1 us, little endian, saturating at 65535
+ *   0: Data[2..3] min, Data[4..5] mean, Data[6..7] max
+ *   1: Data[2..5] count, Data[6..7] last
+ *   2~5: Data[2..7] 直方图第 3(n-2) ~ 3(n-2)+2 段, 饱和于 65535 histogram buckets 3(n-2) to 3(n-2)+2, saturating at 65535
+ ******************************************************************************
+ */
+#include "profiler.h"
+#include "bsp_CAN.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PROFILE_CAN_FRAMES 6
+// 表头与每个探针一行, 每行约 100 字符 the header and one row per probe, about 100 characters each
+#define PROFILE_TEXT_LEN ((PROFILE_NUM + 1) * 128)
+
+Profile_Stat_t Profile_Stat[PROFILE_NUM];
+uint8_t Profile_Dump_Mode = PROFILE_DUMP_OFF; // 可在调试器中修改 may be changed from the debugger
+
+static const char *const Profile_Names[PROFILE_NUM] = {
+    [PROFILE_CHASSIS_CONTROL] = "Chassis_Control",
+    [PROFILE_CHASSIS_RX] = "chassis rx",
+    [PROFILE_CHASSIS_EST] = "chassis est",
+    [PROFILE_CHASSIS_CTRL] = "chassis ctrl",
+    [PROFILE_CHASSIS_TX] = "chassis tx",
+    [PROFILE_KF_UPDATE] = "Kalman_Update",
+    [PROFILE_QEKF] = "QEKF_Update",
+    [PROFILE_AHRS] = "AHRS_Update",
+    [PROFILE_PID] = "PID_Calculate",
+    [PROFILE_PID_BATCH] = "PID_Batch",
+    [PROFILE_INS] = "INS_Task",
+    [PROFILE_CAN_RX_ISR] = "CAN rx ISR",
+    [PROFILE_UART_IDLE_ISR] = "UART idle ISR",
+    [PROFILE_UI] = "UI task",
+};
+
+static char Profile_Text[PROFILE_TEXT_LEN];
+
+void Profile_Record(Profile_Probe_e probe, uint32_t cycles)
+{
+    Profile_Stat_t *stat = &Profile_Stat[probe];
+    uint32_t bucket = 0;
+
+    if (stat->Count == 0 || cycles < stat->Min_cyc)
+        stat->Min_cyc = cycles;
+    if (cycles > stat->Max_cyc)
+        stat->Max_cyc = cycles;
+    stat->Last_cyc = cycles;
+    stat->Sum_cyc += cycles;
+    stat->Count++;
+
+    // floor(log2(cycles)) - MIN_LOG2 + 1
+    if (cycles >> PROFILE_HIST_MIN_LOG2)
+        bucket = 32 - __CLZ(cycles) - PROFILE_HIST_MIN_LOG2;
+    if (bucket >= PROFILE_HIST_BUCKETS)
+        bucket = PROFILE_HIST_BUCKETS - 1;
+    stat->Hist[bucket]++;
+}
+
+void Profile_Reset(void)
+{
+    memset(Profile_Stat, 0, sizeof(Profile_Stat));
+}
+
+const char *Profile_Name(Profile_Probe_e probe)
+{
+    return probe < PROFILE_NUM ? Profile_Names[probe] : "?";
+}
+
+float Profile_Mean_us(Profile_Probe_e probe)
+{
+    const Profile_Stat_t *stat = &Profile_Stat[probe];
+
+    if (stat->Count == 0)
+        return 0;
+    return (float)stat->Sum_cyc / stat->Count / (SystemCoreClock * 1e-6f);
+}
+
+// 周期数转为 0.1 us cycles to 0.1 us
+static uint32_t Profile_To_100ns(uint64_t cycles)
+{
+    return (uint32_t)(cycles * 10 / (SystemCoreClock / 1000000));
+}
+
+static uint16_t Profile_Saturate(uint32_t value)
+{
+    return value > 0xFFFF ? 0xFFFF : value;
+}
+
+uint16_t Profile_Format(char *buf, uint16_t size)
+{
+    uint32_t len, min, mean, max;
+    const Profile_Stat_t *stat;
+
+    len = snprintf(buf, size, "%-16s %8s %10s %10s %10s  hist from <%u cycles, x2 per bucket\r\n",
+                   "probe", "count", "min us", "mean us", "max us", 1u << PROFILE_HIST_MIN_LOG2);
+    for (uint8_t i = 0; i < PROFILE_NUM && len < size; i++)
+    {
+        stat = &Profile_Stat[i];
+        min = Profile_To_100ns(stat->Min_cyc);
+        mean = stat->Count ? Profile_To_100ns(stat->Sum_cyc / stat->Count) : 0;
+        max = Profile_To_100ns(stat->Max_cyc);
+        len += snprintf(buf + len, size - len, "%-16s %8lu %8lu.%lu %8lu.%lu %8lu.%lu ", Profile_Names[i],
+                        (unsigned long)stat->Count, (unsigned long)(min / 10), (unsigned long)(min % 10),
+                        (unsigned long)(mean / 10), (unsigned long)(mean % 10),
+                        (unsigned long)(max / 10), (unsigned long)(max % 10));
+        for (uint8_t j = 0; j < PROFILE_HIST_BUCKETS && len < size; j++)
+            len += snprintf(buf + len, size - len, " %lu", (unsigned long)stat->Hist[j]);
+        if (len < size)
+            len += snprintf(buf + len, size - len, "\r\n");
+    }
+
+    return len < size ? len : size - 1;
+}
+
+HAL_StatusTypeDef Profile_Send_CAN(CAN_HandleTypeDef *hcan, uint16_t std_id)
+{
+    static uint16_t next = 0;
+    uint8_t probe = next / PROFILE_CAN_FRAMES, part = next % PROFILE_CAN_FRAMES;
+    const Profile_Stat_t *stat = &Profile_Stat[probe];
+    uint16_t value[3];
+    uint8_t data[8];
+    HAL_StatusTypeDef ret;
+
+    data[0] = probe;
+    data[1] = part;
+    if (part == 0)
+    {
+        value[0] = Profile_Saturate(Profile_To_100ns(stat->Min_cyc));
+        value[1] = Profile_Saturate(stat->Count ? Profile_To_100ns(stat->Sum_cyc / stat->Count) : 0);
+        value[2] = Profile_Saturate(Profile_To_100ns(stat->Max_cyc));
+    }
+    else if (part == 1)
+    {
+        value[0] = stat->Count & 0xFFFF;
+        value[1] = stat->Count >> 16;
+        value[2] = Profile_Saturate(Profile_To_100ns(stat->Last_cyc));
+    }
+    else
+    {
+        for (uint8_t i = 0; i < 3; i++)
+            value[i] = Profile_Saturate(stat->Hist[(part - 2) * 3 + i]);
+    }
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        data[2 + 2 * i] = value[i] & 0xFF;
+        data[3 + 2 * i] = value[i] >> 8;
+    }
+
+    ret = CAN_Transmit(hcan, std_id, data, 8, CAN_TX_PRIO_TELEMETRY);
+    if (ret != HAL_ERROR && ++next == PROFILE_NUM * PROFILE_CAN_FRAMES)
+        next = 0;
+    return ret;
+}
+
+HAL_StatusTypeDef Profile_Send_Telem(void)
+{
+    // Profile_Text 在发完前由遥测任务读取, 不可改写 the telemetry task reads Profile_Text until it is sent, keep it intact
+    if (Telem_Text_Busy())
+        return HAL_BUSY;
+    return Telem_Send_Text(Profile_Text, Profile_Format(Profile_Text, sizeof(Profile_Text)));
+}
+
+void Profile_Dump(void)
+{
+    if (Profile_Dump_Mode == PROFILE_DUMP_CAN)
+        Profile_Send_CAN(&hcan2, PROFILE_CAN_ID);
+    else if (Profile_Dump_Mode == PROFILE_DUMP_TELEM)
+        Profile_Send_Telem();
+}
@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ * @file    profiler.h
+ * @brief   命名探针计时 named-probe profiler
+ *          PROFILE_BEGIN()/PROFILE_END() 之间的 DWT->CYCCNT 周期数计入静态表中该探针的
+ *          次数/最小/最大/平均值与按 2 的幂分段的直方图, 可经 CAN 或遥测文本帧导出
+ *          the DWT->CYCCNT cycles between PROFILE_BEGIN() and PROFILE_END() go into the
+ *          count/min/max/mean and a power-of-two histogram of the probe in a static table,
+ *          which can be dumped over CAN or as telemetry text frames
+ ******************************************************************************
+ * @attention
+ * 用法 usage:
+ *   PROFILE_BEGIN(PROFILE_PID);
+ *   ...
+ *   PROFILE_END(PROFILE_PID);
+ * 同一作用域内每个探针只能开始一次; 探针可以嵌套, 计时包含内层探针
+ * each probe begins once per scope; probes may nest and include the inner ones
+ * 统计不加锁, 两个可互相抢占的上下文记录同一探针时偶尔会丢失一个样本
+ * the statistics take no lock, a sample may get lost when two contexts that can
+ * preempt each other record the same probe
+ * 主机构建由 host_port.h 将 PROFILE_NOW() 换为 clock_gettime()
+ * the host build maps PROFILE_NOW() to clock_gettime() in host_port.h
+ ******************************************************************************
+ */
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include "main.h"
+#include "stdint.h"
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE 1
+#endif
+
+#define PROFILE_HIST_BUCKETS 12
+#define PROFILE_HIST_MIN_LOG2 7 // 第 0 段为 128 周期 (0.76 us) 以下 bucket 0 holds everything below 128 cycles (0.76 us)
+#define PROFILE_CAN_ID 0x5F0
+
+typedef enum
+{
+    PROFILE_CHASSIS_CONTROL = 0, // Chassis_Control() 整体 as a whole
+    PROFILE_CHASSIS_RX,          // 接收队列与快照 receive queue and snapshots
+    PROFILE_CHASSIS_EST,         // ChassisMotionEst_Update()
+    PROFILE_CHASSIS_CTRL,        // 模式/控制量/运动解算与 PID mode, control values, kinematics and PID
+    PROFILE_CHASSIS_TX,          // 电流与云台手数据发送 current and aerial data transmission
+    PROFILE_KF_UPDATE,           // Kalman_Filter_Update() 与 and KalmanFilter*_Update()
+    PROFILE_QEKF,                // IMU_QuaternionEKF_Update(), 单级 INS fused INS
+    PROFILE_AHRS,                // Quaternion_AHRS_UpdateIMU(), 两级 INS two-stage INS
+    PROFILE_PID,                 // PID_Calculate() 与 and PID_STATIC name_Calculate()
+    PROFILE_PID_BATCH,           // PID_Batch_Calculate()
+    PROFILE_INS,                 // INS_Task()
+    PROFILE_CAN_RX_ISR,          // HAL_CAN_RxFifo0MsgPendingCallback()
+    PROFILE_UART_IDLE_ISR,       // USART_IDLE_IRQHandler()
+    PROFILE_UI,                  // UI 任务每周期 UI task per period
+    PROFILE_NUM,
+} Profile_Probe_e;
+
+typedef enum
+{
+    PROFILE_DUMP_OFF = 0,
+    PROFILE_DUMP_CAN,
+    PROFILE_DUMP_TELEM, // 遥测文本帧 telemetry text frames
+} Profile_Dump_e;
+
+typedef struct
+{
+    uint32_t Count;
+    uint32_t Last_cyc;
+    uint32_t Min_cyc;
+    uint32_t Max_cyc;
+    uint64_t Sum_cyc; // 除以 Count 为平均值 divide by Count for the mean
+    // 第 k 段 (k > 0) 为 [2^(MIN_LOG2 + k - 1), 2^(MIN_LOG2 + k)) 周期, 最后一段不设上限
+    // bucket k (k > 0) holds [2^(MIN_LOG2 + k - 1), 2^(MIN_LOG2 + k)) cycles, the last one is open ended
+    uint32_t Hist[PROFILE_HIST_BUCKETS];
+} Profile_Stat_t;
+
+#ifndef PROFILE_NOW
+#define PROFILE_NOW() (DWT->CYCCNT)
+#endif
+
+#if PROFILE_ENABLE
+#define PROFILE_BEGIN(probe) uint32_t Profile_Start_##probe = PROFILE_NOW()
+#define PROFILE_END(probe) Profile_Record((probe), PROFILE_NOW() - Profile_Start_##probe)
+#else
+#define PROFILE_BEGIN(probe) ((void)0)
+#define PROFILE_END(probe) ((void)0)
+#endif
+
+void Profile_Record(Profile_Probe_e probe, uint32_t cycles);
+void Profile_Reset(void);
+const char *Profile_Name(Profile_Probe_e probe);
+float Profile_Mean_us(Profile_Probe_e probe);
+
+// 以文本表格式化全部探针, 返回长度 format all probes as a text table, returns the length
+uint16_t Profile_Format(char *buf, uint16_t size);
+// 每次调用发出下一帧, 数据帧格式见 profiler.c sends the next frame per call, see profiler.c for the layout
+HAL_StatusTypeDef Profile_Send_CAN(CAN_HandleTypeDef *hcan, uint16_t std_id);
+// 以遥测文本帧发送文本表 (与遥测共用串口), 上一次未发完时返回 HAL_BUSY
+// send the text table as telemetry text frames (sharing the telemetry UART), HAL_BUSY while the last one is still going
+HAL_StatusTypeDef Profile_Send_Telem(void);
+// 按 Profile_Dump_Mode 导出, 由低优先级任务周期调用 dump as selected by Profile_Dump_Mode, called periodically from a low priority task
+void Profile_Dump(void);
+
+extern Profile_Stat_t Profile_Stat[PROFILE_NUM];
+extern uint8_t Profile_Dump_Mode;
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * @file    snapshot.c
+ * @brief   双缓冲顺序锁快照 double-buffered seqlock snapshot
+ ******************************************************************************
+ * @attention
+ *
+ ******************************************************************************
+ */
+#include "snapshot.h"
+#include "main.h"
+#include <string.h>
+
+/**
+ * @param buf  2 * size 字节的存储 storage of 2 * size bytes
+ * @param init 初始值, 为 NULL 时清零 initial value, zeros when NULL
+ */
+void Snapshot_Init(Snapshot_t *snapshot, void *buf, uint16_t size, const void *init)
+{
+    snapshot->Buf = (uint8_t *)buf;
+    snapshot->Size = size;
+    snapshot->Seq = 0;
+    if (init == NULL)
+        memset(buf, 0, 2 * (uint32_t)size);
+    else
+    {
+        memcpy(snapshot->Buf, init, size);
+        memcpy(snapshot->Buf + size, init, size);
+    }
+}
+
+/**
+ * @brief 发布新值 publish a new value
+ * @note  序号加一后读者转向另一份副本, 先改写当前副本; 再加一后读者转回, 改写另一份
+ *        after the first increment readers switch to the other copy while the
+ *        current one is rewritten, after the second they switch back and the
+ *        other copy is rewritten
+ */
+void Snapshot_Publish(Snapshot_t *snapshot, const void *data)
+{
+    uint32_t seq = snapshot->Seq;
+
+    snapshot->Seq = seq + 1;
+    __DMB(); // 读者转向后才改写 rewrite only after readers moved away
+    memcpy(snapshot->Buf + (seq & 1) * snapshot->Size, data, snapshot->Size);
+    __DMB();
+    snapshot->Seq = seq + 2;
+    __DMB();
+    memcpy(snapshot->Buf + ((seq + 1) & 1) * snapshot->Size, data, snapshot->Size);
+}
+
+/**
+ * @brief  读取最近一次发布的值 read the most recently published value
+ * @retval 重读次数 number of retries
+ */
+uint32_t Snapshot_Read(Snapshot_t *snapshot, void *out)
+{
+    uint32_t seq, retry = 0;
+
+    while (1)
+    {
+        seq = snapshot->Seq;
+        __DMB(); // 先读序号再读数据 read the sequence number before the data
+        memcpy(out, snapshot->Buf + (seq & 1) * snapshot->Size, snapshot->Size);
+        __DMB(); // 数据读完后再核对序号 check the sequence number after the data
+        if (snapshot->Seq == seq)
+            return retry;
+        retry++;
+    }
+}
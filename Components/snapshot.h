@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file    snapshot.h
+ * @brief   双缓冲顺序锁快照 double-buffered seqlock snapshot
+ *          写者依次更新两份副本, 读者按序号选择当前未被改写的副本,
+ *          读取期间序号变化则重读. 不使用互斥量, 读者不关中断
+ *          the writer updates two copies in turn and readers pick the copy that
+ *          is not being written by the sequence number, retrying if it changed
+ *          while reading. No mutex, no interrupt masking on the reader side
+ ******************************************************************************
+ * @attention
+ * 同一快照只能有一个写者, 或各写者之间不会互相打断 (如同优先级中断).
+ * 中断中读取被任务打断的写入时不会重读, 任务中读取被中断打断时最多重读一次
+ * a snapshot takes one writer, or writers that never preempt each other (e.g.
+ * interrupts of the same priority). A reader in an interrupt that preempts
+ * the writing task never retries, a task reader preempted by the writing
+ * interrupt retries at most once per publish
+ ******************************************************************************
+ */
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include "stdint.h"
+
+typedef struct
+{
+    volatile uint32_t Seq; // 每次发布加 2, 读者使用副本 Seq & 1 incremented twice per publish, readers use copy Seq & 1
+    uint8_t *Buf;          // 2 * Size 字节 bytes
+    uint16_t Size;
+} Snapshot_t;
+
+// buf 须为两个元素的数组, 以便由 sizeof 推出大小 buf must be a two element array so the size follows from sizeof
+#define Snapshot_Init_Static(snapshot, buf, init) Snapshot_Init((snapshot), (buf), sizeof((buf)[0]), (init))
+
+void Snapshot_Init(Snapshot_t *snapshot, void *buf, uint16_t size, const void *init);
+void Snapshot_Publish(Snapshot_t *snapshot, const void *data);
+uint32_t Snapshot_Read(Snapshot_t *snapshot, void *out);
+
+// 发布次数, 可用于判断是否有新数据 number of publishes, tells whether new data arrived
+static inline uint32_t Snapshot_Count(const Snapshot_t *snapshot)
+{
+    return snapshot->Seq >> 1;
+}
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ ******************************************************************************
+ * @file    state_history.c
+ * @brief   带时间戳的状态历史 timestamped state history
+ ******************************************************************************
+ * @attention
+ *
+ ******************************************************************************
+ */
+#include "state_history.h"
+#include <math.h>
+#include <string.h>
+
+// 第 i 旧的帧在环形缓冲区中的位置, i = 0 为最旧
+// slot of the i-th oldest frame, i = 0 is the oldest
+static inline uint16_t History_Slot(History_t *history, uint16_t i)
+{
+    return (history->Head + history->Len - history->Count + i) % history->Len;
+}
+
+// 返回时间戳不晚于 match_time_stamp_us 的最新帧序号 (0 为最旧), 全部晚于时返回 -1
+// index (0 = oldest) of the newest frame not later than match_time_stamp_us, -1 if all are later
+static int32_t History_Search(History_t *history, uint64_t match_time_stamp_us)
+{
+    int32_t low = 0, high = (int32_t)history->Count - 1, mid, result = -1;
+
+    while (low <= high)
+    {
+        mid = (low + high) / 2;
+        if (history->TimeStamp_us[History_Slot(history, mid)] <= match_time_stamp_us)
+        {
+            result = mid;
+            low = mid + 1;
+        }
+        else
+            high = mid - 1;
+    }
+    return result;
+}
+
+void History_Init(History_t *history, void *frame_buf, uint64_t *time_stamp_buf,
+                  uint16_t frame_size, uint16_t len, History_Interp_f interp)
+{
+    history->Frame = (uint8_t *)frame_buf;
+    history->TimeStamp_us = time_stamp_buf;
+    history->FrameSize = frame_size;
+    history->Len = len;
+    history->Head = 0;
+    history->Count = 0;
+    history->Interp = interp;
+}
+
+void History_Insert(History_t *history, const void *frame, uint64_t time_stamp_us)
+{
+    memcpy(history->Frame + (uint32_t)history->Head * history->FrameSize, frame, history->FrameSize);
+    history->TimeStamp_us[history->Head] = time_stamp_us;
+    history->Head = (history->Head + 1) % history->Len;
+    if (history->Count < history->Len)
+        history->Count++;
+}
+
+/**
+ * @brief 查找时间戳最接近的帧 find the frame closest to the given timestamp
+ * @return 帧存储中的位置, 无数据时为 -1 slot in the frame storage, -1 when empty
+ */
+int32_t History_Find(History_t *history, uint64_t match_time_stamp_us)
+{
+    int32_t i;
+    uint16_t before, after;
+
+    if (history->Count == 0)
+        return -1;
+
+    i = History_Search(history, match_time_stamp_us);
+    if (i < 0)
+        return History_Slot(history, 0);
+    if (i == history->Count - 1)
+        return History_Slot(history, i);
+
+    before = History_Slot(history, i);
+    after = History_Slot(history, i + 1);
+    if (match_time_stamp_us - history->TimeStamp_us[before] <= history->TimeStamp_us[after] - match_time_stamp_us)
+        return before;
+    return after;
+}
+
+void *History_Get(History_t *history, uint16_t slot)
+{
+    return history->Frame + (uint32_t)slot * history->FrameSize;
+}
+
+/**
+ * @brief 在前后两帧之间插值, 超出记录范围时取端点帧
+ *        interpolate between the two bracketing frames,
+ *        clamped to the oldest/newest frame outside the recorded range
+ * @return 无数据时为 0 zero when the history is empty
+ */
+uint8_t History_Interp(History_t *history, uint64_t match_time_stamp_us, void *out)
+{
+    int32_t i;
+    uint16_t before, after;
+    uint64_t span;
+
+    if (history->Count == 0)
+        return 0;
+
+    i = History_Search(history, match_time_stamp_us);
+    if (i < 0)
+    {
+        memcpy(out, History_Get(history, History_Slot(history, 0)), history->FrameSize);
+        return 1;
+    }
+    before = History_Slot(history, i);
+    if (i == history->Count - 1 || history->Interp == NULL)
+    {
+        memcpy(out, History_Get(history, before), history->FrameSize);
+        return 1;
+    }
+    after = History_Slot(history, i + 1);
+
+    span = history->TimeStamp_us[after] - history->TimeStamp_us[before];
+    if (span == 0)
+    {
+        memcpy(out, History_Get(history, after), history->FrameSize);
+        return 1;
+    }
+    history->Interp(History_Get(history, before), History_Get(history, after),
+                    (float)(match_time_stamp_us - history->TimeStamp_us[before]) / (float)span, out);
+    return 1;
+}
+
+/*************************** interpolators ***************************/
+void History_Lerp_f32(const void *before, const void *after, float ratio, void *out)
+{
+    float a = *(const float *)before, b = *(const float *)after;
+    *(float *)out = a + (b - a) * ratio;
+}
+
+// 角度在 [-180, 180] 内, 跨越 ±180 时按最短路径插值
+// angles lie in [-180, 180], interpolation takes the short way across ±180
+void History_Lerp_Angle_Deg(const void *before, const void *after, float ratio, void *out)
+{
+    float a = *(const float *)before, b = *(const float *)after;
+    float delta = b - a, result;
+
+    if (delta > 180.0f)
+        delta -= 360.0f;
+    else if (delta < -180.0f)
+        delta += 360.0f;
+
+    result = a + delta * ratio;
+    if (result > 180.0f)
+        result -= 360.0f;
+    else if (result < -180.0f)
+        result += 360.0f;
+    *(float *)out = result;
+}
+
+// 单位四元数 [w x y z] 球面线性插值 spherical linear interpolation of unit quaternions
+void History_Slerp_Quaternion(const void *before, const void *after, float ratio, void *out)
+{
+    const float *qa = (const float *)before, *qb = (const float *)after;
+    float *q = (float *)out;
+    float dot = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+    float sign = 1.0f, ka, kb, theta, sin_theta, norm;
+
+    // q 与 -q 表示同一姿态, 取较短的弧
+    // q and -q are the same attitude, take the shorter arc
+    if (dot < 0)
+    {
+        dot = -dot;
+        sign = -1.0f;
+    }
+
+    if (dot > 0.9995f)
+    {
+        // 夹角很小时退化为线性插值再归一化 nearly parallel: lerp and renormalize
+        ka = 1.0f - ratio;
+        kb = ratio;
+    }
+    else
+    {
+        theta = acosf(dot);
+        sin_theta = sinf(theta);
+        ka = sinf((1.0f - ratio) * theta) / sin_theta;
+        kb = sinf(ratio * theta) / sin_theta;
+    }
+    kb *= sign;
+
+    for (uint8_t i = 0; i < 4; i++)
+        q[i] = ka * qa[i] + kb * qb[i];
+
+    norm = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (uint8_t i = 0; i < 4; i++)
+        q[i] /= norm;
+}
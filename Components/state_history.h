@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * @file    state_history.h
+ * @brief   带时间戳的状态历史 timestamped state history
+ *          环形缓冲区 O(1) 写入, 二分查找 O(log n) 按时间检索,
+ *          插值方式由调用者指定 (角度线性插值 / 四元数球面插值)
+ *          O(1) insert into a ring buffer, O(log n) lookup by time,
+ *          with a caller supplied interpolator (angle lerp / quaternion slerp)
+ ******************************************************************************
+ * @attention
+ * 存储由调用者静态分配, 时间戳为 DWT_GetTimeline_us() 的微秒整数, 须单调递增
+ * storage is statically allocated by the caller, timestamps are integer
+ * microseconds from DWT_GetTimeline_us() and must not decrease
+ ******************************************************************************
+ */
+#ifndef _STATE_HISTORY_H
+#define _STATE_HISTORY_H
+
+#include "stdint.h"
+
+/**
+ * @brief 插值函数 interpolator
+ * @param before 较早的帧 earlier frame
+ * @param after  较晚的帧 later frame
+ * @param ratio  [0, 1], 0 对应 before
+ * @param out    插值结果 interpolated frame
+ */
+typedef void (*History_Interp_f)(const void *before, const void *after, float ratio, void *out);
+
+typedef struct
+{
+    uint8_t *Frame;         // Len * FrameSize 字节的帧存储 frame storage
+    uint64_t *TimeStamp_us; // 每帧时间戳 per frame timestamps
+    uint16_t FrameSize;
+    uint16_t Len;
+    uint16_t Head;  // 下一次写入位置 next slot to write
+    uint16_t Count; // 有效帧数 number of valid frames
+
+    History_Interp_f Interp;
+} History_t;
+
+// frame_buf 与 time_stamp_buf 须为数组, 以便由 sizeof 推出帧大小和长度
+// frame_buf and time_stamp_buf must be arrays so frame size and length follow from sizeof
+#define History_Init_Static(history, frame_buf, time_stamp_buf, interp)                                  \
+    History_Init((history), (frame_buf), (time_stamp_buf), sizeof((frame_buf)[0]),                       \
+                 sizeof(time_stamp_buf) / sizeof((time_stamp_buf)[0]), (interp))
+
+void History_Init(History_t *history, void *frame_buf, uint64_t *time_stamp_buf,
+                  uint16_t frame_size, uint16_t len, History_Interp_f interp);
+void History_Insert(History_t *history, const void *frame, uint64_t time_stamp_us);
+int32_t History_Find(History_t *history, uint64_t match_time_stamp_us);
+void *History_Get(History_t *history, uint16_t slot);
+uint8_t History_Interp(History_t *history, uint64_t match_time_stamp_us, void *out);
+
+// 插值函数 interpolators
+void History_Lerp_f32(const void *before, const void *after, float ratio, void *out);
+void History_Lerp_Angle_Deg(const void *before, const void *after, float ratio, void *out);
+void History_Slerp_Quaternion(const void *before, const void *after, float ratio, void *out);
+
+#endif
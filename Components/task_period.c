@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ * @file    task_period.c
+ * @brief   按绝对唤醒时刻运行的周期任务 periodic task loop on absolute wake-up times
+ ******************************************************************************
+ * @attention
+ *
+ ******************************************************************************
+ */
+#include "task_period.h"
+#include "main.h"
+#include <math.h>
+
+// 记录本周期开始 record the start of a cycle
+static void TaskPeriod_Start(TaskPeriod_t *period)
+{
+    uint32_t now = DWT->CYCCNT;
+    uint32_t interval = now - period->Start_cyc;
+    float cyc_per_us = SystemCoreClock * 1e-6f;
+
+    period->Start_cyc = now;
+    if (period->Cycle++ == 0)
+        return;
+
+    period->dt = interval / (float)SystemCoreClock;
+    period->Jitter_us = ((int32_t)(interval - period->Period_cyc)) / cyc_per_us;
+    period->JitterAbsSum_us += fabsf(period->Jitter_us);
+    if (fabsf(period->Jitter_us) > period->JitterMax_us)
+        period->JitterMax_us = fabsf(period->Jitter_us);
+}
+
+// 记录本周期的执行时间 record the execution time of this cycle
+static void TaskPeriod_End(TaskPeriod_t *period)
+{
+    period->Exec_us = (uint32_t)(DWT->CYCCNT - period->Start_cyc) / (SystemCoreClock * 1e-6f);
+    if (period->Exec_us > period->ExecMax_us)
+        period->ExecMax_us = period->Exec_us;
+}
+
+/**
+ * @brief 以当前时刻为第一周期的开始 start the first cycle now
+ */
+void TaskPeriod_Init(TaskPeriod_t *period, uint32_t period_ms)
+{
+    period->Period = pdMS_TO_TICKS(period_ms) ? pdMS_TO_TICKS(period_ms) : 1;
+    period->Period_cyc = period->Period * (SystemCoreClock / configTICK_RATE_HZ);
+    period->LastWake = xTaskGetTickCount();
+    period->Cycle = 0;
+    period->dt = period->Period / (float)configTICK_RATE_HZ;
+    TaskPeriod_Reset_Stat(period);
+    TaskPeriod_Start(period);
+}
+
+void TaskPeriod_Reset_Stat(TaskPeriod_t *period)
+{
+    period->Jitter_us = 0;
+    period->JitterMax_us = 0;
+    period->JitterAbsSum_us = 0;
+    period->Exec_us = 0;
+    period->ExecMax_us = 0;
+    period->Overrun = 0;
+    period->Skipped = 0;
+}
+
+/**
+ * @brief 结束本周期, 阻塞到下一周期的唤醒时刻 end this cycle and block until the next wake-up time
+ * @note  已错过下一唤醒时刻时立即开始下一周期; 错过不止一个周期时丢弃无法按时运行的周期,
+ *        相位保持不变, 不会为补足而连续运行
+ *        if the next wake-up time has already passed the next cycle starts at once;
+ *        if more than one was missed, the cycles that can no longer run on time are
+ *        dropped with the phase kept, rather than run back to back
+ */
+void TaskPeriod_Wait(TaskPeriod_t *period)
+{
+    TickType_t now = xTaskGetTickCount();
+    TickType_t late = now - period->LastWake;
+    TickType_t missed;
+
+    TaskPeriod_End(period);
+
+    if (late >= period->Period)
+    {
+        missed = late / period->Period;
+        period->Overrun++;
+        period->Skipped += missed - 1;
+        period->LastWake += missed * period->Period;
+    }
+    else
+        vTaskDelayUntil(&period->LastWake, period->Period);
+
+    TaskPeriod_Start(period);
+}
+
+/**
+ * @brief  结束本周期, 阻塞到下一个任务通知, 超时也开始下一周期
+ *         end this cycle and block until the next task notification, a timeout starts the next cycle too
+ * @param  timeout_ms 最长等待时间 longest wait
+ * @retval 取走的通知数, 0 为超时 notifications taken, 0 on timeout
+ */
+uint32_t TaskPeriod_Wait_Notify(TaskPeriod_t *period, uint32_t timeout_ms)
+{
+    uint32_t count;
+
+    TaskPeriod_End(period);
+
+    count = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    if (count > 1)
+    {
+        period->Overrun++;
+        period->Skipped += count - 1;
+    }
+    period->LastWake = xTaskGetTickCount();
+
+    TaskPeriod_Start(period);
+    return count;
+}
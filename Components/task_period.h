@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * @file    task_period.h
+ * @brief   按绝对唤醒时刻运行的周期任务 periodic task loop on absolute wake-up times
+ *          以 vTaskDelayUntil() 代替 osDelay(), 周期不再叠加执行时间;
+ *          以 DWT->CYCCNT 记录每周期开始时刻的抖动、执行时间与超时次数
+ *          vTaskDelayUntil() replaces osDelay(), so the period no longer grows by
+ *          the execution time; DWT->CYCCNT records the start jitter, execution
+ *          time and overruns of every cycle
+ ******************************************************************************
+ * @attention
+ * 用法 usage:
+ *   TaskPeriod_Init(&period, PERIOD_MS);
+ *   for (;;) { work(); TaskPeriod_Wait(&period); }
+ * 超时后下一周期立即开始, 错过的其余周期不补跑, 唤醒相位保持不变
+ * after an overrun the next cycle starts at once, further missed cycles are
+ * dropped and the wake-up phase is kept
+ * 由事件 (如传感器数据就绪) 定时的任务改用 TaskPeriod_Wait_Notify(), 每个任务通知开始一个周期,
+ * 等待时已积累的多个通知计为超时
+ * tasks timed by an event (e.g. sensor data ready) use TaskPeriod_Wait_Notify() instead, every
+ * task notification starts a cycle, several notifications piled up while waiting count as an overrun
+ ******************************************************************************
+ */
+#ifndef _TASK_PERIOD_H
+#define _TASK_PERIOD_H
+
+#include "stdint.h"
+#include "cmsis_os.h"
+
+typedef struct
+{
+    TickType_t LastWake; // 本周期的标称唤醒时刻 nominal wake-up tick of this cycle
+    TickType_t Period;   // 周期, 系统节拍数 period in RTOS ticks
+    uint32_t Period_cyc; // 周期, CPU 周期数 period in CPU cycles
+
+    uint32_t Cycle;       // 已开始的周期数 number of cycles started
+    uint32_t Start_cyc;   // 本周期开始时的 DWT->CYCCNT cycle counter at the start of this cycle
+    float dt;             // 与上一周期开始的间隔 time since the start of the previous cycle, s
+    float Jitter_us;      // 本周期开始间隔减去周期 start-to-start interval minus the period
+    float JitterMax_us;   // |Jitter_us| 最大值 largest |Jitter_us|
+    float JitterAbsSum_us; // |Jitter_us| 之和, 除以 Cycle - 1 为平均值 sum of |Jitter_us|, divide by Cycle - 1 for the mean
+    float Exec_us;        // 上一周期的执行时间 execution time of the last cycle
+    float ExecMax_us;
+    uint32_t Overrun; // 执行超过周期的次数 cycles that ran past their deadline
+    uint32_t Skipped; // 因超时错过的周期数 cycles lost to overruns
+} TaskPeriod_t;
+
+void TaskPeriod_Init(TaskPeriod_t *period, uint32_t period_ms);
+void TaskPeriod_Wait(TaskPeriod_t *period);
+uint32_t TaskPeriod_Wait_Notify(TaskPeriod_t *period, uint32_t timeout_ms);
+void TaskPeriod_Reset_Stat(TaskPeriod_t *period);
+
+#endif
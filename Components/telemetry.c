@@ -0,0 +1,280 @@
+/**
+ ******************************************************************************
+ * @file    telemetry.c
+ * @brief   二进制遥测 binary telemetry
+ ******************************************************************************
+ * @attention
+ * 发送队列为单生产者 (Telem_Sample() 所在的控制任务) 单消费者 (遥测任务) 无锁环形队列,
+ * 数值按内存原样拷贝, 固件与主机均为小端
+ * the transmit queue is a single producer (the control task calling Telem_Sample()),
+ * single consumer (the telemetry task) lock-free ring; values are copied as they are
+ * in memory, firmware and host are both little endian
+ ******************************************************************************
+ */
+#include "telemetry.h"
+#include "bsp_dwt.h"
+#include "crc8_16.h"
+#include <string.h>
+
+typedef enum
+{
+    TELEM_TX_IDLE = 0,
+    TELEM_TX_DATA,
+    TELEM_TX_SCHEMA,
+    TELEM_TX_TEXT,
+} Telem_Tx_e;
+
+static const uint8_t Telem_Type_Size[] = {
+    [TELEM_FLOAT] = 4,
+    [TELEM_INT16] = 2,
+    [TELEM_UINT32] = 4,
+};
+
+Telem_Config_t Telem_Config = {.Mask = TELEM_DEFAULT_MASK, .Decimation = 0}; // 可在调试器中修改 may be changed from the debugger
+Telem_Stat_t Telem_Stat;
+
+static UART_HandleTypeDef *Telem_Huart = NULL;
+static Telem_Channel_t Telem_Channel[TELEM_CHANNEL_MAX];
+static volatile uint64_t Telem_Registered = 0;
+
+static uint8_t Telem_Queue[TELEM_QUEUE_LEN][TELEM_FRAME_MAX];
+static uint16_t Telem_Queue_Len[TELEM_QUEUE_LEN];
+static volatile uint8_t Telem_Head = 0; // 仅控制任务写 written by the control task only
+static volatile uint8_t Telem_Tail = 0; // 仅遥测任务写 written by the telemetry task only
+static uint16_t Telem_Seq = 0;
+
+static uint8_t Telem_Schema_Frame[TELEM_HEADER_LEN + 2 + TELEM_NAME_LEN + 2];
+static uint8_t Telem_Tx = TELEM_TX_IDLE;
+
+// 文本由调用方写入后置 Telem_Text_Len, 遥测任务发完最后一段后清零
+// the caller sets Telem_Text_Len once the text is in place, the telemetry task clears it after the last piece
+static const char *Telem_Text = NULL;
+static volatile uint16_t Telem_Text_Len = 0;
+static uint16_t Telem_Text_Pos = 0, Telem_Text_Piece = 0;
+static uint8_t Telem_Text_Frame[TELEM_HEADER_LEN + TELEM_TEXT_CHUNK + 2];
+
+void Telem_Init(UART_HandleTypeDef *huart)
+{
+    Telem_Huart = huart;
+}
+
+int8_t Telem_Register(uint8_t id, const char *name, const void *addr, Telem_Type_e type)
+{
+    if (id >= TELEM_CHANNEL_MAX || addr == NULL || type > TELEM_UINT32 || (Telem_Registered & TELEM_BIT(id)))
+        return -1;
+
+    Telem_Channel[id].Addr = addr;
+    Telem_Channel[id].Name = name;
+    Telem_Channel[id].Type = type;
+    __DMB(); // 表项写完后才生效 the entry takes effect only once written
+    Telem_Registered |= TELEM_BIT(id);
+    return 0;
+}
+
+int8_t Telem_Select(uint64_t mask)
+{
+    uint8_t n = 0;
+
+    for (uint8_t id = 0; id < TELEM_CHANNEL_MAX; id++)
+        n += (mask >> id) & 1;
+    if (n > TELEM_FRAME_CHANNELS)
+        return -1;
+    Telem_Config.Mask = mask;
+    return 0;
+}
+
+// 负载已写在 frame + TELEM_HEADER_LEN, 补上帧头与 CRC, 返回帧长
+// the payload is already at frame + TELEM_HEADER_LEN, add the header and CRC, returns the frame length
+static uint16_t Telem_Finish(uint8_t *frame, uint8_t type, uint16_t seq, uint16_t len)
+{
+    uint16_t crc;
+
+    frame[0] = TELEM_SOF;
+    frame[1] = type;
+    frame[2] = len & 0xFF;
+    frame[3] = len >> 8;
+    frame[4] = seq & 0xFF;
+    frame[5] = seq >> 8;
+    crc = CRC16_Update(0xFFFF, frame, TELEM_HEADER_LEN + len);
+    frame[TELEM_HEADER_LEN + len] = crc & 0xFF;
+    frame[TELEM_HEADER_LEN + len + 1] = crc >> 8;
+
+    return TELEM_HEADER_LEN + len + 2;
+}
+
+void Telem_Sample(void)
+{
+    static uint16_t count = 0;
+    uint64_t selected, mask = 0;
+    uint32_t timestamp;
+    uint8_t *frame, *p, slot, n = 0;
+    uint16_t seq;
+
+    if (Telem_Config.Decimation == 0 || Telem_Huart == NULL)
+        return;
+    if (++count < Telem_Config.Decimation)
+        return;
+    count = 0;
+
+    seq = Telem_Seq++;
+    if ((uint8_t)(Telem_Head - Telem_Tail) >= TELEM_QUEUE_LEN)
+    {
+        Telem_Stat.Dropped++;
+        return;
+    }
+
+    slot = Telem_Head % TELEM_QUEUE_LEN;
+    frame = Telem_Queue[slot];
+    p = frame + TELEM_HEADER_LEN + TELEM_DATA_HEADER_LEN;
+    timestamp = (uint32_t)DWT_GetTimeline_us();
+
+    // 超出每帧上限的通道 (在调试器中改掩码时可能出现) 不发送
+    // channels beyond the per-frame limit (possible when the mask is edited in the debugger) are left out
+    selected = Telem_Config.Mask & Telem_Registered;
+    for (uint8_t id = 0; id < TELEM_CHANNEL_MAX && n < TELEM_FRAME_CHANNELS; id++)
+    {
+        if (!(selected & TELEM_BIT(id)))
+            continue;
+        memcpy(p, Telem_Channel[id].Addr, Telem_Type_Size[Telem_Channel[id].Type]);
+        p += Telem_Type_Size[Telem_Channel[id].Type];
+        mask |= TELEM_BIT(id);
+        n++;
+    }
+
+    memcpy(frame + TELEM_HEADER_LEN, &timestamp, 4);
+    memcpy(frame + TELEM_HEADER_LEN + 4, &mask, 8);
+    Telem_Queue_Len[slot] = Telem_Finish(frame, TELEM_FRAME_DATA, seq, p - frame - TELEM_HEADER_LEN);
+
+    __DMB(); // 帧写完后才发布 publish only after the frame is written
+    Telem_Head++;
+    Telem_Stat.Frames++;
+}
+
+// 下一个已登记通道的 schema 帧, 无已登记通道时返回 0
+// schema frame of the next registered channel, returns 0 when none is registered
+static uint16_t Telem_Next_Schema(void)
+{
+    static uint8_t next = 0;
+    uint64_t registered = Telem_Registered;
+    uint8_t *p = Telem_Schema_Frame + TELEM_HEADER_LEN;
+    uint16_t len;
+    uint8_t id;
+
+    if (registered == 0)
+        return 0;
+    while (!(registered & TELEM_BIT(next)))
+        next = (next + 1) % TELEM_CHANNEL_MAX;
+    id = next;
+    next = (next + 1) % TELEM_CHANNEL_MAX;
+
+    len = strnlen(Telem_Channel[id].Name, TELEM_NAME_LEN);
+    p[0] = id;
+    p[1] = Telem_Channel[id].Type;
+    memcpy(p + 2, Telem_Channel[id].Name, len);
+    return Telem_Finish(Telem_Schema_Frame, TELEM_FRAME_SCHEMA, id, len + 2);
+}
+
+HAL_StatusTypeDef Telem_Send_Text(const char *text, uint16_t len)
+{
+    if (Telem_Huart == NULL || text == NULL)
+        return HAL_ERROR;
+    if (Telem_Text_Len != 0)
+        return HAL_BUSY;
+    if (len == 0)
+        return HAL_OK;
+
+    Telem_Text = text;
+    __DMB(); // 文本就绪后才交给遥测任务 hand over to the telemetry task only once the text is in place
+    Telem_Text_Len = len;
+    return HAL_OK;
+}
+
+uint8_t Telem_Text_Busy(void)
+{
+    return Telem_Text_Len != 0;
+}
+
+// 发出文本的下一段 send the next piece of the text
+static void Telem_Send_Text_Piece(void)
+{
+    uint16_t len;
+
+    if (Telem_Text_Len == 0)
+        return;
+    __DMB(); // 先读 Telem_Text_Len 再读文本 read Telem_Text_Len before the text
+
+    Telem_Text_Piece = Telem_Text_Len - Telem_Text_Pos;
+    if (Telem_Text_Piece > TELEM_TEXT_CHUNK)
+        Telem_Text_Piece = TELEM_TEXT_CHUNK;
+    memcpy(Telem_Text_Frame + TELEM_HEADER_LEN, Telem_Text + Telem_Text_Pos, Telem_Text_Piece);
+    len = Telem_Finish(Telem_Text_Frame, TELEM_FRAME_TEXT, Telem_Text_Pos, Telem_Text_Piece);
+    if (HAL_UART_Transmit_DMA(Telem_Huart, Telem_Text_Frame, len) == HAL_OK)
+    {
+        Telem_Tx = TELEM_TX_TEXT;
+        Telem_Stat.Text++;
+        Telem_Stat.Bytes += len;
+    }
+}
+
+void Telem_Task(void)
+{
+    static uint16_t count = 0;
+    uint8_t slot;
+    uint16_t len;
+
+    if (Telem_Huart == NULL)
+        return;
+    // 上一次 DMA 未完成 (或串口被其他发送方占用) the last DMA is still running (or another sender holds the UART)
+    if (Telem_Huart->gState != HAL_UART_STATE_READY)
+        return;
+
+    if (Telem_Tx == TELEM_TX_DATA)
+    {
+        __DMB(); // DMA 读完后才释放 release only after the DMA has read the frame
+        Telem_Tail++;
+    }
+    else if (Telem_Tx == TELEM_TX_TEXT)
+    {
+        Telem_Text_Pos += Telem_Text_Piece;
+        if (Telem_Text_Pos >= Telem_Text_Len)
+        {
+            Telem_Text_Pos = 0;
+            __DMB(); // 最后一段发完后才交还文本 return the text only after its last piece is sent
+            Telem_Text_Len = 0;
+        }
+    }
+    Telem_Tx = TELEM_TX_IDLE;
+
+    // 遥测关闭时只发文本 only text while telemetry is off
+    if (Telem_Config.Decimation == 0)
+    {
+        Telem_Send_Text_Piece();
+        return;
+    }
+
+    if (++count >= TELEM_SCHEMA_PERIOD)
+    {
+        len = Telem_Next_Schema();
+        if (len && HAL_UART_Transmit_DMA(Telem_Huart, Telem_Schema_Frame, len) == HAL_OK)
+        {
+            count = 0;
+            Telem_Tx = TELEM_TX_SCHEMA;
+            Telem_Stat.Schema++;
+            Telem_Stat.Bytes += len;
+            return;
+        }
+    }
+
+    if (Telem_Tail == Telem_Head)
+    {
+        Telem_Send_Text_Piece();
+        return;
+    }
+    __DMB(); // 先读 Head 再读帧 read Head before the frame
+    slot = Telem_Tail % TELEM_QUEUE_LEN;
+    if (HAL_UART_Transmit_DMA(Telem_Huart, Telem_Queue[slot], Telem_Queue_Len[slot]) == HAL_OK)
+    {
+        Telem_Tx = TELEM_TX_DATA;
+        Telem_Stat.Bytes += Telem_Queue_Len[slot];
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ * @file    telemetry.h
+ * @brief   二进制遥测 binary telemetry
+ *          变量 (float/int16/uint32) 按通道号登记, 控制周期末 Telem_Sample() 将选中的通道
+ *          按通道号升序打包为一帧放入发送队列, 遥测任务经 DMA 串口发出, 并轮流发送各通道的
+ *          名称/类型 (schema 帧), 上位机 (Host/telem_decode.c) 据此解出 CSV
+ *          variables (float/int16/uint32) are registered under a channel ID; at the end of a
+ *          control tick Telem_Sample() packs the selected channels in ascending ID order into
+ *          one frame on the transmit queue, the telemetry task sends it by UART DMA and cycles
+ *          through the name/type of every channel (schema frames), from which the host
+ *          (Host/telem_decode.c) writes CSV
+ ******************************************************************************
+ * @attention
+ * 帧格式, 小端 frame layout, little endian:
+ *   [0]      TELEM_SOF
+ *   [1]      帧类型 frame type, Telem_Frame_e
+ *   [2..3]   负载长度 n payload length n
+ *   [4..5]   序号 sequence; 数据帧每次采样加一 (队列满丢帧时也加一), schema 帧为通道号
+ *            data frames count samples (also the ones dropped on a full queue), schema frames carry the ID
+ *   [6..5+n] 负载 payload
+ *   [6+n..7+n] CRC16 (crc8_16.h), 覆盖 [0..5+n] over [0..5+n]
+ * 数据帧负载 data payload: 时间戳 timestamp us (uint32) | 通道掩码 channel mask (uint64) | 各通道值 values
+ * schema 帧负载 schema payload: 通道号 ID (uint8) | 类型 type (uint8) | 名称 name (n - 2 字节 bytes, 无结尾 0 no NUL)
+ * 文本帧负载 text payload: 一段文本, 序号为该段在整段文本中的字节偏移, 偏移 0 开始新的文本
+ *   a piece of text, the sequence is its byte offset in the whole text and offset 0 starts a new one
+ * 带宽 bandwidth: 每帧 frame 20 + 4 * float/uint32 + 2 * int16 字节 bytes, 921600 波特约 92 字节/ms bytes/ms
+ * 通道应在初始化时登记, 登记不加锁 register channels during init, registration takes no lock
+ ******************************************************************************
+ */
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+#include "main.h"
+#include "usart.h"
+#include "stdint.h"
+
+#define TELEM_CHANNEL_MAX 64   // 通道号 0~63, 选择为 64 位掩码 IDs 0 to 63, the selection is a 64 bit mask
+#define TELEM_FRAME_CHANNELS 32 // 每帧最多通道数 channels per frame at most
+#define TELEM_QUEUE_LEN 8
+#define TELEM_SOF 0xA5
+#define TELEM_HEADER_LEN 6
+#define TELEM_NAME_LEN 24
+#define TELEM_DATA_HEADER_LEN 12
+#define TELEM_FRAME_MAX (TELEM_HEADER_LEN + TELEM_DATA_HEADER_LEN + TELEM_FRAME_CHANNELS * 4 + 2)
+#define TELEM_SCHEMA_PERIOD 10 // 每 10 次 Telem_Task() 发一个通道的 schema one channel schema per 10 Telem_Task() calls
+#define TELEM_TASK_PERIOD 1
+#define TELEM_TEXT_CHUNK 128 // 每个文本帧的最大负载 largest payload of a text frame
+
+typedef enum
+{
+    TELEM_FLOAT = 0,
+    TELEM_INT16,
+    TELEM_UINT32,
+} Telem_Type_e;
+
+typedef enum
+{
+    TELEM_FRAME_DATA = 1,
+    TELEM_FRAME_SCHEMA,
+    TELEM_FRAME_TEXT,
+} Telem_Frame_e;
+
+// 通道号分配, 上位机只依赖 schema 帧, 编号可以调整
+// channel IDs, the host relies on the schema frames only, so they may be renumbered
+typedef enum
+{
+    // 底盘运动估计 chassis motion estimate
+    TELEM_CHASSIS_POS_X = 0,
+    TELEM_CHASSIS_POS_Y,
+    TELEM_CHASSIS_VEL_X,
+    TELEM_CHASSIS_VEL_Y,
+    TELEM_CHASSIS_ACC_X,
+    TELEM_CHASSIS_ACC_Y,
+    TELEM_CHASSIS_ODOM_VX, // 轮速反解 wheel odometry
+    TELEM_CHASSIS_ODOM_VY,
+    // 底盘控制 chassis control
+    TELEM_CHASSIS_VX_SET,
+    TELEM_CHASSIS_VY_SET,
+    TELEM_CHASSIS_VR_SET,
+    TELEM_WHEEL1_RPM,
+    TELEM_WHEEL2_RPM,
+    TELEM_WHEEL3_RPM,
+    TELEM_WHEEL4_RPM,
+    TELEM_WHEEL1_OUT,
+    TELEM_WHEEL2_OUT,
+    TELEM_WHEEL3_OUT,
+    TELEM_WHEEL4_OUT,
+    TELEM_CHASSIS_CYCLE,
+    // 姿态 attitude
+    TELEM_INS_YAW = 32,
+    TELEM_INS_PITCH,
+    TELEM_INS_ROLL,
+    TELEM_INS_GVEC_X,
+    TELEM_INS_GVEC_Y,
+    TELEM_INS_GVEC_Z,
+    TELEM_INS_ACCEL_X,
+    TELEM_INS_ACCEL_Y,
+    TELEM_INS_ACCEL_Z,
+    TELEM_INS_GYRO_X,
+    TELEM_INS_GYRO_Y,
+    TELEM_INS_GYRO_Z,
+    TELEM_IMU_TEMP,
+    TELEM_IMU_HEAT_OUT,
+} Telem_Id_e;
+
+#define TELEM_BIT(id) ((uint64_t)1 << (id))
+// 默认选择: 底盘估计器的全部状态与量测 (轮速与加速度计) default selection: all state and measurements (wheels and accelerometer) of the chassis estimator
+#define TELEM_DEFAULT_MASK ((TELEM_BIT(TELEM_CHASSIS_ODOM_VY + 1) - 1) | TELEM_BIT(TELEM_INS_ACCEL_X) | TELEM_BIT(TELEM_INS_ACCEL_Y))
+
+typedef struct
+{
+    const void *Addr;
+    const char *Name;
+    uint8_t Type;
+} Telem_Channel_t;
+
+typedef struct
+{
+    uint64_t Mask;       // 选中的通道, 最多 TELEM_FRAME_CHANNELS 个 selected channels, TELEM_FRAME_CHANNELS at most
+    uint16_t Decimation; // 每 Decimation 次采样发一帧, 0 为关闭 one frame per Decimation samples, 0 is off
+} Telem_Config_t;
+
+typedef struct
+{
+    uint32_t Frames;  // 入队的数据帧 data frames queued
+    uint32_t Dropped; // 队列满丢弃的数据帧 data frames dropped on a full queue
+    uint32_t Schema;  // 发出的 schema 帧 schema frames sent
+    uint32_t Text;    // 发出的文本帧 text frames sent
+    uint32_t Bytes;   // 发出的字节数 bytes sent
+} Telem_Stat_t;
+
+void Telem_Init(UART_HandleTypeDef *huart);
+// 通道号越界或已被占用时返回 -1 returns -1 when the ID is out of range or taken
+int8_t Telem_Register(uint8_t id, const char *name, const void *addr, Telem_Type_e type);
+#define Telem_Register_Float(id, name, addr) Telem_Register((id), (name), (const float *)(addr), TELEM_FLOAT)
+#define Telem_Register_Int16(id, name, addr) Telem_Register((id), (name), (const int16_t *)(addr), TELEM_INT16)
+#define Telem_Register_Uint32(id, name, addr) Telem_Register((id), (name), (const uint32_t *)(addr), TELEM_UINT32)
+// 超过 TELEM_FRAME_CHANNELS 个通道时返回 -1 且不改变选择 returns -1 and keeps the selection above TELEM_FRAME_CHANNELS channels
+int8_t Telem_Select(uint64_t mask);
+
+// 由控制任务在每个周期末调用 called by the control task at the end of every tick
+void Telem_Sample(void);
+// 由遥测任务每 TELEM_TASK_PERIOD ms 调用, 发出队首帧或一个 schema 帧, 二者皆无时发出一个文本帧
+// called by the telemetry task every TELEM_TASK_PERIOD ms, sends the oldest frame or one schema
+// frame, or one text frame when there is neither
+void Telem_Task(void);
+// 将 text 分段为文本帧发出, 遥测关闭时同样发送; 上一段文本未发完时返回 HAL_BUSY
+// text 不拷贝, 在 Telem_Text_Busy() 返回 0 之前不可改写
+// sends text split into text frames, also while telemetry is off; HAL_BUSY while the last text is
+// still going; text is not copied and must stay intact until Telem_Text_Busy() returns 0
+HAL_StatusTypeDef Telem_Send_Text(const char *text, uint16_t len);
+uint8_t Telem_Text_Busy(void);
+
+extern Telem_Config_t Telem_Config;
+extern Telem_Stat_t Telem_Stat;
+
+#endif
@@ -0,0 +1,291 @@
+/**
+ ******************************************************************************
+ * @file    port.c
+ * @brief   FreeRTOS 主机移植层 host (x86 Linux) port of the FreeRTOS kernel
+ *          1. 每个任务一个 ucontext 协程, 执行栈分配在主机堆上; FreeRTOS 分配的
+ *             任务栈只在栈顶保存协程指针, 栈/堆占用仍按固件的字长计算
+ *          2. 虚拟时钟每次推进后检查 1 ms 节拍, 在模拟的中断上下文中调用
+ *             xTaskIncrementTick(), 错过的节拍逐个补发
+ *          3. 中断屏蔽期间 (临界区/中断中) 的切换请求挂起, 解除屏蔽时执行, 与 PendSV 相同
+ *          4. 空闲任务替换为推进虚拟时钟到下一个节拍, 没有就绪任务时时间直接跳过
+ *          1. one ucontext coroutine per task with its execution stack on the host heap;
+ *             the stack allocated by FreeRTOS only holds the coroutine pointer at its top,
+ *             so stack and heap usage still follow the firmware word size
+ *          2. the virtual clock checks the 1 ms tick after every advance and calls
+ *             xTaskIncrementTick() in an emulated interrupt, missed ticks are caught up one by one
+ *          3. switch requests while interrupts are masked (critical section or interrupt) pend
+ *             until unmasked, as PendSV does
+ *          4. the idle task is replaced by advancing the virtual clock to the next tick,
+ *             time jumps ahead while no task is ready
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  调度在单线程上完成, 不使用信号与主机线程, 同一输入下结果逐位可复现
+ *  scheduling runs on one thread without signals or host threads, runs are bit-reproducible
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_rtos.h"
+
+// 主机上 printf 等库函数的栈需求远大于固件, 执行栈不按任务栈深度分配
+// host library calls such as printf need far more stack than the firmware, so the execution stack ignores the task stack depth
+#define PORT_EXEC_STACK_SIZE (256 * 1024)
+
+typedef struct
+{
+    ucontext_t Context;
+    void *Stack;
+    TaskFunction_t Code;
+    void *Parameters;
+} Port_Thread_t;
+
+extern void *volatile pxCurrentTCB;
+
+static ucontext_t Port_Main_Context;
+// 调度器启动前保持屏蔽, 与 ARM_CM4F 移植相同 stays masked until the scheduler starts, as in the ARM_CM4F port
+static UBaseType_t Port_Critical_Nesting = 0xaaaaaaaa;
+static uint32_t Port_Interrupt_Mask = 1;
+static uint8_t Port_In_ISR = 0;
+static uint8_t Port_Yield_Pending = 0;
+static uint8_t Port_Started = 0;
+static uint64_t Port_Tick_ms; // 已送达的节拍 ticks delivered so far
+
+static void (*Port_Tick_Hook)(void) = NULL;
+static uint64_t Port_Stop_us = UINT64_MAX;
+static int (*Port_Stop_Report)(void) = NULL;
+
+Host_RTOS_Stat_t Host_RTOS_Stat;
+
+static Port_Thread_t *Port_Thread_Of(void *tcb)
+{
+    // TCB 的第一个成员为 pxTopOfStack, 协程指针保存在该处且不再改变
+    // pxTopOfStack is the first TCB member, the coroutine pointer stored there never moves
+    StackType_t *top = *(StackType_t **)tcb;
+    Port_Thread_t *thread;
+
+    memcpy(&thread, top, sizeof(thread));
+    return thread;
+}
+
+static void Port_Task_Entry(void)
+{
+    Port_Thread_t *thread = Port_Thread_Of(pxCurrentTCB);
+
+    thread->Code(thread->Parameters);
+    // 任务函数不允许返回 task functions must not return
+    fprintf(stderr, "task %s returned\r\n", pcTaskGetName(NULL));
+    abort();
+}
+
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters)
+{
+    Port_Thread_t *thread = malloc(sizeof(Port_Thread_t));
+
+    if (thread == NULL || (thread->Stack = malloc(PORT_EXEC_STACK_SIZE)) == NULL)
+    {
+        fprintf(stderr, "out of host memory for a task stack\r\n");
+        abort();
+    }
+    thread->Code = pxCode;
+    thread->Parameters = pvParameters;
+    getcontext(&thread->Context);
+    thread->Context.uc_stack.ss_sp = thread->Stack;
+    thread->Context.uc_stack.ss_size = PORT_EXEC_STACK_SIZE;
+    thread->Context.uc_link = NULL;
+    makecontext(&thread->Context, Port_Task_Entry, 0);
+
+    pxTopOfStack -= (sizeof(thread) + sizeof(StackType_t) - 1) / sizeof(StackType_t);
+    memcpy(pxTopOfStack, &thread, sizeof(thread));
+    return pxTopOfStack;
+}
+
+void vPortCleanUpTCB(void *pxTCB)
+{
+    Port_Thread_t *thread = Port_Thread_Of(pxTCB);
+
+    // 删除其他任务时立即回收; 自删除的任务原由空闲任务回收, 空闲任务被替换后不再回收
+    // called at once when another task is deleted; self-deleted tasks were reclaimed by the replaced idle task and now leak
+    free(thread->Stack);
+    free(thread);
+}
+
+// 对应 PendSV: 选出下一个任务并切换协程 the PendSV equivalent: pick the next task and switch coroutines
+static void Port_Switch_Context(void)
+{
+    Port_Thread_t *from = Port_Thread_Of(pxCurrentTCB), *to;
+
+    vTaskSwitchContext();
+    to = Port_Thread_Of(pxCurrentTCB);
+    if (to != from)
+    {
+        Host_RTOS_Stat.ContextSwitch++;
+        swapcontext(&from->Context, &to->Context);
+    }
+}
+
+// 中断未屏蔽时送达节拍与挂起的切换 deliver ticks and pended switches while interrupts are unmasked
+static void Port_Service(void)
+{
+    uint64_t now_ms;
+
+    if (!Port_Started || Port_Interrupt_Mask || Port_In_ISR)
+        return;
+
+    now_ms = Host_Clock_Get_us() / 1000;
+    while (Port_Tick_ms < now_ms)
+    {
+        Port_Tick_ms++;
+        Port_In_ISR = 1;
+        if (Port_Tick_Hook != NULL)
+            Port_Tick_Hook();
+        if (xTaskIncrementTick() != pdFALSE)
+            Port_Yield_Pending = 1;
+        Port_In_ISR = 0;
+        Host_RTOS_Stat.Tick++;
+
+        if (Port_Tick_ms * 1000 >= Port_Stop_us)
+            exit(Port_Stop_Report != NULL ? Port_Stop_Report() : EXIT_SUCCESS);
+        // 节拍钩子可能推进了时钟 the tick hook may have advanced the clock
+        now_ms = Host_Clock_Get_us() / 1000;
+    }
+
+    if (Port_Yield_Pending)
+    {
+        Port_Yield_Pending = 0;
+        Port_Switch_Context();
+    }
+}
+
+void vPortYield(void)
+{
+    Port_Yield_Pending = 1;
+    Port_Service();
+}
+
+void vPortYieldFromISR(void)
+{
+    Port_Yield_Pending = 1;
+}
+
+uint32_t ulPortRaiseInterruptMask(void)
+{
+    uint32_t mask = Port_Interrupt_Mask;
+
+    Port_Interrupt_Mask = 1;
+    return mask;
+}
+
+void vPortSetInterruptMask(uint32_t ulMask)
+{
+    Port_Interrupt_Mask = ulMask;
+    if (!ulMask)
+        Port_Service();
+}
+
+void vPortEnterCritical(void)
+{
+    portDISABLE_INTERRUPTS();
+    Port_Critical_Nesting++;
+}
+
+void vPortExitCritical(void)
+{
+    configASSERT(Port_Critical_Nesting);
+    Port_Critical_Nesting--;
+    if (Port_Critical_Nesting == 0)
+        portENABLE_INTERRUPTS();
+}
+
+// 替换内核的空闲任务: 推进到下一个节拍, 由节拍唤醒其他任务
+// replaces the kernel idle task: advance to the next tick and let it wake the other tasks
+static void Port_Idle_Task(void *parameters)
+{
+    (void)parameters;
+    for (;;)
+    {
+        Host_RTOS_Stat.IdleTick++;
+        Host_Clock_Advance_us(1000 - Host_Clock_Get_us() % 1000);
+    }
+}
+
+BaseType_t xPortStartScheduler(void)
+{
+    Port_Thread_t *first = Port_Thread_Of(pxCurrentTCB);
+
+    Port_Thread_Of(xTaskGetIdleTaskHandle())->Code = Port_Idle_Task;
+
+    Port_Tick_ms = Host_Clock_Get_us() / 1000;
+    Port_Critical_Nesting = 0;
+    Port_Interrupt_Mask = 0;
+    Port_Started = 1;
+    swapcontext(&Port_Main_Context, &first->Context);
+
+    // 仅 vPortEndScheduler() 返回此处 only reached through vPortEndScheduler()
+    Port_Started = 0;
+    return pdFALSE;
+}
+
+void vPortEndScheduler(void)
+{
+    Port_Thread_t *thread = Port_Thread_Of(pxCurrentTCB);
+
+    swapcontext(&thread->Context, &Port_Main_Context);
+}
+
+// 节拍由虚拟时钟产生, 此入口仅供 cmsis_os.c 的 osSystickHandler() 链接
+// ticks come from the virtual clock, this entry only links osSystickHandler() in cmsis_os.c
+void xPortSysTickHandler(void)
+{
+}
+
+uint32_t ulPortGetRunTimeCounter(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+/*************************** host interface ***************************/
+void Host_RTOS_Clock_Hook(void)
+{
+    Port_Service();
+}
+
+void Host_RTOS_Set_Tick_Hook(void (*hook)(void))
+{
+    Port_Tick_Hook = hook;
+}
+
+void Host_RTOS_Set_Stop(uint64_t stop_us, int (*report)(void))
+{
+    Port_Stop_us = stop_us;
+    Port_Stop_Report = report;
+}
+
+void Host_RTOS_ISR(void (*isr)(void *), void *arg)
+{
+    uint8_t in_isr = Port_In_ISR;
+
+    Port_In_ISR = 1;
+    isr(arg);
+    Port_In_ISR = in_isr;
+    Port_Service();
+}
+
+uint32_t Host_RTOS_Get_IPSR(void)
+{
+    // 在中断中时按 SysTick 的异常号返回 report the SysTick exception number while in an interrupt
+    return Port_In_ISR ? 15 : 0;
+}
+
+uint32_t Host_RTOS_Get_PRIMASK(void)
+{
+    return Port_Interrupt_Mask;
+}
@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ * @file    portmacro.h
+ * @brief   FreeRTOS 主机移植层 host (x86 Linux) port of the FreeRTOS kernel
+ *          任务以 ucontext 协程在单个线程上运行, 节拍由虚拟时钟产生,
+ *          调度顺序与时刻完全确定; 中断屏蔽/临界区/PendSV 以标志位模拟
+ *          tasks run as ucontext coroutines on a single thread, ticks come from the
+ *          virtual clock, so scheduling order and timing are fully deterministic;
+ *          interrupt masking, critical sections and PendSV are emulated with flags
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  在 host_rtos 构建中先于 portable/GCC/ARM_CM4F 被包含
+ ******************************************************************************
+ */
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Type definitions. */
+#define portCHAR char
+#define portFLOAT float
+#define portDOUBLE double
+#define portLONG long
+#define portSHORT short
+// 与 Cortex-M4 相同的 32 位栈单元, 任务栈与堆占用和固件一致
+// 32 bit stack words as on the Cortex-M4, so stack and heap usage match the firmware
+#define portSTACK_TYPE uint32_t
+#define portBASE_TYPE long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+typedef uint16_t TickType_t;
+#define portMAX_DELAY (TickType_t)0xffff
+#else
+typedef uint32_t TickType_t;
+#define portMAX_DELAY (TickType_t)0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH (-1)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT 8
+#define portNOP()
+#define portINLINE __inline
+#define portFORCE_INLINE inline __attribute__((always_inline))
+#define portMEMORY_BARRIER() __sync_synchronize()
+
+/* Scheduler utilities. */
+// 任务中调用时立即切换, 在中断或临界区中调用时挂起到退出时执行, 与 PendSV 相同
+// switches at once from a task, pends until exit when called inside an interrupt or critical section, as PendSV does
+void vPortYield(void);
+void vPortYieldFromISR(void);
+#define portYIELD() vPortYield()
+#define portEND_SWITCHING_ISR(xSwitchRequired) \
+    do                                         \
+    {                                          \
+        if ((xSwitchRequired) != pdFALSE)      \
+            vPortYieldFromISR();               \
+    } while (0)
+#define portYIELD_FROM_ISR(x) portEND_SWITCHING_ISR(x)
+
+/* Critical section management. */
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+uint32_t ulPortRaiseInterruptMask(void);
+void vPortSetInterruptMask(uint32_t ulMask);
+
+#define portSET_INTERRUPT_MASK_FROM_ISR() ulPortRaiseInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x) vPortSetInterruptMask(x)
+#define portDISABLE_INTERRUPTS() ((void)ulPortRaiseInterruptMask())
+#define portENABLE_INTERRUPTS() vPortSetInterruptMask(0)
+#define portENTER_CRITICAL() vPortEnterCritical()
+#define portEXIT_CRITICAL() vPortExitCritical()
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters) void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters) void vFunction(void *pvParameters)
+
+// 任务的执行栈在主机堆上, 删除任务时释放 the execution stack lives on the host heap and is freed with the task
+void vPortCleanUpTCB(void *pxTCB);
+#define portCLEAN_UP_TCB(pxTCB) vPortCleanUpTCB(pxTCB)
+
+/* Port optimised task selection. */
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+#if (configMAX_PRIORITIES > 32)
+#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.
+#endif
+
+#define portRECORD_READY_PRIORITY(uxPriority, uxReadyPriorities) (uxReadyPriorities) |= (1UL << (uxPriority))
+#define portRESET_READY_PRIORITY(uxPriority, uxReadyPriorities) (uxReadyPriorities) &= ~(1UL << (uxPriority))
+// 与 Cortex-M 的 clz 指令相同 same as the Cortex-M clz instruction
+#define portGET_HIGHEST_PRIORITY(uxTopPriority, uxReadyPriorities) \
+    uxTopPriority = (31UL - (uint32_t)__builtin_clz((uint32_t)(uxReadyPriorities)))
+
+#endif
+
+/* Run time stats. */
+// 运行时间统计取主机进程 CPU 时间 (us), 虚拟时钟在任务执行期间不前进, 不能用于统计
+// run time stats use the host process CPU time in us, the virtual clock does not move while a task runs
+uint32_t ulPortGetRunTimeCounter(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() ulPortGetRunTimeCounter()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,144 @@
+/**
+ ******************************************************************************
+ * @file    blackbox_decode.c
+ * @brief   黑匣子转存解码 black-box dump decoder
+ *          读入 flash 扇区 11 的转存 (blackbox.h, 由调试器读出或 chassis_sim -B 写出),
+ *          校验头与 CRC16 后每条记录输出一行 CSV, 复位原因等写到 stderr
+ *          reads a dump of flash sector 11 (blackbox.h, read out with the debugger or written by
+ *          chassis_sim -B), checks the header and CRC16, then writes one CSV row per record and
+ *          the reset reason and the like to stderr
+ *
+ *          usage: blackbox_decode [-o out.csv] dump.bin
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc8_16.h"
+#include "blackbox.h"
+
+static const char *Reason_Name[] = {
+    [BLACKBOX_REASON_NONE] = "none",
+    [BLACKBOX_REASON_WATCHDOG] = "watchdog",
+    [BLACKBOX_REASON_HARDFAULT] = "hard fault",
+    [BLACKBOX_REASON_KEY_RESET] = "key reset",
+    [BLACKBOX_REASON_I2C_LOST] = "i2c lost",
+    [BLACKBOX_REASON_REQUEST] = "request",
+};
+
+static uint8_t *Load(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long len;
+
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(len > 0 ? len : 1);
+    if (buf != NULL && fread(buf, 1, len, f) != (size_t)len)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = len;
+    return buf;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL, *out_path = NULL;
+    FILE *out = stdout;
+    BlackBox_Header_t header;
+    BlackBox_Record_t record;
+    const uint8_t *records;
+    uint8_t *buf;
+    size_t size;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            out_path = argv[++i];
+        else if (argv[i][0] != '-' && path == NULL)
+            path = argv[i];
+        else
+        {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s [-o out.csv] dump.bin\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    buf = Load(path, &size);
+    if (buf == NULL)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    if (size < sizeof(header))
+    {
+        fprintf(stderr, "%s: too short\n", path);
+        return EXIT_FAILURE;
+    }
+    memcpy(&header, buf, sizeof(header));
+    records = buf + sizeof(header);
+    if (header.Magic != BLACKBOX_MAGIC)
+    {
+        // 从未转存或转存未写完 never dumped, or the dump did not finish
+        fprintf(stderr, "%s: no dump (magic %08X)\n", path, header.Magic);
+        return EXIT_FAILURE;
+    }
+    if (header.Version != BLACKBOX_VERSION || header.RecordSize != sizeof(BlackBox_Record_t))
+    {
+        fprintf(stderr, "%s: version %u, record size %u, expected %u and %u\n", path,
+                header.Version, header.RecordSize, BLACKBOX_VERSION, (unsigned)sizeof(BlackBox_Record_t));
+        return EXIT_FAILURE;
+    }
+    if (header.Count > BLACKBOX_RECORDS || sizeof(header) + (size_t)header.Count * sizeof(record) > size)
+    {
+        fprintf(stderr, "%s: %u records do not fit\n", path, header.Count);
+        return EXIT_FAILURE;
+    }
+    if (CRC16_Update(0xFFFF, records, header.Count * sizeof(record)) != header.Crc)
+    {
+        fprintf(stderr, "%s: CRC error\n", path);
+        return EXIT_FAILURE;
+    }
+
+    if (out_path != NULL && (out = fopen(out_path, "w")) == NULL)
+    {
+        perror(out_path);
+        return EXIT_FAILURE;
+    }
+    fprintf(out, "t_ms,mode,status,offline,rpm1,rpm2,rpm3,rpm4,cur1,cur2,cur3,cur4,"
+                 "out1,out2,out3,out4,vx,vy,vr,power_w\n");
+    for (uint32_t i = 0; i < header.Count; i++)
+    {
+        memcpy(&record, records + i * sizeof(record), sizeof(record));
+        fprintf(out, "%u,%u,%u,%04X,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%.1f\n",
+                record.Time_ms, record.Mode, record.Status, record.Offline,
+                record.Rpm[0], record.Rpm[1], record.Rpm[2], record.Rpm[3],
+                record.Current[0], record.Current[1], record.Current[2], record.Current[3],
+                record.Output[0], record.Output[1], record.Output[2], record.Output[3],
+                record.Vx, record.Vy, record.Vr, record.Power_dW * 0.1f);
+    }
+    if (out != stdout)
+        fclose(out);
+    free(buf);
+
+    fprintf(stderr, "reason %s, reset flags %08X, %u of %u records, period %u us\n",
+            header.Reason < sizeof(Reason_Name) / sizeof(Reason_Name[0]) ? Reason_Name[header.Reason] : "?",
+            header.ResetFlags, header.Count, header.Total, header.Period_us);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ * @file    can_log.c
+ * @brief   candump 日志读写 reading and writing candump logs
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "can_log.h"
+
+#define CAN_LOG_LINE_MAX 256
+#define CAN_EFF_FLAG 0x80000000u // 与 linux/can.h 相同 same as linux/can.h
+#define CAN_RTR_FLAG 0x40000000u
+#define CAN_ERR_FLAG 0x20000000u
+
+static int CAN_Log_Hex(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+// 解析 "ID#数据", 返回 0 成功, 1 不支持的帧, -1 格式错误
+// parse "ID#data", returns 0 on success, 1 for an unsupported frame, -1 when malformed
+static int CAN_Log_Parse_Frame(const char *text, CAN_Log_Frame_t *frame)
+{
+    const char *p = text;
+    uint32_t id = 0;
+    uint8_t digits = 0;
+    int hi, lo;
+
+    for (; *p != '#'; p++, digits++)
+    {
+        if ((hi = CAN_Log_Hex(*p)) < 0)
+            return -1;
+        id = (id << 4) | hi;
+    }
+    if (digits != 3 && digits != 8)
+        return -1;
+    p++;
+
+    frame->Ext = digits == 8;
+    if (frame->Ext && (id & (CAN_ERR_FLAG | CAN_RTR_FLAG)))
+        return 1;
+    frame->Id = frame->Ext ? id & 0x1FFFFFFF : id;
+    if (!frame->Ext && id > 0x7FF)
+        return -1;
+    if (*p == '#')
+        return 1; // CAN FD
+
+    memset(frame->Data, 0, sizeof(frame->Data));
+    frame->DLC = 0;
+    frame->Rtr = *p == 'R';
+    if (frame->Rtr)
+    {
+        // 长度可选 the length is optional
+        if ((hi = CAN_Log_Hex(p[1])) >= 0 && hi <= 8)
+            frame->DLC = hi;
+        return 0;
+    }
+    for (; *p != '\0' && !isspace((unsigned char)*p); p += 2)
+    {
+        if (*p == '.')
+            p--; // canplayer 允许的字节分隔符 byte separator accepted by canplayer
+        else if (frame->DLC == 8 || (hi = CAN_Log_Hex(p[0])) < 0 || (lo = CAN_Log_Hex(p[1])) < 0)
+            return -1;
+        else
+            frame->Data[frame->DLC++] = (hi << 4) | lo;
+    }
+    return 0;
+}
+
+int CAN_Log_Load(CAN_Log_t *log, const char *path, const char *const iface[2])
+{
+    FILE *file = fopen(path, "r");
+    char line[CAN_LOG_LINE_MAX], name[32], text[64];
+    unsigned long long sec, usec;
+    uint32_t capacity = 0;
+    uint64_t last_us = 0;
+    CAN_Log_Frame_t frame, *grown;
+    int ret;
+
+    memset(log, 0, sizeof(*log));
+    if (file == NULL)
+        return -1;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (line[0] == '\n' || line[0] == '#')
+            continue;
+        if (sscanf(line, " (%llu.%6llu) %31s %63s", &sec, &usec, name, text) != 4)
+        {
+            log->Malformed++;
+            continue;
+        }
+
+        if (iface[0] != NULL && strcmp(name, iface[0]) == 0)
+            frame.Bus = 0;
+        else if (iface[1] != NULL && strcmp(name, iface[1]) == 0)
+            frame.Bus = 1;
+        else
+        {
+            log->OtherIface++;
+            continue;
+        }
+
+        ret = CAN_Log_Parse_Frame(text, &frame);
+        if (ret != 0)
+        {
+            if (ret > 0)
+                log->Unsupported++;
+            else
+                log->Malformed++;
+            continue;
+        }
+
+        frame.Time_us = sec * 1000000ull + usec;
+        if (log->Count > 0 && frame.Time_us < last_us)
+        {
+            log->Backwards++;
+            frame.Time_us = last_us;
+        }
+        last_us = frame.Time_us;
+
+        if (log->Count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 4096;
+            grown = realloc(log->Frame, capacity * sizeof(CAN_Log_Frame_t));
+            if (grown == NULL)
+            {
+                fclose(file);
+                CAN_Log_Free(log);
+                return -1;
+            }
+            log->Frame = grown;
+        }
+        log->Frame[log->Count++] = frame;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+void CAN_Log_Free(CAN_Log_t *log)
+{
+    free(log->Frame);
+    log->Frame = NULL;
+    log->Count = 0;
+}
+
+void CAN_Log_Write(FILE *file, const char *iface, const CAN_Log_Frame_t *frame)
+{
+    fprintf(file, "(%010llu.%06llu) %s ", (unsigned long long)(frame->Time_us / 1000000),
+            (unsigned long long)(frame->Time_us % 1000000), iface);
+    fprintf(file, frame->Ext ? "%08X#" : "%03X#", (unsigned)frame->Id);
+    if (frame->Rtr)
+        fputc('R', file);
+    else
+        for (uint8_t i = 0; i < frame->DLC && i < 8; i++)
+            fprintf(file, "%02X", frame->Data[i]);
+    fputc('\n', file);
+}
@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * @file    can_log.h
+ * @brief   candump 日志读写 reading and writing candump logs
+ *          格式与 can-utils 的 candump -l / canplayer 相同, 每行一帧:
+ *          (秒.微秒) 接口名 ID#数据, 标准帧 ID 为 3 位十六进制, 扩展帧为 8 位, 远程帧数据为 R
+ *          same format as candump -l / canplayer of can-utils, one frame per line:
+ *          (seconds.microseconds) interface ID#data, 3 hex digits for a standard ID,
+ *          8 for an extended one, R as the data of a remote frame
+ *          (1436509052.249713) can0 201#1A2B000000640000
+ *          供 can_replay 与 chassis_sim 使用
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#ifndef _CAN_LOG_H
+#define _CAN_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct
+{
+    uint64_t Time_us; // 日志中的时间戳 timestamp in the log
+    uint32_t Id;
+    uint8_t Bus; // 0: hcan1 1: hcan2
+    uint8_t Ext; // 扩展帧 extended ID
+    uint8_t Rtr; // 远程帧 remote frame
+    uint8_t DLC;
+    uint8_t Data[8];
+} CAN_Log_Frame_t;
+
+typedef struct
+{
+    CAN_Log_Frame_t *Frame;
+    uint32_t Count;
+    uint32_t OtherIface;  // 未映射到 hcan1/hcan2 的接口上的帧 frames on interfaces not mapped to hcan1/hcan2
+    uint32_t Unsupported; // CAN FD 帧与错误帧 CAN FD and error frames
+    uint32_t Malformed;   // 无法解析的行 lines that do not parse
+    uint32_t Backwards;   // 时间戳早于前一帧, 按前一帧时刻回放 timestamp before the previous frame, replayed at that time
+} CAN_Log_t;
+
+// 读入整份日志, iface[0]/iface[1] 为映射到 hcan1/hcan2 的接口名, 失败返回 -1
+// load a whole log, iface[0]/iface[1] are the interfaces mapped to hcan1/hcan2, returns -1 on failure
+int CAN_Log_Load(CAN_Log_t *log, const char *path, const char *const iface[2]);
+void CAN_Log_Free(CAN_Log_t *log);
+
+// 追加一帧 append a frame
+void CAN_Log_Write(FILE *file, const char *iface, const CAN_Log_Frame_t *frame);
+
+#endif
@@ -0,0 +1,314 @@
+/**
+ ******************************************************************************
+ * @file    can_replay.c
+ * @brief   CAN 日志回放 CAN log replay
+ *          1. 按日志中的原始时间间隔在虚拟时钟上把各帧注入 hcan1/hcan2 的
+ *             HAL_CAN_RxFifo0MsgPendingCallback, 按 CHASSIS_TASK_PERIOD 调用 Chassis_Control(),
+ *             经 HAL_CAN_AddTxMessage 发出的帧在离开总线时记录为 candump 日志;
+ *             每个周期的底盘状态累积为摘要, 同一日志与同一固件得到相同的摘要, 用于回归比对
+ *          2. 不经虚拟时钟, 将日志反复送入接收中断与 CAN_RxQueue_Drain(), 分别统计两者的主机耗时
+ *          1. injects the frames into HAL_CAN_RxFifo0MsgPendingCallback of hcan1/hcan2 with the
+ *             original spacing of the log on the virtual clock, calls Chassis_Control() every
+ *             CHASSIS_TASK_PERIOD and logs the frames sent through HAL_CAN_AddTxMessage in candump
+ *             format when they leave the bus; the chassis state of every tick goes into a digest,
+ *             the same log and firmware always give the same digest, for regression checks
+ *          2. feeds the log through the receive interrupt and CAN_RxQueue_Drain() repeatedly
+ *             without the virtual clock and times the two separately on the host
+ *
+ *          usage: can_replay [-1 iface] [-2 iface] [-o tx.log] [-b passes] [-e digest] capture.log
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  日志中没有 IMU 数据, 回放时 BMI088 保持静止水平
+ *  the log carries no IMU data, BMI088 stays still and level during the replay
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_hal.h"
+#include "can_log.h"
+#include "chassis_task.h"
+
+#define REPLAY_ID_MAX 64
+#define REPLAY_TICK_US (CHASSIS_TASK_PERIOD * 1000)
+
+typedef struct
+{
+    uint32_t Id;
+    uint8_t Bus;
+    uint8_t Ext;
+    uint32_t Count;
+    uint64_t First_us, Last_us;
+} Replay_Id_t;
+
+static CAN_Log_t Log;
+static const char *Iface[2] = {"can0", "can1"};
+static FILE *TxLog = NULL;
+static uint64_t Start_us; // 日志首帧对应的虚拟时刻 virtual time of the first frame of the log
+static uint64_t Digest = 0xcbf29ce484222325ull;
+static uint32_t TxRecorded[2];
+
+static double Host_Wall_Time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// FNV-1a
+static void Digest_Update(const void *data, uint32_t len)
+{
+    const uint8_t *p = data;
+
+    for (uint32_t i = 0; i < len; i++)
+        Digest = (Digest ^ p[i]) * 0x100000001b3ull;
+}
+
+static void Replay_Inject(const CAN_Log_Frame_t *frame)
+{
+    CAN_RxHeaderTypeDef header = {0};
+
+    header.StdId = frame->Ext ? 0 : frame->Id;
+    header.ExtId = frame->Ext ? frame->Id : 0;
+    header.IDE = frame->Ext ? CAN_ID_EXT : CAN_ID_STD;
+    header.RTR = frame->Rtr ? CAN_RTR_REMOTE : CAN_RTR_DATA;
+    header.DLC = frame->DLC;
+    Host_CAN_Receive_Frame(frame->Bus ? &hcan2 : &hcan1, &header, frame->Data);
+}
+
+// 发出的帧与接收的帧使用同一时间基准 sent frames share the time base of the received ones
+static void Replay_Record_Tx(CAN_HandleTypeDef *hcan, const CAN_TxHeaderTypeDef *header, const uint8_t *data)
+{
+    CAN_Log_Frame_t frame;
+
+    frame.Time_us = Log.Frame[0].Time_us + (Host_Clock_Get_us() - Start_us);
+    frame.Bus = hcan == &hcan2;
+    frame.Ext = header->IDE == CAN_ID_EXT;
+    frame.Id = frame.Ext ? header->ExtId : header->StdId;
+    frame.Rtr = header->RTR == CAN_RTR_REMOTE;
+    frame.DLC = header->DLC > 8 ? 8 : header->DLC;
+    memcpy(frame.Data, data, frame.DLC);
+    TxRecorded[frame.Bus]++;
+    if (TxLog != NULL)
+        CAN_Log_Write(TxLog, Iface[frame.Bus], &frame);
+}
+
+static void Replay_Control(double *cost_sum, double *cost_max)
+{
+    double t0 = Host_Wall_Time_s(), cost;
+
+    Chassis_Control();
+    cost = Host_Wall_Time_s() - t0;
+    *cost_sum += cost;
+    if (cost > *cost_max)
+        *cost_max = cost;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        Digest_Update(&Chassis.ChassisMotor[i].Velocity_RPM, sizeof(Chassis.ChassisMotor[i].Velocity_RPM));
+        Digest_Update(&Chassis.ChassisMotor[i].Output, sizeof(Chassis.ChassisMotor[i].Output));
+    }
+    Digest_Update(&Chassis.RC.ch3, sizeof(Chassis.RC.ch3));
+    Digest_Update(&Chassis.RC.ch4, sizeof(Chassis.RC.ch4));
+    Digest_Update(&Chassis.posX1000, sizeof(Chassis.posX1000));
+    Digest_Update(&Chassis.posY1000, sizeof(Chassis.posY1000));
+    Digest_Update(Chassis.Velocity, sizeof(Chassis.Velocity));
+    Digest_Update(Chassis.Position, sizeof(Chassis.Position));
+}
+
+/**
+ * @brief 按原始时间回放: 与 chassis_sim 相同, 在周期时刻之前到达的帧由该周期处理,
+ *        恰好在周期时刻到达的帧留给下一周期
+ *        timed replay: as in chassis_sim, frames that arrive before a tick are handled by
+ *        that tick, a frame arriving exactly on the tick is left to the next one
+ */
+static uint32_t Replay_Run(double *cost_sum, double *cost_max)
+{
+    uint64_t tick_us = Start_us + REPLAY_TICK_US, time_us;
+    uint32_t ticks = 0;
+
+    for (uint32_t i = 0; i < Log.Count; i++)
+    {
+        time_us = Start_us + (Log.Frame[i].Time_us - Log.Frame[0].Time_us);
+        for (; tick_us <= time_us; tick_us += REPLAY_TICK_US, ticks++)
+        {
+            Host_Clock_Advance_us((uint32_t)(tick_us - Host_Clock_Get_us()));
+            Replay_Control(cost_sum, cost_max);
+        }
+        if (time_us > Host_Clock_Get_us())
+            Host_Clock_Advance_us((uint32_t)(time_us - Host_Clock_Get_us()));
+        Replay_Inject(&Log.Frame[i]);
+    }
+    // 处理最后一批帧 handle the last frames
+    Host_Clock_Advance_us((uint32_t)(tick_us - Host_Clock_Get_us()));
+    Replay_Control(cost_sum, cost_max);
+
+    return ticks + 1;
+}
+
+/**
+ * @brief 解码吞吐: 帧按回放时所属的周期分批, 每批先逐帧进入接收中断, 再由 CAN_RxQueue_Drain() 处理
+ *        decode throughput: frames are batched by the tick that handles them in the replay,
+ *        each batch goes through the receive interrupt frame by frame, then CAN_RxQueue_Drain()
+ */
+static void Replay_Bench(uint32_t passes)
+{
+    double isr_s = 0, drain_s = 0, t0, t1;
+    uint32_t start, end;
+    uint64_t tick;
+
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (start = 0; start < Log.Count; start = end)
+        {
+            tick = (Log.Frame[start].Time_us - Log.Frame[0].Time_us) / REPLAY_TICK_US;
+            for (end = start + 1; end < Log.Count; end++)
+                if ((Log.Frame[end].Time_us - Log.Frame[0].Time_us) / REPLAY_TICK_US != tick)
+                    break;
+
+            t0 = Host_Wall_Time_s();
+            for (uint32_t i = start; i < end; i++)
+                Replay_Inject(&Log.Frame[i]);
+            t1 = Host_Wall_Time_s();
+            CAN_RxQueue_Drain(&CAN_RxQueue);
+            drain_s += Host_Wall_Time_s() - t1;
+            isr_s += t1 - t0;
+        }
+    }
+
+    printf("decode bench     %u passes, rx interrupt %.1f ns/frame, drain %.1f ns/frame, %.2f M frames/s\n",
+           passes, isr_s / ((double)passes * Log.Count) * 1e9, drain_s / ((double)passes * Log.Count) * 1e9,
+           (double)passes * Log.Count / (isr_s + drain_s) * 1e-6);
+}
+
+static void Print_Log_Summary(void)
+{
+    static Replay_Id_t id[REPLAY_ID_MAX];
+    uint32_t ids = 0, other = 0, j;
+    const CAN_Log_Frame_t *frame;
+
+    for (uint32_t i = 0; i < Log.Count; i++)
+    {
+        frame = &Log.Frame[i];
+        for (j = 0; j < ids; j++)
+            if (id[j].Id == frame->Id && id[j].Bus == frame->Bus && id[j].Ext == frame->Ext)
+                break;
+        if (j == ids)
+        {
+            if (ids == REPLAY_ID_MAX)
+            {
+                other++;
+                continue;
+            }
+            id[ids].Id = frame->Id;
+            id[ids].Bus = frame->Bus;
+            id[ids].Ext = frame->Ext;
+            id[ids].First_us = frame->Time_us;
+            ids++;
+        }
+        id[j].Count++;
+        id[j].Last_us = frame->Time_us;
+    }
+
+    printf("log              %u frames, %.3f s, other interfaces %u, unsupported %u, malformed %u, out of order %u\n",
+           Log.Count, (Log.Frame[Log.Count - 1].Time_us - Log.Frame[0].Time_us) * 1e-6,
+           Log.OtherIface, Log.Unsupported, Log.Malformed, Log.Backwards);
+    printf("%-6s %-8s %-10s %10s %12s\n", "bus", "iface", "id", "frames", "interval ms");
+    for (j = 0; j < ids; j++)
+        printf("%-6s %-8s %-10X %10u %12.3f\n", id[j].Bus ? "hcan2" : "hcan1", Iface[id[j].Bus], id[j].Id, id[j].Count,
+               id[j].Count > 1 ? (id[j].Last_us - id[j].First_us) * 1e-3 / (id[j].Count - 1) : 0.0);
+    if (other)
+        printf("frames of further IDs %u\n", other);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL, *tx_path = NULL;
+    uint32_t passes = 20, ticks;
+    uint64_t expect = 0;
+    double cost_sum = 0, cost_max = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-1") == 0 && i + 1 < argc)
+            Iface[0] = argv[++i];
+        else if (strcmp(argv[i], "-2") == 0 && i + 1 < argc)
+            Iface[1] = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            tx_path = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            passes = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+            expect = strtoull(argv[++i], NULL, 16);
+        else if (argv[i][0] != '-' && path == NULL)
+            path = argv[i];
+        else
+        {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s [-1 iface] [-2 iface] [-o tx.log] [-b passes] [-e digest] capture.log\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (CAN_Log_Load(&Log, path, Iface) != 0)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    if (Log.Count == 0)
+    {
+        fprintf(stderr, "%s: no frames on %s/%s\n", path, Iface[0], Iface[1]);
+        return EXIT_FAILURE;
+    }
+    if (tx_path != NULL && (TxLog = fopen(tx_path, "w")) == NULL)
+    {
+        perror(tx_path);
+        return EXIT_FAILURE;
+    }
+
+    Host_HAL_Init();
+    DWT_Init(HOST_CPU_FREQ_MHZ);
+    CAN_Device_Init();
+    Chassis_Init();
+    BMI088.Accel[2] = 9.8f;
+    Host_CAN_Set_Tx_Callback(Replay_Record_Tx);
+    Start_us = Host_Clock_Get_us();
+
+    Print_Log_Summary();
+    ticks = Replay_Run(&cost_sum, &cost_max);
+    Host_CAN_Set_Tx_Callback(NULL);
+    if (TxLog != NULL)
+        fclose(TxLog);
+
+    printf("replay           %u ticks, Chassis_Control mean %.0f ns, max %.0f ns\n",
+           ticks, cost_sum / ticks * 1e9, cost_max * 1e9);
+    printf("CAN rx           hcan1 %u (unhandled %u), hcan2 %u (unhandled %u), overflow %u, high water %u/%u\n",
+           CAN_RxStat[0].Received, CAN_RxStat[0].Unhandled, CAN_RxStat[1].Received, CAN_RxStat[1].Unhandled,
+           CAN_RxQueue.Overflow, CAN_RxQueue.HighWater, CAN_RX_QUEUE_LEN);
+    printf("CAN tx           hcan1 %u, hcan2 %u%s%s\n", TxRecorded[0], TxRecorded[1],
+           tx_path != NULL ? " recorded to " : "", tx_path != NULL ? tx_path : "");
+    printf("rc               ch3 %d ch4 %d, nav pos [%d %d]\n",
+           Chassis.RC.ch3, Chassis.RC.ch4, Chassis.posX1000, Chassis.posY1000);
+    printf("motor rpm        [%.0f %.0f %.0f %.0f]\n", Chassis.ChassisMotor[0].Velocity_RPM,
+           Chassis.ChassisMotor[1].Velocity_RPM, Chassis.ChassisMotor[2].Velocity_RPM, Chassis.ChassisMotor[3].Velocity_RPM);
+    printf("est    vel [%.2f %.2f] cm/s pos [%.2f %.2f] cm\n",
+           Chassis.Velocity[0], Chassis.Velocity[1], Chassis.Position[0], Chassis.Position[1]);
+    printf("digest           %016llx\n", (unsigned long long)Digest);
+
+    if (passes)
+        Replay_Bench(passes);
+    CAN_Log_Free(&Log);
+
+    if (expect != 0 && expect != Digest)
+    {
+        printf("digest mismatch, expected %016llx\n", (unsigned long long)expect);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,274 @@
+/**
+ ******************************************************************************
+ * @file    can_tx_test.c
+ * @brief   CAN 发送队列主机测试 host test of the CAN transmit queue
+ *          在 host_hal.c 的 bxCAN 模型 (3 邮箱, ID 仲裁, 1 Mbps 位时间) 上运行 bsp_CAN.c:
+ *          A. CAN2 总线关闭时 CAN1 电机帧照常发出, CAN2 发送不阻塞, 丢帧被计数
+ *          B. CAN1 遥测过载时电机帧延迟有界
+ *          C. 拥堵时同 ID 电机帧只保留最新值
+ *          D. 复位前清空电机帧, 等到零电流帧发出或超时
+ *
+ *          usage: can_tx_test [-n ticks]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_hal.h"
+#include "bsp_CAN.h"
+#include "motor.h"
+
+// 8 字节标准帧最坏位填充下的总线时间, 与 host_hal.c 一致 bus time of an 8 byte frame, as in host_hal.c
+#define CAN_FRAME_TIME_US 135
+#define TEST_MOTOR_FRAMES_PER_TICK 2
+
+typedef struct
+{
+    uint64_t EnqueueTime_us[2]; // 0x200, 0x1FF
+    uint8_t Waiting[2];
+    uint32_t Delivered[2];
+    uint64_t Latency_Sum_us;
+    uint64_t Latency_Max_us;
+    uint16_t LastSeq[2];
+    uint32_t Telemetry[2];
+} TxRecord_t;
+
+static TxRecord_t Record;
+static uint8_t Fail = 0;
+
+static int8_t Motor_Index(uint32_t std_id)
+{
+    if (std_id == CAN_Transmit_1_4_ID)
+        return 0;
+    if (std_id == CAN_Transmit_5_8_ID)
+        return 1;
+    return -1;
+}
+
+static void Record_Tx(CAN_HandleTypeDef *hcan, const CAN_TxHeaderTypeDef *header, const uint8_t *data)
+{
+    int8_t i = Motor_Index(header->StdId);
+    uint64_t latency;
+
+    if (i < 0)
+    {
+        Record.Telemetry[hcan == &hcan2]++;
+        return;
+    }
+    if (hcan != &hcan1)
+        return;
+
+    Record.Delivered[i]++;
+    Record.LastSeq[i] = (uint16_t)(data[0] << 8 | data[1]);
+    if (Record.Waiting[i])
+    {
+        latency = Host_Clock_Get_us() - Record.EnqueueTime_us[i];
+        Record.Latency_Sum_us += latency;
+        if (latency > Record.Latency_Max_us)
+            Record.Latency_Max_us = latency;
+        Record.Waiting[i] = 0;
+    }
+}
+
+// 同 ID 被覆盖的帧沿用最早的入队时刻, 延迟按数据最早等待的时间计
+// a replaced frame keeps the earliest enqueue time, latency counts from when data first waited
+static HAL_StatusTypeDef Send_Motor(uint8_t i, uint16_t seq)
+{
+    HAL_StatusTypeDef status;
+
+    if (!Record.Waiting[i])
+    {
+        Record.EnqueueTime_us[i] = Host_Clock_Get_us();
+        Record.Waiting[i] = 1;
+    }
+    if (i == 0)
+        status = Send_Motor_Current_1_4(&hcan1, (int16_t)seq, 0, 0, 0);
+    else
+        status = Send_Motor_Current_5_8(&hcan1, (int16_t)seq, 0, 0, 0);
+    return status;
+}
+
+static void Send_Telemetry(CAN_HandleTypeDef *hcan)
+{
+    uint8_t judge[8] = {0};
+    float x = 1.0f, y = 2.0f;
+    uint8_t key = 0;
+
+    Send_Robot_Info(hcan, 7, 240, 0, 30, 30, 240, 0, 30, 4, 1500);
+    Send_JudgeRxData(hcan, judge);
+    SendAerialData(hcan, &x, &y, &key);
+}
+
+static void Test_Reset(void)
+{
+    Host_HAL_Init();
+    DWT_Init(HOST_CPU_FREQ_MHZ);
+    CAN_Device_Init();
+    memset(CAN_Get_TxQueue(&hcan1), 0, sizeof(CAN_TxQueue_t));
+    memset(CAN_Get_TxQueue(&hcan2), 0, sizeof(CAN_TxQueue_t));
+    memset(&Record, 0, sizeof(Record));
+    Host_CAN_Set_Tx_Callback(Record_Tx);
+}
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-52s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static void Print_Stat(const char *name, CAN_HandleTypeDef *hcan)
+{
+    CAN_TxStat_t *stat = &CAN_Get_TxQueue(hcan)->Stat;
+    const char *prio[CAN_TX_PRIO_NUM] = {"motor", "control", "telemetry"};
+
+    printf("  %s  sent %u, replaced %u, tx error %u, on wire %u\n",
+           name, stat->Sent, stat->Replaced, stat->TxError, Host_CAN_Stat[hcan == &hcan2].TxCount);
+    for (uint8_t p = 0; p < CAN_TX_PRIO_NUM; p++)
+        printf("    %-10s enqueued %7u  dropped %7u  high water %u/%u\n",
+               prio[p], stat->Enqueued[p], stat->Dropped[p], stat->HighWater[p], CAN_TX_QUEUE_LEN);
+}
+
+// A. CAN2 无应答 (线缆脱落/总线关闭), 旧实现在此忙等邮箱
+// A. CAN2 unacknowledged (cable off / bus-off), where the old code spun on the mailboxes
+static void Test_Stalled_Bus(uint32_t ticks)
+{
+    uint32_t sent = 0, can2_before;
+
+    printf("A. CAN2 stalled, 2 ms motor ticks on CAN1\n");
+    Test_Reset();
+    Host_CAN_Set_Stalled(&hcan2, 1);
+
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        Send_Motor(0, (uint16_t)tick);
+        Send_Motor(1, (uint16_t)tick);
+        sent++;
+        Send_Telemetry(&hcan2);
+        Send_Power_Data(&hcan2, 60, 100);
+        Host_Clock_Advance_us(2000);
+    }
+    Print_Stat("CAN1", &hcan1);
+    Print_Stat("CAN2", &hcan2);
+
+    Check(Record.Delivered[0] == sent && Record.Delivered[1] == sent, "every CAN1 motor frame reached the bus");
+    Check(Record.Latency_Max_us <= 2 * CAN_FRAME_TIME_US, "CAN1 motor latency within two frame times");
+    Check(CAN_Get_TxQueue(&hcan2)->Stat.Dropped[CAN_TX_PRIO_TELEMETRY] > 0, "CAN2 overflow counted as drops");
+    Check(Host_CAN_Stat[1].TxCount == 0, "nothing left the stalled bus");
+
+    can2_before = Host_CAN_Stat[1].TxCount;
+    Host_CAN_Set_Stalled(&hcan2, 0);
+    Host_Clock_Advance_us(20000);
+    Check(Host_CAN_Stat[1].TxCount > can2_before &&
+              CAN_Get_TxQueue(&hcan2)->Count[CAN_TX_PRIO_TELEMETRY] == 0,
+          "CAN2 queue drains once the bus recovers");
+}
+
+// B. CAN1 上遥测超出总线带宽, 电机帧在 1 ms 周期内随机时刻入队
+// B. telemetry on CAN1 exceeds the bus bandwidth, motor frames are queued at random points of a 1 ms tick
+static void Test_Telemetry_Flood(uint32_t ticks)
+{
+    uint32_t offset;
+    uint32_t bound = (TEST_MOTOR_FRAMES_PER_TICK + 2) * CAN_FRAME_TIME_US;
+    char what[64];
+
+    printf("B. CAN1 flooded with telemetry, 1 ms motor ticks\n");
+    Test_Reset();
+    srand(1);
+
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        Send_Telemetry(&hcan1);
+        offset = rand() % 1000;
+        Host_Clock_Advance_us(offset);
+        Send_Motor(0, (uint16_t)tick);
+        Send_Motor(1, (uint16_t)tick);
+        Send_Telemetry(&hcan1);
+        Host_Clock_Advance_us(1000 - offset);
+    }
+    Host_Clock_Advance_us(20000);
+    Print_Stat("CAN1", &hcan1);
+    printf("  motor latency   mean %.0f us, max %llu us (frame %d us)\n",
+           (double)Record.Latency_Sum_us / (Record.Delivered[0] + Record.Delivered[1]),
+           (unsigned long long)Record.Latency_Max_us, CAN_FRAME_TIME_US);
+
+    snprintf(what, sizeof(what), "motor latency within %u us", bound);
+    Check(Record.Latency_Max_us <= bound, what);
+    Check(CAN_Get_TxQueue(&hcan1)->Stat.Dropped[CAN_TX_PRIO_MOTOR] == 0, "no motor frame dropped");
+    Check(Record.LastSeq[0] == (uint16_t)(ticks - 1) && Record.LastSeq[1] == (uint16_t)(ticks - 1),
+          "last motor frames carry the latest command");
+    Check(Record.Telemetry[0] > 0 && CAN_Get_TxQueue(&hcan1)->Stat.Dropped[CAN_TX_PRIO_TELEMETRY] > 0,
+          "telemetry uses the spare bandwidth, overflow dropped");
+}
+
+// C. 总线拥堵时电机帧合并 motor frames coalesce while the bus is blocked
+static void Test_Motor_Coalescing(void)
+{
+    HAL_StatusTypeDef status[5];
+
+    printf("C. motor frame coalescing\n");
+    Test_Reset();
+    Host_CAN_Set_Stalled(&hcan1, 1);
+
+    // 第一帧直接进入邮箱, 第二帧入队, 之后覆盖队列中的第二帧
+    // the first frame goes straight to a mailbox, the second is queued, later ones replace it
+    for (uint16_t seq = 0; seq < 5; seq++)
+        status[seq] = Send_Motor_Current_1_4(&hcan1, (int16_t)seq, 0, 0, 0);
+    Host_CAN_Set_Stalled(&hcan1, 0);
+    Host_Clock_Advance_us(10 * CAN_FRAME_TIME_US);
+    Print_Stat("CAN1", &hcan1);
+
+    Check(status[0] == HAL_OK && status[1] == HAL_OK && status[2] == HAL_BUSY && status[4] == HAL_BUSY,
+          "HAL_BUSY reported once a motor frame is replaced");
+    Check(CAN_Get_TxQueue(&hcan1)->Stat.Replaced == 3 && Record.Delivered[0] == 2, "three frames replaced, two sent");
+    Check(Record.LastSeq[0] == 4, "latest command delivered");
+}
+
+// D. 复位前的电机帧清空 motor frame flush before a reset
+static void Test_Motor_Flush(void)
+{
+    HAL_StatusTypeDef status;
+
+    printf("D. motor frame flush\n");
+    Test_Reset();
+
+    // 旧帧仍在邮箱中, 零电流帧排在其后 an older frame is still in a mailbox, the zero current frame waits behind it
+    Send_Motor_Current_1_4(&hcan1, 1, 0, 0, 0);
+    Send_Motor_Current_1_4(&hcan1, 0, 0, 0, 0);
+    status = CAN_TxQueue_Flush_Motor(&hcan1, CAN_TX_FLUSH_TIMEOUT_MS);
+    Check(status == HAL_OK && Record.Delivered[0] == 2 && Record.LastSeq[0] == 0,
+          "flush waits until the zero current frame is sent");
+
+    Host_CAN_Set_Stalled(&hcan1, 1);
+    Send_Motor_Current_1_4(&hcan1, 2, 0, 0, 0);
+    status = CAN_TxQueue_Flush_Motor(&hcan1, CAN_TX_FLUSH_TIMEOUT_MS);
+    Host_CAN_Set_Stalled(&hcan1, 0);
+    Check(status == HAL_TIMEOUT, "flush times out on a stalled bus");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = 10000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            ticks = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n ticks]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Test_Stalled_Bus(ticks);
+    Test_Telemetry_Flood(ticks);
+    Test_Motor_Coalescing();
+    Test_Motor_Flush();
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
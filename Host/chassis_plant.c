@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file    chassis_plant.c
+ * @brief   麦克纳姆轮底盘被控对象模型 mecanum chassis plant model
+ *          每个轮子视为独立的一阶惯性环节, 车体质量平均折算到四个转子,
+ *          车体速度/加速度使用与 chassis_task.c 相同的逆解公式求得
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <math.h>
+#include <string.h>
+#include "chassis_plant.h"
+
+#define PLANT_PI 3.14159265358979f
+#define C620_CURRENT_COEF (20.0f / 16384.0f) // 给定值 -> A
+#define PLANT_RAD_TO_RPM (60.0f / (2.0f * PLANT_PI))
+#define PLANT_KX 0.25f
+#define PLANT_KY 0.25f
+
+void ChassisPlant_Init(ChassisPlant_t *plant)
+{
+    float chassis_mass = 20.0f;
+    float rotor_inertia = 1.5e-5f;
+
+    memset(plant, 0, sizeof(ChassisPlant_t));
+
+    // 与 chassis_task.c 中的轮速换算保持一致: 轮径 76mm, 减速比 14
+    plant->WheelRadius = 0.076f;
+    plant->ReductionRatio = 14.0f;
+    plant->TorqueConstant = 0.3f / 19.2f;
+    plant->Inertia = rotor_inertia + chassis_mass / 4.0f * plant->WheelRadius * plant->WheelRadius /
+                                         (plant->ReductionRatio * plant->ReductionRatio);
+    plant->Viscous = 2e-5f;
+    plant->Coulomb = 5e-3f;
+}
+
+void ChassisPlant_Update(ChassisPlant_t *plant, const float current[4], float dt)
+{
+    float wheel_accel[4], wheel_vel[4];
+    float drive, friction, omega_dot;
+    float rpm_to_cmps = 2.0f * PLANT_PI / 60.0f * plant->WheelRadius * 100.0f / plant->ReductionRatio;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        plant->Current[i] = current[i];
+        drive = plant->TorqueConstant * current[i] * C620_CURRENT_COEF - plant->Viscous * plant->Omega[i];
+
+        // 静摩擦: 驱动力矩不足时轮子保持静止
+        if (fabsf(plant->Omega[i]) < 1e-3f && fabsf(drive) <= plant->Coulomb)
+        {
+            omega_dot = -plant->Omega[i] / dt;
+        }
+        else
+        {
+            friction = plant->Omega[i] > 0 ? plant->Coulomb : -plant->Coulomb;
+            if (fabsf(plant->Omega[i]) < 1e-3f)
+                friction = drive > 0 ? plant->Coulomb : -plant->Coulomb;
+            omega_dot = (drive - friction) / plant->Inertia;
+        }
+
+        plant->Omega[i] += omega_dot * dt;
+        plant->Angle[i] += plant->Omega[i] * dt;
+        plant->Angle[i] = fmodf(plant->Angle[i], 2.0f * PLANT_PI);
+        if (plant->Angle[i] < 0)
+            plant->Angle[i] += 2.0f * PLANT_PI;
+        plant->Velocity_RPM[i] = plant->Omega[i] * PLANT_RAD_TO_RPM;
+
+        wheel_accel[i] = omega_dot * PLANT_RAD_TO_RPM * rpm_to_cmps;
+        wheel_vel[i] = plant->Velocity_RPM[i] * rpm_to_cmps;
+    }
+
+    plant->Velocity[0] = (wheel_vel[1] + wheel_vel[2] - wheel_vel[0] - wheel_vel[3]) * PLANT_KX;
+    plant->Velocity[1] = (wheel_vel[0] + wheel_vel[1] - wheel_vel[2] - wheel_vel[3]) * PLANT_KY;
+    plant->Accel[0] = (wheel_accel[1] + wheel_accel[2] - wheel_accel[0] - wheel_accel[3]) * PLANT_KX / 100.0f;
+    plant->Accel[1] = (wheel_accel[0] + wheel_accel[1] - wheel_accel[2] - wheel_accel[3]) * PLANT_KY / 100.0f;
+    plant->Position[0] += plant->Velocity[0] * dt;
+    plant->Position[1] += plant->Velocity[1] * dt;
+}
+
+// 按 C620 电调反馈格式打包 0x201~0x204
+void ChassisPlant_Pack_Feedback(ChassisPlant_t *plant, uint8_t motor, uint8_t data[8])
+{
+    uint16_t angle = (uint16_t)(plant->Angle[motor] / (2.0f * PLANT_PI) * 8192.0f) & 0x1FFF;
+    int16_t rpm = (int16_t)lrintf(plant->Velocity_RPM[motor]);
+    int16_t current = (int16_t)plant->Current[motor];
+
+    data[0] = angle >> 8;
+    data[1] = angle;
+    data[2] = rpm >> 8;
+    data[3] = rpm;
+    data[4] = current >> 8;
+    data[5] = current;
+    data[6] = 40;
+    data[7] = 0;
+}
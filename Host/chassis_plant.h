@@ -0,0 +1,42 @@
+/**
+ ******************************************************************************
+ * @file    chassis_plant.h
+ * @brief   麦克纳姆轮底盘被控对象模型 mecanum chassis plant model
+ *          四个 M3508 + C620, 输入为 C620 电流给定值, 输出为电调反馈帧
+ *          与车体加速度 (BMI088.Accel 同单位)
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#ifndef _CHASSIS_PLANT_H
+#define _CHASSIS_PLANT_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    // 参数 均折算到电机转子侧
+    float TorqueConstant; // N*m/A
+    float Inertia;        // kg*m^2 含四分之一车体质量的折算惯量
+    float Viscous;        // N*m*s/rad
+    float Coulomb;        // N*m
+    float WheelRadius;    // m
+    float ReductionRatio;
+
+    // 状态
+    float Current[4]; // C620 给定值 [-16384, 16384]
+    float Omega[4];   // 转子角速度 rad/s
+    float Angle[4];   // 转子角度 rad
+    float Velocity_RPM[4];
+
+    float Velocity[2]; // 车体速度 cm/s, 与 Chassis.Vx_is/Vy_is 同一坐标系
+    float Accel[2];    // 车体加速度 m/s^2
+    float Position[2]; // cm
+} ChassisPlant_t;
+
+void ChassisPlant_Init(ChassisPlant_t *plant);
+void ChassisPlant_Update(ChassisPlant_t *plant, const float current[4], float dt);
+void ChassisPlant_Pack_Feedback(ChassisPlant_t *plant, uint8_t motor, uint8_t data[8]);
+
+#endif
@@ -0,0 +1,265 @@
+/**
+ ******************************************************************************
+ * @file    chassis_sim.c
+ * @brief   主机闭环仿真 host closed-loop simulation
+ *          以虚拟时钟按 CHASSIS_TASK_PERIOD 调用 Chassis_Control(),
+ *          电机反馈与云台板转发的遥控器数据经 HAL_CAN_RxFifo0MsgPendingCallback 注入,
+ *          被控对象由 chassis_plant.c 给出, 统计 Chassis_Control() 的主机耗时;
+ *          -l 将两路总线上收发的帧记录为 candump 日志, 可由 can_replay 回放
+ *          -l records the frames received and sent on both buses as a candump log for can_replay
+ *          -T 每个周期采样一帧遥测, 将串口发出的字节流写入文件, 可由 telem_decode 解出 CSV
+ *          -T samples telemetry every tick and writes the UART byte stream to a file for telem_decode
+ *          -B 结束时以复位请求模拟重启, 将黑匣子转存的 flash 扇区写入文件, 可由 blackbox_decode 解出 CSV
+ *          -B emulates a reboot on a reset request at the end and writes the flash sector holding the
+ *          black-box dump to a file for blackbox_decode
+ *
+ *          usage: chassis_sim [-n ticks] [-o trace.csv] [-l can.log] [-T telem.bin] [-B blackbox.bin]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_hal.h"
+#include "can_log.h"
+#include "chassis_plant.h"
+#include "chassis_task.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include "blackbox.h"
+
+static ChassisPlant_t ChassisPlant;
+static FILE *CanLog = NULL;
+static FILE *TelemLog = NULL;
+static FILE *BlackBoxDump = NULL;
+
+static double Host_Wall_Time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void Sim_Log_Frame(uint8_t bus, uint32_t std_id, const uint8_t *data, uint8_t dlc)
+{
+    static const char *iface[2] = {"can0", "can1"};
+    CAN_Log_Frame_t frame = {0};
+
+    if (CanLog == NULL)
+        return;
+    frame.Time_us = Host_Clock_Get_us();
+    frame.Bus = bus;
+    frame.Id = std_id;
+    frame.DLC = dlc;
+    memcpy(frame.Data, data, dlc);
+    CAN_Log_Write(CanLog, iface[bus], &frame);
+}
+
+static void Sim_Receive(CAN_HandleTypeDef *hcan, uint32_t std_id, const uint8_t *data)
+{
+    Sim_Log_Frame(hcan == &hcan2, std_id, data, 8);
+    Host_CAN_Receive(hcan, std_id, data, 8);
+}
+
+static void Sim_Log_Tx(CAN_HandleTypeDef *hcan, const CAN_TxHeaderTypeDef *header, const uint8_t *data)
+{
+    Sim_Log_Frame(hcan == &hcan2, header->StdId, data, header->DLC);
+}
+
+static void Sim_Telem_Tx(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len)
+{
+    if (huart == &huart6)
+        fwrite(data, 1, len, TelemLog);
+}
+
+// 遥控器激励: 前后阶跃 + 左右正弦, 周期 8s; 与云台板相同, 以 0x131/0x132 两帧发送 DR16 的 16 字节数据
+// remote control excitation: forward steps and a lateral sine over 8 s; sent as the 16 DR16 bytes
+// in the 0x131/0x132 frames, as the gimbal board does
+static void Sim_Set_RemoteControl(uint32_t tick)
+{
+    float t = tick * CHASSIS_TASK_PERIOD * 0.001f;
+    float phase = fmodf(t, 8.0f);
+    int16_t ch[4];
+    uint64_t bits = 0;
+    uint8_t buf[16] = {0};
+
+    ch[0] = 0;
+    ch[1] = 0;
+    ch[2] = phase < 2.0f ? 330 : (phase < 4.0f ? 0 : (phase < 6.0f ? -330 : 0));
+    ch[3] = (int16_t)(200.0f * sinf(2.0f * PI * t / 8.0f));
+    for (uint8_t i = 0; i < 4; i++)
+        bits |= (uint64_t)((ch[i] + RC_CH_VALUE_OFFSET) & 0x07FF) << (11 * i);
+    bits |= (uint64_t)Switch_Middle << 44;
+    bits |= (uint64_t)Switch_Middle << 46;
+    for (uint8_t i = 0; i < 6; i++)
+        buf[i] = (bits >> (8 * i)) & 0xff;
+
+    Sim_Receive(&hcan2, CAN_RC_DATA_Frame_0, buf);
+    Sim_Receive(&hcan2, CAN_RC_DATA_Frame_1, buf + 8);
+}
+
+static void Sim_Feed_Sensors(void)
+{
+    uint8_t data[8];
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        ChassisPlant_Pack_Feedback(&ChassisPlant, i, data);
+        Sim_Receive(&hcan1, CAN_Receive_1_ID + i, data);
+    }
+    BMI088.Accel[0] = ChassisPlant.Accel[0];
+    BMI088.Accel[1] = ChassisPlant.Accel[1];
+    BMI088.Accel[2] = 9.8f;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = 500000;
+    FILE *trace = NULL;
+    double wall_start, wall_total, t0, cost, cost_sum = 0, cost_max = 0;
+    float current[4];
+    static char text[2048];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            ticks = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            trace = fopen(argv[++i], "w");
+            if (trace == NULL)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+        {
+            CanLog = fopen(argv[++i], "w");
+            if (CanLog == NULL)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc)
+        {
+            TelemLog = fopen(argv[++i], "wb");
+            if (TelemLog == NULL)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "-B") == 0 && i + 1 < argc)
+        {
+            BlackBoxDump = fopen(argv[++i], "wb");
+            if (BlackBoxDump == NULL)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-n ticks] [-o trace.csv] [-l can.log] [-T telem.bin] [-B blackbox.bin]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Host_HAL_Init();
+    BlackBox_Boot(RCC_CSR_PORRSTF, CHASSIS_TASK_PERIOD * 1000);
+    DWT_Init(HOST_CPU_FREQ_MHZ);
+    CAN_Device_Init();
+    Chassis_Init();
+    ChassisPlant_Init(&ChassisPlant);
+    Host_CAN_Set_Tx_Callback(Sim_Log_Tx);
+    if (TelemLog != NULL)
+    {
+        // 与固件相同, 遥测任务每 1 ms 发送一次 as in the firmware, the telemetry task sends every 1 ms
+        Telem_Init(&huart6);
+        Telem_Config.Decimation = 1;
+        Host_UART_Set_Tx_Callback(Sim_Telem_Tx);
+    }
+
+    if (trace != NULL)
+        fprintf(trace, "t,ch3,ch4,V1,V2,V3,V4,rpm1,rpm2,rpm3,rpm4,out1,out2,out3,out4,"
+                       "plant_vx,plant_vy,est_vx,est_vy,est_px,est_py,plant_px,plant_py\n");
+
+    wall_start = Host_Wall_Time_s();
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        Sim_Set_RemoteControl(tick);
+        Sim_Feed_Sensors();
+        Host_Clock_Advance_us(CHASSIS_TASK_PERIOD * 1000);
+
+        t0 = Host_Wall_Time_s();
+        Chassis_Control();
+        cost = Host_Wall_Time_s() - t0;
+        cost_sum += cost;
+        if (cost > cost_max)
+            cost_max = cost;
+        Telem_Sample();
+        for (uint8_t i = 0; i < CHASSIS_TASK_PERIOD / TELEM_TASK_PERIOD; i++)
+            Telem_Task();
+
+        // Send_Chassis_Current() 当前发送零电流, 对象直接取速度环输出
+        for (uint8_t i = 0; i < 4; i++)
+            current[i] = Chassis.ChassisMotor[i].Output;
+        ChassisPlant_Update(&ChassisPlant, current, CHASSIS_TASK_PERIOD * 0.001f);
+
+        if (trace != NULL)
+            fprintf(trace, "%.3f,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,"
+                           "%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                    Host_Clock_Get_us() * 1e-6, remote_control.ch3, remote_control.ch4,
+                    Chassis.V1, Chassis.V2, Chassis.V3, Chassis.V4,
+                    Chassis.ChassisMotor[0].Velocity_RPM, Chassis.ChassisMotor[1].Velocity_RPM,
+                    Chassis.ChassisMotor[2].Velocity_RPM, Chassis.ChassisMotor[3].Velocity_RPM,
+                    Chassis.ChassisMotor[0].Output, Chassis.ChassisMotor[1].Output,
+                    Chassis.ChassisMotor[2].Output, Chassis.ChassisMotor[3].Output,
+                    ChassisPlant.Velocity[0], ChassisPlant.Velocity[1],
+                    Chassis.Velocity[0], Chassis.Velocity[1],
+                    Chassis.Position[0], Chassis.Position[1],
+                    ChassisPlant.Position[0], ChassisPlant.Position[1]);
+    }
+    wall_total = Host_Wall_Time_s() - wall_start;
+
+    if (trace != NULL)
+        fclose(trace);
+    if (CanLog != NULL)
+        fclose(CanLog);
+    if (TelemLog != NULL)
+        fclose(TelemLog);
+    if (BlackBoxDump != NULL)
+    {
+        BlackBox_Mark(BLACKBOX_REASON_REQUEST);
+        BlackBox_Boot(RCC_CSR_SFTRSTF, CHASSIS_TASK_PERIOD * 1000);
+        fwrite(Host_Flash_Map(BLACKBOX_FLASH_ADDR, BLACKBOX_FLASH_SIZE), 1, BLACKBOX_FLASH_SIZE, BlackBoxDump);
+        fclose(BlackBoxDump);
+    }
+
+    printf("ticks            %u (%.1f s simulated)\n", ticks, ticks * CHASSIS_TASK_PERIOD * 0.001);
+    printf("wall time        %.3f s, %.0f ticks/s\n", wall_total, ticks / wall_total);
+    printf("Chassis_Control  mean %.0f ns, max %.0f ns\n", cost_sum / ticks * 1e9, cost_max * 1e9);
+    printf("CAN1 tx/rx       %u/%u, CAN2 tx/rx %u/%u\n",
+           Host_CAN_Stat[0].TxCount, Host_CAN_Stat[0].RxCount, Host_CAN_Stat[1].TxCount, Host_CAN_Stat[1].RxCount);
+    printf("CAN rx queue     unhandled %u/%u, overflow %u, high water %u/%u\n",
+           CAN_RxStat[0].Unhandled, CAN_RxStat[1].Unhandled, CAN_RxQueue.Overflow, CAN_RxQueue.HighWater, CAN_RX_QUEUE_LEN);
+    if (TelemLog != NULL)
+        printf("telemetry        frames %u, dropped %u, schema %u, %u bytes\n",
+               Telem_Stat.Frames, Telem_Stat.Dropped, Telem_Stat.Schema, Telem_Stat.Bytes);
+    if (BlackBoxDump != NULL)
+        printf("black box        %u sector erased, %u words programmed\n", Host_Flash_Stat.Erase, Host_Flash_Stat.Program);
+    printf("plant  vel [%.2f %.2f] cm/s pos [%.2f %.2f] cm\n",
+           ChassisPlant.Velocity[0], ChassisPlant.Velocity[1], ChassisPlant.Position[0], ChassisPlant.Position[1]);
+    printf("est    vel [%.2f %.2f] cm/s pos [%.2f %.2f] cm\n",
+           Chassis.Velocity[0], Chassis.Velocity[1], Chassis.Position[0], Chassis.Position[1]);
+
+    Profile_Format(text, sizeof(text));
+    printf("%s", text);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ * @file    crc_bench.c
+ * @brief   CRC8/CRC16 校验与吞吐测试 CRC8/CRC16 cross-check and throughput benchmark
+ *          1. 逐字节表与按多项式逐位计算的结果一致
+ *          2. 对每个初值, 4 字节字中每个位置的每个字节值, slice-by-4 与逐字节查表一致
+ *          3. 随机数据的所有长度 (0~300) 与对齐, 在任意位置分段增量计算结果不变
+ *          4. 帧长与长数据上逐字节查表与 slice-by-4 的吞吐
+ *          1. the byte-wise tables match a bit-by-bit computation from the polynomial
+ *          2. for every initial value, every byte value at every position of a 4 byte
+ *             word, slice-by-4 matches the byte-wise table
+ *          3. random data of every length (0~300) and alignment gives the same result
+ *             when fed incrementally, split at any point
+ *          4. throughput of the byte-wise table and slice-by-4 at frame sizes and on long data
+ *
+ *          usage: crc_bench [-n bytes]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  x86 主机上以 TSC 周期计 bytes/cycle, 与 Cortex-M4 的周期数不可直接比较
+ *  bytes/cycle is measured in TSC cycles on x86 hosts, not comparable to Cortex-M4 cycles
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "crc8_16.h"
+
+#define BENCH_MAX_LEN 300
+
+static uint8_t Fail = 0;
+static volatile uint32_t Sink;
+
+static double Host_Wall_Time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t Host_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 原 judgement_info.c 的逐字节实现 the byte-wise loops formerly in judgement_info.c
+static uint8_t Bytewise_CRC8(uint8_t crc, const uint8_t *data, uint32_t len)
+{
+    while (len--)
+        crc = CRC8_Table[0][crc ^ *data++];
+    return crc;
+}
+
+static uint16_t Bytewise_CRC16(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+    while (len--)
+        crc = (crc >> 8) ^ CRC16_Table[0][(crc ^ *data++) & 0xFF];
+    return crc;
+}
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static uint8_t Check_Tables(void)
+{
+    uint16_t crc8, crc16;
+
+    for (uint16_t i = 0; i < 256; i++)
+    {
+        crc8 = i;
+        crc16 = i;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc8 = crc8 & 1 ? (crc8 >> 1) ^ 0x8C : crc8 >> 1;         // x8+x5+x4+1 反射 reflected
+            crc16 = crc16 & 1 ? (crc16 >> 1) ^ 0x8408 : crc16 >> 1; // x16+x12+x5+1 反射 reflected
+        }
+        if (CRC8_Table[0][i] != crc8 || CRC16_Table[0][i] != crc16)
+            return 0;
+    }
+    return 1;
+}
+
+static uint8_t Check_Words(void)
+{
+    // 4 字节对齐, 保证走 slice-by-4 路径 4 byte aligned so the slice-by-4 path is taken
+    static uint32_t word;
+    uint8_t *w = (uint8_t *)&word;
+
+    for (uint32_t init = 0; init < 65536; init++)
+        for (uint8_t pos = 0; pos < 4; pos++)
+            for (uint16_t v = 0; v < 256; v++)
+            {
+                word = 0x5A3C96E1;
+                w[pos] = (uint8_t)v;
+                if (CRC16_Update((uint16_t)init, w, 4) != Bytewise_CRC16((uint16_t)init, w, 4))
+                    return 0;
+                if (init < 256 && CRC8_Update((uint8_t)init, w, 4) != Bytewise_CRC8((uint8_t)init, w, 4))
+                    return 0;
+            }
+    return 1;
+}
+
+static uint8_t Check_Lengths(uint32_t *seed)
+{
+    static uint8_t buf[BENCH_MAX_LEN + 8];
+    uint8_t *data, crc8;
+    uint16_t crc16;
+
+    for (uint32_t i = 0; i < sizeof(buf); i++)
+    {
+        *seed = *seed * 1664525u + 1013904223u;
+        buf[i] = *seed >> 24;
+    }
+    for (uint8_t align = 0; align < 4; align++)
+        for (uint32_t len = 0; len <= BENCH_MAX_LEN; len++)
+        {
+            data = buf + align;
+            crc8 = Bytewise_CRC8(0xFF, data, len);
+            crc16 = Bytewise_CRC16(0xFFFF, data, len);
+            for (uint32_t split = 0; split <= len; split++)
+            {
+                if (CRC8_Update(CRC8_Update(0xFF, data, split), data + split, len - split) != crc8)
+                    return 0;
+                if (CRC16_Update(CRC16_Update(0xFFFF, data, split), data + split, len - split) != crc16)
+                    return 0;
+            }
+        }
+    return 1;
+}
+
+static void Bench(const char *name, const uint8_t *data, uint32_t len, uint32_t total)
+{
+    uint32_t rounds = total / len, s = 0;
+    double t[4];
+    uint64_t c[4];
+
+    for (uint8_t k = 0; k < 4; k++)
+    {
+        t[k] = Host_Wall_Time_s();
+        c[k] = Host_Cycles();
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            switch (k)
+            {
+            case 0:
+                s += Bytewise_CRC8(0xFF, data, len);
+                break;
+            case 1:
+                s += CRC8_Update(0xFF, data, len);
+                break;
+            case 2:
+                s += Bytewise_CRC16(0xFFFF, data, len);
+                break;
+            default:
+                s += CRC16_Update(0xFFFF, data, len);
+                break;
+            }
+            __asm__ volatile("" ::: "memory");
+        }
+        t[k] = Host_Wall_Time_s() - t[k];
+        c[k] = Host_Cycles() - c[k];
+    }
+    Sink = s;
+
+    printf("%-14s", name);
+    for (uint8_t k = 0; k < 4; k++)
+    {
+        if (c[k] != 0)
+            printf("  %5.2f ns %5.2f B/c", t[k] / ((double)rounds * len) * 1e9, (double)rounds * len / c[k]);
+        else
+            printf("  %5.2f ns        ", t[k] / ((double)rounds * len) * 1e9);
+    }
+    printf("   x%.2f x%.2f\n", t[0] / t[1], t[2] / t[3]);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t total = 64u << 20, seed = 1;
+    static uint8_t data[4096];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            total = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n bytes]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("cross-check (CRC_SLICE_BY_4 = %d)\n", CRC_SLICE_BY_4);
+    Check(Check_Tables(), "byte-wise tables match the polynomials");
+    Check(Check_Words(), "slice-by-4 matches byte-wise, all inits x positions x bytes");
+    Check(Check_Lengths(&seed), "lengths 0~300 x alignments 0~3, split at every point");
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = seed >> 24;
+    }
+    printf("\nper byte       CRC8 byte-wise        CRC8 slice-by-4       CRC16 byte-wise       CRC16 slice-by-4      speedup\n");
+    Bench("header 4 B", data, 4, total / 8);
+    Bench("power 25 B", data, 23, total / 2);
+    Bench("frame 128 B", data, 126, total);
+    Bench("4096 B", data, sizeof(data), total);
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/**
+ ******************************************************************************
+ * @file    history_test.c
+ * @brief   带时间戳状态历史的主机测试 host test of the timestamped state history
+ *          检查环形缓冲区绕回, 跨绕回点的按时间查找与插值, 空历史与超出记录范围的查询,
+ *          并以随机时间戳与线性查找逐次对比
+ *          checks the ring buffer wraparound, lookup and interpolation by time across
+ *          the wrap point, empty and out-of-range queries, and compares every lookup
+ *          with a linear search on random timestamps, and that the DWT timeline used as
+ *          the timestamp source stays exact across CYCCNT wraps
+ *
+ *          usage: history_test
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_hal.h"
+#include "bsp_dwt.h"
+#include "state_history.h"
+
+#define TEST_LEN 8
+#define TEST_INSERTS 20 // 写满两圈半 two and a half laps
+#define TEST_RANDOM_LEN 13
+#define TEST_RANDOM_INSERTS 5000
+#define TEST_TIMELINE_WRAPS 3  // CYCCNT 回绕次数 CYCCNT wraps to run through
+#define TEST_TIMELINE_STEP_US 997
+
+static uint8_t Fail = 0;
+static uint32_t Seed = 1;
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static uint32_t Rand(uint32_t n)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return (Seed >> 8) % n;
+}
+
+static float Value_At(History_t *history, int32_t slot)
+{
+    return slot < 0 ? NAN : *(float *)History_Get(history, (uint16_t)slot);
+}
+
+// 第 i 帧的时间戳, 间隔不均匀 timestamp of frame i, unevenly spaced
+static uint64_t Time_Of(uint32_t i)
+{
+    return 1000000ull + i * 1000ull + (i % 3) * 100ull;
+}
+
+// 以线性查找给出最接近的时间戳, 前后距离相等时取较早的一个; 时间戳相同的帧之间不作区分
+// closest timestamp by linear search, the earlier one when both sides are equally far;
+// frames with the same timestamp are not told apart
+static uint64_t Closest_Linear(const uint64_t *time, uint32_t first, uint32_t last, uint64_t t)
+{
+    uint32_t best = first;
+    uint64_t best_d = UINT64_MAX, d;
+
+    for (uint32_t i = first; i <= last; i++)
+    {
+        d = time[i] > t ? time[i] - t : t - time[i];
+        if (d < best_d)
+        {
+            best_d = d;
+            best = i;
+        }
+    }
+    return time[best];
+}
+
+int main(void)
+{
+    static float frame[TEST_LEN], random_frame[TEST_RANDOM_LEN];
+    static uint64_t time_stamp[TEST_LEN], random_time_stamp[TEST_RANDOM_LEN];
+    static float value[TEST_RANDOM_INSERTS];
+    static uint64_t time[TEST_RANDOM_INSERTS];
+    History_t history, random_history;
+    uint32_t oldest = TEST_INSERTS - TEST_LEN, mismatch = 0, interp_mismatch = 0;
+    float v = 0, a, b, q[4];
+    uint8_t ok;
+
+    History_Init_Static(&history, frame, time_stamp, History_Lerp_f32);
+
+    // 空历史 empty history
+    Check(History_Find(&history, Time_Of(0)) == -1, "empty history: History_Find() returns -1");
+    Check(History_Interp(&history, Time_Of(0), &v) == 0, "empty history: History_Interp() returns 0");
+
+    for (uint32_t i = 0; i < TEST_INSERTS; i++)
+    {
+        v = (float)i;
+        History_Insert(&history, &v, Time_Of(i));
+    }
+    Check(history.Count == TEST_LEN && history.Head == TEST_INSERTS % TEST_LEN,
+          "wraparound: count saturates at the length, head wraps");
+
+    // 保留的每一帧均能按自身时间戳找到, 包括跨绕回点的帧
+    // every retained frame is found by its own timestamp, including those across the wrap point
+    ok = 1;
+    for (uint32_t i = oldest; i < TEST_INSERTS; i++)
+        ok &= Value_At(&history, History_Find(&history, Time_Of(i))) == (float)i;
+    Check(ok, "lookup by exact timestamp across the wrap");
+
+    // 相邻两帧之间取较近的一帧 between two frames the closer one is returned
+    ok = 1;
+    for (uint32_t i = oldest; i + 1 < TEST_INSERTS; i++)
+    {
+        uint64_t t0 = Time_Of(i), t1 = Time_Of(i + 1);
+        ok &= Value_At(&history, History_Find(&history, t0 + (t1 - t0) / 4)) == (float)i;
+        ok &= Value_At(&history, History_Find(&history, t1 - (t1 - t0) / 4)) == (float)(i + 1);
+    }
+    Check(ok, "lookup between frames returns the closer one");
+
+    // 绕回点两侧的两帧之间插值: 槽位 TEST_LEN-1 与 0 the frames either side of the wrap: slots TEST_LEN-1 and 0
+    {
+        uint32_t before = oldest + (TEST_LEN - 1 - history.Head), after = before + 1;
+        uint64_t t = (Time_Of(before) + Time_Of(after)) / 2;
+        float expected = before + (float)(t - Time_Of(before)) / (float)(Time_Of(after) - Time_Of(before));
+
+        History_Interp(&history, t, &v);
+        Check(fabsf(v - expected) < 1e-5f, "interpolation between the frames on either side of the wrap");
+    }
+
+    // 早于最旧帧 (已被覆盖的帧) 与晚于最新帧的查询取端点帧
+    // queries older than the oldest retained frame (overwritten ones) or newer than the newest clamp to the ends
+    Check(Value_At(&history, History_Find(&history, Time_Of(0))) == (float)oldest &&
+              Value_At(&history, History_Find(&history, Time_Of(oldest) - 1)) == (float)oldest,
+          "too old query: History_Find() returns the oldest retained frame");
+    Check(History_Interp(&history, Time_Of(0), &v) == 1 && v == (float)oldest,
+          "too old query: History_Interp() clamps to the oldest retained frame");
+    Check(Value_At(&history, History_Find(&history, Time_Of(TEST_INSERTS) * 2)) == (float)(TEST_INSERTS - 1) &&
+              History_Interp(&history, Time_Of(TEST_INSERTS) * 2, &v) == 1 && v == (float)(TEST_INSERTS - 1),
+          "too new query: both clamp to the newest frame");
+
+    // 随机间隔 (含相同时间戳) 与线性查找逐次对比 random spacing, repeated timestamps included, against a linear search
+    History_Init_Static(&random_history, random_frame, random_time_stamp, History_Lerp_f32);
+    for (uint32_t i = 0; i < TEST_RANDOM_INSERTS; i++)
+    {
+        value[i] = (float)Rand(100000);
+        time[i] = (i ? time[i - 1] : 10000) + Rand(4) * 250;
+        History_Insert(&random_history, &value[i], time[i]);
+
+        {
+            uint32_t first = i + 1 > TEST_RANDOM_LEN ? i + 1 - TEST_RANDOM_LEN : 0;
+            uint64_t span = time[i] - time[first] + 2000;
+            uint64_t t = time[first] + Rand((uint32_t)span) - 1000;
+            int32_t slot = History_Find(&random_history, t);
+
+            if (slot < 0 || random_time_stamp[slot] != Closest_Linear(time, first, i, t))
+                mismatch++;
+            // 插值结果落在前后两帧的值之间 the interpolated value lies between the bracketing values
+            History_Interp(&random_history, t, &v);
+            a = b = value[first];
+            for (uint32_t j = first; j <= i; j++)
+                if (time[j] <= t)
+                {
+                    a = value[j];
+                    b = j < i ? value[j + 1] : value[j];
+                }
+            if (t >= time[first] && !(v >= fminf(a, b) - 1e-3f && v <= fmaxf(a, b) + 1e-3f))
+                interp_mismatch++;
+        }
+    }
+    printf("random: %u inserts into %u slots, %u lookup and %u interpolation mismatches\n",
+           TEST_RANDOM_INSERTS, TEST_RANDOM_LEN, mismatch, interp_mismatch);
+    Check(mismatch == 0, "random timestamps: History_Find() matches a linear search");
+    Check(interp_mismatch == 0, "random timestamps: History_Interp() stays between the bracketing frames");
+
+    // 插值函数 interpolators
+    a = 170, b = -170;
+    History_Lerp_Angle_Deg(&a, &b, 0.5f, &v);
+    Check(fabsf(fabsf(v) - 180.0f) < 1e-4f, "angle lerp takes the short way across +-180");
+    {
+        const float qa[4] = {1, 0, 0, 0}, qb[4] = {-cosf(0.5f), 0, 0, -sinf(0.5f)}; // -q 为同一姿态 -q is the same attitude
+        History_Slerp_Quaternion(qa, qb, 0.5f, q);
+        Check(fabsf(q[0] - cosf(0.25f)) < 1e-5f && fabsf(q[3] - sinf(0.25f)) < 1e-5f &&
+                  fabsf(q[0] * q[0] + q[3] * q[3] - 1) < 1e-5f,
+              "quaternion slerp takes the shorter arc and stays unit length");
+    }
+
+    // 时间戳来源: DWT 时间轴 timestamp source: the DWT timeline
+    {
+        uint64_t end_us = (uint64_t)TEST_TIMELINE_WRAPS * ((1ull << 32) / HOST_CPU_FREQ_MHZ + 1);
+        uint64_t last = 0, t;
+        uint32_t exact = 1, monotonic = 1, at_exact = 1, cyccnt;
+
+        Host_HAL_Init();
+        DWT_Init(HOST_CPU_FREQ_MHZ);
+        while (Host_Clock_Get_us() < end_us)
+        {
+            cyccnt = DWT->CYCCNT;
+            Host_Clock_Advance_us(TEST_TIMELINE_STEP_US / 3);
+            at_exact &= DWT_GetTimeline_us_At(cyccnt) == Host_Clock_Get_us() - TEST_TIMELINE_STEP_US / 3;
+            Host_Clock_Advance_us(TEST_TIMELINE_STEP_US - TEST_TIMELINE_STEP_US / 3);
+            t = DWT_GetTimeline_us();
+            exact &= t == Host_Clock_Get_us();
+            monotonic &= t >= last;
+            last = t;
+        }
+        Check(monotonic, "DWT timeline never goes backwards across CYCCNT wraps");
+        Check(exact, "DWT timeline matches the virtual clock, 2^32 cycles per wrap");
+        Check(at_exact, "DWT_GetTimeline_us_At() dates an earlier CYCCNT exactly");
+    }
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
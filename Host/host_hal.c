@@ -0,0 +1,613 @@
+/**
+ ******************************************************************************
+ * @file    host_hal.c
+ * @brief   主机构建下的 HAL/CAN/RTOS 桩 host-side HAL stubs
+ *          1. 虚拟时钟驱动 DWT->CYCCNT 与 HAL_GetTick()/xTaskGetTickCount()
+ *          2. bxCAN 发送按 3 个邮箱与 1 Mbps 位时间建模, 完成时触发发送中断回调;
+ *             接收由仿真主动注入
+ *          3. 未参与主机构建的外设模块 (INA226/ADC/串口空闲中断) 给出最小实现
+ *          4. host_rtos 构建 (定义 HOST_RTOS) 中 FreeRTOS 为真实内核, 句柄与外设模块来自固件源文件,
+ *             时钟推进后交给移植层送达节拍, CAN 发送完成在中断上下文中回调
+ *          4. in the host_rtos build (HOST_RTOS defined) FreeRTOS is the real kernel, handles and
+ *             peripheral modules come from the firmware sources, the port delivers ticks after every
+ *             clock advance and CAN transmit completions call back in interrupt context
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_hal.h"
+#include "cmsis_os.h"
+#include "arm_math.h"
+#include "iwdg.h"
+#include "usart.h"
+#include "i2c.h"
+#include "power_measure.h"
+#include "bsp_usart_idle.h"
+#include "bsp_adc.h"
+#ifdef HOST_RTOS
+#include "host_rtos.h"
+#endif
+
+DWT_Type Host_DWT;
+CoreDebug_Type Host_CoreDebug;
+
+static uint64_t Host_Time_us;
+
+uint32_t Host_CCMRAM[64 * 1024 / 4];
+
+// 仅模拟扇区 11 only sector 11 is modelled
+#define HOST_FLASH_SECTOR11_ADDR 0x080E0000
+#define HOST_FLASH_SECTOR11_SIZE (128 * 1024)
+static uint8_t Host_Flash_Sector11[HOST_FLASH_SECTOR11_SIZE];
+static uint8_t Host_Flash_Locked = 1;
+Host_Flash_Stat_t Host_Flash_Stat;
+
+#ifndef HOST_RTOS
+CAN_HandleTypeDef hcan1;
+CAN_HandleTypeDef hcan2;
+IWDG_HandleTypeDef hiwdg;
+UART_HandleTypeDef huart1;
+UART_HandleTypeDef huart3;
+UART_HandleTypeDef huart6;
+I2C_HandleTypeDef hi2c3;
+#endif
+
+Host_CAN_Stat_t Host_CAN_Stat[2];
+
+static CAN_TypeDef Host_CAN1, Host_CAN2;
+static Host_CAN_Tx_Callback_t Host_CAN_Tx_Callback = NULL;
+static Host_UART_Tx_Callback_t Host_UART_Tx_Callback = NULL;
+
+// bxCAN 发送部分模型: 3 个邮箱, 按 ID 仲裁, 帧按位时间占用总线
+// bxCAN transmit model: three mailboxes, ID arbitration, frames occupy the bus for their bit time
+typedef struct
+{
+    CAN_TxHeaderTypeDef Header[3];
+    uint8_t Data[3][8];
+    uint8_t Pending;    // 第 i 位为邮箱 i 已请求发送 bit i: mailbox i requested
+    int8_t Active;      // 正在总线上的邮箱, -1 为空闲 mailbox on the wire, -1 when idle
+    uint64_t DoneAt_us; // 当前帧发送完成时刻 end of the frame on the wire
+    uint8_t Stalled;
+    uint32_t ActiveITs;
+} Host_bxCAN_t;
+
+static Host_bxCAN_t Host_bxCAN[2];
+
+static struct
+{
+    CAN_RxHeaderTypeDef Header;
+    uint8_t Data[8];
+} Host_CAN_RxFrame;
+
+void Host_HAL_Init(void)
+{
+#ifdef HOST_RTOS
+    Host_Periph_Init();
+#endif
+    // Cortex-M4 FPU 处理非规格化数无额外开销, x86 上则慢数十倍,
+    // 开启 FTZ/DAZ 以免协方差衰减到非规格化区间后主机耗时失真
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_ldmxcsr(__builtin_ia32_stmxcsr() | 0x8040);
+#endif
+    Host_Time_us = 0;
+    memset(&Host_DWT, 0, sizeof(Host_DWT));
+
+    hcan1.Instance = &Host_CAN1;
+    hcan2.Instance = &Host_CAN2;
+    memset(Host_bxCAN, 0, sizeof(Host_bxCAN));
+    memset(Host_CAN_Stat, 0, sizeof(Host_CAN_Stat));
+    Host_bxCAN[0].Active = -1;
+    Host_bxCAN[1].Active = -1;
+    hcan1.State = HAL_CAN_STATE_LISTENING;
+    hcan2.State = HAL_CAN_STATE_LISTENING;
+    // 三个发送邮箱初始为空
+    Host_CAN1.TSR = CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2;
+    Host_CAN2.TSR = CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2;
+#ifndef HOST_RTOS
+    // host_rtos 构建中由固件的 MX_USARTx_UART_Init() 置位 set by the firmware MX_USARTx_UART_Init() in the host_rtos build
+    huart1.gState = HAL_UART_STATE_READY;
+    huart3.gState = HAL_UART_STATE_READY;
+    huart6.gState = HAL_UART_STATE_READY;
+#endif
+
+    ina226[0].Bus_Voltage = 24.0f;
+
+    memset(Host_Flash_Sector11, 0xFF, sizeof(Host_Flash_Sector11));
+    memset(&Host_Flash_Stat, 0, sizeof(Host_Flash_Stat));
+}
+
+/*************************** virtual clock ***************************/
+static void Host_CAN_Tx_Done(uint8_t bus);
+#ifdef HOST_RTOS
+static void Host_CAN_Tx_IRQHandler(void *can);
+#endif
+
+// 只向前推进: 任务在推进途中被抢占时, 其他任务可能已越过目标时刻, 与 HAL_Delay() 的绝对截止时刻相同
+// only moves forward: a task preempted while advancing may find another task already past its target,
+// the same as the absolute deadline of HAL_Delay()
+static void Host_Clock_Set_us(uint64_t time_us)
+{
+    if (time_us <= Host_Time_us)
+        return;
+    Host_DWT.CYCCNT += (uint32_t)(time_us - Host_Time_us) * HOST_CPU_FREQ_MHZ;
+    Host_Time_us = time_us;
+}
+
+// 推进时钟, 期间按时间顺序处理 CAN 发送完成事件
+// advance the clock, handling CAN transmit completions in time order on the way
+void Host_Clock_Advance_us(uint32_t us)
+{
+    uint64_t target = Host_Time_us + us;
+    int8_t bus;
+
+    for (;;)
+    {
+        bus = -1;
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            if (Host_bxCAN[i].Active < 0 || Host_bxCAN[i].Stalled || Host_bxCAN[i].DoneAt_us > target)
+                continue;
+            if (bus < 0 || Host_bxCAN[i].DoneAt_us < Host_bxCAN[bus].DoneAt_us)
+                bus = i;
+        }
+        if (bus < 0)
+            break;
+        Host_Clock_Set_us(Host_bxCAN[bus].DoneAt_us);
+#ifdef HOST_RTOS
+        Host_RTOS_ISR(Host_CAN_Tx_IRQHandler, &Host_bxCAN[bus]);
+#else
+        Host_CAN_Tx_Done(bus);
+#endif
+    }
+    Host_Clock_Set_us(target);
+#ifdef HOST_RTOS
+    Host_RTOS_Clock_Hook();
+#endif
+}
+
+uint64_t Host_Clock_Get_us(void)
+{
+    return Host_Time_us;
+}
+
+uint32_t Host_Profile_Cycles(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * HOST_CPU_FREQ_MHZ * 1000000 + (uint64_t)ts.tv_nsec * HOST_CPU_FREQ_MHZ / 1000);
+}
+
+uint32_t SystemCoreClock = HOST_CPU_FREQ_MHZ * 1000000;
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(Host_Time_us / 1000);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    Host_Clock_Advance_us(Delay * 1000);
+}
+
+void HAL_NVIC_SystemReset(void)
+{
+    fprintf(stderr, "HAL_NVIC_SystemReset at %llu us\r\n", (unsigned long long)Host_Time_us);
+    exit(EXIT_FAILURE);
+}
+
+/*************************** FreeRTOS ***************************/
+#ifndef HOST_RTOS
+void *pvPortMalloc(size_t xWantedSize)
+{
+    return malloc(xWantedSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)HAL_GetTick();
+}
+
+static void (*Host_Wake_Hook)(void) = NULL;
+
+void Host_RTOS_Set_Wake_Hook(void (*hook)(void))
+{
+    Host_Wake_Hook = hook;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    HAL_Delay(xTicksToDelay);
+    if (Host_Wake_Hook != NULL)
+        Host_Wake_Hook();
+}
+
+// 节拍为 1ms, 推进到唤醒节拍的开始; 已过期时立即返回 1 ms ticks, advance to the start of the wake-up tick, return at once if it has passed
+void vTaskDelayUntil(TickType_t *const pxPreviousWakeTime, const TickType_t xTimeIncrement)
+{
+    TickType_t wake = *pxPreviousWakeTime + xTimeIncrement;
+
+    if ((int32_t)(wake - xTaskGetTickCount()) > 0)
+    {
+        Host_Clock_Advance_us((uint32_t)((uint64_t)wake * 1000 - Host_Time_us));
+        if (Host_Wake_Hook != NULL)
+            Host_Wake_Hook();
+    }
+    *pxPreviousWakeTime = wake;
+}
+
+// 没有中断给出通知, 等满超时 no interrupt gives notifications, the whole timeout elapses
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    vTaskDelay(xTicksToWait);
+    return 0;
+}
+
+// 单线程仿真, 临界区为空 single threaded simulation, critical sections are empty
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+#else
+DWT_Type *Host_DWT_Access(void)
+{
+    static uint64_t last_us = UINT64_MAX;
+
+    // 同一虚拟时刻的重复读取视为忙等 repeated reads at the same virtual time count as busy waiting
+    if (Host_Time_us == last_us)
+        Host_Clock_Advance_us(1);
+    last_us = Host_Time_us;
+    return &Host_DWT;
+}
+#endif
+
+/*************************** CAN ***************************/
+void Host_CAN_Set_Tx_Callback(Host_CAN_Tx_Callback_t callback)
+{
+    Host_CAN_Tx_Callback = callback;
+}
+
+void Host_CAN_Receive(CAN_HandleTypeDef *hcan, uint32_t std_id, const uint8_t *data, uint8_t dlc)
+{
+    CAN_RxHeaderTypeDef header = {0};
+
+    header.StdId = std_id;
+    header.IDE = CAN_ID_STD;
+    header.RTR = CAN_RTR_DATA;
+    header.DLC = dlc;
+    Host_CAN_Receive_Frame(hcan, &header, data);
+}
+
+void Host_CAN_Receive_Frame(CAN_HandleTypeDef *hcan, const CAN_RxHeaderTypeDef *header, const uint8_t *data)
+{
+    uint8_t dlc = header->DLC > 8 ? 8 : header->DLC;
+
+    Host_CAN_RxFrame.Header = *header;
+    Host_CAN_RxFrame.Header.Timestamp = HAL_GetTick();
+    memset(Host_CAN_RxFrame.Data, 0, sizeof(Host_CAN_RxFrame.Data));
+    if (header->RTR == CAN_RTR_DATA)
+        memcpy(Host_CAN_RxFrame.Data, data, dlc);
+
+    Host_CAN_Stat[hcan == &hcan2].RxCount++;
+    HAL_CAN_RxFifo0MsgPendingCallback(hcan);
+}
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan, CAN_FilterTypeDef *sFilterConfig)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan)
+{
+    hcan->State = HAL_CAN_STATE_LISTENING;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef *hcan, uint32_t ActiveITs)
+{
+    Host_bxCAN[hcan == &hcan2].ActiveITs |= ActiveITs;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_ResetError(CAN_HandleTypeDef *hcan)
+{
+    hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+    return HAL_OK;
+}
+
+// 标准数据帧位数, 含最坏情况位填充与 3 位帧间隔
+// bits of a standard data frame, including worst case bit stuffing and the 3 bit interframe space
+static uint32_t Host_CAN_Frame_Bits(uint8_t dlc)
+{
+    return 47 + 8 * dlc + (34 + 8 * dlc - 1) / 4;
+}
+
+static void Host_CAN_Update_TSR(uint8_t bus)
+{
+    CAN_TypeDef *instance = (bus ? &hcan2 : &hcan1)->Instance;
+    const uint32_t tme[3] = {CAN_TSR_TME0, CAN_TSR_TME1, CAN_TSR_TME2};
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (Host_bxCAN[bus].Pending & (1 << i))
+            instance->TSR &= ~tme[i];
+        else
+            instance->TSR |= tme[i];
+    }
+}
+
+// 总线空闲时按仲裁 (ID 小者优先) 开始发送下一帧, 1 Mbps 下每位 1 us
+// when the bus is idle start the next frame by arbitration (lowest ID wins), 1 us per bit at 1 Mbps
+static void Host_CAN_Start_Next(uint8_t bus)
+{
+    Host_bxCAN_t *can = &Host_bxCAN[bus];
+    int8_t next = -1;
+
+    if (can->Active >= 0 || can->Stalled)
+        return;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (!(can->Pending & (1 << i)))
+            continue;
+        if (next < 0 || can->Header[i].StdId < can->Header[next].StdId)
+            next = i;
+    }
+    if (next < 0)
+        return;
+    can->Active = next;
+    can->DoneAt_us = Host_Time_us + Host_CAN_Frame_Bits(can->Header[next].DLC);
+}
+
+static void Host_CAN_Tx_Done(uint8_t bus)
+{
+    Host_bxCAN_t *can = &Host_bxCAN[bus];
+    CAN_HandleTypeDef *hcan = bus ? &hcan2 : &hcan1;
+    uint8_t mailbox = can->Active;
+
+    can->Pending &= ~(1 << mailbox);
+    can->Active = -1;
+    Host_CAN_Update_TSR(bus);
+    Host_CAN_Stat[bus].TxCount++;
+    if (Host_CAN_Tx_Callback != NULL)
+        Host_CAN_Tx_Callback(hcan, &can->Header[mailbox], can->Data[mailbox]);
+
+    // 硬件在中断响应前已开始下一帧的仲裁 hardware arbitrates the next frame before the ISR runs
+    Host_CAN_Start_Next(bus);
+
+    if (can->ActiveITs & CAN_IT_TX_MAILBOX_EMPTY)
+    {
+        if (mailbox == 0)
+            HAL_CAN_TxMailbox0CompleteCallback(hcan);
+        else if (mailbox == 1)
+            HAL_CAN_TxMailbox1CompleteCallback(hcan);
+        else
+            HAL_CAN_TxMailbox2CompleteCallback(hcan);
+    }
+}
+
+#ifdef HOST_RTOS
+static void Host_CAN_Tx_IRQHandler(void *can)
+{
+    Host_CAN_Tx_Done((Host_bxCAN_t *)can - Host_bxCAN);
+}
+
+// 固件的 MX_CANx_Init() 将句柄指向 CAN1/CAN2 寄存器地址, 此处改接发送模型的寄存器
+// the firmware MX_CANx_Init() points the handle at the CAN1/CAN2 addresses, rebind it to the model registers
+HAL_StatusTypeDef HAL_CAN_Init(CAN_HandleTypeDef *hcan)
+{
+    hcan->Instance = hcan == &hcan2 ? &Host_CAN2 : &Host_CAN1;
+    hcan->Instance->TSR = CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2;
+    hcan->State = HAL_CAN_STATE_READY;
+    return HAL_OK;
+}
+#endif
+
+void Host_CAN_Set_Stalled(CAN_HandleTypeDef *hcan, uint8_t stalled)
+{
+    Host_bxCAN_t *can = &Host_bxCAN[hcan == &hcan2];
+
+    can->Stalled = stalled;
+    if (!stalled)
+    {
+        // 恢复后重新发送被挂起的帧 restart the frame that was on the wire
+        if (can->Active >= 0)
+            can->DoneAt_us = Host_Time_us + Host_CAN_Frame_Bits(can->Header[can->Active].DLC);
+        else
+            Host_CAN_Start_Next(hcan == &hcan2);
+    }
+}
+
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef *hcan)
+{
+    uint8_t pending = Host_bxCAN[hcan == &hcan2].Pending;
+    return 3 - ((pending & 1) + ((pending >> 1) & 1) + ((pending >> 2) & 1));
+}
+
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *pHeader, uint8_t aData[], uint32_t *pTxMailbox)
+{
+    uint8_t bus = hcan == &hcan2;
+    Host_bxCAN_t *can = &Host_bxCAN[bus];
+    uint8_t mailbox;
+
+    if (hcan->State != HAL_CAN_STATE_READY && hcan->State != HAL_CAN_STATE_LISTENING)
+    {
+        hcan->ErrorCode |= HAL_CAN_ERROR_NOT_INITIALIZED;
+        return HAL_ERROR;
+    }
+    for (mailbox = 0; mailbox < 3; mailbox++)
+        if (!(can->Pending & (1 << mailbox)))
+            break;
+    if (mailbox == 3)
+    {
+        hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+        return HAL_ERROR;
+    }
+
+    can->Header[mailbox] = *pHeader;
+    memcpy(can->Data[mailbox], aData, 8);
+    can->Pending |= 1 << mailbox;
+    Host_CAN_Update_TSR(bus);
+    if (pTxMailbox != NULL)
+        *pTxMailbox = CAN_TX_MAILBOX0 << mailbox;
+
+    Host_CAN_Start_Next(bus);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan, uint32_t RxFifo, CAN_RxHeaderTypeDef *pHeader, uint8_t aData[])
+{
+    *pHeader = Host_CAN_RxFrame.Header;
+    memcpy(aData, Host_CAN_RxFrame.Data, 8);
+    return HAL_OK;
+}
+
+/*************************** flash ***************************/
+// 擦除置 0xFF, 编程只能将位清零, 与 NOR flash 相同 erase sets 0xFF and programming only clears bits, as on NOR flash
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    Host_Flash_Locked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    Host_Flash_Locked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError)
+{
+    *SectorError = 0xFFFFFFFFU;
+    if (Host_Flash_Locked || pEraseInit->TypeErase != FLASH_TYPEERASE_SECTORS)
+        return HAL_ERROR;
+    for (uint32_t sector = pEraseInit->Sector; sector < pEraseInit->Sector + pEraseInit->NbSectors; sector++)
+    {
+        if (sector != FLASH_SECTOR_11)
+        {
+            *SectorError = sector;
+            return HAL_ERROR;
+        }
+        memset(Host_Flash_Sector11, 0xFF, sizeof(Host_Flash_Sector11));
+        Host_Flash_Stat.Erase++;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    uint8_t *p = Host_Flash_Map(Address, 4);
+
+    if (Host_Flash_Locked || TypeProgram != FLASH_TYPEPROGRAM_WORD || p == NULL || (Address & 3))
+        return HAL_ERROR;
+    for (uint8_t i = 0; i < 4; i++)
+        p[i] &= (Data >> (8 * i)) & 0xFF;
+    Host_Flash_Stat.Program++;
+    return HAL_OK;
+}
+
+uint8_t *Host_Flash_Map(uint32_t addr, uint32_t size)
+{
+    if (addr < HOST_FLASH_SECTOR11_ADDR || addr + size > HOST_FLASH_SECTOR11_ADDR + HOST_FLASH_SECTOR11_SIZE)
+        return NULL;
+    return Host_Flash_Sector11 + (addr - HOST_FLASH_SECTOR11_ADDR);
+}
+
+/*************************** other peripherals ***************************/
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef *hiwdg)
+{
+    return HAL_OK;
+}
+
+#ifndef HOST_RTOS
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size,
+                                          uint32_t Timeout)
+{
+    memset(pRxData, 0, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size)
+{
+    memset(pRxData, 0, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_DMAStop(SPI_HandleTypeDef *hspi)
+{
+    return HAL_OK;
+}
+#endif
+
+HAL_UART_StateTypeDef HAL_UART_GetState(UART_HandleTypeDef *huart)
+{
+    return HAL_UART_STATE_READY;
+}
+
+void Host_UART_Set_Tx_Callback(Host_UART_Tx_Callback_t callback)
+{
+    Host_UART_Tx_Callback = callback;
+}
+
+// 发送立即完成, 串口始终空闲 the transfer completes at once, the UART stays ready
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart->gState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    if (Host_UART_Tx_Callback != NULL)
+        Host_UART_Tx_Callback(huart, pData, Size);
+    return HAL_OK;
+}
+
+#ifndef HOST_RTOS
+void USART_IDLE_Init(UART_HandleTypeDef *huart, uint8_t *rx_buf, uint16_t dma_buf_num)
+{
+}
+
+void USART_IDLE_Stream_Init(UART_HandleTypeDef *huart, uint8_t *rx_buf, uint16_t dma_buf_num)
+{
+}
+#endif
+
+/*************************** CMSIS-DSP ***************************/
+// 仓库中缺少 arm_common_tables.h, 查表三角函数以 libm 代替
+float32_t arm_sin_f32(float32_t x)
+{
+    return sinf(x);
+}
+
+float32_t arm_cos_f32(float32_t x)
+{
+    return cosf(x);
+}
+
+/*************************** modules not built on host ***************************/
+#ifndef HOST_RTOS
+ina226_t ina226[3];
+
+float get_temprate(void)
+{
+    return 40.0f;
+}
+
+float get_battery_voltage(void)
+{
+    return 24.0f;
+}
+#endif
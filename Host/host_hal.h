@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * @file    host_hal.h
+ * @brief   主机构建下的 HAL/CAN/RTOS 桩 host-side HAL stubs
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#ifndef _HOST_HAL_H
+#define _HOST_HAL_H
+
+#include "main.h"
+#include "can.h"
+#include "usart.h"
+
+typedef void (*Host_CAN_Tx_Callback_t)(CAN_HandleTypeDef *hcan, const CAN_TxHeaderTypeDef *header, const uint8_t *data);
+typedef void (*Host_UART_Tx_Callback_t)(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len);
+
+typedef struct
+{
+    uint32_t TxCount;
+    uint32_t RxCount;
+} Host_CAN_Stat_t;
+
+typedef struct
+{
+    uint32_t Erase;   // 擦除的扇区数 sectors erased
+    uint32_t Program; // 编程的字数 words programmed
+} Host_Flash_Stat_t;
+
+void Host_HAL_Init(void);
+
+// 向 CAN 总线注入一帧并进入 HAL_CAN_RxFifo0MsgPendingCallback, 与中断上下文等效
+void Host_CAN_Receive(CAN_HandleTypeDef *hcan, uint32_t std_id, const uint8_t *data, uint8_t dlc);
+// 同上, 可注入扩展帧与远程帧 as above, also for extended and remote frames
+void Host_CAN_Receive_Frame(CAN_HandleTypeDef *hcan, const CAN_RxHeaderTypeDef *header, const uint8_t *data);
+// 帧在总线上发送完成时回调, 为 NULL 时仅计数
+// called when a frame has left the bus, count only when NULL
+void Host_CAN_Set_Tx_Callback(Host_CAN_Tx_Callback_t callback);
+// 模拟总线关闭/无应答: 邮箱中的帧不再发出, 直到恢复
+// emulate bus-off / no ACK: frames stay in their mailboxes until released
+void Host_CAN_Set_Stalled(CAN_HandleTypeDef *hcan, uint8_t stalled);
+// HAL_UART_Transmit_DMA() 发出的数据, 为 NULL 时丢弃 data sent by HAL_UART_Transmit_DMA(), discarded when NULL
+void Host_UART_Set_Tx_Callback(Host_UART_Tx_Callback_t callback);
+// 模拟的 flash 中 addr 起 size 字节的主机地址, 超出模拟范围 (扇区 11) 时返回 NULL
+// host address of size bytes of the modelled flash at addr, NULL outside the model (sector 11)
+uint8_t *Host_Flash_Map(uint32_t addr, uint32_t size);
+
+// 任务从 vTaskDelay()/vTaskDelayUntil() 醒来时回调, 可在其中推进时钟以模拟被抢占的唤醒延迟
+// called when a task wakes from vTaskDelay()/vTaskDelayUntil(), advance the clock there to model wake-up latency from preemption
+void Host_RTOS_Set_Wake_Hook(void (*hook)(void));
+
+#ifdef HOST_RTOS
+// host_periph.c: 映射外设寄存器区, 由 Host_HAL_Init() 调用 maps the peripheral registers, called by Host_HAL_Init()
+void Host_Periph_Init(void);
+// BMI088 的加速度 (m/s^2)/角速度 (rad/s)/温度 (度), 下次读取时生效
+// BMI088 acceleration (m/s^2), angular rate (rad/s) and temperature (degC), seen by the next read
+void Host_BMI088_Set(const float accel[3], const float gyro[3], float temperature);
+// 在两个传感器上各产生若干次数据就绪中断, 须在中断上下文中调用
+// raise a number of data ready interrupts on each die, call from interrupt context
+void Host_BMI088_Data_Ready(uint8_t accel, uint8_t gyro);
+// 经 DMA 接收一段数据并产生空闲中断, 须在中断上下文中调用
+// receive a burst through the DMA and raise the idle interrupt, call from interrupt context
+void Host_UART_Receive(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len);
+#endif
+
+extern Host_CAN_Stat_t Host_CAN_Stat[2];
+extern Host_Flash_Stat_t Host_Flash_Stat;
+
+#endif
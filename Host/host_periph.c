@@ -0,0 +1,499 @@
+/**
+ ******************************************************************************
+ * @file    host_periph.c
+ * @brief   host_rtos 构建的外设与 HAL 桩 peripherals and HAL shims of the host_rtos build
+ *          1. 外设寄存器地址区 (0x40000000 起) 映射为主机内存, CubeMX 生成的
+ *             MX_xxx_Init()/HAL_xxx_MspInit() 与直接读写寄存器的驱动原样运行
+ *          2. HAL_xxx_Init() 与 HAL 库相同地调用 HAL_xxx_MspInit(), 使 DMA 句柄按固件方式链接
+ *          3. SPI1 上的 BMI088 按寄存器建模, 数据由仿真经 Host_BMI088_Set() 给出,
+ *             数据就绪中断由 Host_BMI088_Data_Ready() 产生
+ *          4. 串口接收按 DMA 写入固件的接收缓冲区后产生空闲中断
+ *          5. ADC 按通道返回额定的内部参考/温度/电池电压
+ *          1. the peripheral address region (from 0x40000000) is mapped to host memory, so the
+ *             CubeMX MX_xxx_Init()/HAL_xxx_MspInit() and drivers poking registers run unmodified
+ *          2. HAL_xxx_Init() calls HAL_xxx_MspInit() as the HAL does, DMA handles get linked as in the firmware
+ *          3. the BMI088 on SPI1 is modelled by its registers, the simulation supplies data through Host_BMI088_Set()
+ *             and raises data ready through Host_BMI088_Data_Ready()
+ *          4. UART reception writes into the firmware receive buffer as the DMA would, then raises the idle interrupt
+ *          5. the ADC returns the nominal reference, temperature and battery voltages per channel
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  DMA 地址寄存器只有 32 位, host_rtos 以 -no-pie 链接, 使固件的全局缓冲区位于低 4 GB
+ *  the DMA address registers are 32 bit, host_rtos links with -no-pie so the firmware's global buffers sit below 4 GB
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "host_hal.h"
+#include "adc.h"
+#include "dma.h"
+#include "i2c.h"
+#include "iwdg.h"
+#include "spi.h"
+#include "tim.h"
+#include "usart.h"
+#include "BMI088driver.h"
+#include "BMI088reg.h"
+#include "bsp_usart_idle.h"
+
+// APB1 到 AHB2 (RNG) 的全部外设 all peripherals from APB1 up to AHB2 (RNG)
+#define HOST_PERIPH_SIZE (RNG_BASE + 0x400 - PERIPH_BASE)
+
+void Host_Periph_Init(void)
+{
+    void *base = mmap((void *)PERIPH_BASE, HOST_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+
+    if (base != (void *)PERIPH_BASE)
+    {
+        perror("map peripheral registers");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*************************** core/RCC ***************************/
+// 时基由虚拟时钟提供, 时钟树与中断控制器无需配置 the time base comes from the virtual clock, clock tree and NVIC need no setup
+HAL_StatusTypeDef HAL_Init(void)
+{
+    return HAL_OK;
+}
+
+void HAL_IncTick(void)
+{
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+    return HAL_OK;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef *hiwdg)
+{
+    return HAL_OK;
+}
+
+/*************************** GPIO/BMI088 ***************************/
+// BMI088 寄存器模型: 片选拉低开始一次传输, 第一个字节为地址 (最高位为读),
+// 加速度计读操作多一个空字节, 连续读时地址自增
+// BMI088 register model: chip select low starts a transfer, the first byte is the address
+// (top bit set to read), accelerometer reads return one dummy byte first, burst reads auto-increment
+// 角速度计 FIFO: 流模式下每个样本入队一帧, 连续读 FIFO_DATA 逐字节出队, 写 FIFO_CONFIG_1 清空
+// gyro FIFO: in stream mode every sample queues a frame, burst reads of FIFO_DATA dequeue byte by
+// byte, writing FIFO_CONFIG_1 clears it
+#define HOST_BMI088_FIFO_FRAMES 100
+
+typedef struct
+{
+    uint8_t Reg[128];
+    uint8_t Dummy; // 读操作前的空字节数 dummy bytes before read data
+    uint8_t SoftReset;
+    uint8_t ChipID;
+    uint8_t Selected;
+    uint8_t Index; // 本次传输中的字节序号 byte index within the transfer
+    uint8_t Address;
+    uint8_t Fifo[HOST_BMI088_FIFO_FRAMES][BMI088_GYRO_FIFO_FRAME_LEN];
+    uint8_t FifoHead, FifoCount, FifoByte, FifoOverrun;
+} Host_BMI088_Die_t;
+
+// BMI088driver.c 中按量程设置的灵敏度 sensitivities set by range in BMI088driver.c
+extern float BMI088_ACCEL_SEN;
+extern float BMI088_GYRO_SEN;
+
+static Host_BMI088_Die_t Host_BMI088_Accel = {.Dummy = 1, .SoftReset = BMI088_ACC_SOFTRESET, .ChipID = BMI088_ACC_CHIP_ID_VALUE};
+static Host_BMI088_Die_t Host_BMI088_Gyro = {.Dummy = 0, .SoftReset = BMI088_GYRO_SOFTRESET, .ChipID = BMI088_GYRO_CHIP_ID_VALUE};
+
+static void Host_BMI088_Fifo_Clear(Host_BMI088_Die_t *die)
+{
+    die->FifoHead = die->FifoCount = die->FifoByte = die->FifoOverrun = 0;
+}
+
+static void Host_BMI088_Reset(Host_BMI088_Die_t *die)
+{
+    memset(die->Reg, 0, sizeof(die->Reg));
+    die->Reg[0] = die->ChipID;
+    Host_BMI088_Fifo_Clear(die);
+}
+
+// 角速度样本入队, 满时丢弃最旧的帧; 返回是否刚达到水位
+// queue a gyro sample, dropping the oldest frame when full; returns whether the watermark was just reached
+static uint8_t Host_BMI088_Fifo_Push(Host_BMI088_Die_t *die)
+{
+    uint8_t watermark = die->Reg[BMI088_GYRO_FIFO_CONFIG_0] & BMI088_GYRO_FIFO_WATERMARK_LEVEL;
+
+    if (!(die->Reg[BMI088_GYRO_FIFO_CONFIG_1] & BMI088_GYRO_FIFO_MODE_STREAM))
+        return 0;
+    if (die->FifoCount == HOST_BMI088_FIFO_FRAMES)
+    {
+        die->FifoHead = (die->FifoHead + 1) % HOST_BMI088_FIFO_FRAMES;
+        die->FifoCount--;
+        die->FifoByte = 0;
+        die->FifoOverrun = 1;
+    }
+    memcpy(die->Fifo[(die->FifoHead + die->FifoCount) % HOST_BMI088_FIFO_FRAMES], &die->Reg[BMI088_GYRO_X_L], BMI088_GYRO_FIFO_FRAME_LEN);
+    die->FifoCount++;
+    return die->Reg[BMI088_GYRO_FIFO_WM_ENABLE] == BMI088_GYRO_FIFO_WM_ON && (die->Reg[BMI088_GYRO_CTRL] & BMI088_FIFO_INT_ON) &&
+           watermark > 0 && die->FifoCount == watermark;
+}
+
+static uint8_t Host_BMI088_Fifo_Pop(Host_BMI088_Die_t *die)
+{
+    uint8_t data;
+
+    if (die->FifoCount == 0)
+        return 0;
+    data = die->Fifo[die->FifoHead][die->FifoByte];
+    if (++die->FifoByte == BMI088_GYRO_FIFO_FRAME_LEN)
+    {
+        die->FifoByte = 0;
+        die->FifoHead = (die->FifoHead + 1) % HOST_BMI088_FIFO_FRAMES;
+        die->FifoCount--;
+    }
+    return data;
+}
+
+static void Host_BMI088_Put16(uint8_t *reg, float value, float sen)
+{
+    float raw = value / sen;
+    int16_t lsb = raw > 32767.0f ? 32767 : (raw < -32768.0f ? -32768 : (int16_t)raw);
+
+    reg[0] = lsb & 0xff;
+    reg[1] = (lsb >> 8) & 0xff;
+}
+
+void Host_BMI088_Set(const float accel[3], const float gyro[3], float temperature)
+{
+    int16_t temp = (int16_t)((temperature - BMI088_TEMP_OFFSET) / BMI088_TEMP_FACTOR);
+
+    if (Host_BMI088_Accel.Reg[0] != BMI088_ACC_CHIP_ID_VALUE)
+    {
+        Host_BMI088_Reset(&Host_BMI088_Accel);
+        Host_BMI088_Reset(&Host_BMI088_Gyro);
+    }
+    // 按驱动当前的量程换算 scaled with the range the driver currently uses
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        Host_BMI088_Put16(&Host_BMI088_Accel.Reg[BMI088_ACCEL_XOUT_L + 2 * i], accel[i], BMI088_ACCEL_SEN);
+        Host_BMI088_Put16(&Host_BMI088_Gyro.Reg[BMI088_GYRO_X_L + 2 * i], gyro[i], BMI088_GYRO_SEN);
+    }
+    Host_BMI088_Accel.Reg[BMI088_TEMP_M] = (temp >> 3) & 0xff;
+    Host_BMI088_Accel.Reg[BMI088_TEMP_M + 1] = (temp & 0x07) << 5;
+}
+
+// 仅在驱动已将数据就绪映射到中断引脚时产生 only raised once the driver has mapped data ready to the interrupt pin
+void Host_BMI088_Data_Ready(uint8_t accel, uint8_t gyro)
+{
+    for (uint8_t i = 0; i < accel && (Host_BMI088_Accel.Reg[BMI088_INT_MAP_DATA] & BMI088_ACC_INT1_DRDY_INTERRUPT); i++)
+        HAL_GPIO_EXTI_Callback(INT1_ACCEL_Pin);
+    for (uint8_t i = 0; i < gyro; i++)
+    {
+        uint8_t watermark = Host_BMI088_Fifo_Push(&Host_BMI088_Gyro);
+
+        if ((Host_BMI088_Gyro.Reg[BMI088_GYRO_INT3_INT4_IO_MAP] & BMI088_GYRO_DRDY_IO_INT3) ||
+            (watermark && (Host_BMI088_Gyro.Reg[BMI088_GYRO_INT3_INT4_IO_MAP] & BMI088_GYRO_FIFO_IO_INT3)))
+            HAL_GPIO_EXTI_Callback(INT1_GYRO_Pin);
+    }
+}
+
+static uint8_t Host_BMI088_Transfer(Host_BMI088_Die_t *die, uint8_t tx)
+{
+    uint8_t rx = 0, index = die->Index++;
+
+    if (index == 0)
+    {
+        die->Address = tx;
+        return 0;
+    }
+    if (die->Address & 0x80)
+    {
+        uint8_t reg = ((die->Address & 0x7f) + index - 1 - die->Dummy) & 0x7f;
+
+        // FIFO 仅在角速度计上建模, 连续读 FIFO_DATA 时地址不自增 the FIFO is only modelled on the gyro, burst reads of FIFO_DATA do not auto-increment
+        if (die == &Host_BMI088_Gyro && (die->Address & 0x7f) == BMI088_GYRO_FIFO_DATA)
+            rx = Host_BMI088_Fifo_Pop(die);
+        else if (die == &Host_BMI088_Gyro && reg == BMI088_GYRO_FIFO_STATUS)
+            rx = die->FifoCount | (die->FifoOverrun ? BMI088_GYRO_FIFO_OVERRUN : 0);
+        else if (index > die->Dummy)
+            rx = die->Reg[reg];
+    }
+    else if (index == 1)
+    {
+        if (die->Address == die->SoftReset)
+            Host_BMI088_Reset(die);
+        else
+            die->Reg[die->Address] = tx;
+        if (die == &Host_BMI088_Gyro && die->Address == BMI088_GYRO_FIFO_CONFIG_1)
+            Host_BMI088_Fifo_Clear(die);
+    }
+    return rx;
+}
+
+static void Host_BMI088_Select(Host_BMI088_Die_t *die, GPIO_PinState state)
+{
+    if (die->Reg[0] != die->ChipID)
+        Host_BMI088_Reset(die);
+    die->Selected = state == GPIO_PIN_RESET;
+    die->Index = 0;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET)
+        GPIOx->ODR |= GPIO_Pin;
+    else
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+
+    if (GPIOx == CS1_ACCEL_GPIO_Port && GPIO_Pin == CS1_ACCEL_Pin)
+        Host_BMI088_Select(&Host_BMI088_Accel, PinState);
+    else if (GPIOx == CS1_GYRO_GPIO_Port && GPIO_Pin == CS1_GYRO_Pin)
+        Host_BMI088_Select(&Host_BMI088_Gyro, PinState);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/*************************** SPI/I2C ***************************/
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi)
+{
+    HAL_SPI_MspInit(hspi);
+    hspi->State = HAL_SPI_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size,
+                                          uint32_t Timeout)
+{
+    for (uint16_t i = 0; i < Size; i++)
+    {
+        pRxData[i] = 0;
+        if (hspi != &hspi1)
+            continue;
+        if (Host_BMI088_Accel.Selected)
+            pRxData[i] = Host_BMI088_Transfer(&Host_BMI088_Accel, pTxData[i]);
+        else if (Host_BMI088_Gyro.Selected)
+            pRxData[i] = Host_BMI088_Transfer(&Host_BMI088_Gyro, pTxData[i]);
+    }
+    return HAL_OK;
+}
+
+// 传输立即完成, 在调用者的上下文中进入完成回调 the transfer completes at once, the completion callback runs in the caller's context
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size)
+{
+    HAL_SPI_TransmitReceive(hspi, pTxData, pRxData, Size, 0);
+    HAL_SPI_TxRxCpltCallback(hspi);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_DMAStop(SPI_HandleTypeDef *hspi)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    HAL_I2C_MspInit(hi2c);
+    hi2c->State = HAL_I2C_STATE_READY;
+    return HAL_OK;
+}
+
+// 总线上没有器件应答 no device answers on the bus
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize,
+                                   uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+    return HAL_ERROR;
+}
+
+/*************************** UART ***************************/
+typedef struct
+{
+    UART_HandleTypeDef *Handle;
+    uint16_t Length; // 缓冲区长度, 取首次接收时的 NDTR buffer length, the NDTR seen at the first reception
+} Host_UART_Rx_t;
+
+static Host_UART_Rx_t Host_UART_Rx[3];
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    HAL_UART_MspInit(huart);
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+}
+
+// 按 DMA 写入一段数据后置空闲标志并进入空闲中断, 须在中断上下文中调用
+// 环形模式从当前写位置续写并回绕, 普通模式每段从缓冲区开头写起 (固件在空闲中断中重启 DMA)
+// write a burst as the DMA would, then set the idle flag and run the idle interrupt, call from interrupt context;
+// circular mode continues from the write position and wraps, normal mode starts each burst at the
+// buffer start (the firmware restarts the DMA in the idle interrupt)
+void Host_UART_Receive(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len)
+{
+    DMA_Stream_TypeDef *dma;
+    Host_UART_Rx_t *rx = NULL;
+    uint8_t *buf;
+
+    if (huart->hdmarx == NULL)
+        return;
+    dma = huart->hdmarx->Instance;
+    if (!(dma->CR & DMA_SxCR_EN) || dma->M0AR == 0)
+        return;
+
+    for (uint8_t i = 0; i < sizeof(Host_UART_Rx) / sizeof(Host_UART_Rx[0]); i++)
+    {
+        if (Host_UART_Rx[i].Handle == NULL)
+        {
+            Host_UART_Rx[i].Handle = huart;
+            Host_UART_Rx[i].Length = dma->NDTR;
+        }
+        if (Host_UART_Rx[i].Handle == huart)
+        {
+            rx = &Host_UART_Rx[i];
+            break;
+        }
+    }
+    if (rx == NULL || rx->Length == 0)
+        return;
+
+    buf = (uint8_t *)(uintptr_t)dma->M0AR;
+    if (!(dma->CR & DMA_SxCR_CIRC))
+        dma->NDTR = rx->Length;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (dma->NDTR == 0)
+        {
+            if (!(dma->CR & DMA_SxCR_CIRC))
+                break; // 普通模式下缓冲区写满后丢弃 dropped once the buffer is full in normal mode
+            dma->NDTR = rx->Length;
+        }
+        buf[rx->Length - dma->NDTR] = data[i];
+        dma->NDTR--;
+    }
+
+    huart->Instance->SR |= UART_FLAG_IDLE;
+    USART_IDLE_IRQHandler(huart);
+    huart->Instance->SR &= ~UART_FLAG_IDLE;
+}
+
+/*************************** TIM ***************************/
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim)
+{
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim)
+{
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *sClockSourceConfig)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *sMasterConfig)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef *htim, TIM_BreakDeadTimeConfigTypeDef *sBreakDeadTimeConfig)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    return HAL_OK;
+}
+
+/*************************** ADC ***************************/
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc)
+{
+    hadc->State = HAL_ADC_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig)
+{
+    // 以规则序列第一位寄存器记录所选通道 the first regular sequence slot records the selected channel
+    hadc->Instance->SQR3 = sConfig->Channel;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef *hadc, uint32_t Timeout)
+{
+    return HAL_OK;
+}
+
+// 3.3 V 参考下的 12 位读数: 内部参考 1.2 V, 芯片 40 度, 电池 24 V 经 22k/200k 分压
+// 12 bit readings against 3.3 V: 1.2 V internal reference, 40 degC die, 24 V battery through the 22k/200k divider
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef *hadc)
+{
+    switch (hadc->Instance->SQR3)
+    {
+    case ADC_CHANNEL_VREFINT:
+        return 1489;
+    case ADC_CHANNEL_TEMPSENSOR:
+        return 990;
+    case ADC_CHANNEL_8:
+        return 2951;
+    default:
+        return 0;
+    }
+}
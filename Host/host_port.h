@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ * @file    host_port.h
+ * @brief   x86/Linux 主机构建适配层 host build glue
+ *          由 Makefile 以 -include 方式强制包含, 沿用固件的 CubeMX/HAL/CMSIS
+ *          头文件, 仅将内核调试寄存器 (DWT/CoreDebug) 重定向到主机内存,
+ *          使 bsp_dwt.c 在虚拟时钟下原样运行
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#ifndef _HOST_PORT_H
+#define _HOST_PORT_H
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+#define HOST_CPU_FREQ_MHZ 168
+
+extern DWT_Type Host_DWT;
+extern CoreDebug_Type Host_CoreDebug;
+
+#undef DWT
+#undef CoreDebug
+#define DWT (&Host_DWT)
+#define CoreDebug (&Host_CoreDebug)
+
+// cmsis_gcc.h 中的 dmb 指令无法在主机上汇编, 以编译器内存屏障代替
+// the dmb instruction from cmsis_gcc.h does not assemble on the host, use a full barrier instead
+#define __DMB() __sync_synchronize()
+
+// arm_math.h 按 ARM_MATH_CM4 使用 cmsis_gcc.h 的 DSP 指令, 主机上没有 __ARM_FEATURE_DSP, 以 C 实现代替
+// arm_math.h uses the cmsis_gcc.h DSP instructions under ARM_MATH_CM4; the host has no __ARM_FEATURE_DSP,
+// so they are implemented in C
+static inline uint32_t __SMUAD(uint32_t op1, uint32_t op2)
+{
+    return (uint32_t)((int32_t)(int16_t)op1 * (int16_t)op2 + (int32_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16));
+}
+
+static inline uint64_t __SMLALD(uint32_t op1, uint32_t op2, uint64_t acc)
+{
+    return (uint64_t)((int64_t)acc + (int32_t)(int16_t)op1 * (int16_t)op2 + (int32_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16));
+}
+
+static inline int32_t __QADD(int32_t op1, int32_t op2)
+{
+    int64_t sum = (int64_t)op1 + op2;
+    return sum > INT32_MAX ? INT32_MAX : sum < INT32_MIN ? INT32_MIN : (int32_t)sum;
+}
+
+static inline int32_t __QSUB(int32_t op1, int32_t op2)
+{
+    int64_t diff = (int64_t)op1 - op2;
+    return diff > INT32_MAX ? INT32_MAX : diff < INT32_MIN ? INT32_MIN : (int32_t)diff;
+}
+
+// 虚拟时钟 virtual clock, DWT->CYCCNT 与 HAL_GetTick() 均由其驱动
+void Host_Clock_Advance_us(uint32_t us);
+uint64_t Host_Clock_Get_us(void);
+
+// 虚拟时钟在代码执行期间不前进, profiler.h 的探针改用主机单调时钟, 按 HOST_CPU_FREQ_MHZ 折算为周期数
+// the virtual clock stands still while code runs, so the profiler.h probes use the host monotonic
+// clock, scaled to cycles at HOST_CPU_FREQ_MHZ
+uint32_t Host_Profile_Cycles(void);
+#define PROFILE_NOW() Host_Profile_Cycles()
+
+// 黑匣子环形缓冲区改放主机内存中的 CCM 替身 the black-box ring goes to a stand-in for CCM in host memory
+extern uint32_t Host_CCMRAM[];
+#define BLACKBOX_RAM_ADDR ((uintptr_t)Host_CCMRAM)
+
+#ifdef HOST_RTOS
+// 完整任务集构建: 任务代码不推进虚拟时钟, 在 CYCCNT 上忙等 (DWT_Delay) 会永远等下去,
+// 因此经由函数访问 DWT, 在同一时刻重复读取时推进 1 us
+// full task set build: task code does not advance the virtual clock and would spin forever
+// on CYCCNT (DWT_Delay), so DWT goes through a function that advances 1 us on repeated reads at the same time
+DWT_Type *Host_DWT_Access(void);
+#undef DWT
+#define DWT (Host_DWT_Access())
+
+// 无法在主机上汇编的内核寄存器访问 core register accesses that do not assemble on the host
+uint32_t Host_RTOS_Get_IPSR(void);
+#define __get_IPSR() Host_RTOS_Get_IPSR()
+#define __set_FAULTMASK(faultMask) ((void)(faultMask))
+
+// 中断屏蔽映射到移植层的标志位 interrupt masking maps onto the port layer flag
+uint32_t Host_RTOS_Get_PRIMASK(void);
+uint32_t ulPortRaiseInterruptMask(void);
+void vPortSetInterruptMask(uint32_t ulMask);
+#define __get_PRIMASK() Host_RTOS_Get_PRIMASK()
+#define __set_PRIMASK(priMask) vPortSetInterruptMask(priMask)
+#define __disable_irq() ((void)ulPortRaiseInterruptMask())
+#else
+// 单线程仿真没有可屏蔽的中断 the single threaded simulation has no interrupts to mask
+#define __get_PRIMASK() 0u
+#define __set_PRIMASK(priMask) ((void)(priMask))
+#define __disable_irq() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @file    host_rtos.h
+ * @brief   主机 FreeRTOS 移植层接口 interface of the host FreeRTOS port
+ *          供 host_rtos 构建中的仿真程序驱动调度器, 实现见 FreeRTOS_Posix/port.c
+ *          lets the simulations of the host_rtos build drive the scheduler,
+ *          implemented in FreeRTOS_Posix/port.c
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#ifndef _HOST_RTOS_H
+#define _HOST_RTOS_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t Tick;          // 已送达的节拍 ticks delivered
+    uint32_t IdleTick;      // 空闲任务推进的节拍 ticks advanced by the idle task
+    uint32_t ContextSwitch; // 任务切换次数 task switches
+} Host_RTOS_Stat_t;
+
+// 虚拟时钟每次推进后调用, 送达节拍与挂起的任务切换 (host_hal.c)
+// called after every advance of the virtual clock, delivers ticks and pended switches (host_hal.c)
+void Host_RTOS_Clock_Hook(void);
+// 每个节拍在中断上下文中先于 xTaskIncrementTick() 回调, 用于注入外设事件
+// called from the tick interrupt before xTaskIncrementTick(), used to inject peripheral events
+void Host_RTOS_Set_Tick_Hook(void (*hook)(void));
+// 虚拟时钟到达 stop_us 时调用 report 并以其返回值结束进程, report 为 NULL 时返回 0
+// at virtual time stop_us call report and exit with its return value, 0 when report is NULL
+void Host_RTOS_Set_Stop(uint64_t stop_us, int (*report)(void));
+// 在中断上下文中调用 isr, 其中请求的任务切换在返回后执行
+// call isr in interrupt context, switches requested there happen after it returns
+void Host_RTOS_ISR(void (*isr)(void *), void *arg);
+// __get_IPSR() 的主机实现, cmsis_os.c 以此判断是否在中断中
+// host implementation of __get_IPSR(), cmsis_os.c uses it to detect interrupt context
+uint32_t Host_RTOS_Get_IPSR(void);
+
+extern Host_RTOS_Stat_t Host_RTOS_Stat;
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ ******************************************************************************
+ * @file    imu_fifo_bench.c
+ * @brief   角速度全速率积分主机基准 host benchmark of full-rate gyro integration
+ *          合成一段高速旋转: 绕 z 自旋并叠加 x/y 正交振动 (圆锥运动), 以细步长双精度积分出真值;
+ *          角速度计以 2 kHz 输出各采样周期内的平均角速度并按 2000 dps 量程量化, 加速度计给出真实重力.
+ *          姿态解算均为 1 kHz, 比较四种角速度输入:
+ *          1. 每 2 个样本取 1 个 (原数据就绪抽取读取)
+ *          2. FIFO 中全部样本取平均
+ *          3. 全部样本经圆锥补偿 (Coning_Get_Rotation() / dt)
+ *          4. 圆锥补偿并按一阶积分预校正 (Coning_Get_Rate(), 固件采用)
+ *          分别送入 Quaternion_AHRS_UpdateIMU() 与 IMU_QuaternionEKF_Update(), 给出结束时的航向误差
+ *          与全程最大姿态误差; 4 相对 1 的航向误差未显著减小时返回非零
+ *          synthesises a fast rotation: a spin about z with an x/y vibration in quadrature (coning)
+ *          on top, integrated in double precision on a fine step as the truth; the gyro outputs the
+ *          mean rate of each sample period at 2 kHz, quantised to the 2000 dps range, and the
+ *          accelerometer gives the true gravity. The attitude filters run at 1 kHz with four gyro inputs:
+ *          1. every 2nd sample (the old data ready decimated read)
+ *          2. the mean of all samples in the FIFO
+ *          3. all samples with coning compensation (Coning_Get_Rotation() / dt)
+ *          4. coning compensation pre-warped for first order integration (Coning_Get_Rate(), as in the firmware)
+ *          each fed to Quaternion_AHRS_UpdateIMU() and IMU_QuaternionEKF_Update(); reports the heading
+ *          error at the end and the largest attitude error of the run, and fails unless 4 clearly
+ *          reduces the heading error of 1
+ *
+ *          usage: imu_fifo_bench [-t seconds] [-w spin rad/s]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_hal.h"
+#include "BMI088driver.h"
+#include "ConingIntegrator.h"
+#include "QuaternionAHRS.h"
+#include "QuaternionEKF.h"
+
+#define BENCH_GYRO_HZ 2000
+#define BENCH_FRAMES 2    // 每次姿态更新的样本数, 与 FIFO 水位一致 samples per attitude update, the FIFO watermark
+#define BENCH_SUBSTEPS 40 // 真值每个样本周期的积分步数 truth integration steps per sample period
+#define BENCH_VIB_HZ 150.0
+#define BENCH_VIB_AMP 3.0 // 振动角速度幅值 rad/s vibration rate amplitude
+#define BENCH_GRAVITY 9.8f
+#define BENCH_MIN_GAIN 5.0f // 航向误差至少减小的倍数 required reduction of the heading error
+
+typedef enum
+{
+    MODE_DECIMATE = 0,
+    MODE_MEAN,
+    MODE_CONING,
+    MODE_CONING_PREWARP,
+    MODE_NUM,
+} Bench_Mode_e;
+
+static const char *Mode_Name[MODE_NUM] = {
+    "every 2nd sample",
+    "mean of samples",
+    "coning",
+    "coning + pre-warp",
+};
+
+typedef struct
+{
+    double YawErr; // 结束时的航向误差 heading error at the end, deg
+    double MaxErr; // 最大姿态误差 largest attitude error, deg
+} Bench_Result_t;
+
+// QuaternionAHRS.c 的积分项 integral terms of QuaternionAHRS.c
+extern volatile float integralFBx, integralFBy, integralFBz;
+
+static double Spin;
+
+static void Quat_Mult(const double a[4], const double b[4], double r[4])
+{
+    double t[4];
+
+    t[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    t[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    t[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    t[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+    memcpy(r, t, sizeof(t));
+}
+
+// 机体系角速度真值 true body rate
+static void Body_Rate(double t, double w[3])
+{
+    double phase = 2 * M_PI * BENCH_VIB_HZ * t;
+
+    w[0] = BENCH_VIB_AMP * cos(phase);
+    w[1] = BENCH_VIB_AMP * sin(phase);
+    // 自旋在前 0.5 s 内线性加速 the spin ramps up over the first 0.5 s
+    w[2] = Spin * (t < 0.5 ? t / 0.5 : 1.0);
+}
+
+// 按一个样本周期推进真值, 返回该周期的平均角速度 advances the truth by one sample period, returns its mean rate
+static void Truth_Step(double t, double q[4], double mean[3])
+{
+    const double h = 1.0 / BENCH_GYRO_HZ / BENCH_SUBSTEPS;
+    double w[3], dq[4], angle, s;
+
+    mean[0] = mean[1] = mean[2] = 0;
+    for (int k = 0; k < BENCH_SUBSTEPS; k++)
+    {
+        Body_Rate(t + (k + 0.5) * h, w);
+        angle = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) * h;
+        s = angle > 1e-12 ? sin(0.5 * angle) / angle * h : 0.5 * h;
+        dq[0] = cos(0.5 * angle);
+        dq[1] = w[0] * s;
+        dq[2] = w[1] * s;
+        dq[3] = w[2] * s;
+        Quat_Mult(q, dq, q);
+        for (int i = 0; i < 3; i++)
+            mean[i] += w[i] / BENCH_SUBSTEPS;
+    }
+    s = 1.0 / sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int i = 0; i < 4; i++)
+        q[i] *= s;
+}
+
+// 按 2000 dps 量程量化 quantised to the 2000 dps range
+static float Gyro_Quantise(double w)
+{
+    double raw = w / BMI088_GYRO_2000_SEN;
+
+    raw = raw > 32767 ? 32767 : (raw < -32768 ? -32768 : raw);
+    return (int16_t)lrint(raw) * BMI088_GYRO_2000_SEN;
+}
+
+static double Yaw_Of(const double q[4])
+{
+    return atan2(2.0 * (q[0] * q[3] + q[1] * q[2]), 2.0 * (q[0] * q[0] + q[1] * q[1]) - 1.0) * 180.0 / M_PI;
+}
+
+static double Wrap_180(double deg)
+{
+    while (deg > 180)
+        deg -= 360;
+    while (deg < -180)
+        deg += 360;
+    return deg;
+}
+
+// 估计值以双精度归一化, 滤波器中的 invSqrt() 只近似归一 the estimate is normalised in double, invSqrt() in the filters only nearly is
+static void Normalise(const float est[4], double q[4])
+{
+    double norm = sqrt((double)est[0] * est[0] + (double)est[1] * est[1] + (double)est[2] * est[2] + (double)est[3] * est[3]);
+
+    for (int i = 0; i < 4; i++)
+        q[i] = est[i] / norm;
+}
+
+// 估计值与真值之间的转角, 取误差四元数的矢量部以免 acos 在 0 附近失去精度
+// rotation angle between the estimate and the truth from the vector part of the error
+// quaternion, acos would lose the precision near 0
+static double Attitude_Error(const double truth[4], const float est[4])
+{
+    double e[4], conj[4] = {truth[0], -truth[1], -truth[2], -truth[3]}, v;
+
+    Normalise(est, e);
+    Quat_Mult(conj, e, e);
+    v = sqrt(e[1] * e[1] + e[2] * e[2] + e[3] * e[3]);
+    return 2 * asin(v > 1 ? 1 : v) * 180.0 / M_PI;
+}
+
+static void Filter_Reset(void)
+{
+    q0 = 1;
+    q1 = q2 = q3 = 0;
+    integralFBx = integralFBy = integralFBz = 0;
+    QEKF_INS.Initialized = 0;
+}
+
+static void Run(Bench_Mode_e mode, double seconds, Bench_Result_t *ahrs, Bench_Result_t *qekf)
+{
+    const float dt = 1.0f / BENCH_GYRO_HZ;
+    uint32_t updates = (uint32_t)(seconds * BENCH_GYRO_HZ / BENCH_FRAMES);
+    double q[4] = {1, 0, 0, 0}, est[4], mean[3], t = 0, err;
+    float gyro[BENCH_FRAMES][3], rate[3], accel[3], update_dt;
+    static Coning_t coning;
+
+    Filter_Reset();
+    memset(&coning, 0, sizeof(coning));
+    memset(ahrs, 0, sizeof(*ahrs));
+    memset(qekf, 0, sizeof(*qekf));
+
+    for (uint32_t u = 0; u < updates; u++)
+    {
+        // 一次 FIFO 读出的样本 the samples of one FIFO read
+        Coning_Reset(&coning);
+        for (int f = 0; f < BENCH_FRAMES; f++)
+        {
+            Truth_Step(t, q, mean);
+            t += 1.0 / BENCH_GYRO_HZ;
+            for (int i = 0; i < 3; i++)
+                gyro[f][i] = Gyro_Quantise(mean[i]);
+            Coning_Update(&coning, gyro[f], dt);
+        }
+
+        update_dt = coning.dt;
+        switch (mode)
+        {
+        case MODE_DECIMATE:
+            memcpy(rate, gyro[BENCH_FRAMES - 1], sizeof(rate));
+            break;
+        case MODE_MEAN:
+            for (int i = 0; i < 3; i++)
+                rate[i] = coning.Alpha[i] / coning.dt;
+            break;
+        case MODE_CONING:
+            Coning_Get_Rotation(&coning, rate);
+            for (int i = 0; i < 3; i++)
+                rate[i] /= coning.dt;
+            break;
+        default:
+            update_dt = Coning_Get_Rate(&coning, rate);
+            break;
+        }
+
+        // 重力在机体系中的方向 gravity in the body frame
+        accel[0] = BENCH_GRAVITY * 2 * (q[1] * q[3] - q[0] * q[2]);
+        accel[1] = BENCH_GRAVITY * 2 * (q[2] * q[3] + q[0] * q[1]);
+        accel[2] = BENCH_GRAVITY * (q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]);
+
+        Quaternion_AHRS_UpdateIMU(rate[0], rate[1], rate[2], accel[0], accel[1], accel[2], update_dt);
+        IMU_QuaternionEKF_Update(rate[0], rate[1], rate[2], accel[0], accel[1], accel[2], update_dt);
+
+        err = Attitude_Error(q, AHRS.q);
+        if (err > ahrs->MaxErr)
+            ahrs->MaxErr = err;
+        err = Attitude_Error(q, QEKF_INS.q);
+        if (err > qekf->MaxErr)
+            qekf->MaxErr = err;
+    }
+    Normalise(AHRS.q, est);
+    ahrs->YawErr = Wrap_180(Yaw_Of(est) - Yaw_Of(q));
+    Normalise(QEKF_INS.q, est);
+    qekf->YawErr = Wrap_180(Yaw_Of(est) - Yaw_Of(q));
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 20;
+    Bench_Result_t ahrs[MODE_NUM], qekf[MODE_NUM];
+    uint8_t fail;
+
+    Spin = 30;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            Spin = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-t seconds] [-w spin rad/s]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%.1f s, spin %.1f rad/s, vibration %.1f rad/s at %.0f Hz, gyro %u Hz, %u samples per 1 kHz update\n",
+           seconds, Spin, BENCH_VIB_AMP, BENCH_VIB_HZ, BENCH_GYRO_HZ, BENCH_FRAMES);
+    printf("%-20s %14s %14s %14s %14s\n", "gyro input", "AHRS yaw deg", "AHRS max deg", "QEKF yaw deg", "QEKF max deg");
+    for (int m = 0; m < MODE_NUM; m++)
+    {
+        Run((Bench_Mode_e)m, seconds, &ahrs[m], &qekf[m]);
+        printf("%-20s %14.4f %14.4f %14.4f %14.4f\n", Mode_Name[m], ahrs[m].YawErr, ahrs[m].MaxErr, qekf[m].YawErr, qekf[m].MaxErr);
+    }
+
+    fail = !(fabs(ahrs[MODE_CONING_PREWARP].YawErr) * BENCH_MIN_GAIN < fabs(ahrs[MODE_DECIMATE].YawErr));
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
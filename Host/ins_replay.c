@@ -0,0 +1,655 @@
+/**
+ ******************************************************************************
+ * @file    ins_replay.c
+ * @brief   姿态解算回放对比 attitude estimator replay comparison
+ *          将 IMU 记录逐行送入 INS_Task() 的两种姿态解算, 对比耗时与精度:
+ *          1. 两级 two-stage: gEstimateKF_Update() 滤出重力, 再交给 Quaternion_AHRS_UpdateIMU()
+ *          2. 单级 fused (INS_USE_QEKF): IMU_QuaternionEKF_Update() 直接融合角速度与加速度
+ *          记录为 telem_decode 输出的 CSV, 需含 time_us, ins.gyro_x/y/z 与 ins.accel_x/y/z 列;
+ *          含 true.q0~q3 列时按真值给出倾角误差与航向误差, 否则只给出两者之间的差异.
+ *          未给出记录时合成一段底盘运动 (静止, 行驶, 小陀螺自旋, 颠簸路面; 含线加速度, IMU 偏离
+ *          旋转中心的向心加速度, 振动, 角速度计零偏与噪声), -w 将其写为同格式的记录
+ *          replays an IMU recording row by row through both attitude pipelines of INS_Task() and
+ *          compares cost and accuracy:
+ *          1. two-stage: gEstimateKF_Update() filters out gravity for Quaternion_AHRS_UpdateIMU()
+ *          2. fused (INS_USE_QEKF): IMU_QuaternionEKF_Update() fuses gyro and accel directly
+ *          the recording is a telem_decode CSV with time_us, ins.gyro_x/y/z and ins.accel_x/y/z
+ *          columns; with true.q0~q3 columns the tilt and heading errors against the truth are
+ *          reported, otherwise only the difference between the two. Without a recording a chassis
+ *          run is synthesised (still, driving, spinning, rough ground; with linear acceleration,
+ *          the centripetal acceleration of an IMU off the rotation centre, vibration, gyro bias
+ *          and noise), and -w writes it as a recording in the same format
+ *          有真值时按真值检查单级解算的加速度卡方检验: 多少样本确在门限内, 其中被拒的比例,
+ *          以及门限外被接受的比例
+ *          with truth the chi-square gate of the fused pipeline is checked against it: how many
+ *          samples are really within the gate, the share of those rejected and the share of the
+ *          others accepted
+ *          判定 pass/fail: 单级倾角均方根误差不大于两级, 航向最大误差不比两级大 REPLAY_YAW_MARGIN_DEG
+ *          以上 (需真值); 两者航向之差不超过 REPLAY_YAW_DIFF_DEG. 两者都没有航向参照, 相对真值的
+ *          航向误差主要是共同的 z 轴零偏积分, 故只限制单级解算额外引入的部分
+ *          pass/fail: the fused tilt RMS error is no larger than the two-stage one and its largest
+ *          heading error is at most REPLAY_YAW_MARGIN_DEG above the two-stage one (with truth);
+ *          the two headings stay within REPLAY_YAW_DIFF_DEG of each other. Neither has a heading
+ *          reference, so the heading error against the truth is mostly the shared z gyro bias
+ *          drift, and only what the fused pipeline adds is limited
+ *
+ *          usage: ins_replay [-t seconds] [-s seed] [-w out.csv] [recording.csv]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  主机耗时只反映相对开销, 固件上的周期数由 PROFILE_INS 探针以 DWT->CYCCNT 实测
+ *  host times only show the relative cost, the PROFILE_INS probe measures the target
+ *  cycles with DWT->CYCCNT
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_hal.h"
+#include "ins_task.h"
+#include "GravityEstimateKF.h"
+#include "QuaternionAHRS.h"
+#include "QuaternionEKF.h"
+
+#define REPLAY_DT 0.001
+#define REPLAY_SEGMENT 4.0        // 每段运动的时长 s length of a motion segment
+#define REPLAY_SETTLE 2.0         // 不计入误差的起始时长 s start-up time left out of the errors
+#define REPLAY_IMU_OFFSET 0.05    // IMU 偏离旋转中心的距离 m distance of the IMU from the rotation centre
+#define REPLAY_VIB_HZ 120.0       // 电机振动频率 motor vibration frequency
+#define REPLAY_VIB_AMP 1.5        // 振动加速度幅值 m/s² vibration amplitude
+#define REPLAY_YAW_MARGIN_DEG 5.0 // 单级航向最大误差超出两级的上限 limit on the fused heading error above the two-stage one
+#define REPLAY_YAW_DIFF_DEG 8.0   // 两者航向之差的上限 limit on the heading difference of the two
+#define REPLAY_LINE_LEN 4096
+#define REPLAY_COLUMNS 11
+
+typedef struct
+{
+    uint64_t Time_us;
+    float Gyro[3];
+    float Accel[3];
+    float q[4]; // 真值, 无真值时 q[0] 为 nan truth, q[0] is nan without one
+} Replay_Row_t;
+
+typedef struct
+{
+    Replay_Row_t *Row;
+    uint32_t Num, Size;
+    uint8_t Has_Truth;
+} Replay_Log_t;
+
+typedef enum
+{
+    MOTION_STILL = 0,
+    MOTION_DRIVE,
+    MOTION_SPIN,
+    MOTION_ROUGH,
+    MOTION_NUM,
+} Motion_e;
+
+typedef struct
+{
+    Motion_e Motion;
+    double Yaw, Pitch, Roll;     // rad
+    double dPitch, dRoll;        // rad/s
+    double YawRate, YawRate_Set; // rad/s
+    double Pitch_Set, Roll_Set;  // rad
+    double Lin[3];               // 世界系线加速度 world frame linear acceleration, m/s²
+    double Lin_Sigma;
+    double q[4], w[3];
+    double Bias[3];
+} Motion_t;
+
+typedef struct
+{
+    const char *Name;
+    uint64_t Cycles;
+    uint32_t Updates, Rejected;
+    double Tilt_Sq, Tilt_Max, Heading_Max, Heading_End;
+    uint32_t Samples;
+    float q[4];
+} Pipeline_t;
+
+// 按真值统计的卡方检验判定 chi-square gate decisions scored against the truth
+typedef struct
+{
+    uint32_t Clean, Clean_Rejected;         // 真值残差在门限内 truth residual within the gate
+    uint32_t Corrupted, Corrupted_Accepted; // 真值残差超出门限 truth residual beyond the gate
+} Gate_Stat_t;
+
+// QuaternionAHRS.c 的积分项 integral terms of QuaternionAHRS.c
+extern volatile float integralFBx, integralFBy, integralFBz;
+
+static uint32_t Seed = 1;
+static uint8_t Fail = 0;
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static double Rand_Double(double range)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return ((Seed >> 8) / (double)(1 << 24) * 2 - 1) * range;
+}
+
+static double Rand_Gauss(double sigma)
+{
+    // 12 个均匀分布之和 sum of 12 uniforms
+    double sum = 0;
+    for (uint8_t i = 0; i < 12; i++)
+        sum += Rand_Double(0.5);
+    return sum * sigma;
+}
+
+static uint64_t Host_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void Quat_Mult(const double a[4], const double b[4], double r[4])
+{
+    double t[4];
+
+    t[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    t[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    t[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    t[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+    memcpy(r, t, sizeof(t));
+}
+
+// 世界系向量转到机体系 world frame vector into the body frame: q* ⊗ v ⊗ q
+static void World_To_Body(const double q[4], const double v[3], double out[3])
+{
+    double qc[4] = {q[0], -q[1], -q[2], -q[3]}, p[4] = {0, v[0], v[1], v[2]};
+
+    Quat_Mult(qc, p, p);
+    Quat_Mult(p, q, p);
+    memcpy(out, &p[1], 3 * sizeof(double));
+}
+
+static void Cross(const double a[3], const double b[3], double r[3])
+{
+    double t[3] = {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    memcpy(r, t, sizeof(t));
+}
+
+/*************************** 合成记录 synthetic recording ***************************/
+
+static void Motion_Init(Motion_t *m)
+{
+    memset(m, 0, sizeof(*m));
+    m->q[0] = 1;
+    for (uint8_t i = 0; i < 3; i++)
+        m->Bias[i] = Rand_Double(0.005);
+}
+
+// 每段开始时随机选择运动 pick a random motion at the start of every segment
+static void Motion_Segment(Motion_t *m)
+{
+    m->Motion = (Motion_e)((Seed >> 16) % MOTION_NUM);
+    Rand_Double(1);
+    switch (m->Motion)
+    {
+    case MOTION_STILL:
+        m->YawRate_Set = 0;
+        m->Lin_Sigma = 0;
+        break;
+    case MOTION_DRIVE:
+        m->YawRate_Set = Rand_Double(2);
+        m->Pitch_Set = Rand_Double(3 * M_PI / 180);
+        m->Roll_Set = Rand_Double(3 * M_PI / 180);
+        m->Lin_Sigma = 3;
+        break;
+    case MOTION_SPIN:
+        m->YawRate_Set = (Rand_Double(1) > 0 ? 1 : -1) * (8 + fabs(Rand_Double(7)));
+        m->Pitch_Set = Rand_Double(2 * M_PI / 180);
+        m->Roll_Set = Rand_Double(2 * M_PI / 180);
+        m->Lin_Sigma = 1.5;
+        break;
+    default:
+        m->YawRate_Set = Rand_Double(1);
+        m->Lin_Sigma = 2;
+        break;
+    }
+}
+
+// 推进一步并给出量测 advance one step and give the measurements
+static void Motion_Step(Motion_t *m, uint32_t k, float gyro[3], float accel[3])
+{
+    const double dt = REPLAY_DT, wn = 2 * M_PI * 1.5, tau = 0.5;
+    const double offset[3] = {REPLAY_IMU_OFFSET, 0, 0};
+    double half[3], c[3], s[3], q[4], dq[4], qc[4], v, angle, w_last[3], alpha[3], f[3], t[3], g[3];
+
+    if (k % (uint32_t)(REPLAY_SEGMENT / dt) == 0)
+        Motion_Segment(m);
+    if (m->Motion == MOTION_ROUGH && k % 300 == 0)
+    {
+        m->Pitch_Set = Rand_Double(10 * M_PI / 180);
+        m->Roll_Set = Rand_Double(10 * M_PI / 180);
+    }
+
+    // 航向角速度一阶跟随, 倾角二阶临界阻尼跟随 first order yaw rate, critically damped tilt
+    m->YawRate += (m->YawRate_Set - m->YawRate) * dt / 0.3;
+    m->dPitch += (wn * wn * (m->Pitch_Set - m->Pitch) - 2 * wn * m->dPitch) * dt;
+    m->dRoll += (wn * wn * (m->Roll_Set - m->Roll) - 2 * wn * m->dRoll) * dt;
+    m->Yaw += m->YawRate * dt;
+    m->Pitch += m->dPitch * dt;
+    m->Roll += m->dRoll * dt;
+
+    // 线加速度: 均值回归的随机过程 linear acceleration: a mean reverting random process
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        double sigma = i == 2 ? (m->Motion == MOTION_ROUGH ? 2 : 0) : m->Lin_Sigma;
+        m->Lin[i] += -m->Lin[i] * dt / tau + sigma * sqrt(2 * dt / tau) * Rand_Gauss(1);
+    }
+
+    // q = qz(yaw) ⊗ qy(pitch) ⊗ qx(roll)
+    half[0] = 0.5 * m->Roll, half[1] = 0.5 * m->Pitch, half[2] = 0.5 * m->Yaw;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        c[i] = cos(half[i]);
+        s[i] = sin(half[i]);
+    }
+    q[0] = c[0] * c[1] * c[2] + s[0] * s[1] * s[2];
+    q[1] = s[0] * c[1] * c[2] - c[0] * s[1] * s[2];
+    q[2] = c[0] * s[1] * c[2] + s[0] * c[1] * s[2];
+    q[3] = c[0] * c[1] * s[2] - s[0] * s[1] * c[2];
+
+    // 机体系角速度取相邻两步间的旋转 the body rate is the rotation between two steps
+    qc[0] = m->q[0], qc[1] = -m->q[1], qc[2] = -m->q[2], qc[3] = -m->q[3];
+    Quat_Mult(qc, q, dq);
+    if (dq[0] < 0)
+        for (uint8_t i = 0; i < 4; i++)
+            dq[i] = -dq[i];
+    v = sqrt(dq[1] * dq[1] + dq[2] * dq[2] + dq[3] * dq[3]);
+    angle = 2 * atan2(v, dq[0]);
+    memcpy(w_last, m->w, sizeof(w_last));
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        m->w[i] = v > 0 ? dq[i + 1] / v * angle / dt : 0;
+        alpha[i] = k ? (m->w[i] - w_last[i]) / dt : 0;
+    }
+    memcpy(m->q, q, sizeof(q));
+
+    // 比力 specific force: R^T (a + g) + w x (w x r) + alpha x r
+    g[0] = m->Lin[0], g[1] = m->Lin[1], g[2] = m->Lin[2] + INS_GRAVITY;
+    World_To_Body(q, g, f);
+    Cross(m->w, offset, t);
+    Cross(m->w, t, t);
+    for (uint8_t i = 0; i < 3; i++)
+        f[i] += t[i];
+    Cross(alpha, offset, t);
+    for (uint8_t i = 0; i < 3; i++)
+        f[i] += t[i];
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        double vib = m->Motion == MOTION_STILL ? 0 : REPLAY_VIB_AMP * sin(2 * M_PI * REPLAY_VIB_HZ * k * dt + i);
+        gyro[i] = (float)(m->w[i] + m->Bias[i] + Rand_Gauss(0.005));
+        accel[i] = (float)(f[i] + vib + Rand_Gauss(0.03));
+    }
+}
+
+static Replay_Row_t *Log_Append(Replay_Log_t *log)
+{
+    if (log->Num == log->Size)
+    {
+        log->Size = log->Size ? log->Size * 2 : 4096;
+        log->Row = realloc(log->Row, log->Size * sizeof(Replay_Row_t));
+        if (log->Row == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return &log->Row[log->Num++];
+}
+
+static void Log_Synthesise(Replay_Log_t *log, double seconds)
+{
+    Motion_t motion;
+    uint32_t steps = (uint32_t)(seconds / REPLAY_DT);
+    Replay_Row_t *row;
+
+    Motion_Init(&motion);
+    log->Has_Truth = 1;
+    for (uint32_t k = 0; k < steps; k++)
+    {
+        row = Log_Append(log);
+        Motion_Step(&motion, k, row->Gyro, row->Accel);
+        row->Time_us = (uint64_t)k * (uint64_t)(REPLAY_DT * 1e6);
+        for (uint8_t i = 0; i < 4; i++)
+            row->q[i] = (float)motion.q[i];
+    }
+}
+
+/*************************** 记录读写 recording io ***************************/
+
+static const char *Column_Name[REPLAY_COLUMNS] = {
+    "time_us", "ins.gyro_x", "ins.gyro_y", "ins.gyro_z", "ins.accel_x", "ins.accel_y", "ins.accel_z",
+    "true.q0", "true.q1", "true.q2", "true.q3"};
+
+static int Log_Write(const Replay_Log_t *log, const char *path)
+{
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    // 与 telem_decode 的输出格式一致 the layout of the telem_decode output
+    fprintf(out, "seq,%s", Column_Name[0]);
+    for (uint8_t c = 4; c < 7; c++)
+        fprintf(out, ",%s", Column_Name[c]);
+    for (uint8_t c = 1; c < 4; c++)
+        fprintf(out, ",%s", Column_Name[c]);
+    for (uint8_t c = 7; c < REPLAY_COLUMNS; c++)
+        fprintf(out, ",%s", Column_Name[c]);
+    fprintf(out, "\n");
+    for (uint32_t k = 0; k < log->Num; k++)
+    {
+        const Replay_Row_t *row = &log->Row[k];
+        fprintf(out, "%u,%llu,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", k,
+                (unsigned long long)row->Time_us, row->Accel[0], row->Accel[1], row->Accel[2],
+                row->Gyro[0], row->Gyro[1], row->Gyro[2], row->q[0], row->q[1], row->q[2], row->q[3]);
+    }
+    fclose(out);
+    return 0;
+}
+
+static int Log_Read(Replay_Log_t *log, const char *path)
+{
+    static char line[REPLAY_LINE_LEN];
+    int column[REPLAY_COLUMNS], n = 0;
+    FILE *in = fopen(path, "r");
+    char *tok, *save;
+
+    if (in == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    for (uint8_t c = 0; c < REPLAY_COLUMNS; c++)
+        column[c] = -1;
+    if (fgets(line, sizeof(line), in) == NULL)
+    {
+        fprintf(stderr, "%s: empty\n", path);
+        fclose(in);
+        return -1;
+    }
+    line[strcspn(line, "\r\n")] = 0;
+    for (tok = strtok_r(line, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save), n++)
+        for (uint8_t c = 0; c < REPLAY_COLUMNS; c++)
+            if (strcmp(tok, Column_Name[c]) == 0)
+                column[c] = n;
+    for (uint8_t c = 0; c < 7; c++)
+        if (column[c] < 0)
+        {
+            fprintf(stderr, "%s: no %s column\n", path, Column_Name[c]);
+            fclose(in);
+            return -1;
+        }
+    log->Has_Truth = column[7] >= 0 && column[8] >= 0 && column[9] >= 0 && column[10] >= 0;
+
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        double value[REPLAY_COLUMNS] = {0};
+        Replay_Row_t *row;
+
+        value[7] = NAN;
+        n = 0;
+        for (tok = strtok_r(line, ",\r\n", &save); tok != NULL; tok = strtok_r(NULL, ",\r\n", &save), n++)
+            for (uint8_t c = 0; c < REPLAY_COLUMNS; c++)
+                if (column[c] == n)
+                    value[c] = strtod(tok, NULL);
+        row = Log_Append(log);
+        row->Time_us = (uint64_t)value[0];
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            row->Gyro[i] = (float)value[1 + i];
+            row->Accel[i] = (float)value[4 + i];
+        }
+        for (uint8_t i = 0; i < 4; i++)
+            row->q[i] = (float)value[7 + i];
+    }
+    fclose(in);
+    return 0;
+}
+
+/*************************** 回放 replay ***************************/
+
+// 机体系重力方向 gravity direction in the body frame
+static void Gravity_Of(const float q[4], double g[3])
+{
+    g[0] = 2.0 * ((double)q[1] * q[3] - (double)q[0] * q[2]);
+    g[1] = 2.0 * ((double)q[0] * q[1] + (double)q[2] * q[3]);
+    g[2] = (double)q[0] * q[0] - (double)q[1] * q[1] - (double)q[2] * q[2] + (double)q[3] * q[3];
+}
+
+static double Tilt_Diff_deg(const float a[4], const float b[4])
+{
+    double ga[3], gb[3], c[3];
+
+    Gravity_Of(a, ga);
+    Gravity_Of(b, gb);
+    Cross(ga, gb, c);
+    return atan2(sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]), ga[0] * gb[0] + ga[1] * gb[1] + ga[2] * gb[2]) * 180.0 / M_PI;
+}
+
+static double Heading_Diff_deg(const float a[4], const float b[4])
+{
+    double ya = atan2(2.0 * (a[0] * a[3] + a[1] * a[2]), 2.0 * (a[0] * a[0] + a[1] * a[1]) - 1.0);
+    double yb = atan2(2.0 * (b[0] * b[3] + b[1] * b[2]), 2.0 * (b[0] * b[0] + b[1] * b[1]) - 1.0);
+    double d = fmod((ya - yb) * 180.0 / M_PI + 540.0, 360.0) - 180.0;
+    return d;
+}
+
+// 与 INS_Task() 的两级解算相同 as the two-stage pipeline of INS_Task()
+static void Two_Stage_Update(const Replay_Row_t *row, float dt)
+{
+    gEstimateKF_Update(row->Gyro[X], row->Gyro[Y], row->Gyro[Z], row->Accel[X], row->Accel[Y], row->Accel[Z], dt);
+    Quaternion_AHRS_UpdateIMU(row->Gyro[X], row->Gyro[Y], row->Gyro[Z], gVec[X], gVec[Y], gVec[Z], dt);
+    Get_EulerAngle(AHRS.q);
+}
+
+// 与 INS_Task() 的单级解算相同 as the fused pipeline of INS_Task()
+static void Fused_Update(const Replay_Row_t *row, float dt)
+{
+    float up[3] = {0, 0, INS_GRAVITY};
+
+    IMU_QuaternionEKF_Update(row->Gyro[X], row->Gyro[Y], row->Gyro[Z], row->Accel[X], row->Accel[Y], row->Accel[Z], dt);
+    memcpy(AHRS.q, QEKF_INS.q, sizeof(AHRS.q));
+    EarthFrameToBodyFrame(up, gVec, AHRS.q);
+    Get_EulerAngle(AHRS.q);
+}
+
+static void Pipeline_Score(Pipeline_t *p, const Replay_Row_t *row, double t)
+{
+    double tilt, heading;
+
+    if (t < REPLAY_SETTLE)
+        return;
+    tilt = Tilt_Diff_deg(p->q, row->q);
+    heading = Heading_Diff_deg(p->q, row->q);
+    p->Tilt_Sq += tilt * tilt;
+    if (!(tilt <= p->Tilt_Max))
+        p->Tilt_Max = tilt;
+    if (!(fabs(heading) <= p->Heading_Max))
+        p->Heading_Max = fabs(heading);
+    p->Heading_End = heading;
+    p->Samples++;
+}
+
+// 以真值给出的残差对单级解算本次的卡方检验判定计分, 统计量与 IMU_QuaternionEKF 的相同
+// score this fused gate decision with the residual against the truth, same statistic as IMU_QuaternionEKF
+static void Gate_Score(Gate_Stat_t *gate, const Replay_Row_t *row, uint8_t rejected)
+{
+    double g[3], n, r = 0;
+
+    Gravity_Of(row->q, g);
+    n = sqrt((double)row->Accel[0] * row->Accel[0] + (double)row->Accel[1] * row->Accel[1] +
+             (double)row->Accel[2] * row->Accel[2]);
+    for (uint8_t i = 0; i < 3; i++)
+        r += (row->Accel[i] / n - g[i]) * (row->Accel[i] / n - g[i]);
+    if (r <= QEKF_INS.ChiSquareTestThreshold)
+    {
+        gate->Clean++;
+        gate->Clean_Rejected += rejected;
+    }
+    else
+    {
+        gate->Corrupted++;
+        gate->Corrupted_Accepted += !rejected;
+    }
+}
+
+static void Replay(const Replay_Log_t *log, Pipeline_t *two_stage, Pipeline_t *fused, Pipeline_t *diff, Gate_Stat_t *gate)
+{
+    uint64_t t0;
+    float dt;
+    double t;
+
+    // 两级 two-stage
+    gEstimateKF_Init(INS_GKF_Q, INS_GKF_R);
+    q0 = 1, q1 = q2 = q3 = 0;
+    integralFBx = integralFBy = integralFBz = 0;
+    // 单级 fused
+    memset(&QEKF_INS, 0, sizeof(QEKF_INS));
+    IMU_QuaternionEKF_Init(INS_QEKF_Q1, INS_QEKF_Q2, INS_QEKF_R, INS_QEKF_LAMBDA, INS_QEKF_LPF);
+
+    for (uint32_t k = 1; k < log->Num; k++)
+    {
+        const Replay_Row_t *row = &log->Row[k];
+
+        dt = (row->Time_us - log->Row[k - 1].Time_us) * 1e-6f;
+        t = (row->Time_us - log->Row[0].Time_us) * 1e-6;
+
+        t0 = Host_Cycles();
+        Two_Stage_Update(row, dt);
+        two_stage->Cycles += Host_Cycles() - t0;
+        memcpy(two_stage->q, AHRS.q, sizeof(AHRS.q));
+        two_stage->Updates++;
+
+        t0 = Host_Cycles();
+        Fused_Update(row, dt);
+        fused->Cycles += Host_Cycles() - t0;
+        memcpy(fused->q, QEKF_INS.q, sizeof(QEKF_INS.q));
+        fused->Updates++;
+        fused->Rejected += QEKF_INS.IMU_QuaternionEKF.SkipEq5;
+
+        if (log->Has_Truth)
+        {
+            Pipeline_Score(two_stage, row, t);
+            Pipeline_Score(fused, row, t);
+            Gate_Score(gate, row, QEKF_INS.IMU_QuaternionEKF.SkipEq5);
+        }
+        // 两者之差, 以两级结果为参照 the difference, with the two-stage result as reference
+        {
+            Replay_Row_t ref = *row;
+            memcpy(ref.q, two_stage->q, sizeof(ref.q));
+            Pipeline_Score(diff, &ref, t);
+            memcpy(diff->q, fused->q, sizeof(diff->q));
+        }
+    }
+}
+
+static void Pipeline_Print(const Pipeline_t *p)
+{
+    if (p->Updates)
+        printf("%-12s %12.1f", p->Name, (double)p->Cycles / p->Updates);
+    else
+        printf("%-12s %12s", p->Name, "-");
+    if (p->Samples)
+        printf(" %12.3f %12.3f %12.2f %12.2f", sqrt(p->Tilt_Sq / p->Samples), p->Tilt_Max, p->Heading_Max, p->Heading_End);
+    if (p->Rejected)
+        printf("   %.1f%% of the accel updates rejected", 100.0 * p->Rejected / p->Updates);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    Replay_Log_t log = {0};
+    Pipeline_t two_stage = {"two-stage"}, fused = {"fused QEKF"}, diff = {"difference"};
+    Gate_Stat_t gate = {0};
+    char what[96];
+    const char *record = NULL, *write = NULL;
+    double seconds = 120, tilt_rms[2];
+    uint32_t seed;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            Seed = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            write = argv[++i];
+        else if (argv[i][0] != '-' && record == NULL)
+            record = argv[i];
+        else
+        {
+            fprintf(stderr, "usage: %s [-t seconds] [-s seed] [-w out.csv] [recording.csv]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Host_HAL_Init();
+    DWT_Init(HOST_CPU_FREQ_MHZ);
+
+    if (record != NULL)
+    {
+        if (Log_Read(&log, record) != 0)
+            return EXIT_FAILURE;
+        printf("%s: %u rows, %s\n", record, log.Num, log.Has_Truth ? "with truth" : "no truth");
+    }
+    else
+    {
+        seed = Seed;
+        Log_Synthesise(&log, seconds);
+        printf("synthetic chassis run, %.0f s at %.0f Hz, seed %u\n", seconds, 1 / REPLAY_DT, seed);
+        if (write != NULL && Log_Write(&log, write) != 0)
+            return EXIT_FAILURE;
+    }
+    if (log.Num < 2)
+    {
+        fprintf(stderr, "nothing to replay\n");
+        return EXIT_FAILURE;
+    }
+
+    Replay(&log, &two_stage, &fused, &diff, &gate);
+
+    printf("%-12s %12s %12s %12s %12s %12s\n", "pipeline", "host TSC cyc", "tilt rms deg", "tilt max deg",
+           "|yaw| max deg", "yaw end deg");
+    Pipeline_Print(&two_stage);
+    Pipeline_Print(&fused);
+    Pipeline_Print(&diff);
+
+    if (log.Has_Truth)
+    {
+        // 被拒的量测多为确实偏离重力的样本 the rejected updates are mostly samples that really are off gravity
+        printf("accel gate: %.1f%% of the samples within it by the truth, %.1f%% of those rejected, %.1f%% of the rest accepted\n",
+               100.0 * gate.Clean / (gate.Clean + gate.Corrupted), gate.Clean ? 100.0 * gate.Clean_Rejected / gate.Clean : 0.0,
+               gate.Corrupted ? 100.0 * gate.Corrupted_Accepted / gate.Corrupted : 0.0);
+
+        tilt_rms[0] = sqrt(two_stage.Tilt_Sq / (two_stage.Samples ? two_stage.Samples : 1));
+        tilt_rms[1] = sqrt(fused.Tilt_Sq / (fused.Samples ? fused.Samples : 1));
+        Check(tilt_rms[1] <= tilt_rms[0], "fused tilt RMS error no larger than the two-stage one");
+        snprintf(what, sizeof(what), "fused max heading error at most %g deg above the two-stage one", REPLAY_YAW_MARGIN_DEG);
+        Check(fused.Heading_Max <= two_stage.Heading_Max + REPLAY_YAW_MARGIN_DEG, what);
+    }
+    snprintf(what, sizeof(what), "the two headings stay within %g deg of each other", REPLAY_YAW_DIFF_DEG);
+    Check(diff.Heading_Max <= REPLAY_YAW_DIFF_DEG, what);
+    free(log.Row);
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
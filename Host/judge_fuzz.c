@@ -0,0 +1,259 @@
+/**
+ ******************************************************************************
+ * @file    judge_fuzz.c
+ * @brief   裁判系统解析器模糊测试 referee parser fuzz harness
+ *          回放抓取的字节流 (未给出时使用生成的字节流), 先原样回放, 再做随机变异
+ *          (翻转位, 插入 SOF, 删除/插入/复制片段, 伪造 CRC8 正确的帧头),
+ *          以随机长度分段写入环形 DMA 缓冲区交给 JudgeParser_Feed_Ring(),
+ *          解出的帧序列须与离线参考解析完全一致
+ *          replays captured byte streams (a generated one if none is given), first
+ *          as captured, then randomly mutated, written into the circular DMA buffer
+ *          in random chunks; the decoded frames must match the offline reference exactly
+ *
+ *          usage: judge_fuzz [-i iterations] [-s seed] [capture.bin ...]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  失败的字节流写入 judge_fuzz_fail.bin, 可作为参数直接复现
+ *  a failing stream is written to judge_fuzz_fail.bin, pass it back to reproduce
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_hal.h"
+#include "judgement_info.h"
+#include "judge_stream.h"
+
+#define FUZZ_MAX_MUTATIONS 8
+
+typedef struct
+{
+    uint32_t Frames;
+    uint32_t Chain; // 按顺序累积的帧哈希 order sensitive hash of the frames
+} FrameRecord_t;
+
+static FrameRecord_t Parsed, Reference;
+static uint32_t Seed = 1;
+
+static void Record_Frame(FrameRecord_t *record, const uint8_t *frame, uint16_t frame_len)
+{
+    record->Chain = record->Chain * 31 + JudgeStream_Hash(frame, frame_len);
+    record->Frames++;
+}
+
+static void Parsed_Frame(const uint8_t *frame, uint16_t frame_len)
+{
+    Record_Frame(&Parsed, frame, frame_len);
+}
+
+static void Reference_Frame(const uint8_t *frame, uint16_t frame_len, void *arg)
+{
+    Record_Frame(&Reference, frame, frame_len);
+}
+
+static uint32_t Rand_Below(uint32_t n)
+{
+    return n == 0 ? 0 : JudgeStream_Rand(&Seed) % n;
+}
+
+/**
+ * @brief 以随机长度分段写入环形缓冲区并解析, 与参考解析比对
+ *        write the stream into the ring in random chunks, parse it and compare with the reference
+ * @retval 1 一致 match
+ */
+static uint8_t Replay(const uint8_t *stream, uint32_t len, JudgeParser_t *parser)
+{
+    uint8_t ring[JUDGE_RX_BUF_LEN];
+    uint32_t pos = 0, write_pos = 0, chunk, burst;
+
+    memset(&Parsed, 0, sizeof(Parsed));
+    memset(&Reference, 0, sizeof(Reference));
+    JudgeStream_Reference_Scan(stream, len, Reference_Frame, NULL);
+
+    memset(ring, 0, sizeof(ring));
+    JudgeParser_Init(parser, Parsed_Frame);
+    while (pos < len)
+    {
+        // 两次空闲中断之间不足一整圈 less than one lap between two idle interrupts
+        burst = 1 + Rand_Below(JUDGE_RX_BUF_LEN - 1);
+        if (burst > len - pos)
+            burst = len - pos;
+        while (burst != 0)
+        {
+            chunk = burst < JUDGE_RX_BUF_LEN - write_pos ? burst : JUDGE_RX_BUF_LEN - write_pos;
+            memcpy(ring + write_pos, stream + pos, chunk);
+            write_pos = (write_pos + chunk) % JUDGE_RX_BUF_LEN;
+            pos += chunk;
+            burst -= chunk;
+        }
+        JudgeParser_Feed_Ring(parser, ring, JUDGE_RX_BUF_LEN, write_pos);
+        if (parser->Index > JUDGE_FRAME_MAX_LEN)
+            return 0;
+    }
+    return Parsed.Frames == Reference.Frames && Parsed.Chain == Reference.Chain;
+}
+
+// 对 buf 的前 len 字节做一次变异, 返回新长度, 不超过 cap
+// apply one mutation to the first len bytes of buf, returns the new length, at most cap
+static uint32_t Mutate(uint8_t *buf, uint32_t len, uint32_t cap)
+{
+    uint32_t at = Rand_Below(len), span = 1 + Rand_Below(2 * JUDGE_FRAME_MAX_LEN), i;
+    uint16_t data_length;
+
+    if (len == 0)
+        return 0;
+    if (span > len - at)
+        span = len - at;
+
+    switch (Rand_Below(6))
+    {
+    case 0: // 翻转一位 flip a bit
+        buf[at] ^= 1 << Rand_Below(8);
+        break;
+    case 1: // 写入 SOF write a SOF
+        buf[at] = JUDGE_SOF;
+        break;
+    case 2: // 删除片段 delete a span
+        memmove(buf + at, buf + at + span, len - at - span);
+        len -= span;
+        break;
+    case 3: // 插入随机字节 insert random bytes
+    case 4: // 复制片段 duplicate a span
+        if (len + span > cap)
+            break;
+        memmove(buf + at + span, buf + at, len - at);
+        if (Rand_Below(2))
+            for (i = 0; i < span; i++)
+                buf[at + i] = (uint8_t)JudgeStream_Rand(&Seed);
+        len += span;
+        break;
+    default: // 伪造 CRC8 正确而长度随机的帧头 forge a header with a good CRC8 and a random length
+        if (len - at < JUDGE_FRAME_HEADER_LEN)
+            break;
+        data_length = Rand_Below(JUDGE_DATA_MAX_LEN + 8);
+        buf[at] = JUDGE_SOF;
+        buf[at + 1] = data_length & 0xFF;
+        buf[at + 2] = data_length >> 8;
+        Append_CRC8_Check_Sum(buf + at, JUDGE_FRAME_HEADER_LEN);
+        break;
+    }
+    return len;
+}
+
+static uint8_t *Load(const char *path, uint32_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long size;
+
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(size + 1);
+    *len = fread(buf, 1, size, f);
+    fclose(f);
+    return buf;
+}
+
+static void Save_Failure(const uint8_t *stream, uint32_t len)
+{
+    FILE *f = fopen("judge_fuzz_fail.bin", "wb");
+
+    if (f != NULL)
+    {
+        fwrite(stream, 1, len, f);
+        fclose(f);
+    }
+    printf("FAIL: parsed %u frames, reference %u, stream saved to judge_fuzz_fail.bin\n",
+           Parsed.Frames, Reference.Frames);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 2000, captures = 0, len, cap, mutated_len, frames = 0, mutated_frames = 0;
+    uint64_t bytes = 0;
+    uint8_t *stream, *mutated;
+    JudgeParser_t parser;
+    const char *name;
+
+    Host_HAL_Init();
+
+    for (int i = 1; i <= argc; i++)
+    {
+        if (i < argc && strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+        {
+            iterations = strtoul(argv[++i], NULL, 0);
+            continue;
+        }
+        if (i < argc && strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            Seed = strtoul(argv[++i], NULL, 0);
+            if (Seed == 0)
+                Seed = 1;
+            continue;
+        }
+        if (i < argc && argv[i][0] == '-')
+        {
+            fprintf(stderr, "usage: %s [-i iterations] [-s seed] [capture.bin ...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if (i < argc)
+        {
+            name = argv[i];
+            stream = Load(name, &len);
+            if (stream == NULL)
+            {
+                perror(name);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (captures == 0)
+        {
+            // 未给出抓包时使用生成的字节流 use a generated stream when no capture is given
+            name = "(generated)";
+            stream = malloc(2000 * JUDGE_FRAME_MAX_LEN);
+            len = JudgeStream_Generate(stream, 2000 * JUDGE_FRAME_MAX_LEN, 2000, &Seed);
+        }
+        else
+            break;
+        captures++;
+
+        if (!Replay(stream, len, &parser))
+        {
+            Save_Failure(stream, len);
+            return EXIT_FAILURE;
+        }
+        printf("%-24s %u bytes, %u frames replayed\n", name, len, Parsed.Frames);
+        frames += Parsed.Frames;
+        bytes += len;
+
+        cap = len + FUZZ_MAX_MUTATIONS * 2 * JUDGE_FRAME_MAX_LEN;
+        mutated = malloc(cap);
+        for (uint32_t k = 0; k < iterations; k++)
+        {
+            memcpy(mutated, stream, len);
+            mutated_len = len;
+            for (uint32_t m = 1 + Rand_Below(FUZZ_MAX_MUTATIONS); m > 0; m--)
+                mutated_len = Mutate(mutated, mutated_len, cap);
+
+            if (!Replay(mutated, mutated_len, &parser))
+            {
+                Save_Failure(mutated, mutated_len);
+                return EXIT_FAILURE;
+            }
+            mutated_frames += Parsed.Frames;
+            bytes += mutated_len;
+        }
+        free(mutated);
+        free(stream);
+    }
+
+    printf("%u captures, %u mutated streams, %llu bytes, %u + %u frames, all match the reference\n",
+           captures, captures * iterations, (unsigned long long)bytes, frames, mutated_frames);
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
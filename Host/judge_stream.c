@@ -0,0 +1,131 @@
+/**
+ ******************************************************************************
+ * @file    judge_stream.c
+ * @brief   裁判系统字节流生成与参考解析 referee byte stream generator and reference scanner
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <string.h>
+#include "judge_stream.h"
+#include "judgement_info.h"
+
+typedef struct
+{
+    uint16_t Cmd;
+    uint16_t Len; // 0 为 0x0301 交互数据, 长度随机 0 marks 0x0301 interactive data with a random length
+    uint8_t Weight;
+} JudgeStream_Cmd_t;
+
+// 权重大致对应各命令的发送频率 weights roughly follow the send rate of each command
+static const JudgeStream_Cmd_t JudgeStream_Cmd[] = {
+    {GAME_STATUS_CMD_ID, 11, 2},
+    {GAME_ROBOT_HP_CMD_ID, 32, 2},
+    {EVEN_DATA_CMD_ID, 4, 1},
+    {GAME_ROBOT_STATUS_CMD_ID, 27, 20},
+    {POWER_HEAT_DATA_CMD_ID, 16, 100},
+    {GAME_ROBOT_POS_CMD_ID, 16, 20},
+    {BUFF_MUSK_CMD_ID, 1, 2},
+    {ROBOT_HURT_CMD_ID, 1, 2},
+    {SHOOT_DATA_CMD_ID, 7, 10},
+    {BULLET_REMAINING_CMD_ID, 6, 2},
+    {RFID_STATUS_CMD_ID, 4, 2},
+    {STUDENT_INTERACTIVE_HEADER_DATA_CMD_ID, 0, 10},
+};
+
+uint32_t JudgeStream_Rand(uint32_t *state)
+{
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// FNV-1a
+uint32_t JudgeStream_Hash(const uint8_t *data, uint32_t len)
+{
+    uint32_t hash = 2166136261u;
+    while (len--)
+        hash = (hash ^ *data++) * 16777619u;
+    return hash;
+}
+
+uint16_t JudgeStream_Build_Frame(uint8_t *buf, uint16_t cmd, uint8_t seq, const uint8_t *data, uint16_t data_len)
+{
+    buf[0] = JUDGE_SOF;
+    buf[1] = data_len & 0xFF;
+    buf[2] = data_len >> 8;
+    buf[3] = seq;
+    Append_CRC8_Check_Sum(buf, JUDGE_FRAME_HEADER_LEN);
+    buf[5] = cmd & 0xFF;
+    buf[6] = cmd >> 8;
+    memcpy(buf + 7, data, data_len);
+    Append_CRC16_Check_Sum(buf, data_len + 9);
+    return data_len + 9;
+}
+
+uint32_t JudgeStream_Generate(uint8_t *buf, uint32_t buf_len, uint32_t frames, uint32_t *seed)
+{
+    uint32_t total_weight = 0, pos = 0, r;
+    uint8_t data[JUDGE_DATA_MAX_LEN];
+    uint16_t len;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(JudgeStream_Cmd) / sizeof(JudgeStream_Cmd[0]); i++)
+        total_weight += JudgeStream_Cmd[i].Weight;
+
+    for (uint32_t n = 0; n < frames && pos + JUDGE_FRAME_MAX_LEN <= buf_len; n++)
+    {
+        r = JudgeStream_Rand(seed) % total_weight;
+        for (i = 0; r >= JudgeStream_Cmd[i].Weight; i++)
+            r -= JudgeStream_Cmd[i].Weight;
+
+        len = JudgeStream_Cmd[i].Len;
+        if (len == 0)
+            len = 6 + JudgeStream_Rand(seed) % (JUDGE_DATA_MAX_LEN - 6 + 1);
+        // 数据中常含 0xA5, 检验解析器不会被假的 SOF 带偏 payloads often contain 0xA5, false SOFs must not derail the parser
+        for (uint16_t k = 0; k < len; k++)
+            data[k] = JudgeStream_Rand(seed) % 8 == 0 ? JUDGE_SOF : (uint8_t)JudgeStream_Rand(seed);
+
+        pos += JudgeStream_Build_Frame(buf + pos, JudgeStream_Cmd[i].Cmd, (uint8_t)n, data, len);
+    }
+    return pos;
+}
+
+uint32_t JudgeStream_Reference_Scan(const uint8_t *buf, uint32_t len, JudgeStream_Frame_f on_frame, void *arg)
+{
+    uint32_t pos = 0, frames = 0;
+    uint16_t data_length, frame_len;
+
+    while (pos + JUDGE_FRAME_HEADER_LEN <= len)
+    {
+        if (buf[pos] != JUDGE_SOF)
+        {
+            pos++;
+            continue;
+        }
+        data_length = buf[pos + 1] | buf[pos + 2] << 8;
+        if (data_length > JUDGE_DATA_MAX_LEN || !Verify_CRC8_Check_Sum((uint8_t *)buf + pos, JUDGE_FRAME_HEADER_LEN))
+        {
+            pos++;
+            continue;
+        }
+        frame_len = data_length + 9;
+        if (pos + frame_len > len)
+            break;
+        if (!Verify_CRC16_Check_Sum((uint8_t *)buf + pos, frame_len))
+        {
+            pos++;
+            continue;
+        }
+        if (on_frame != NULL)
+            on_frame(buf + pos, frame_len, arg);
+        frames++;
+        pos += frame_len;
+    }
+    return frames;
+}
@@ -0,0 +1,32 @@
+/**
+ ******************************************************************************
+ * @file    judge_stream.h
+ * @brief   裁判系统字节流生成与参考解析 referee byte stream generator and reference scanner
+ *          供 judge_bench 与 judge_fuzz 使用
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#ifndef _JUDGE_STREAM_H
+#define _JUDGE_STREAM_H
+
+#include <stdint.h>
+
+typedef void (*JudgeStream_Frame_f)(const uint8_t *frame, uint16_t frame_len, void *arg);
+
+uint32_t JudgeStream_Rand(uint32_t *state);
+uint32_t JudgeStream_Hash(const uint8_t *data, uint32_t len);
+
+// 组一帧并填好 CRC8/CRC16, 返回整帧长度 build a frame with CRC8/CRC16 filled in, returns its length
+uint16_t JudgeStream_Build_Frame(uint8_t *buf, uint16_t cmd, uint8_t seq, const uint8_t *data, uint16_t data_len);
+
+// 按比赛中各命令的长度分布生成 frames 帧, 返回字节数 generate frames with the in-match command mix, returns the byte count
+uint32_t JudgeStream_Generate(uint8_t *buf, uint32_t buf_len, uint32_t frames, uint32_t *seed);
+
+// 离线参考解析: 逐字节寻找校验通过的帧, 命中后跳过整帧, 末尾不完整的帧不计
+// offline reference: look for a frame that checks out at every byte, skip the whole
+// frame on a hit, an incomplete frame at the end is not counted
+uint32_t JudgeStream_Reference_Scan(const uint8_t *buf, uint32_t len, JudgeStream_Frame_f on_frame, void *arg);
+
+#endif
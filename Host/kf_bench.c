@@ -0,0 +1,687 @@
+/**
+ ******************************************************************************
+ * @file    kf_bench.c
+ * @brief   卡尔曼滤波器主机基准 kalman filter host benchmark
+ *          对比 KalmanFilter_t (arm_mat_*, 堆分配) 与编译期定维滤波器:
+ *          1. 相同输入下逐步比较 FilteredValue, 给出最大相对误差
+ *          2. 分别计时, 给出每次更新的耗时 (ns 与主机 TSC 周期)
+ *          维度与模型分别取自 ChassisMotionEst (6x4), QEKF_INS (6x3),
+ *          gEstimateKF (3x3)
+ *          3. ChassisMotionEst 分块模式 (2 个 3x2) 与 6x4 稠密模式的对比
+ *          4. KalmanFilter_t 序贯标量更新 (UseSequentialUpdate) 与矩阵求逆更新的
+ *             等价性与耗时, 误差超限时返回非零
+ *
+ *          usage: kf_bench [-n updates]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  主机耗时只反映相对开销, 固件上的周期数需以 DWT->CYCCNT 实测
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_hal.h"
+#include "kalman_filter.h"
+#include "kalman_filter_static.h"
+#include "system_identification.h"
+
+#define BENCH_DT 0.002f
+#define BENCH_SEQ_TOLERANCE 1e-4f
+#define BENCH_STATIC_TOLERANCE 1e-4f // 通用与定长滤波器的最大相对误差 largest relative error between generic and static
+#define BENCH_BLOCK_TOLERANCE 1e-4f  // 稠密与分块模式的最大相对误差 largest relative error between dense and block
+
+typedef struct
+{
+    const char *Name;
+    uint8_t xhatSize, zSize;
+    // 设置当前步的 F/H/z, 参数为 KalmanFilter_t 与定维滤波器的对应数组
+    void (*Step)(uint32_t k, float *F, float *H, float *z);
+    const float *P_Init, *Q, *R, *H_Init;
+    KalmanFilter_t Generic;
+    void *StaticKF;
+    void (*Static_Init)(void *kf);
+    float *(*Static_Update)(void *kf);
+} Bench_Case_t;
+
+static uint32_t rand_state = 0x12345678;
+
+static float Bench_Noise(void)
+{
+    // xorshift32, 输出 [-1, 1)
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return (float)(rand_state >> 8) / 8388608.0f - 1.0f;
+}
+
+static double Host_Wall_Time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t Host_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*************************** ChassisMotionEst 6x4 ***************************/
+// 与 chassis_task.c 相同, 两轴之间没有初始协方差 as in chassis_task.c, no initial covariance between the axes
+static const float Chassis_P[36] = {
+    1000, 0.1, 0.1, 0, 0, 0,
+    0.1, 10000, 0.1, 0, 0, 0,
+    0.1, 0.1, 10000, 0, 0, 0,
+    0, 0, 0, 1000, 0.1, 0.1,
+    0, 0, 0, 0.1, 10000, 0.1,
+    0, 0, 0, 0.1, 0.1, 10000};
+static const float Chassis_Q[36] = {
+    10, 0, 0, 0, 0, 0,
+    0, 1000, 0, 0, 0, 0,
+    0, 0, 10, 0, 0, 0,
+    0, 0, 0, 10, 0, 0,
+    0, 0, 0, 0, 1000, 0,
+    0, 0, 0, 0, 0, 10};
+static const float Chassis_R[16] = {
+    100000, 0, 0, 0,
+    0, 100, 0, 0,
+    0, 0, 100000, 0,
+    0, 0, 0, 100};
+static const float Chassis_H[24] = {
+    0, 1, 0, 0, 0, 0,
+    0, 0, 1, 0, 0, 0,
+    0, 0, 0, 0, 1, 0,
+    0, 0, 0, 0, 0, 1};
+
+static void Chassis_Step(uint32_t k, float *F, float *H, float *z)
+{
+    float t = k * BENCH_DT;
+    float dt = BENCH_DT * (1.0f + 0.05f * Bench_Noise()); // 任务周期抖动
+
+    memset(F, 0, sizeof(float) * 36);
+    for (uint8_t i = 0; i < 6; i++)
+        F[i * 7] = 1;
+    F[1] = dt;
+    F[2] = dt * dt * 0.5f;
+    F[8] = dt;
+    F[22] = dt;
+    F[23] = dt * dt * 0.5f;
+    F[29] = dt;
+
+    z[0] = 150.0f * sinf(t) + 5.0f * Bench_Noise();
+    z[1] = 150.0f * cosf(t) + 50.0f * Bench_Noise();
+    z[2] = 80.0f * sinf(0.7f * t) + 5.0f * Bench_Noise();
+    z[3] = 56.0f * cosf(0.7f * t) + 50.0f * Bench_Noise();
+}
+
+/*************************** QEKF_INS 6x3 ***************************/
+static const float QEKF_P[36] = {
+    100000, 0.1, 0.1, 0.1, 0.1, 0.1,
+    0.1, 100000, 0.1, 0.1, 0.1, 0.1,
+    0.1, 0.1, 100000, 0.1, 0.1, 0.1,
+    0.1, 0.1, 0.1, 100000, 0.1, 0.1,
+    0.1, 0.1, 0.1, 0.1, 10000, 0.1,
+    0.1, 0.1, 0.1, 0.1, 0.1, 10000};
+static const float QEKF_Q[36] = {
+    10 * BENCH_DT, 0, 0, 0, 0, 0,
+    0, 10 * BENCH_DT, 0, 0, 0, 0,
+    0, 0, 10 * BENCH_DT, 0, 0, 0,
+    0, 0, 0, 10 * BENCH_DT, 0, 0,
+    0, 0, 0, 0, 0.001f * BENCH_DT, 0,
+    0, 0, 0, 0, 0, 0.001f * BENCH_DT};
+static const float QEKF_R[9] = {
+    1000000, 0, 0,
+    0, 1000000, 0,
+    0, 0, 1000000};
+
+// 以匀速转动的参考姿态给出 QuaternionEKF.c 中相同形式的 F 与 H
+static void QEKF_Step(uint32_t k, float *F, float *H, float *z)
+{
+    float t = k * BENCH_DT;
+    float gx = 0.5f * sinf(t), gy = 0.3f * cosf(0.5f * t), gz = 1.0f;
+    float hx = 0.5f * gx * BENCH_DT, hy = 0.5f * gy * BENCH_DT, hz = 0.5f * gz * BENCH_DT;
+    float q0 = cosf(0.1f * t), q1 = sinf(0.1f * t) * 0.6f, q2 = sinf(0.1f * t) * 0.8f, q3 = 0;
+
+    memset(F, 0, sizeof(float) * 36);
+    for (uint8_t i = 0; i < 6; i++)
+        F[i * 7] = 1;
+    F[1] = -hx, F[2] = -hy, F[3] = -hz;
+    F[6] = hx, F[8] = hz, F[9] = -hy;
+    F[12] = hy, F[13] = -hz, F[15] = hx;
+    F[18] = hz, F[19] = hy, F[20] = -hx;
+    F[4] = q1 * BENCH_DT / 2, F[5] = q2 * BENCH_DT / 2;
+    F[10] = -q0 * BENCH_DT / 2, F[11] = q3 * BENCH_DT / 2;
+    F[16] = -q3 * BENCH_DT / 2, F[17] = -q0 * BENCH_DT / 2;
+    F[22] = q2 * BENCH_DT / 2, F[23] = -q1 * BENCH_DT / 2;
+
+    memset(H, 0, sizeof(float) * 18);
+    H[0] = -2 * q2, H[1] = 2 * q3, H[2] = -2 * q0, H[3] = 2 * q1;
+    H[6] = 2 * q1, H[7] = 2 * q0, H[8] = 2 * q3, H[9] = 2 * q2;
+    H[12] = 2 * q0, H[13] = -2 * q1, H[14] = -2 * q2, H[15] = 2 * q3;
+
+    z[0] = 2 * (q1 * q3 - q0 * q2) + 0.01f * Bench_Noise();
+    z[1] = 2 * (q0 * q1 + q2 * q3) + 0.01f * Bench_Noise();
+    z[2] = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3 + 0.01f * Bench_Noise();
+}
+
+/*************************** gEstimateKF 3x3 ***************************/
+static const float Gravity_P[9] = {
+    100, 0.1, 0.1,
+    0.1, 100, 0.1,
+    0.1, 0.1, 100};
+static const float Gravity_Q[9] = {
+    0.01, 0, 0,
+    0, 0.01, 0,
+    0, 0, 0.01};
+static const float Gravity_R[9] = {
+    100000, 0, 0,
+    0, 100000, 0,
+    0, 0, 100000};
+static const float Gravity_H[9] = {
+    1, 0, 0,
+    0, 1, 0,
+    0, 0, 1};
+
+static void Gravity_Step(uint32_t k, float *F, float *H, float *z)
+{
+    float t = k * BENCH_DT;
+    float gx = 0.5f * sinf(t) * BENCH_DT, gy = 0.3f * cosf(t) * BENCH_DT, gz = BENCH_DT;
+
+    F[0] = 1, F[1] = gz, F[2] = -gy;
+    F[3] = -gz, F[4] = 1, F[5] = gx;
+    F[6] = gy, F[7] = -gx, F[8] = 1;
+
+    z[0] = 0.5f * sinf(0.3f * t) + 0.5f * Bench_Noise();
+    z[1] = 0.5f * cosf(0.3f * t) + 0.5f * Bench_Noise();
+    z[2] = 9.8f + 0.5f * Bench_Noise();
+}
+
+/*************************** static filter adapters ***************************/
+static KalmanFilter6x4_t Chassis_KF;
+static KalmanFilter6x3_t QEKF_KF;
+static KalmanFilter3x3_t Gravity_KF;
+
+#define BENCH_STATIC_ADAPTER(type)                                          \
+    static void type##_Bench_Init(void *kf) { type##_Init((type##_t *)kf); } \
+    static float *type##_Bench_Update(void *kf) { return type##_Update((type##_t *)kf); }
+BENCH_STATIC_ADAPTER(KalmanFilter6x4)
+BENCH_STATIC_ADAPTER(KalmanFilter6x3)
+BENCH_STATIC_ADAPTER(KalmanFilter3x3)
+
+static Bench_Case_t Bench_Case[3] = {
+    {"ChassisMotionEst 6x4", 6, 4, Chassis_Step, Chassis_P, Chassis_Q, Chassis_R, Chassis_H, {0},
+     &Chassis_KF, KalmanFilter6x4_Bench_Init, KalmanFilter6x4_Bench_Update},
+    {"QEKF_INS 6x3", 6, 3, QEKF_Step, QEKF_P, QEKF_Q, QEKF_R, NULL, {0},
+     &QEKF_KF, KalmanFilter6x3_Bench_Init, KalmanFilter6x3_Bench_Update},
+    {"gEstimateKF 3x3", 3, 3, Gravity_Step, Gravity_P, Gravity_Q, Gravity_R, Gravity_H, {0},
+     &Gravity_KF, KalmanFilter3x3_Bench_Init, KalmanFilter3x3_Bench_Update},
+};
+
+typedef struct
+{
+    float *xhat, *P, *F, *H, *Q, *R, *z;
+} Bench_View_t;
+
+static Bench_View_t Static_View(Bench_Case_t *c)
+{
+    Bench_View_t v;
+    // 各实例为不同的结构体类型, 逐一取成员
+    if (c->StaticKF == &Chassis_KF)
+    {
+        v.xhat = Chassis_KF.xhat_data, v.P = Chassis_KF.P_data, v.F = Chassis_KF.F_data;
+        v.H = Chassis_KF.H_data, v.Q = Chassis_KF.Q_data, v.R = Chassis_KF.R_data;
+        v.z = Chassis_KF.MeasuredVector;
+    }
+    else if (c->StaticKF == &QEKF_KF)
+    {
+        v.xhat = QEKF_KF.xhat_data, v.P = QEKF_KF.P_data, v.F = QEKF_KF.F_data;
+        v.H = QEKF_KF.H_data, v.Q = QEKF_KF.Q_data, v.R = QEKF_KF.R_data;
+        v.z = QEKF_KF.MeasuredVector;
+    }
+    else
+    {
+        v.xhat = Gravity_KF.xhat_data, v.P = Gravity_KF.P_data, v.F = Gravity_KF.F_data;
+        v.H = Gravity_KF.H_data, v.Q = Gravity_KF.Q_data, v.R = Gravity_KF.R_data;
+        v.z = Gravity_KF.MeasuredVector;
+    }
+    return v;
+}
+
+static Bench_View_t Generic_View(KalmanFilter_t *kf)
+{
+    Bench_View_t v = {kf->xhat_data, kf->P_data, kf->F_data, kf->H_data, kf->Q_data, kf->R_data, kf->MeasuredVector};
+    return v;
+}
+
+static void Bench_Load(Bench_Case_t *c, Bench_View_t v)
+{
+    uint8_t x = c->xhatSize, z = c->zSize;
+
+    memset(v.xhat, 0, sizeof(float) * x);
+    memcpy(v.P, c->P_Init, sizeof(float) * x * x);
+    memcpy(v.Q, c->Q, sizeof(float) * x * x);
+    memcpy(v.R, c->R, sizeof(float) * z * z);
+    if (c->H_Init != NULL)
+        memcpy(v.H, c->H_Init, sizeof(float) * z * x);
+    if (c->StaticKF == &QEKF_KF)
+        v.xhat[0] = 1;
+}
+
+// KalmanFilter_t 只在 main 中初始化一次, 此处仅重置内容
+static void Bench_Reset(Bench_Case_t *c)
+{
+    Bench_Load(c, Generic_View(&c->Generic));
+    c->Static_Init(c->StaticKF);
+    Bench_Load(c, Static_View(c));
+}
+
+// 两个滤波器以相同输入同步运行, 返回 FilteredValue 的最大相对误差
+static float Bench_Compare(Bench_Case_t *c, uint32_t updates)
+{
+    Bench_View_t g, s;
+    float *xg, *xs, err, max_err = 0;
+
+    Bench_Reset(c);
+    g = Generic_View(&c->Generic);
+    s = Static_View(c);
+    rand_state = 0x12345678;
+    for (uint32_t k = 0; k < updates; k++)
+    {
+        c->Step(k, g.F, g.H, g.z);
+        memcpy(s.F, g.F, sizeof(float) * c->xhatSize * c->xhatSize);
+        memcpy(s.H, g.H, sizeof(float) * c->zSize * c->xhatSize);
+        memcpy(s.z, g.z, sizeof(float) * c->zSize);
+
+        xg = Kalman_Filter_Update(&c->Generic);
+        xs = c->Static_Update(c->StaticKF);
+        for (uint8_t i = 0; i < c->xhatSize; i++)
+        {
+            err = fabsf(xg[i] - xs[i]) / fmaxf(1.0f, fabsf(xg[i]));
+            if (err > max_err)
+                max_err = err;
+        }
+    }
+    return max_err;
+}
+
+// 输入预先生成, 计时只包含写入 F/H/z 与一次更新
+static void Bench_Time(Bench_Case_t *c, uint32_t updates, int use_static, double *ns, double *cycles)
+{
+    static float F[64][36], H[64][24], z[64][4];
+    Bench_View_t v;
+    double t0;
+    uint64_t c0;
+    uint8_t x = c->xhatSize, zs = c->zSize;
+
+    Bench_Reset(c);
+    v = use_static ? Static_View(c) : Generic_View(&c->Generic);
+    rand_state = 0x12345678;
+    for (uint32_t k = 0; k < 64; k++)
+    {
+        memcpy(H[k], v.H, sizeof(float) * zs * x);
+        c->Step(k, F[k], H[k], z[k]);
+    }
+
+    t0 = Host_Wall_Time_s();
+    c0 = Host_Cycles();
+    for (uint32_t k = 0; k < updates; k++)
+    {
+        memcpy(v.F, F[k & 63], sizeof(float) * x * x);
+        memcpy(v.H, H[k & 63], sizeof(float) * zs * x);
+        memcpy(v.z, z[k & 63], sizeof(float) * zs);
+        if (use_static)
+            c->Static_Update(c->StaticKF);
+        else
+            Kalman_Filter_Update(&c->Generic);
+    }
+    *cycles = (double)(Host_Cycles() - c0) / updates;
+    *ns = (Host_Wall_Time_s() - t0) / updates * 1e9;
+}
+
+/*************************** ChassisMotionEst block mode ***************************/
+static KalmanFilter3x2_t Chassis_Axis_KF[2];
+
+static void Chassis_Block_Reset(void)
+{
+    KalmanFilter6x4_Init(&Chassis_KF);
+    memcpy(Chassis_KF.P_data, Chassis_P, sizeof(Chassis_P));
+    memcpy(Chassis_KF.Q_data, Chassis_Q, sizeof(Chassis_Q));
+    memcpy(Chassis_KF.R_data, Chassis_R, sizeof(Chassis_R));
+    memcpy(Chassis_KF.H_data, Chassis_H, sizeof(Chassis_H));
+
+    // 与 chassis_task.c 相同, 取 6 维模型的对角块
+    for (uint8_t axis = 0; axis < 2; axis++)
+    {
+        KalmanFilter3x2_t *kf = &Chassis_Axis_KF[axis];
+        KalmanFilter3x2_Init(kf);
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                kf->P_data[i * 3 + j] = Chassis_P[(axis * 3 + i) * 6 + axis * 3 + j];
+                kf->Q_data[i * 3 + j] = Chassis_Q[(axis * 3 + i) * 6 + axis * 3 + j];
+            }
+        }
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            for (uint8_t j = 0; j < 3; j++)
+                kf->H_data[i * 3 + j] = Chassis_H[(axis * 2 + i) * 6 + axis * 3 + j];
+            for (uint8_t j = 0; j < 2; j++)
+                kf->R_data[i * 2 + j] = Chassis_R[(axis * 2 + i) * 4 + axis * 2 + j];
+        }
+    }
+}
+
+static void Chassis_Block_Load(const float *F, const float *z)
+{
+    for (uint8_t axis = 0; axis < 2; axis++)
+    {
+        for (uint8_t i = 0; i < 3; i++)
+            for (uint8_t j = 0; j < 3; j++)
+                Chassis_Axis_KF[axis].F_data[i * 3 + j] = F[(axis * 3 + i) * 6 + axis * 3 + j];
+        Chassis_Axis_KF[axis].MeasuredVector[0] = z[axis * 2];
+        Chassis_Axis_KF[axis].MeasuredVector[1] = z[axis * 2 + 1];
+    }
+}
+
+// 稠密与分块以相同输入同步运行, 返回 Position/Velocity/Accel 的最大相对误差
+static float Chassis_Block_Compare(uint32_t updates)
+{
+    static float H[24];
+    float err, max_err = 0;
+
+    Chassis_Block_Reset();
+    rand_state = 0x12345678;
+    for (uint32_t k = 0; k < updates; k++)
+    {
+        Chassis_Step(k, Chassis_KF.F_data, H, Chassis_KF.MeasuredVector);
+        Chassis_Block_Load(Chassis_KF.F_data, Chassis_KF.MeasuredVector);
+        KalmanFilter6x4_Update(&Chassis_KF);
+        KalmanFilter3x2_Update(&Chassis_Axis_KF[0]);
+        KalmanFilter3x2_Update(&Chassis_Axis_KF[1]);
+        for (uint8_t i = 0; i < 6; i++)
+        {
+            err = fabsf(Chassis_KF.FilteredValue[i] - Chassis_Axis_KF[i / 3].FilteredValue[i % 3]) /
+                  fmaxf(1.0f, fabsf(Chassis_KF.FilteredValue[i]));
+            if (err > max_err)
+                max_err = err;
+        }
+    }
+    return max_err;
+}
+
+// 以稠密 6x4 为基准, 比较 Position/Velocity/Accel 并分别计时
+// 固件的 F, P 初值, Q, R, H 均按轴分块对角, 两种模式的数学完全相同, 只差浮点舍入,
+// 超出 BENCH_BLOCK_TOLERANCE 即失败
+// the firmware F, initial P, Q, R and H are all block diagonal per axis, so both modes do the
+// same math up to float rounding, checked against BENCH_BLOCK_TOLERANCE
+static int Bench_Chassis_Block(uint32_t updates)
+{
+    static float F[64][36], H[24], z[64][4];
+    float err;
+    double t0, ns_dense, ns_block;
+    uint64_t c0;
+    double cyc_dense, cyc_block;
+
+    err = Chassis_Block_Compare(100000);
+
+    rand_state = 0x12345678;
+    for (uint32_t k = 0; k < 64; k++)
+        Chassis_Step(k, F[k], H, z[k]);
+
+    Chassis_Block_Reset();
+    t0 = Host_Wall_Time_s();
+    c0 = Host_Cycles();
+    for (uint32_t k = 0; k < updates; k++)
+    {
+        memcpy(Chassis_KF.F_data, F[k & 63], sizeof(Chassis_KF.F_data));
+        memcpy(Chassis_KF.MeasuredVector, z[k & 63], sizeof(Chassis_KF.MeasuredVector));
+        KalmanFilter6x4_Update(&Chassis_KF);
+    }
+    cyc_dense = (double)(Host_Cycles() - c0) / updates;
+    ns_dense = (Host_Wall_Time_s() - t0) / updates * 1e9;
+
+    Chassis_Block_Reset();
+    t0 = Host_Wall_Time_s();
+    c0 = Host_Cycles();
+    for (uint32_t k = 0; k < updates; k++)
+    {
+        Chassis_Block_Load(F[k & 63], z[k & 63]);
+        KalmanFilter3x2_Update(&Chassis_Axis_KF[0]);
+        KalmanFilter3x2_Update(&Chassis_Axis_KF[1]);
+    }
+    cyc_block = (double)(Host_Cycles() - c0) / updates;
+    ns_block = (Host_Wall_Time_s() - t0) / updates * 1e9;
+
+    printf("\n%-22s %12s %12s %12s %12s %8s %10s\n",
+           "ChassisMotionEst", "6x4 ns", "2x(3x2) ns", "6x4 cyc", "2x(3x2) cyc", "speedup", "max err");
+    printf("%-22s %12.1f %12.1f %12.0f %12.0f %7.2fx %10.2e %s\n",
+           "dense vs block", ns_dense, ns_block, cyc_dense, cyc_block, ns_dense / ns_block, err,
+           err < BENCH_BLOCK_TOLERANCE ? "ok" : "FAIL");
+    return !(err < BENCH_BLOCK_TOLERANCE);
+}
+
+/*************************** sequential update ***************************/
+typedef struct
+{
+    KalmanFilter_t Batch, Sequential;
+    FirstOrderSI_t BatchSI, SequentialSI;
+} Bench_Seq_t;
+
+static Bench_Seq_t Bench_Seq;
+
+// 两种更新的状态差以后验标准差为单位: 位置等不可观积分状态的方差持续增长,
+// 单精度舍入差异随之累积, 按相对值比较会误报
+static float Seq_Error(const KalmanFilter_t *b, const KalmanFilter_t *q)
+{
+    float err, max_err = 0;
+    uint8_t n = b->xhatSize;
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        err = fabsf(b->FilteredValue[i] - q->FilteredValue[i]) / sqrtf(fmaxf(b->P_data[i * n + i], 1e-12f));
+        if (err > max_err)
+            max_err = err;
+    }
+    return max_err;
+}
+
+static void Seq_Chassis_Init(KalmanFilter_t *kf, uint8_t auto_adjust, uint8_t sequential)
+{
+    if (kf->xhat_data == NULL)
+        Kalman_Filter_Init(kf, 6, 0, 4);
+    memset(kf->xhat_data, 0, sizeof(float) * 6);
+    memcpy(kf->P_data, Chassis_P, sizeof(Chassis_P));
+    memcpy(kf->Q_data, Chassis_Q, sizeof(Chassis_Q));
+    kf->UseAutoAdjustment = auto_adjust;
+    kf->UseSequentialUpdate = sequential;
+    if (auto_adjust)
+    {
+        // 与 ChassisMotionEst_Init 中注释掉的自动调整配置一致
+        const uint8_t map[4] = {2, 3, 5, 6};
+        // H R 由 H_K_R_Adjustment 逐次重建, 清除上一个用例留下的完整矩阵, 与新初始化的滤波器一致
+        // H and R are rebuilt by H_K_R_Adjustment every update; clear the full matrices left by the
+        // previous case, as in a freshly initialised filter
+        memset(kf->R_data, 0, sizeof(Chassis_R));
+        memset(kf->H_data, 0, sizeof(Chassis_H));
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            kf->MeasurementMap[i] = map[i];
+            kf->MeasurementDegree[i] = 1;
+            kf->MatR_DiagonalElements[i] = Chassis_R[i * 5];
+        }
+    }
+    else
+    {
+        memcpy(kf->R_data, Chassis_R, sizeof(Chassis_R));
+        memcpy(kf->H_data, Chassis_H, sizeof(Chassis_H));
+    }
+}
+
+// auto_adjust 时每个量测以 30% 概率置零, 模拟不同采样率的传感器
+static float Seq_Chassis_Run(uint8_t auto_adjust, uint32_t updates, int timed_sequential, double *ns)
+{
+    KalmanFilter_t *b = &Bench_Seq.Batch, *q = &Bench_Seq.Sequential;
+    float F[36], H[24], z[4], err, max_err = 0;
+    double t0;
+
+    Seq_Chassis_Init(b, auto_adjust, 0);
+    Seq_Chassis_Init(q, auto_adjust, 1);
+    rand_state = 0x12345678;
+    for (uint32_t k = 0; k < updates; k++)
+    {
+        Chassis_Step(k % 100000, F, H, z);
+        if (auto_adjust)
+        {
+            for (uint8_t i = 0; i < 4; i++)
+                if (Bench_Noise() < -0.4f)
+                    z[i] = 0;
+        }
+
+        if (ns != NULL)
+        {
+            KalmanFilter_t *kf = timed_sequential ? q : b;
+            memcpy(kf->F_data, F, sizeof(F));
+            memcpy(kf->MeasuredVector, z, sizeof(z));
+            t0 = Host_Wall_Time_s();
+            Kalman_Filter_Update(kf);
+            *ns += Host_Wall_Time_s() - t0;
+            continue;
+        }
+
+        memcpy(b->F_data, F, sizeof(F));
+        memcpy(q->F_data, F, sizeof(F));
+        memcpy(b->MeasuredVector, z, sizeof(z));
+        memcpy(q->MeasuredVector, z, sizeof(z));
+        Kalman_Filter_Update(b);
+        Kalman_Filter_Update(q);
+        err = Seq_Error(b, q);
+        if (err > max_err)
+            max_err = err;
+    }
+    if (ns != NULL)
+        *ns = *ns / updates * 1e9;
+    return max_err;
+}
+
+// 一阶系统 x' = c0·x + c1·u 的在线辨识, 真值 c0 = -5, c1 = 20, 输入为方波
+static float Seq_SI_Run(uint32_t updates, int timed_sequential, double *ns)
+{
+    FirstOrderSI_t *b = &Bench_Seq.BatchSI, *q = &Bench_Seq.SequentialSI;
+    float x = 0, u, err, max_err = 0;
+    double t0;
+
+    if (b->SI_EKF.xhat_data == NULL)
+    {
+        FirstOrderSI_Init(b, -10, 0.1, 0.1, 0.1, 0.1, 1, 0.9999f);
+        FirstOrderSI_Init(q, -10, 0.1, 0.1, 0.1, 0.1, 1, 0.9999f);
+    }
+    b->SI_EKF.UseSequentialUpdate = 0;
+    q->SI_EKF.UseSequentialUpdate = 1;
+    rand_state = 0x12345678;
+    for (uint32_t k = 0; k < updates; k++)
+    {
+        u = (k / 500) % 2 ? 1.0f : -1.0f;
+        x += (-5.0f * x + 20.0f * u) * BENCH_DT;
+
+        if (ns != NULL)
+        {
+            FirstOrderSI_t *si = timed_sequential ? q : b;
+            t0 = Host_Wall_Time_s();
+            FirstOrderSI_Update(si, u, x + 0.01f * Bench_Noise(), BENCH_DT);
+            *ns += Host_Wall_Time_s() - t0;
+            continue;
+        }
+
+        float noise = 0.01f * Bench_Noise();
+        FirstOrderSI_Update(b, u, x + noise, BENCH_DT);
+        FirstOrderSI_Update(q, u, x + noise, BENCH_DT);
+        err = Seq_Error(&b->SI_EKF, &q->SI_EKF);
+        if (err > max_err)
+            max_err = err;
+    }
+    if (ns != NULL)
+        *ns = *ns / updates * 1e9;
+    return max_err;
+}
+
+static int Bench_Sequential(uint32_t updates)
+{
+    const char *name[3] = {"ChassisMotionEst 6x4", "6x4 auto adjustment", "FirstOrderSI 3x1"};
+    double ns_b, ns_q;
+    float err;
+    int fail = 0;
+
+    printf("\n%-22s %12s %13s %8s %10s\n", "KalmanFilter_t", "inverse ns", "sequential ns", "speedup", "err/sigma");
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        ns_b = ns_q = 0;
+        if (i < 2)
+        {
+            err = Seq_Chassis_Run(i, 100000, 0, NULL);
+            Seq_Chassis_Run(i, updates, 0, &ns_b);
+            Seq_Chassis_Run(i, updates, 1, &ns_q);
+        }
+        else
+        {
+            err = Seq_SI_Run(100000, 0, NULL);
+            Seq_SI_Run(updates, 0, &ns_b);
+            Seq_SI_Run(updates, 1, &ns_q);
+        }
+        printf("%-22s %12.1f %13.1f %7.2fx %10.2e %s\n",
+               name[i], ns_b, ns_q, ns_b / ns_q, err, err < BENCH_SEQ_TOLERANCE ? "ok" : "FAIL");
+        if (!(err < BENCH_SEQ_TOLERANCE))
+            fail = 1;
+    }
+    return fail;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t updates = 1000000;
+    double ns_g, ns_s, cyc_g, cyc_s;
+    int fail = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            updates = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n updates]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Host_HAL_Init();
+
+    printf("%-22s %12s %12s %12s %12s %8s %10s\n",
+           "filter", "generic ns", "static ns", "generic cyc", "static cyc", "speedup", "max err");
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        Bench_Case_t *c = &Bench_Case[i];
+        float err;
+
+        Kalman_Filter_Init(&c->Generic, c->xhatSize, 0, c->zSize);
+        err = Bench_Compare(c, 100000);
+
+        Bench_Time(c, updates, 0, &ns_g, &cyc_g);
+        Bench_Time(c, updates, 1, &ns_s, &cyc_s);
+        printf("%-22s %12.1f %12.1f %12.0f %12.0f %7.2fx %10.2e %s\n",
+               c->Name, ns_g, ns_s, cyc_g, cyc_s, ns_g / ns_s, err, err < BENCH_STATIC_TOLERANCE ? "ok" : "FAIL");
+        if (!(err < BENCH_STATIC_TOLERANCE))
+            fail = 1;
+    }
+    if (Bench_Chassis_Block(updates))
+        fail = 1;
+
+    if (Bench_Sequential(updates))
+        fail = 1;
+    return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/**
+ ******************************************************************************
+ * @file    period_test.c
+ * @brief   周期任务调度主机测试 host test of the periodic task loop
+ *          在虚拟时钟上以相同负载运行两种循环:
+ *          A. 原 work(); osDelay(PERIOD), 实际周期为 PERIOD 加执行时间
+ *          B. TaskPeriod_Wait(), 周期与相位不随执行时间变化, 抖动只来自唤醒延迟
+ *          负载执行时间随机, 唤醒时加入随机抢占延迟, 并按间隔注入超过一个/多个周期的超时
+ *          runs two loops with the same load on the virtual clock:
+ *          A. the old work(); osDelay(PERIOD), whose real period is PERIOD plus the execution time
+ *          B. TaskPeriod_Wait(), whose period and phase do not move with the execution
+ *             time, jitter only comes from the wake-up latency
+ *          the execution time is random, a random preemption delay is added on wake-up,
+ *          and overruns of one or several periods are injected at intervals
+ *
+ *          usage: period_test [-n cycles] [-p period ms]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_hal.h"
+#include "task_period.h"
+
+#define TEST_LATENCY_MAX_US 60  // 唤醒后被更高优先级任务/中断占用的最长时间 longest preemption after wake-up
+#define TEST_EXEC_MIN_US 200
+#define TEST_EXEC_MAX_US 900
+#define TEST_OVERRUN_EVERY 997  // 每隔多少周期注入一次超时 cycles between injected overruns
+
+static uint8_t Fail = 0;
+static uint32_t Seed = 1;
+static uint32_t Period_ms;
+static uint64_t Phase_us;         // 第一个周期的开始时刻 start of the first cycle
+static uint32_t PhaseErrors;      // 唤醒时刻不在周期整数倍上的次数 wake-ups off the period grid
+static uint8_t CheckPhase;
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static uint32_t Rand(uint32_t n)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return (Seed >> 8) % n;
+}
+
+// 唤醒时先检查相位, 再推进一段被抢占的时间 check the phase on wake-up, then advance by a preemption delay
+static void Wake_Hook(void)
+{
+    if (CheckPhase && (Host_Clock_Get_us() - Phase_us) % (Period_ms * 1000) != 0)
+        PhaseErrors++;
+    Host_Clock_Advance_us(Rand(TEST_LATENCY_MAX_US + 1));
+}
+
+// 第 i 周期的执行时间, 注入的超时分别跨过 1 个和 3 个周期
+// execution time of cycle i, the injected overruns run past 1 and 3 periods
+static uint32_t Exec_us(uint32_t i, uint32_t *overruns, uint32_t *skipped)
+{
+    if (i % TEST_OVERRUN_EVERY == TEST_OVERRUN_EVERY - 1)
+    {
+        uint32_t periods = (i / TEST_OVERRUN_EVERY) % 2 ? 3 : 1;
+        (*overruns)++;
+        *skipped += periods - 1;
+        return periods * Period_ms * 1000 + Period_ms * 500;
+    }
+    return TEST_EXEC_MIN_US + Rand(TEST_EXEC_MAX_US - TEST_EXEC_MIN_US + 1);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t cycles = 100000, overruns = 0, skipped = 0, dummy = 0;
+    uint64_t start_us, elapsed_us;
+    TaskPeriod_t period;
+    double mean_a, mean_b;
+
+    Period_ms = 2;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            cycles = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+            Period_ms = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n cycles] [-p period ms]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (Period_ms < 1)
+        Period_ms = 1;
+    // 超时后的周期晚半个周期开始, 须仍能按时结束, 否则超时会连续出现
+    // the cycle after an overrun starts half a period late and must still finish in time, or overruns chain
+    if (Period_ms * 500 <= TEST_EXEC_MAX_US + TEST_LATENCY_MAX_US)
+    {
+        fprintf(stderr, "period must be longer than %u us\n", 2 * (TEST_EXEC_MAX_US + TEST_LATENCY_MAX_US));
+        return EXIT_FAILURE;
+    }
+
+    Host_HAL_Init();
+    Host_RTOS_Set_Wake_Hook(Wake_Hook);
+
+    // A. work(); osDelay(PERIOD)
+    Seed = 1;
+    start_us = Host_Clock_Get_us();
+    for (uint32_t i = 0; i < cycles; i++)
+    {
+        Host_Clock_Advance_us(Exec_us(i, &dummy, &dummy));
+        vTaskDelay(Period_ms);
+    }
+    elapsed_us = Host_Clock_Get_us() - start_us;
+    mean_a = (double)elapsed_us / cycles;
+
+    // B. TaskPeriod_Wait(), 同一随机序列 the same random sequence
+    Seed = 1;
+    Host_Clock_Advance_us(1000 - Host_Clock_Get_us() % 1000); // 从节拍边界开始 start on a tick boundary
+    Phase_us = Host_Clock_Get_us();
+    CheckPhase = 1;
+    TaskPeriod_Init(&period, Period_ms);
+    start_us = Host_Clock_Get_us();
+    for (uint32_t i = 0; i < cycles; i++)
+    {
+        Host_Clock_Advance_us(Exec_us(i, &overruns, &skipped));
+        TaskPeriod_Wait(&period);
+    }
+    elapsed_us = Host_Clock_Get_us() - start_us;
+    mean_b = (double)elapsed_us / (cycles + skipped);
+
+    printf("period %u ms, %u cycles, execution %u~%u us, wake-up latency 0~%u us\n",
+           Period_ms, cycles, TEST_EXEC_MIN_US, TEST_EXEC_MAX_US, TEST_LATENCY_MAX_US);
+    printf("osDelay         mean period %8.1f us (%+.1f%%)\n", mean_a, (mean_a / (Period_ms * 1000) - 1) * 100);
+    printf("TaskPeriod      mean period %8.1f us (%+.3f%%), jitter mean %.1f us max %.1f us\n",
+           mean_b, (mean_b / (Period_ms * 1000) - 1) * 100,
+           period.JitterAbsSum_us / (period.Cycle - 1), period.JitterMax_us);
+    printf("                execution max %.1f us, overrun %u (injected %u), skipped %u (expected %u)\n",
+           period.ExecMax_us, period.Overrun, overruns, period.Skipped, skipped);
+
+    Check(fabs(mean_b - Period_ms * 1000) <= TEST_LATENCY_MAX_US / (double)cycles + 1e-6,
+          "no drift: elapsed time is a whole number of periods");
+    Check(PhaseErrors == 0, "every wake-up lies on the period grid, also after overruns");
+    Check(period.Overrun == overruns && period.Skipped == skipped, "overrun and skipped counts match the injected ones");
+    Check(period.Cycle == cycles + 1, "one cycle started per loop");
+    // 超时后的周期立即开始, 抖动为超出量; 其余周期的抖动不超过唤醒延迟之差
+    // cycles after an overrun start late by the excess, all others stay within the latency spread
+    Check(period.JitterAbsSum_us / (period.Cycle - 1) < TEST_LATENCY_MAX_US, "mean jitter below the wake-up latency");
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
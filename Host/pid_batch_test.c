@@ -0,0 +1,225 @@
+/**
+ ******************************************************************************
+ * @file    pid_batch_test.c
+ * @brief   成批 PID 主机测试 host test of the batched PID
+ *          对每种功能组合, 以同一组随机测量/期望值 (含死区内的误差, 饱和, nan/inf/0 输入)
+ *          逐路调用自行计时的 PID_Calculate() 与一次使用共享 DWT_Tick_t 的 PID_Batch_Calculate_Tick(),
+ *          要求各路的输出与中间量逐位相同, 并由探针统计比较两者每周期 (N 路) 的耗时
+ *          for every feature set, feeds the same random measurements and references (errors
+ *          inside the deadband, saturation, nan/inf/0 inputs) to the self-timed PID_Calculate() per
+ *          channel and to one PID_Batch_Calculate_Tick() on a shared DWT_Tick_t; outputs and
+ *          intermediate terms must match bit for bit, and the probes compare the time per tick
+ *          (N channels) of both
+ *          另以 Motor_Speed_Calculate_Tick() 逐个对比 Motor_Speed_Calculate_Batch(), 含已初始化
+ *          与未初始化的速度前馈
+ *          also compares Motor_Speed_Calculate_Batch() with Motor_Speed_Calculate_Tick() per motor,
+ *          with the velocity feedforward both initialised and left at zero
+ *
+ *          usage: pid_batch_test [-n ticks]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_hal.h"
+#include "controller.h"
+#include "motor.h"
+#include "profiler.h"
+
+#define TEST_N PID_BATCH_MAX
+
+typedef struct
+{
+    const char *Name;
+    float DeadBand;
+    uint8_t Improve;
+} Test_Config_t;
+
+static const Test_Config_t Test_Config[] = {
+    {"none", 0, NONE},
+    {"wheel (IL|OF)", 0, Integral_Limit | OutputFilter},
+    {"IL|OF deadband 20", 20, Integral_Limit | OutputFilter},
+    {"trapezoid|DoM", 0, Trapezoid_Intergral | Derivative_On_Measurement},
+    {"all supported", 5, PID_BATCH_IMPROVE},
+};
+
+static uint8_t Fail = 0;
+static uint32_t Seed = 1;
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static float Rand_Float(float range)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return ((Seed >> 8) / (float)(1 << 24) * 2 - 1) * range;
+}
+
+static uint32_t Rand(uint32_t n)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return (Seed >> 8) % n;
+}
+
+// 测量值: 随期望缓慢跟随, 偶尔为非正规数 measurement follows the reference slowly, occasionally not a normal number
+static float Measure(float ref, float last)
+{
+    static const float special[] = {0.0f, -0.0f, 1e-40f, INFINITY, -INFINITY, NAN};
+    if (Rand(200) == 0)
+        return special[Rand(sizeof(special) / sizeof(special[0]))];
+    if (!isfinite(last))
+        last = 0;
+    return last + (ref - last) * 0.05f + Rand_Float(30);
+}
+
+static uint8_t Same(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// 返回不一致的次数 returns the number of mismatches
+static uint32_t Run(const Test_Config_t *config, uint32_t ticks)
+{
+    static PID_t pid[TEST_N];
+    static PID_Batch_t batch;
+    DWT_Tick_t tick_ctx = {0}; // 与 PID_t 的计数一样从 0 起计时 timed from 0 like the PID_t counters
+    float measure[TEST_N] = {0}, ref[TEST_N] = {0};
+    uint32_t mismatch = 0;
+
+    memset(pid, 0, sizeof(pid));
+    for (uint8_t i = 0; i < TEST_N; i++)
+        PID_Init(&pid[i], 16384, 16384, config->DeadBand, 15, 30, 0.02f, 500, 100, 0.005f, 0.002f, 1, config->Improve);
+    PID_Batch_Init(&batch, TEST_N, 16384, 16384, config->DeadBand, 15, 30, 0.02f, 0.005f, 0.002f, config->Improve);
+    Host_Clock_Advance_us(2000);
+
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        // 期望值每 500 周期阶跃一次, 幅度足以饱和 the reference steps every 500 ticks, far enough to saturate
+        if (tick % 500 == 0)
+            for (uint8_t i = 0; i < TEST_N; i++)
+                ref[i] = Rand_Float(9000);
+        for (uint8_t i = 0; i < TEST_N; i++)
+            measure[i] = Measure(ref[i], measure[i]);
+        // 周期在 1.5~2.5 ms 间抖动 the period jitters between 1.5 and 2.5 ms
+        Host_Clock_Advance_us(1500 + Rand(1001));
+        DWT_Tick_Update(&tick_ctx);
+
+        for (uint8_t i = 0; i < TEST_N; i++)
+            PID_Calculate(&pid[i], measure[i], ref[i]);
+        PID_Batch_Calculate_Tick(&batch, &tick_ctx, measure, ref);
+
+        for (uint8_t i = 0; i < TEST_N; i++)
+            if (!Same(pid[i].Output, batch.Output[i]) || !Same(pid[i].Pout, batch.Pout[i]) ||
+                !Same(pid[i].Iout, batch.Iout[i]) || !Same(pid[i].Dout, batch.Dout[i]) ||
+                !Same(pid[i].ITerm, batch.ITerm[i]))
+            {
+                if (mismatch == 0)
+                    printf("  first mismatch at tick %u channel %u: output %.9g vs %.9g\n",
+                           tick, i, pid[i].Output, batch.Output[i]);
+                mismatch++;
+            }
+    }
+    return mismatch;
+}
+
+// 电机层: 偶数路带速度前馈, 奇数路前馈保持全零 (MaxOut 为 0)
+// motor level: even channels carry a velocity feedforward, odd ones keep it all zero (MaxOut 0)
+static uint32_t Run_Motor(uint32_t ticks)
+{
+    static Motor_t scalar[TEST_N], batch_motor[TEST_N];
+    static PID_Batch_t batch;
+    static float c[3] = {0.4f, 0.02f, 0};
+    const uint8_t improve = Integral_Limit | OutputFilter;
+    DWT_Tick_t tick_ctx = {0};
+    float ref[TEST_N] = {0};
+    uint32_t mismatch = 0;
+
+    memset(scalar, 0, sizeof(scalar));
+    for (uint8_t i = 0; i < TEST_N; i++)
+    {
+        scalar[i].Max_Out = 16384;
+        PID_Init(&scalar[i].PID_Velocity, 16384, 16384, 0, 15, 30, 0.02f, 500, 100, 0.005f, 0.002f, 1, improve);
+        if (i % 2 == 0)
+            Feedforward_Init(&scalar[i].FFC_Velocity, 6000, c, 0.002f, 0, 0);
+    }
+    memcpy(batch_motor, scalar, sizeof(scalar));
+    PID_Batch_Init(&batch, TEST_N, 16384, 16384, 0, 15, 30, 0.02f, 0.005f, 0.002f, improve);
+    Host_Clock_Advance_us(2000);
+
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        if (tick % 500 == 0)
+            for (uint8_t i = 0; i < TEST_N; i++)
+                ref[i] = Rand_Float(9000);
+        for (uint8_t i = 0; i < TEST_N; i++)
+            scalar[i].Velocity_RPM = batch_motor[i].Velocity_RPM = Measure(ref[i], scalar[i].Velocity_RPM);
+        Host_Clock_Advance_us(1500 + Rand(1001));
+        DWT_Tick_Update(&tick_ctx);
+
+        for (uint8_t i = 0; i < TEST_N; i++)
+            Motor_Speed_Calculate_Tick(&scalar[i], &tick_ctx, scalar[i].Velocity_RPM, ref[i]);
+        Motor_Speed_Calculate_Batch(batch_motor, &batch, &tick_ctx, ref);
+
+        for (uint8_t i = 0; i < TEST_N; i++)
+            if (!Same(scalar[i].Output, batch_motor[i].Output) ||
+                !Same(scalar[i].FFC_Velocity.Output, batch_motor[i].FFC_Velocity.Output) ||
+                !Same(scalar[i].FFC_Velocity.Ref, batch_motor[i].FFC_Velocity.Ref))
+            {
+                if (mismatch == 0)
+                    printf("  first mismatch at tick %u motor %u: output %.9g vs %.9g\n",
+                           tick, i, scalar[i].Output, batch_motor[i].Output);
+                mismatch++;
+            }
+    }
+    return mismatch;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = 200000, mismatch;
+    char what[96];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            ticks = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n ticks]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Host_HAL_Init();
+    DWT_Init(HOST_CPU_FREQ_MHZ);
+
+    printf("%u ticks of %u channels per feature set, time per tick from the probes\n", ticks, TEST_N);
+    printf("%-20s %14s %14s %8s\n", "features", "scalar us", "batch us", "speedup");
+    for (uint8_t c = 0; c < sizeof(Test_Config) / sizeof(Test_Config[0]); c++)
+    {
+        float scalar_us, batch_us;
+
+        Profile_Reset();
+        mismatch = Run(&Test_Config[c], ticks);
+        scalar_us = Profile_Mean_us(PROFILE_PID) * TEST_N;
+        batch_us = Profile_Mean_us(PROFILE_PID_BATCH);
+        printf("%-20s %14.3f %14.3f %7.2fx\n", Test_Config[c].Name, scalar_us, batch_us, scalar_us / batch_us);
+
+        snprintf(what, sizeof(what), "%s: tick batch equals PID_Calculate() bit for bit", Test_Config[c].Name);
+        Check(mismatch == 0, what);
+    }
+
+    mismatch = Run_Motor(ticks);
+    Check(mismatch == 0, "motor batch equals Motor_Speed_Calculate_Tick() bit for bit");
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,295 @@
+/**
+ ******************************************************************************
+ * @file    pid_static_test.c
+ * @brief   编译期定功能 PID 主机测试与基准 host test and benchmark of the fixed-feature PID
+ *          对每种功能组合 (固件中的 PID_Rotate/PID_Heat, 以及本文件生成的无功能/轮速/全部功能),
+ *          以同一组随机测量/期望值 (含死区内的误差, 饱和, nan/inf/0 输入) 分别调用
+ *          PID_Calculate() 与生成的 _Calculate(), 要求输出与中间量逐位相同,
+ *          再分别计时, 给出每次计算的主机 TSC 周期数与结构体字节数
+ *          for every feature set (PID_Rotate/PID_Heat from the firmware, plus none/wheel/all
+ *          generated here), feeds the same random measurements and references (errors inside the
+ *          deadband, saturation, nan/inf/0 inputs) to PID_Calculate() and to the generated
+ *          _Calculate(); outputs and intermediate terms must match bit for bit. Both are then
+ *          timed, giving host TSC cycles per call and the struct size
+ *
+ *          usage: pid_static_test [-n ticks]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  PID_Calculate() 与生成的 _Calculate() 均含 PROFILE_PID 探针, 其开销单独测出后从两者扣除;
+ *  主机耗时只反映相对开销, 固件上的周期数需以 DWT->CYCCNT 实测
+ *  PID_Calculate() and the generated _Calculate() both carry the PROFILE_PID probe, whose cost
+ *  is measured and subtracted from both;
+ *  host times only show the relative cost, measure with DWT->CYCCNT on the target
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+#include "host_hal.h"
+#include "controller.h"
+#include "pid_static.h"
+#include "profiler.h"
+
+//                 name       IL DOM TRAP OF CIR DF EH
+PID_STATIC_DECLARE(PID_Plain, 0, 0,  0,   0, 0,  0, 0)
+PID_STATIC_DECLARE(PID_Wheel, 1, 0,  0,   1, 0,  0, 0)
+PID_STATIC_DECLARE(PID_Full,  1, 1,  1,   1, 1,  1, 1)
+PID_STATIC_DEFINE(PID_Plain, 0, 0, 0, 0, 0, 0, 0)
+PID_STATIC_DEFINE(PID_Wheel, 1, 0, 0, 1, 0, 0, 0)
+PID_STATIC_DEFINE(PID_Full, 1, 1, 1, 1, 1, 1, 1)
+
+typedef struct
+{
+    const char *Name;
+    uint8_t Improve;
+    uint32_t Size;
+    void (*Init)(float deadband);
+    float (*Calculate)(float measure, float ref);
+    void *Pid;
+    uint32_t Off_Pout, Off_Iout, Off_Dout, Off_ITerm, Off_Output;
+    uint64_t (*Errors)(void);
+} Test_Case_t;
+
+// 为每个类型生成一个实例与统一接口 one instance and a uniform interface per type
+#define TEST_CASE_DEFINE(name, EH)                                                                  \
+    static name##_t name##_Pid;                                                                     \
+    static void name##_Test_Init(float deadband)                                                    \
+    {                                                                                               \
+        name##_Init(&name##_Pid, 16384, 16384, deadband, 15, 30, 0.02f, 500, 100, 0.005f, 0.002f); \
+    }                                                                                               \
+    static float name##_Test_Calculate(float measure, float ref)                                    \
+    {                                                                                               \
+        return name##_Calculate(&name##_Pid, measure, ref);                                         \
+    }                                                                                               \
+    static uint64_t name##_Test_Errors(void)                                                        \
+    {                                                                                               \
+        return PID_STATIC_IF_ELSE(EH, name##_Pid.ERRORHandler.ERRORCount, 0);                       \
+    }
+
+#define TEST_CASE(name)                                                                   \
+    {                                                                                     \
+        #name, name##_IMPROVE, sizeof(name##_t), name##_Test_Init, name##_Test_Calculate, \
+        &name##_Pid, offsetof(name##_t, Pout), offsetof(name##_t, Iout),                  \
+        offsetof(name##_t, Dout), offsetof(name##_t, ITerm), offsetof(name##_t, Output),  \
+        name##_Test_Errors                                                                \
+    }
+
+TEST_CASE_DEFINE(PID_Plain, 0)
+TEST_CASE_DEFINE(PID_Wheel, 0)
+TEST_CASE_DEFINE(PID_Rotate, 0)
+TEST_CASE_DEFINE(PID_Heat, 0)
+TEST_CASE_DEFINE(PID_Full, 1)
+
+static const Test_Case_t Test_Case[] = {
+    TEST_CASE(PID_Plain),
+    TEST_CASE(PID_Wheel),
+    TEST_CASE(PID_Rotate),
+    TEST_CASE(PID_Heat),
+    TEST_CASE(PID_Full),
+};
+
+static const float Test_DeadBand[] = {0, 20};
+
+static PID_t Dynamic;
+static uint8_t Fail = 0;
+static uint32_t Seed = 1;
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static float Rand_Float(float range)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return ((Seed >> 8) / (float)(1 << 24) * 2 - 1) * range;
+}
+
+static uint32_t Rand(uint32_t n)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return (Seed >> 8) % n;
+}
+
+static uint64_t Host_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 测量值: 随期望缓慢跟随, 偶尔为非正规数 measurement follows the reference slowly, occasionally not a normal number
+static float Measure(float ref, float last)
+{
+    static const float special[] = {0.0f, -0.0f, 1e-40f, INFINITY, -INFINITY, NAN};
+    if (Rand(200) == 0)
+        return special[Rand(sizeof(special) / sizeof(special[0]))];
+    if (!isfinite(last))
+        last = 0;
+    return last + (ref - last) * 0.05f + Rand_Float(30);
+}
+
+static uint8_t Same(float a, const void *pid, uint32_t offset)
+{
+    return memcmp(&a, (const uint8_t *)pid + offset, sizeof(float)) == 0;
+}
+
+static void Dynamic_Init(const Test_Case_t *test, float deadband)
+{
+    memset(&Dynamic, 0, sizeof(Dynamic));
+    PID_Init(&Dynamic, 16384, 16384, deadband, 15, 30, 0.02f, 500, 100, 0.005f, 0.002f, 1, test->Improve);
+}
+
+// 返回不一致的次数 returns the number of mismatches
+static uint32_t Run(const Test_Case_t *test, float deadband, uint32_t ticks)
+{
+    float measure = 0, ref = 0;
+    uint32_t mismatch = 0;
+
+    Dynamic_Init(test, deadband);
+    test->Init(deadband);
+    Host_Clock_Advance_us(2000);
+
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        // 期望值每 500 周期阶跃一次, 幅度足以饱和 the reference steps every 500 ticks, far enough to saturate
+        if (tick % 500 == 0)
+            ref = Rand_Float(9000);
+        measure = Measure(ref, measure);
+        // 周期在 1.5~2.5 ms 间抖动 the period jitters between 1.5 and 2.5 ms
+        Host_Clock_Advance_us(1500 + Rand(1001));
+
+        PID_Calculate(&Dynamic, measure, ref);
+        test->Calculate(measure, ref);
+
+        if (!Same(Dynamic.Output, test->Pid, test->Off_Output) || !Same(Dynamic.Pout, test->Pid, test->Off_Pout) ||
+            !Same(Dynamic.Iout, test->Pid, test->Off_Iout) || !Same(Dynamic.Dout, test->Pid, test->Off_Dout) ||
+            !Same(Dynamic.ITerm, test->Pid, test->Off_ITerm) ||
+            ((test->Improve & ErrorHandle) && Dynamic.ERRORHandler.ERRORCount != test->Errors()))
+        {
+            if (mismatch == 0)
+                printf("  first mismatch at tick %u: output %.9g vs %.9g\n", tick, Dynamic.Output,
+                       *(const float *)((const uint8_t *)test->Pid + test->Off_Output));
+            mismatch++;
+        }
+    }
+    return mismatch;
+}
+
+// 每次调用的平均周期数, 已扣除一对 rdtsc 的开销 mean cycles per call, less the cost of a rdtsc pair
+static double Time_Dynamic(const Test_Case_t *test, uint32_t ticks, double overhead)
+{
+    uint64_t sum = 0, t0;
+
+    Dynamic_Init(test, 0);
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        float ref = (tick / 500 % 2) ? 5000.0f : -5000.0f;
+        Host_Clock_Advance_us(2000);
+        t0 = Host_Cycles();
+        PID_Calculate(&Dynamic, ref * 0.9f + Rand_Float(30), ref);
+        sum += Host_Cycles() - t0;
+    }
+    return (double)sum / ticks - overhead;
+}
+
+static double Time_Static(const Test_Case_t *test, uint32_t ticks, double overhead)
+{
+    uint64_t sum = 0, t0;
+
+    test->Init(0);
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        float ref = (tick / 500 % 2) ? 5000.0f : -5000.0f;
+        Host_Clock_Advance_us(2000);
+        t0 = Host_Cycles();
+        test->Calculate(ref * 0.9f + Rand_Float(30), ref);
+        sum += Host_Cycles() - t0;
+    }
+    return (double)sum / ticks - overhead;
+}
+
+static double Time_Overhead(uint32_t ticks)
+{
+    uint64_t sum = 0, t0;
+
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        t0 = Host_Cycles();
+        sum += Host_Cycles() - t0;
+    }
+    return (double)sum / ticks;
+}
+
+// PROFILE_PID 探针本身的开销 cost of the PROFILE_PID probe itself
+static double Time_Probe(uint32_t ticks, double overhead)
+{
+    uint64_t sum = 0, t0;
+
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        t0 = Host_Cycles();
+        {
+            PROFILE_BEGIN(PROFILE_PID);
+            PROFILE_END(PROFILE_PID);
+        }
+        sum += Host_Cycles() - t0;
+    }
+    Profile_Reset();
+    return (double)sum / ticks - overhead;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = 200000, mismatch;
+    double overhead, probe;
+    char what[96];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            ticks = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n ticks]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Host_HAL_Init();
+    DWT_Init(HOST_CPU_FREQ_MHZ);
+
+    for (uint8_t c = 0; c < sizeof(Test_Case) / sizeof(Test_Case[0]); c++)
+        for (uint8_t d = 0; d < sizeof(Test_DeadBand) / sizeof(Test_DeadBand[0]); d++)
+        {
+            mismatch = Run(&Test_Case[c], Test_DeadBand[d], ticks);
+            snprintf(what, sizeof(what), "%s (improve %02X) deadband %g: equals PID_Calculate() bit for bit",
+                     Test_Case[c].Name, Test_Case[c].Improve, Test_DeadBand[d]);
+            Check(mismatch == 0, what);
+        }
+
+    overhead = Time_Overhead(ticks);
+    probe = Time_Probe(ticks, overhead);
+    printf("\n%u calls per feature set, host TSC cycles per call, PROFILE_PID probe (%.1f) subtracted from both\n",
+           ticks, probe);
+    printf("%-12s %8s %10s %10s %8s %12s %12s\n", "features", "improve", "PID_t", "static", "speedup",
+           "PID_t bytes", "static bytes");
+    for (uint8_t c = 0; c < sizeof(Test_Case) / sizeof(Test_Case[0]); c++)
+    {
+        double dynamic_cyc = Time_Dynamic(&Test_Case[c], ticks, overhead) - probe;
+        double static_cyc = Time_Static(&Test_Case[c], ticks, overhead) - probe;
+        printf("%-12s       %02X %10.1f %10.1f %7.2fx %12u %12u\n", Test_Case[c].Name, Test_Case[c].Improve,
+               dynamic_cyc, static_cyc, dynamic_cyc / static_cyc, (unsigned)sizeof(PID_t), Test_Case[c].Size);
+    }
+    Profile_Reset();
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,421 @@
+/**
+ ******************************************************************************
+ * @file    qekf_test.c
+ * @brief   四元数 EKF 稀疏展开更新的主机测试与基准 host test and benchmark of the sparsity-expanded QEKF update
+ *          以随机姿态运动 (静止, 慢转, 快速自旋, 线加速度冲击) 生成角速度计 (含零偏与噪声) 与
+ *          加速度计序列, 逐步比较 IMU_QuaternionEKF_Update() 的通用矩阵路径与稀疏展开路径:
+ *          1. 单步: 每步从通用路径的同一状态出发, 比较协方差 (按 sqrt(Pii Pjj) 归一化),
+ *             四元数, 零偏与卡方检验的判定
+ *          2. 全程: 两路各自独立运行, 比较全程最大的倾角差与零偏差; 航向不可观, 舍入差异会随
+ *             积分累积, 只作报告. 作为参照, 同时给出通用路径在 x 轴角速度偏移 1 ulp 时相对自身的差异
+ *          再分别计时, 给出每次更新的主机 TSC 周期数与 PROFILE_QEKF 探针的平均值
+ *          generates gyro (with bias and noise) and accelerometer sequences from random motion
+ *          (still, slow turns, fast spins, linear acceleration shocks) and steps the generic matrix
+ *          path and the sparsity-expanded path of IMU_QuaternionEKF_Update() side by side:
+ *          1. one step: every step starts both from the state of the generic path and compares the
+ *             covariance (scaled by sqrt(Pii Pjj)), quaternion, bias and chi-square decisions
+ *          2. free running: both paths run on their own, comparing the largest tilt and bias
+ *             difference over the run; the heading is unobservable and integrates the rounding
+ *             differences, so it is only reported. For reference, the same differences are given
+ *             for the generic path against itself with the x gyro input moved by 1 ulp; a sequence
+ *             where that reference exceeds the tolerances is ill-conditioned and is held to a
+ *             multiple of the reference instead
+ *          then times both, giving host TSC cycles per update and the mean of the PROFILE_QEKF probe
+ *
+ *          usage: qekf_test [-n steps per sequence] [-s sequences]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  主机耗时只反映相对开销, 固件上的周期数由 PROFILE_QEKF 探针以 DWT->CYCCNT 实测
+ *  host times only show the relative cost, the PROFILE_QEKF probe measures the target
+ *  cycles with DWT->CYCCNT
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_hal.h"
+#include "bsp_dwt.h"
+#include "QuaternionEKF.h"
+#include "profiler.h"
+
+#define TEST_DT 0.001f
+#define TEST_GRAVITY 9.8
+#define TEST_SEGMENT 2000 // 每段运动的步数 steps per motion segment
+
+// 单步容差 one step tolerances
+#define TEST_P_TOLERANCE 1e-4f // |dPij| / sqrt(Pii Pjj)
+#define TEST_Q_TOLERANCE 1e-5f
+#define TEST_BIAS_TOLERANCE 1e-7f
+#define TEST_DECISION_RATE 1e-4 // 卡方判定不一致的比例上限 limit on the share of differing chi-square decisions
+// 全程容差 free running tolerances
+#define TEST_DRIFT_TILT_DEG 0.1
+#define TEST_DRIFT_BIAS 5e-4f
+// 通用路径自身对 1 ulp 输入变化的差异超过上述容差时 (如绕 z 轴长时间高速自旋, x/y 零偏几乎不可观),
+// 改为要求不超过该差异的倍数
+// where the generic path itself moves by more than the above for a 1 ulp input change (such as a long
+// fast spin about z, leaving the x/y bias barely observable), require no more than a multiple of that
+#define TEST_DRIFT_ULP_SCALE 4
+
+typedef enum
+{
+    MOTION_STILL = 0,
+    MOTION_SLOW,
+    MOTION_SPIN,
+    MOTION_SHOCK,
+    MOTION_NUM,
+} Motion_e;
+
+typedef struct
+{
+    double q[4];     // 真实姿态 true attitude
+    double w[3];     // 真实角速度 true rate, rad/s
+    double bias[3];  // 角速度计零偏 gyro bias, rad/s
+    double shock[3]; // 线加速度 linear acceleration, m/s²
+    Motion_e Motion;
+} Motion_t;
+
+typedef struct
+{
+    double Tilt_deg, Heading_deg;
+    float Bias;
+} Drift_t;
+
+typedef struct
+{
+    float P_Error, Q_Error, Bias_Error;
+    uint32_t Decisions, Steps;
+    Drift_t Closed; // 稀疏展开路径 sparsity-expanded path
+    Drift_t Ulp;    // 通用路径, 输入偏移 1 ulp generic path, input moved by 1 ulp
+} Test_Result_t;
+
+static QEKF_INS_t QEKF_Init_State;
+static uint8_t Fail = 0;
+static uint32_t Seed = 1;
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static double Rand_Double(double range)
+{
+    Seed = Seed * 1664525u + 1013904223u;
+    return ((Seed >> 8) / (double)(1 << 24) * 2 - 1) * range;
+}
+
+static double Rand_Gauss(double sigma)
+{
+    // 12 个均匀分布之和 sum of 12 uniforms
+    double sum = 0;
+    for (uint8_t i = 0; i < 12; i++)
+        sum += Rand_Double(0.5);
+    return sum * sigma;
+}
+
+static uint64_t Host_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void Motion_Init(Motion_t *m)
+{
+    memset(m, 0, sizeof(*m));
+    m->q[0] = 1;
+    for (uint8_t i = 0; i < 3; i++)
+        m->bias[i] = Rand_Double(0.02);
+}
+
+// 每段开始时随机选择运动 pick a random motion at the start of every segment
+static void Motion_Segment(Motion_t *m)
+{
+    m->Motion = (Motion_e)(Seed % MOTION_NUM);
+    Rand_Double(1);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        switch (m->Motion)
+        {
+        case MOTION_STILL:
+            m->w[i] = 0;
+            break;
+        case MOTION_SLOW:
+            m->w[i] = Rand_Double(1);
+            break;
+        case MOTION_SPIN:
+            m->w[i] = i == 2 ? Rand_Double(30) : Rand_Double(3);
+            break;
+        default:
+            m->w[i] = Rand_Double(0.5);
+            break;
+        }
+        m->shock[i] = 0;
+    }
+}
+
+// 推进一步并给出量测 advance one step and give the measurements
+static void Motion_Step(Motion_t *m, uint32_t k, float gyro[3], float accel[3])
+{
+    double half[3], dq[4], n, g[3];
+
+    if (k % TEST_SEGMENT == 0)
+        Motion_Segment(m);
+    if (m->Motion == MOTION_SHOCK && k % 200 == 0)
+        for (uint8_t i = 0; i < 3; i++)
+            m->shock[i] = Rand_Double(30);
+    for (uint8_t i = 0; i < 3; i++)
+        m->shock[i] *= 0.98;
+
+    // q = q ⊗ exp(w dt / 2)
+    for (uint8_t i = 0; i < 3; i++)
+        half[i] = 0.5 * m->w[i] * TEST_DT;
+    n = sqrt(half[0] * half[0] + half[1] * half[1] + half[2] * half[2]);
+    dq[0] = cos(n);
+    for (uint8_t i = 0; i < 3; i++)
+        dq[i + 1] = n > 0 ? half[i] * sin(n) / n : 0;
+    {
+        double a[4] = {m->q[0], m->q[1], m->q[2], m->q[3]};
+        m->q[0] = a[0] * dq[0] - a[1] * dq[1] - a[2] * dq[2] - a[3] * dq[3];
+        m->q[1] = a[0] * dq[1] + a[1] * dq[0] + a[2] * dq[3] - a[3] * dq[2];
+        m->q[2] = a[0] * dq[2] - a[1] * dq[3] + a[2] * dq[0] + a[3] * dq[1];
+        m->q[3] = a[0] * dq[3] + a[1] * dq[2] - a[2] * dq[1] + a[3] * dq[0];
+    }
+
+    // 机体系重力方向, 与 QEKF 的量测模型一致 gravity in the body frame, as in the QEKF measurement model
+    g[0] = 2 * (m->q[1] * m->q[3] - m->q[0] * m->q[2]);
+    g[1] = 2 * (m->q[0] * m->q[1] + m->q[2] * m->q[3]);
+    g[2] = m->q[0] * m->q[0] - m->q[1] * m->q[1] - m->q[2] * m->q[2] + m->q[3] * m->q[3];
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        gyro[i] = (float)(m->w[i] + m->bias[i] + Rand_Gauss(0.003));
+        accel[i] = (float)(g[i] * TEST_GRAVITY + m->shock[i] + Rand_Gauss(0.05));
+    }
+}
+
+static void Step(QEKF_INS_t *ins, uint8_t closed_form, const float gyro[3], const float accel[3])
+{
+    QEKF_INS = *ins;
+    QEKF_INS.UseClosedForm = closed_form;
+    IMU_QuaternionEKF_Update(gyro[0], gyro[1], gyro[2], accel[0], accel[1], accel[2], TEST_DT);
+    *ins = QEKF_INS;
+}
+
+// 两个姿态的机体系重力方向之间的夹角 angle between the body frame gravity directions of two attitudes
+static double Tilt_Diff_deg(const float *a, const float *b)
+{
+    double ga[3], gb[3], cross[3], dot;
+
+    ga[0] = 2.0 * (a[1] * a[3] - a[0] * a[2]);
+    ga[1] = 2.0 * (a[0] * a[1] + a[2] * a[3]);
+    ga[2] = (double)a[0] * a[0] - a[1] * a[1] - a[2] * a[2] + a[3] * a[3];
+    gb[0] = 2.0 * (b[1] * b[3] - b[0] * b[2]);
+    gb[1] = 2.0 * (b[0] * b[1] + b[2] * b[3]);
+    gb[2] = (double)b[0] * b[0] - b[1] * b[1] - b[2] * b[2] + b[3] * b[3];
+    cross[0] = ga[1] * gb[2] - ga[2] * gb[1];
+    cross[1] = ga[2] * gb[0] - ga[0] * gb[2];
+    cross[2] = ga[0] * gb[1] - ga[1] * gb[0];
+    dot = ga[0] * gb[0] + ga[1] * gb[1] + ga[2] * gb[2];
+    return atan2(sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), dot) * 180.0 / M_PI;
+}
+
+static double Heading_Diff_deg(const QEKF_INS_t *a, const QEKF_INS_t *b)
+{
+    double diff = fmod(fabs((double)a->Yaw - b->Yaw), 360.0);
+    return diff > 180.0 ? 360.0 - diff : diff;
+}
+
+static void Compare_Drift(const QEKF_INS_t *a, const QEKF_INS_t *b, Drift_t *drift)
+{
+    double diff;
+    float bias_err;
+
+    diff = Tilt_Diff_deg(a->q, b->q);
+    if (!(diff <= drift->Tilt_deg))
+        drift->Tilt_deg = diff;
+    diff = Heading_Diff_deg(a, b);
+    if (!(diff <= drift->Heading_deg))
+        drift->Heading_deg = diff;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        bias_err = fabsf(a->GyroBias[i] - b->GyroBias[i]);
+        if (!(bias_err <= drift->Bias))
+            drift->Bias = bias_err;
+    }
+}
+
+static void Max_Drift(Drift_t *total, const Drift_t *drift)
+{
+    total->Tilt_deg = fmax(total->Tilt_deg, drift->Tilt_deg);
+    total->Heading_deg = fmax(total->Heading_deg, drift->Heading_deg);
+    total->Bias = fmaxf(total->Bias, drift->Bias);
+}
+
+static void Compare_Step(const QEKF_INS_t *generic, const QEKF_INS_t *closed, Test_Result_t *result)
+{
+    const KalmanFilter6x3_t *g = &generic->IMU_QuaternionEKF, *c = &closed->IMU_QuaternionEKF;
+    float err;
+
+    for (uint8_t i = 0; i < 6; i++)
+        for (uint8_t j = 0; j < 6; j++)
+        {
+            err = fabsf(g->P_data[i * 6 + j] - c->P_data[i * 6 + j]) / sqrtf(g->P_data[i * 7] * g->P_data[j * 7]);
+            if (!(err <= result->P_Error)) // nan 亦记入 nan counts too
+                result->P_Error = err;
+        }
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        err = fabsf(g->xhat_data[i] - c->xhat_data[i]);
+        if (!(err <= result->Q_Error))
+            result->Q_Error = err;
+    }
+    for (uint8_t i = 4; i < 6; i++)
+    {
+        err = fabsf(g->xhat_data[i] - c->xhat_data[i]);
+        if (!(err <= result->Bias_Error))
+            result->Bias_Error = err;
+    }
+    if (g->SkipEq5 != c->SkipEq5 || generic->ConvergeFlag != closed->ConvergeFlag ||
+        generic->ErrorCount != closed->ErrorCount)
+        result->Decisions++;
+}
+
+static void Run(uint32_t steps, Test_Result_t *result)
+{
+    static QEKF_INS_t generic, closed, single, ulp;
+    Motion_t motion;
+    float gyro[3], accel[3], gyro_ulp[3];
+
+    Motion_Init(&motion);
+    generic = QEKF_Init_State;
+    closed = QEKF_Init_State;
+    ulp = QEKF_Init_State;
+    for (uint32_t k = 0; k < steps; k++)
+    {
+        Motion_Step(&motion, k, gyro, accel);
+
+        single = generic;
+        Step(&generic, FALSE, gyro, accel);
+        Step(&single, TRUE, gyro, accel);
+        Step(&closed, TRUE, gyro, accel);
+        gyro_ulp[0] = nextafterf(gyro[0], INFINITY);
+        gyro_ulp[1] = gyro[1];
+        gyro_ulp[2] = gyro[2];
+        Step(&ulp, FALSE, gyro_ulp, accel);
+
+        // 第一步自初始协方差 1e5 起, 单步比较从第二步开始 the first step starts from the 1e5 initial covariance, compare from the second
+        if (k > 0)
+            Compare_Step(&generic, &single, result);
+        result->Steps++;
+
+        Compare_Drift(&generic, &closed, &result->Closed);
+        Compare_Drift(&generic, &ulp, &result->Ulp);
+    }
+}
+
+// 每次更新的平均周期数与探针均值 mean cycles per update and the probe mean
+static double Time_Path(uint8_t closed_form, uint32_t steps, float *probe_us)
+{
+    Motion_t motion;
+    float gyro[3], accel[3];
+    uint64_t sum = 0, t0;
+
+    Seed = 7;
+    Motion_Init(&motion);
+    QEKF_INS = QEKF_Init_State;
+    QEKF_INS.UseClosedForm = closed_form;
+    Profile_Reset();
+    for (uint32_t k = 0; k < steps; k++)
+    {
+        Motion_Step(&motion, k, gyro, accel);
+        t0 = Host_Cycles();
+        IMU_QuaternionEKF_Update(gyro[0], gyro[1], gyro[2], accel[0], accel[1], accel[2], TEST_DT);
+        sum += Host_Cycles() - t0;
+    }
+    *probe_us = Profile_Mean_us(PROFILE_QEKF);
+    Profile_Reset();
+    return (double)sum / steps;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t steps = 100000, sequences = 4;
+    Test_Result_t result = {0};
+    double generic_cyc, closed_cyc;
+    float generic_us, closed_us;
+    char what[96];
+    uint8_t drift_ok = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            steps = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            sequences = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n steps per sequence] [-s sequences]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Host_HAL_Init();
+    DWT_Init(HOST_CPU_FREQ_MHZ);
+
+    // 初始状态只取一次: IMU_QuaternionEKF_P 随后被观测函数覆盖
+    // take the initial state once: IMU_QuaternionEKF_P is overwritten by the observer afterwards
+    memset(&QEKF_INS, 0, sizeof(QEKF_INS));
+    IMU_QuaternionEKF_Init(10, 0.001, 1000000, 0.9996, 0);
+    QEKF_Init_State = QEKF_INS;
+
+    for (uint32_t s = 0; s < sequences; s++)
+    {
+        Test_Result_t seq = {0};
+
+        Seed = 1 + s;
+        Run(steps, &seq);
+        printf("sequence %u: %u steps, one step max dP %.2e dq %.2e dbias %.2e, %u decisions differ\n",
+               s, seq.Steps, seq.P_Error, seq.Q_Error, seq.Bias_Error, seq.Decisions);
+        printf("  free running max: closed form tilt %.2e deg bias %.2e rad/s heading %.2e deg\n",
+               seq.Closed.Tilt_deg, seq.Closed.Bias, seq.Closed.Heading_deg);
+        printf("                    gyro +1 ulp tilt %.2e deg bias %.2e rad/s heading %.2e deg\n",
+               seq.Ulp.Tilt_deg, seq.Ulp.Bias, seq.Ulp.Heading_deg);
+        result.P_Error = fmaxf(result.P_Error, seq.P_Error);
+        result.Q_Error = fmaxf(result.Q_Error, seq.Q_Error);
+        result.Bias_Error = fmaxf(result.Bias_Error, seq.Bias_Error);
+        result.Decisions += seq.Decisions;
+        result.Steps += seq.Steps;
+        Max_Drift(&result.Closed, &seq.Closed);
+        Max_Drift(&result.Ulp, &seq.Ulp);
+        drift_ok &= seq.Closed.Tilt_deg < fmax(TEST_DRIFT_TILT_DEG, TEST_DRIFT_ULP_SCALE * seq.Ulp.Tilt_deg) &&
+                    seq.Closed.Bias < fmaxf(TEST_DRIFT_BIAS, TEST_DRIFT_ULP_SCALE * seq.Ulp.Bias);
+        if (seq.Ulp.Tilt_deg > TEST_DRIFT_TILT_DEG || seq.Ulp.Bias > TEST_DRIFT_BIAS)
+            printf("  ill-conditioned: the 1 ulp reference exceeds the tolerances, held to %dx it\n", TEST_DRIFT_ULP_SCALE);
+    }
+
+    snprintf(what, sizeof(what), "one step covariance |dPij| / sqrt(Pii Pjj) < %g", TEST_P_TOLERANCE);
+    Check(result.P_Error < TEST_P_TOLERANCE, what);
+    snprintf(what, sizeof(what), "one step quaternion < %g, bias < %g", TEST_Q_TOLERANCE, TEST_BIAS_TOLERANCE);
+    Check(result.Q_Error < TEST_Q_TOLERANCE && result.Bias_Error < TEST_BIAS_TOLERANCE, what);
+    snprintf(what, sizeof(what), "chi-square decisions differ on < %g of the steps", TEST_DECISION_RATE);
+    Check(result.Decisions <= TEST_DECISION_RATE * result.Steps, what);
+    snprintf(what, sizeof(what), "free running tilt < %g deg, bias < %g rad/s, or %dx 1 ulp", TEST_DRIFT_TILT_DEG,
+             TEST_DRIFT_BIAS, TEST_DRIFT_ULP_SCALE);
+    Check(drift_ok, what);
+
+    generic_cyc = Time_Path(FALSE, steps, &generic_us);
+    closed_cyc = Time_Path(TRUE, steps, &closed_us);
+    printf("\n%u updates per path, IMU_QuaternionEKF_Update() as a whole\n", steps);
+    printf("%-12s %14s %16s\n", "path", "host TSC cyc", "PROFILE_QEKF us");
+    printf("%-12s %14.1f %16.3f\n", "generic", generic_cyc, generic_us);
+    printf("%-12s %14.1f %16.3f\n", "closed form", closed_cyc, closed_us);
+    printf("speedup %.2fx\n", generic_cyc / closed_cyc);
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,288 @@
+/**
+ ******************************************************************************
+ * @file    rtos_sim.c
+ * @brief   完整任务集主机仿真 host simulation of the full task set
+ *          原样运行固件的 main(): 外设初始化, MX_FREERTOS_Init() 创建的七个任务
+ *          (Gimbal/INS/Detect/PowerMeasure/UI/Chassis/Telem) 在主机 FreeRTOS 移植层上按虚拟时间调度;
+ *          节拍中断中注入外设事件:
+ *          1. 每 1 ms 四个 C620 的反馈帧 (CAN1), 被控对象由 chassis_plant.c 给出
+ *          2. 每 1 ms 更新 BMI088 的读数并产生数据就绪中断 (加速度计 800 Hz, 角速度计 2 kHz 入 FIFO), 由 SPI1 DMA 读出
+ *          3. 每 14 ms 一帧 DR16 遥控器数据 (USART3 DMA + 空闲中断), 激励与 chassis_sim 相同
+ *          结束时输出各任务的主机 CPU 占比, INS/底盘周期任务在真实调度下的抖动与超时, 堆余量
+ *          runs the firmware main() unmodified: peripheral init and the seven tasks created by
+ *          MX_FREERTOS_Init() (Gimbal/INS/Detect/PowerMeasure/UI/Chassis/Telem) are scheduled in
+ *          virtual time on the host FreeRTOS port; the tick interrupt injects peripheral events:
+ *          1. feedback frames of the four C620 every 1 ms (CAN1), plant from chassis_plant.c
+ *          2. new BMI088 readings every 1 ms with data ready interrupts (accelerometer 800 Hz, gyro 2 kHz into its FIFO), read by SPI1 DMA
+ *          3. a DR16 remote control frame every 14 ms (USART3 DMA + idle interrupt), same excitation as chassis_sim
+ *          reports the host CPU share of each task, jitter and overruns of the INS/chassis periodic
+ *          tasks under the real scheduler, and the heap headroom
+ *          -T 开启遥测 (每个底盘周期一帧), 将 USART6 发出的字节流写入文件, 可由 telem_decode 解出 CSV
+ *          -T enables telemetry (one frame per chassis tick) and writes the USART6 byte stream to a file for telem_decode
+ *          -T 同时以遥测文本帧导出计时统计表 -T also dumps the profiler table as telemetry text frames
+ *
+ *          usage: rtos_sim [-t seconds] [-T telem.bin]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_hal.h"
+#include "host_rtos.h"
+#include "chassis_plant.h"
+#include "chassis_task.h"
+#include "ins_task.h"
+#include "QuaternionAHRS.h"
+#include "usart.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include "task.h"
+
+#define SIM_RC_PERIOD_MS 14 // DR16 接收机的帧间隔 frame interval of the DR16 receiver
+#define SIM_TASK_MAX 16
+
+int Firmware_Main(void);
+
+static ChassisPlant_t ChassisPlant;
+static uint8_t Fail = 0;
+static double Wall_Start_s;
+static uint64_t Sched_Start_us; // 调度器启动时刻 (首个节拍) time the scheduler started (first tick)
+static uint32_t RC_Frames = 0;
+static FILE *TelemLog = NULL;
+
+static double Host_Wall_Time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+// DR16 帧: 4 个 11 位通道 (中位 1024) 与两个拨杆依次按位打包, 之后为鼠标与键盘
+// DR16 frame: four 11 bit channels (centre 1024) and the two switches packed bit by bit, followed by mouse and keys
+static void Sim_Pack_RC(uint8_t frame[RC_FRAME_LENGTH], const int16_t ch[4], uint8_t left, uint8_t right)
+{
+    uint64_t bits = 0;
+
+    for (uint8_t i = 0; i < 4; i++)
+        bits |= (uint64_t)((ch[i] + RC_CH_VALUE_OFFSET) & 0x07FF) << (11 * i);
+    bits |= (uint64_t)(right & 0x03) << 44;
+    bits |= (uint64_t)(left & 0x03) << 46;
+
+    memset(frame, 0, RC_FRAME_LENGTH);
+    for (uint8_t i = 0; i < 6; i++)
+        frame[i] = (bits >> (8 * i)) & 0xff;
+}
+
+// 遥控器激励: 前后阶跃 + 左右正弦, 周期 8s, 与 chassis_sim 相同
+static void Sim_Send_RemoteControl(float t)
+{
+    float phase = fmodf(t, 8.0f);
+    uint8_t frame[RC_FRAME_LENGTH];
+    int16_t ch[4];
+
+    ch[0] = 0;
+    ch[1] = 0;
+    ch[2] = phase < 2.0f ? 330 : (phase < 4.0f ? 0 : (phase < 6.0f ? -330 : 0));
+    ch[3] = (int16_t)(200.0f * sinf(2.0f * PI * t / 8.0f));
+    Sim_Pack_RC(frame, ch, Switch_Middle, Switch_Middle);
+    Host_UART_Receive(&huart3, frame, RC_FRAME_LENGTH);
+    RC_Frames++;
+}
+
+static void Sim_Telem_Tx(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len)
+{
+    if (huart == &huart6)
+        fwrite(data, 1, len, TelemLog);
+}
+
+// 节拍中断, 在 xTaskIncrementTick() 之前 tick interrupt, ahead of xTaskIncrementTick()
+static void Sim_Tick(void)
+{
+    uint64_t now_us = Host_Clock_Get_us();
+    uint32_t ms = (uint32_t)((now_us - Sched_Start_us) / 1000);
+    float accel[3], gyro[3] = {0, 0, 0}, current[4];
+    uint8_t data[8];
+
+    if (Sched_Start_us == 0)
+    {
+        Sched_Start_us = now_us;
+        ms = 0;
+    }
+
+    // Send_Chassis_Current() 当前发送零电流, 对象直接取速度环输出
+    for (uint8_t i = 0; i < 4; i++)
+        current[i] = Chassis.ChassisMotor[i].Output;
+    ChassisPlant_Update(&ChassisPlant, current, 0.001f);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        ChassisPlant_Pack_Feedback(&ChassisPlant, i, data);
+        Host_CAN_Receive(&hcan1, CAN_Receive_1_ID + i, data, 8);
+    }
+
+    accel[0] = ChassisPlant.Accel[0];
+    accel[1] = ChassisPlant.Accel[1];
+    accel[2] = 9.8f;
+    Host_BMI088_Set(accel, gyro, 40.0f);
+    // 每 5 ms 4 个加速度计样本, 每 1 ms 2 个角速度样本 4 accelerometer samples every 5 ms, 2 gyro samples every 1 ms
+    Host_BMI088_Data_Ready(ms % 5 != 4, 2);
+
+    if (ms % SIM_RC_PERIOD_MS == 0)
+        Sim_Send_RemoteControl(ms * 0.001f);
+}
+
+static void Print_Period(const char *name, const TaskPeriod_t *period)
+{
+    printf("%-8s cycles %u, jitter mean %.1f us max %.1f us, execution max %.1f us, overrun %u, skipped %u\n",
+           name, period->Cycle, period->Cycle > 1 ? period->JitterAbsSum_us / (period->Cycle - 1) : 0.0f,
+           period->JitterMax_us, period->ExecMax_us, period->Overrun, period->Skipped);
+}
+
+// 固件实际运行路径上的探针 the probes on the path the firmware actually runs
+static const Profile_Probe_e Sim_Probe[] = {
+    PROFILE_CHASSIS_CONTROL, PROFILE_KF_UPDATE, PROFILE_PID, PROFILE_PID_BATCH,
+#ifdef INS_USE_QEKF
+    PROFILE_QEKF,
+#else
+    PROFILE_AHRS,
+#endif
+    PROFILE_INS, PROFILE_CAN_RX_ISR, PROFILE_UART_IDLE_ISR, PROFILE_UI,
+};
+
+static int Sim_Report(void)
+{
+    static TaskStatus_t status[SIM_TASK_MAX];
+    static const char *state_name[] = {"running", "ready", "blocked", "suspended", "deleted", "invalid"};
+    static char text[2048];
+    const char *firmware_task[] = {"GimbalTask", "INSTask", "DetectTask", "PowerMeasureTas", "UITask", "ChassisTask", "TelemTask"};
+    double wall_total = Host_Wall_Time_s() - Wall_Start_s;
+    double sched_s = (Host_Clock_Get_us() - Sched_Start_us) * 1e-6;
+    uint32_t total_run_time, tasks, found = 0, probed = 0;
+
+    tasks = uxTaskGetSystemState(status, SIM_TASK_MAX, &total_run_time);
+
+    printf("simulated        %.3f s (scheduler %.3f s), wall time %.3f s\n",
+           Host_Clock_Get_us() * 1e-6, sched_s, wall_total);
+    printf("ticks            %u, advanced by idle %u (%.1f%%), context switches %u\n",
+           Host_RTOS_Stat.Tick, Host_RTOS_Stat.IdleTick, 100.0 * Host_RTOS_Stat.IdleTick / Host_RTOS_Stat.Tick,
+           Host_RTOS_Stat.ContextSwitch);
+    printf("heap             free %u, min ever free %u of %u bytes\n",
+           (uint32_t)xPortGetFreeHeapSize(), (uint32_t)xPortGetMinimumEverFreeHeapSize(), (uint32_t)configTOTAL_HEAP_SIZE);
+    printf("%-16s %4s %-9s %12s %6s\n", "task", "prio", "state", "host cpu us", "share");
+    for (uint32_t i = 0; i < tasks; i++)
+    {
+        printf("%-16s %4u %-9s %12u %5.1f%%\n", status[i].pcTaskName, (uint32_t)status[i].uxCurrentPriority,
+               state_name[status[i].eCurrentState], status[i].ulRunTimeCounter,
+               total_run_time ? 100.0 * status[i].ulRunTimeCounter / total_run_time : 0.0);
+        for (uint8_t j = 0; j < sizeof(firmware_task) / sizeof(firmware_task[0]); j++)
+            if (strcmp(status[i].pcTaskName, firmware_task[j]) == 0)
+                found++;
+    }
+    Print_Period("INS", &INS_Period);
+    Print_Period("Chassis", &Chassis_Period);
+    printf("BMI088 DMA       gyro %u, accel %u, temperature %u, overrun %u, error %u\n", BMI088_DMA_Stat.Gyro,
+           BMI088_DMA_Stat.Accel, BMI088_DMA_Stat.Temp, BMI088_DMA_Stat.Overrun, BMI088_DMA_Stat.Error);
+    printf("CAN1 tx/rx       %u/%u, CAN2 tx/rx %u/%u, RC frames %u\n",
+           Host_CAN_Stat[0].TxCount, Host_CAN_Stat[0].RxCount, Host_CAN_Stat[1].TxCount, Host_CAN_Stat[1].RxCount, RC_Frames);
+    printf("CAN rx queue     overflow %u, dropped before start %u, high water %u/%u\n",
+           CAN_RxQueue.Overflow, CAN_RxQueue.NotRunning, CAN_RxQueue.HighWater, CAN_RX_QUEUE_LEN);
+    printf("attitude         yaw %.3f pitch %.3f roll %.3f deg\n", AHRS.Yaw, AHRS.Pitch, AHRS.Roll);
+    printf("plant  vel [%.2f %.2f] cm/s pos [%.2f %.2f] cm\n",
+           ChassisPlant.Velocity[0], ChassisPlant.Velocity[1], ChassisPlant.Position[0], ChassisPlant.Position[1]);
+    if (TelemLog != NULL)
+    {
+        fclose(TelemLog);
+        // 921600 波特, 每字节 10 位 921600 baud, 10 bits per byte
+        printf("telemetry        frames %u, dropped %u, schema %u, text %u, %.0f B/s of %u B/s\n", Telem_Stat.Frames,
+               Telem_Stat.Dropped, Telem_Stat.Schema, Telem_Stat.Text, Telem_Stat.Bytes / sched_s, huart6.Init.BaudRate / 10);
+    }
+    Profile_Format(text, sizeof(text));
+    printf("%s", text);
+    for (uint8_t i = 0; i < sizeof(Sim_Probe) / sizeof(Sim_Probe[0]); i++)
+        if (Profile_Stat[Sim_Probe[i]].Count > 0)
+            probed++;
+
+    Check(found == sizeof(firmware_task) / sizeof(firmware_task[0]), "all firmware tasks created by MX_FREERTOS_Init()");
+    // 首个周期从任务初始化完成开始, 只要求大部分节拍都执行了一次
+    // the first cycle starts after task init, only require most of the ticks to have run once
+    Check(INS_Period.Cycle > sched_s * 1000 * 0.9, "INS task runs every 1 ms");
+#if BMI088_USE_GYRO_FIFO
+    Check(BMI088_DMA_Stat.Gyro >= (INS_Period.Cycle - 1) * BMI088_GYRO_FIFO_WATERMARK && BMI088_DMA_Stat.Error == 0 &&
+              BMI088_DMA_Stat.Overrun == 0,
+          "INS woken by every gyro FIFO read, no errors or lost samples");
+#else
+    Check(BMI088_DMA_Stat.Gyro >= INS_Period.Cycle - 1 && BMI088_DMA_Stat.Error == 0 && BMI088_DMA_Stat.Overrun == 0,
+          "INS woken by every gyro DMA read, no errors or lost samples");
+#endif
+    Check(BMI088_DMA_Stat.Temp > 0 && BMI088_DMA_Stat.Temp <= BMI088_DMA_Stat.Accel / BMI088_TEMP_DECIMATION,
+          "temperature read at the decimated rate");
+    Check(Chassis_Period.Cycle > (sched_s - 1.0) * 1000 / CHASSIS_TASK_PERIOD * 0.9, "chassis task runs every period after its 1 s start delay");
+    Check(INS_Period.Overrun == 0 && Chassis_Period.Overrun == 0, "no overruns of the periodic tasks");
+    Check(CAN_RxQueue.Overflow == 0, "CAN receive queue never overflows, start-up delay included");
+    Check(probed == sizeof(Sim_Probe) / sizeof(Sim_Probe[0]), "every profiler probe on the firmware path records samples");
+    Check(Chassis.RC.ch3 != 0 || Chassis.RC.ch4 != 0, "remote control reaches the chassis through UART DMA and the snapshot");
+    // 车体加速度使重力估计略有倾斜 the body acceleration tilts the gravity estimate slightly
+    Check(fabsf(AHRS.Pitch) < 5.0f && fabsf(AHRS.Roll) < 5.0f, "attitude stays near level with gravity on z");
+    if (TelemLog != NULL)
+    {
+        Check(Telem_Stat.Frames >= Chassis_Period.Cycle - 1 && Telem_Stat.Dropped == 0, "one telemetry frame per chassis tick, none dropped");
+        Check(Telem_Stat.Bytes / sched_s < huart6.Init.BaudRate / 10, "telemetry fits the USART6 bandwidth");
+        Check(Telem_Stat.Text > 0, "profiler table sent as telemetry text frames");
+    }
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    float seconds = 10.0f;
+    float accel[3] = {0, 0, 9.8f}, gyro[3] = {0, 0, 0};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            seconds = strtof(argv[++i], NULL);
+        else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc)
+        {
+            TelemLog = fopen(argv[++i], "wb");
+            if (TelemLog == NULL)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-t seconds] [-T telem.bin]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Host_HAL_Init();
+    ChassisPlant_Init(&ChassisPlant);
+    Host_BMI088_Set(accel, gyro, 40.0f);
+    Host_RTOS_Set_Tick_Hook(Sim_Tick);
+    Host_RTOS_Set_Stop((uint64_t)(seconds * 1e6), Sim_Report);
+    if (TelemLog != NULL)
+    {
+        Telem_Config.Decimation = 1;
+        // 计时统计表与遥测共用 USART6 the profiler table shares USART6 with telemetry
+        Profile_Dump_Mode = PROFILE_DUMP_TELEM;
+        Host_UART_Set_Tx_Callback(Sim_Telem_Tx);
+    }
+
+    Wall_Start_s = Host_Wall_Time_s();
+    // 固件的 main() 不返回, 由 Sim_Report() 结束进程 the firmware main() never returns, Sim_Report() ends the process
+    return Firmware_Main();
+}
@@ -0,0 +1,362 @@
+/**
+ ******************************************************************************
+ * @file    snapshot_test.c
+ * @brief   顺序锁快照多线程压力测试 multithreaded stress test of the seqlock snapshot
+ *          一个写线程连续发布, 多个读线程连续读取, 每次读到的值须各字段一致且不倒退:
+ *          1. 通用快照, 256 字节记录, 各字段由同一计数值导出
+ *          2. Callback_RC_Handle() 解码 DR16 帧后发布, RC_Read() 读出的各通道一致
+ *          3. Chassis_NavSnapshot, X/Y/Z 与规划点来自同一帧
+ *          DR16 与 CAN 两个遥控器来源交替发布时, RC_Read() 须返回最近的一帧
+ *          另有一个不加保护的对照组, 统计直接读取时出现的撕裂读数;
+ *          以及中断打断写者的情形: 发布进行到一半时读取, 须立即得到旧值且不重读
+ *          one writer thread publishes back to back while several reader threads read;
+ *          every value read must be self-consistent and must not go backwards:
+ *          1. generic snapshot of a 256 byte record whose fields derive from one counter
+ *          2. DR16 frames decoded and published by Callback_RC_Handle(), all channels
+ *             read through RC_Read() must agree
+ *          3. Chassis_NavSnapshot, X/Y/Z and the plan point must come from one frame
+ *          with the DR16 and CAN remote control sources publishing in turn, RC_Read()
+ *          must return the latest frame
+ *          an unprotected control group counts the torn values seen by plain reads,
+ *          and a reader interrupting a half finished publish must get the old value
+ *          at once without retrying
+ *
+ *          usage: snapshot_test [-t seconds per case] [-r readers]
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  单核主机上撕裂只在写线程被抢占于拷贝中途时出现, 对照组的撕裂数可能很小
+ *  on a single core host tearing only happens when the writer is preempted
+ *  in the middle of a copy, so the control group may count few torn reads
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "host_hal.h"
+#include "snapshot.h"
+#include "remote_control.h"
+#include "chassis_task.h"
+
+#define TEST_MAX_READERS 8
+#define TEST_RECORD_WORDS 64
+
+typedef struct
+{
+    uint32_t Word[TEST_RECORD_WORDS]; // Word[i] = n * 2654435761 + i
+} Record_t;
+
+typedef struct
+{
+    const char *Name;
+    void (*Publish)(uint32_t n);
+    uint8_t (*Read)(uint32_t *n); // 读出并校验, 返回 0 表示撕裂 read and check, 0 means torn
+    uint8_t Monotonic;            // n 为完整计数值, 可检查倒退 n is the full counter, check that it never goes back
+} Case_t;
+
+typedef struct
+{
+    const Case_t *Case;
+    uint64_t Reads;
+    uint64_t Retries;
+    uint64_t Torn;
+    uint64_t Backwards;
+} ReaderStat_t;
+
+static volatile uint8_t Running;
+static __thread uint32_t ReaderRetry; // 当前读线程本次读取的重读次数 retries of this read in the current reader
+static uint8_t Fail = 0;
+
+static Record_t Record_Buf[2];
+static Snapshot_t Record_Snapshot;
+static volatile Record_t Record_Plain;
+
+static void Check(uint8_t ok, const char *what)
+{
+    printf("  %-64s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok)
+        Fail = 1;
+}
+
+static void Record_Fill(Record_t *record, uint32_t n)
+{
+    for (uint32_t i = 0; i < TEST_RECORD_WORDS; i++)
+        record->Word[i] = n * 2654435761u + i;
+}
+
+static uint8_t Record_Check(const Record_t *record, uint32_t *n)
+{
+    // Word[0] = n * 2654435761, 2654435761 为奇数, 可由模逆元求回 n
+    // 2654435761 is odd, so n follows from Word[0] through the modular inverse
+    uint32_t inv = 2654435761u;
+    for (uint8_t i = 0; i < 4; i++)
+        inv *= 2 - 2654435761u * inv;
+    *n = record->Word[0] * inv;
+    for (uint32_t i = 1; i < TEST_RECORD_WORDS; i++)
+        if (record->Word[i] != *n * 2654435761u + i)
+            return 0;
+    return 1;
+}
+
+/*************************** 1. generic snapshot ***************************/
+static void Record_Publish(uint32_t n)
+{
+    Record_t record;
+    Record_Fill(&record, n);
+    Snapshot_Publish(&Record_Snapshot, &record);
+}
+
+static uint8_t Record_Read(uint32_t *n)
+{
+    Record_t record;
+    ReaderRetry += Snapshot_Read(&Record_Snapshot, &record);
+    return Record_Check(&record, n);
+}
+
+// 对照组: 不加保护的逐字段读写 control group: plain field by field reads and writes
+static void Plain_Publish(uint32_t n)
+{
+    for (uint32_t i = 0; i < TEST_RECORD_WORDS; i++)
+        Record_Plain.Word[i] = n * 2654435761u + i;
+}
+
+static uint8_t Plain_Read(uint32_t *n)
+{
+    Record_t record;
+    for (uint32_t i = 0; i < TEST_RECORD_WORDS; i++)
+        record.Word[i] = Record_Plain.Word[i];
+    return Record_Check(&record, n);
+}
+
+/*************************** 2. remote control ***************************/
+// 按 DR16 协议编码, 四个通道、拨杆、鼠标与键盘均由 n 的低 16 位导出
+// encode a DR16 frame, channels, switches, mouse and keys derive from the low 16 bits of n
+static void RC_Encode(uint8_t *buff, uint32_t n)
+{
+    uint16_t ch = RC_CH_VALUE_OFFSET - 660 + (n & 0xFFFF) % 1321;
+    uint8_t sw = 1 + (n & 0xFFFF) % 3;
+
+    buff[0] = ch;
+    buff[1] = (ch >> 8) | (ch << 3);
+    buff[2] = (ch >> 5) | (ch << 6);
+    buff[3] = ch >> 2;
+    buff[4] = (ch >> 10) | (ch << 1);
+    buff[5] = (ch >> 7) | (sw << 4) | (sw << 6);
+    buff[6] = n;
+    buff[7] = n >> 8;
+    buff[8] = n;
+    buff[9] = n >> 8;
+    buff[10] = n;
+    buff[11] = n >> 8;
+    buff[12] = n & 1;
+    buff[13] = n & 1;
+    buff[14] = n;
+    buff[15] = n >> 8;
+}
+
+static void RC_Frame_Publish(uint32_t n)
+{
+    uint8_t buff[16];
+
+    RC_Encode(buff, n);
+    Callback_RC_Handle(&remote_control, buff, RC_SOURCE_UART);
+}
+
+static uint8_t RC_Check_Read(uint32_t *n)
+{
+    RC_Type rc;
+    uint16_t m;
+
+    ReaderRetry += Snapshot_Read(&RC_Snapshot[RC_SOURCE_UART], &rc);
+    m = rc.key_code;
+    *n = m; // 仅低 16 位, 读线程可能被挂起超过一个回绕周期, 不检查倒退 low 16 bits only, a reader may sleep through a wrap, so no backwards check
+    return rc.ch1 == -660 + m % 1321 && rc.ch2 == rc.ch1 && rc.ch3 == rc.ch1 && rc.ch4 == rc.ch1 &&
+           rc.switch_left == 1 + m % 3 && rc.switch_right == rc.switch_left &&
+           (uint16_t)rc.mouse.x == m && (uint16_t)rc.mouse.y == m && (uint16_t)rc.mouse.z == m &&
+           rc.mouse.press_left == (m & 1) && rc.mouse.press_right == (m & 1);
+}
+
+/*************************** 3. navigation ***************************/
+static void Nav_Publish(uint32_t n)
+{
+    Chassis_Nav_t nav;
+    nav.posX1000 = n;
+    nav.posY1000 = ~n;
+    nav.posZ1000 = n * 3;
+    nav.PlanX1000 = n * 5;
+    nav.PlanY1000 = n * 7;
+    nav.TimeStamp = n;
+    Snapshot_Publish(&Chassis_NavSnapshot, &nav);
+}
+
+static uint8_t Nav_Read(uint32_t *n)
+{
+    Chassis_Nav_t nav;
+    ReaderRetry += Snapshot_Read(&Chassis_NavSnapshot, &nav);
+    *n = nav.TimeStamp;
+    return nav.posX1000 == (int16_t)nav.TimeStamp && nav.posY1000 == (int16_t)~nav.TimeStamp &&
+           nav.posZ1000 == (int16_t)(nav.TimeStamp * 3) && nav.PlanX1000 == (int16_t)(nav.TimeStamp * 5) &&
+           nav.PlanY1000 == (int16_t)(nav.TimeStamp * 7);
+}
+
+/*************************** runner ***************************/
+static void *Reader_Thread(void *arg)
+{
+    ReaderStat_t *stat = (ReaderStat_t *)arg;
+    uint32_t n, last = 0;
+
+    while (Running)
+    {
+        ReaderRetry = 0;
+        if (!stat->Case->Read(&n))
+            stat->Torn++;
+        else
+        {
+            if (stat->Case->Monotonic && (int32_t)(n - last) < 0)
+                stat->Backwards++;
+            last = n;
+        }
+        stat->Retries += ReaderRetry;
+        stat->Reads++;
+    }
+    return NULL;
+}
+
+static double Host_Wall_Time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void Run_Case(const Case_t *test_case, uint8_t readers, double seconds, uint8_t expect_consistent)
+{
+    pthread_t thread[TEST_MAX_READERS];
+    ReaderStat_t stat[TEST_MAX_READERS], total = {0};
+    uint32_t n = 1;
+    double start;
+    char what[96];
+
+    test_case->Publish(0);
+    memset(stat, 0, sizeof(stat));
+    Running = 1;
+    for (uint8_t i = 0; i < readers; i++)
+    {
+        stat[i].Case = test_case;
+        pthread_create(&thread[i], NULL, Reader_Thread, &stat[i]);
+    }
+
+    start = Host_Wall_Time_s();
+    while (Host_Wall_Time_s() - start < seconds)
+        for (uint32_t i = 0; i < 4096; i++)
+            test_case->Publish(n++);
+
+    Running = 0;
+    for (uint8_t i = 0; i < readers; i++)
+    {
+        pthread_join(thread[i], NULL);
+        total.Reads += stat[i].Reads;
+        total.Retries += stat[i].Retries;
+        total.Torn += stat[i].Torn;
+        total.Backwards += stat[i].Backwards;
+    }
+
+    printf("%-22s %10u publishes %10llu reads %8llu retries %8llu torn %4llu backwards\n",
+           test_case->Name, n - 1, (unsigned long long)total.Reads, (unsigned long long)total.Retries,
+           (unsigned long long)total.Torn, (unsigned long long)total.Backwards);
+    if (expect_consistent)
+    {
+        snprintf(what, sizeof(what), "%s: no torn or stale values", test_case->Name);
+        Check(total.Torn == 0 && total.Backwards == 0 && total.Reads > 0, what);
+    }
+}
+
+// 写者停在发布中途 (副本正被改写) 时的读取, 模拟中断打断写任务
+// read while the writer is stopped half way through a publish, as an interrupt preempting the writing task would
+static void Check_Preempted_Writer(void)
+{
+    Record_t record, out;
+    Snapshot_t snapshot;
+    Record_t buf[2];
+    uint32_t seq, n, retry;
+    uint8_t ok = 1;
+
+    Snapshot_Init_Static(&snapshot, buf, NULL);
+    Record_Fill(&record, 1);
+    Snapshot_Publish(&snapshot, &record);
+
+    for (uint8_t phase = 0; phase < 2; phase++)
+    {
+        // phase 0: 第一次加一后改写副本 seq & 1; phase 1: 第二次加一后改写另一份
+        // phase 0: after the first increment, copy seq & 1 is being rewritten; phase 1: after the second, the other one
+        seq = snapshot.Seq;
+        snapshot.Seq = seq + 1 + phase;
+        memset(snapshot.Buf + ((seq + phase) & 1) * snapshot.Size, 0xA5, snapshot.Size / 2);
+        retry = Snapshot_Read(&snapshot, &out);
+        ok &= retry == 0 && Record_Check(&out, &n) && n == 1;
+        snapshot.Seq = seq;
+        memcpy(snapshot.Buf, &record, sizeof(record));
+        memcpy(snapshot.Buf + sizeof(record), &record, sizeof(record));
+    }
+    Check(ok, "reader preempting a publish gets the old value without retry");
+}
+
+// DR16 与 CAN 两个来源交替发布, RC_Read() 须返回最近发布的一帧
+// the DR16 and CAN sources publish in turn, RC_Read() must return the frame published last
+static void Check_RC_Source(void)
+{
+    static const uint8_t order[] = {RC_SOURCE_CAN, RC_SOURCE_UART, RC_SOURCE_UART, RC_SOURCE_CAN, RC_SOURCE_UART};
+    uint8_t buff[16], ok = 1;
+    RC_Type rc;
+
+    for (uint8_t i = 0; i < sizeof(order); i++)
+    {
+        RC_Encode(buff, 1000 + i);
+        Callback_RC_Handle(order[i] == RC_SOURCE_CAN ? &remote_control_can : &remote_control, buff, order[i]);
+        RC_Read(&rc);
+        ok &= rc.key_code == 1000 + i;
+    }
+    Check(ok, "RC_Read() returns the source that published last");
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 1.0;
+    uint8_t readers = 3;
+    static const Case_t Plain_Case = {"plain (unprotected)", Plain_Publish, Plain_Read, 1};
+    static const Case_t Record_Case = {"snapshot 256 B", Record_Publish, Record_Read, 1};
+    static const Case_t RC_Case = {"RC_Snapshot", RC_Frame_Publish, RC_Check_Read, 0};
+    static const Case_t Nav_Case = {"Chassis_NavSnapshot", Nav_Publish, Nav_Read, 1};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            readers = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-t seconds per case] [-r readers]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (readers < 1)
+        readers = 1;
+    if (readers > TEST_MAX_READERS)
+        readers = TEST_MAX_READERS;
+
+    Host_HAL_Init();
+    Snapshot_Init_Static(&Record_Snapshot, Record_Buf, NULL);
+
+    Check_Preempted_Writer();
+    Check_RC_Source();
+    Run_Case(&Plain_Case, readers, seconds, 0);
+    Run_Case(&Record_Case, readers, seconds, 1);
+    Run_Case(&RC_Case, readers, seconds, 1);
+    Run_Case(&Nav_Case, readers, seconds, 1);
+
+    printf("%s\n", Fail ? "FAIL" : "PASS");
+    return Fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
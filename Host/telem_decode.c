@@ -0,0 +1,312 @@
+/**
+ ******************************************************************************
+ * @file    telem_decode.c
+ * @brief   遥测流解码 telemetry stream decoder
+ *          读入串口上录得的遥测字节流 (telemetry.h), 按帧头与 CRC16 重新同步,
+ *          第一遍收集 schema 帧与出现过的通道, 第二遍每个数据帧输出一行 CSV:
+ *          序号与时间戳 (均已展开回绕) 后接按通道号排列的各列, 本帧未选中的通道留空
+ *          reads a telemetry byte stream captured on the UART (telemetry.h) and resyncs on the
+ *          header and CRC16; the first pass collects the schema frames and the channels in use,
+ *          the second writes one CSV row per data frame: sequence and timestamp (both unwrapped)
+ *          followed by one column per channel in ID order, empty where the frame did not carry it
+ *          -t 将文本帧 (如计时统计表) 依次写入文件 -t writes the text frames (such as the profiler table) to a file
+ *
+ *          usage: telem_decode [-o out.csv] [-t text.txt] capture.bin
+ ******************************************************************************
+ * @attention
+ *  仅用于主机仿真, 固件构建不包含本文件
+ *  schema 帧轮流发送, 整个录制中都未收到其 schema 的通道无法解出, 含该通道的数据帧计为 unknown
+ *  schema frames go round in turn; a channel whose schema never appears in the capture cannot be
+ *  decoded, data frames carrying it count as unknown
+ ******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc8_16.h"
+#include "telemetry.h"
+
+#define DECODE_PAYLOAD_MAX 1024
+
+typedef struct
+{
+    char Name[TELEM_NAME_LEN + 1];
+    uint8_t Type;
+    uint8_t Known;
+} Decode_Channel_t;
+
+typedef struct
+{
+    uint32_t Data;
+    uint32_t Schema;
+    uint32_t Text;
+    uint32_t Unknown;   // 含未知通道的数据帧 data frames with a channel of unknown schema
+    uint32_t Malformed; // 长度与掩码不符 length does not match the mask
+    uint32_t CrcError;
+    uint32_t Lost;      // 由序号跳变推出的丢帧 frames lost according to the sequence
+    uint32_t Skipped;   // 重新同步时跳过的字节 bytes skipped while resyncing
+} Decode_Stat_t;
+
+static Decode_Channel_t Channel[TELEM_CHANNEL_MAX];
+static uint64_t Used = 0; // 数据帧中出现过的通道 channels seen in data frames
+static Decode_Stat_t Stat;
+static FILE *Text_Out = NULL;
+
+static const uint8_t Type_Size[] = {
+    [TELEM_FLOAT] = 4,
+    [TELEM_INT16] = 2,
+    [TELEM_UINT32] = 4,
+};
+
+static uint8_t *Load(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long len;
+
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(len > 0 ? len : 1);
+    if (buf != NULL && fread(buf, 1, len, f) != (size_t)len)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = len;
+    return buf;
+}
+
+// 数据帧中各通道值的总长, 有未知通道时返回 -1 length of the values in a data frame, -1 with an unknown channel
+static int32_t Values_Len(uint64_t mask)
+{
+    int32_t len = 0;
+
+    for (uint8_t id = 0; id < TELEM_CHANNEL_MAX; id++)
+    {
+        if (!(mask & TELEM_BIT(id)))
+            continue;
+        if (!Channel[id].Known)
+            return -1;
+        len += Type_Size[Channel[id].Type];
+    }
+    return len;
+}
+
+static void Write_Header(FILE *out)
+{
+    fprintf(out, "seq,time_us");
+    for (uint8_t id = 0; id < TELEM_CHANNEL_MAX; id++)
+        if (Used & TELEM_BIT(id))
+            fprintf(out, ",%s", Channel[id].Known ? Channel[id].Name : "?");
+    fprintf(out, "\n");
+}
+
+static void Write_Row(FILE *out, uint64_t seq, uint64_t time_us, uint64_t mask, const uint8_t *p)
+{
+    float f;
+    int16_t i16;
+    uint32_t u32;
+
+    fprintf(out, "%llu,%llu", (unsigned long long)seq, (unsigned long long)time_us);
+    for (uint8_t id = 0; id < TELEM_CHANNEL_MAX; id++)
+    {
+        if (!(Used & TELEM_BIT(id)))
+            continue;
+        fputc(',', out);
+        if (!(mask & TELEM_BIT(id)))
+            continue;
+        switch (Channel[id].Type)
+        {
+        case TELEM_FLOAT:
+            memcpy(&f, p, 4);
+            fprintf(out, "%.9g", f);
+            break;
+        case TELEM_INT16:
+            memcpy(&i16, p, 2);
+            fprintf(out, "%d", i16);
+            break;
+        default:
+            memcpy(&u32, p, 4);
+            fprintf(out, "%u", u32);
+            break;
+        }
+        p += Type_Size[Channel[id].Type];
+    }
+    fputc('\n', out);
+}
+
+// 解析一遍; out 为 NULL 时只收集 schema 与通道, 否则输出 CSV 并统计
+// one pass; collects the schema and channels when out is NULL, writes CSV and counts otherwise
+static void Decode(const uint8_t *buf, size_t size, FILE *out)
+{
+    uint64_t seq = 0, time_us = 0, mask;
+    uint32_t timestamp, last_timestamp = 0;
+    uint16_t len, raw_seq, last_seq = 0, crc;
+    uint8_t first = 1, type, id;
+    const uint8_t *payload;
+    int32_t values;
+    size_t pos = 0;
+
+    while (pos + TELEM_HEADER_LEN + 2 <= size)
+    {
+        len = buf[pos + 2] | buf[pos + 3] << 8;
+        if (buf[pos] != TELEM_SOF || len > DECODE_PAYLOAD_MAX ||
+            (buf[pos + 1] != TELEM_FRAME_DATA && buf[pos + 1] != TELEM_FRAME_SCHEMA && buf[pos + 1] != TELEM_FRAME_TEXT))
+        {
+            pos++;
+            if (out)
+                Stat.Skipped++;
+            continue;
+        }
+        if (pos + TELEM_HEADER_LEN + len + 2 > size)
+            break; // 录制在帧中间结束 the capture ends inside a frame
+        crc = buf[pos + TELEM_HEADER_LEN + len] | buf[pos + TELEM_HEADER_LEN + len + 1] << 8;
+        if (CRC16_Update(0xFFFF, buf + pos, TELEM_HEADER_LEN + len) != crc)
+        {
+            pos++;
+            if (out)
+            {
+                Stat.CrcError++;
+                Stat.Skipped++;
+            }
+            continue;
+        }
+
+        type = buf[pos + 1];
+        payload = buf + pos + TELEM_HEADER_LEN;
+        raw_seq = buf[pos + 4] | buf[pos + 5] << 8;
+        pos += TELEM_HEADER_LEN + len + 2;
+
+        if (type == TELEM_FRAME_TEXT)
+        {
+            if (out)
+            {
+                Stat.Text++;
+                if (Text_Out)
+                    fwrite(payload, 1, len, Text_Out);
+            }
+            continue;
+        }
+        if (type == TELEM_FRAME_SCHEMA)
+        {
+            if (len < 2 || payload[0] >= TELEM_CHANNEL_MAX || payload[1] > TELEM_UINT32)
+                continue;
+            id = payload[0];
+            if (out == NULL)
+            {
+                memset(Channel[id].Name, 0, sizeof(Channel[id].Name));
+                memcpy(Channel[id].Name, payload + 2, len - 2 < TELEM_NAME_LEN ? len - 2 : TELEM_NAME_LEN);
+                Channel[id].Type = payload[1];
+                Channel[id].Known = 1;
+            }
+            else
+                Stat.Schema++;
+            continue;
+        }
+
+        if (len < TELEM_DATA_HEADER_LEN)
+            continue;
+        memcpy(&timestamp, payload, 4);
+        memcpy(&mask, payload + 4, 8);
+        if (out == NULL)
+        {
+            Used |= mask;
+            continue;
+        }
+
+        values = Values_Len(mask);
+        if (values < 0)
+        {
+            Stat.Unknown++;
+            continue;
+        }
+        if (values != len - TELEM_DATA_HEADER_LEN)
+        {
+            Stat.Malformed++;
+            continue;
+        }
+
+        // 16 位序号与 32 位微秒时间戳展开为 64 位 unwrap the 16 bit sequence and the 32 bit microsecond timestamp
+        if (first)
+        {
+            seq = raw_seq;
+            time_us = timestamp;
+            first = 0;
+        }
+        else
+        {
+            Stat.Lost += (uint16_t)(raw_seq - last_seq - 1);
+            seq += (uint16_t)(raw_seq - last_seq);
+            time_us += (uint32_t)(timestamp - last_timestamp);
+        }
+        last_seq = raw_seq;
+        last_timestamp = timestamp;
+
+        Write_Row(out, seq, time_us, mask, payload + TELEM_DATA_HEADER_LEN);
+        Stat.Data++;
+    }
+    if (out)
+        Stat.Skipped += size - pos;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL, *out_path = NULL, *text_path = NULL;
+    FILE *out = stdout;
+    uint8_t *buf;
+    size_t size;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            out_path = argv[++i];
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            text_path = argv[++i];
+        else if (argv[i][0] != '-' && path == NULL)
+            path = argv[i];
+        else
+        {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s [-o out.csv] [-t text.txt] capture.bin\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    buf = Load(path, &size);
+    if (buf == NULL)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    if (out_path != NULL && (out = fopen(out_path, "w")) == NULL)
+    {
+        perror(out_path);
+        return EXIT_FAILURE;
+    }
+    if (text_path != NULL && (Text_Out = fopen(text_path, "w")) == NULL)
+    {
+        perror(text_path);
+        return EXIT_FAILURE;
+    }
+
+    Decode(buf, size, NULL);
+    Write_Header(out);
+    Decode(buf, size, out);
+    if (out != stdout)
+        fclose(out);
+    if (Text_Out)
+        fclose(Text_Out);
+    free(buf);
+
+    fprintf(stderr, "data %u, schema %u, text %u, lost %u, unknown %u, malformed %u, crc errors %u, skipped %u bytes\n",
+            Stat.Data, Stat.Schema, Stat.Text, Stat.Lost, Stat.Unknown, Stat.Malformed, Stat.CrcError, Stat.Skipped);
+    return Stat.Data ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -27,6 +27,7 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "includes.h"
+#include "profiler.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -49,6 +50,7 @@
 uint8_t count_ui = 0;
 uint8_t count_shoot = 0;
 uint16_t enemy_outpost_HP = 1500;
+osThreadId TelemTaskHandle;
 /* USER CODE END Variables */
 osThreadId GimbalTaskHandle;
 osThreadId INSTaskHandle;
@@ -59,6 +61,7 @@ osThreadId ChassisTaskHandle;
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
+void StartTelemTask(void const *argument);
 
 /* USER CODE END FunctionPrototypes */
 
@@ -157,6 +160,9 @@ void MX_FREERTOS_Init(void)
 
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
+  // 遥测发送, 按 Telem_Config 开启, 默认关闭 telemetry transmission, enabled by Telem_Config, off by default
+  osThreadDef(TelemTask, StartTelemTask, osPriorityBelowNormal, 0, 256);
+  TelemTaskHandle = osThreadCreate(osThread(TelemTask), NULL);
   /* USER CODE END RTOS_THREADS */
 }
 
@@ -191,12 +197,14 @@ void StartINSTask(void const *argument)
 {
   /* USER CODE BEGIN StartINSTask */
   INS_Init();
+  // 由 BMI088 的数据就绪定时, 周期统计仍以 1 ms 为标称值 timed by the BMI088 data ready, the period statistics keep 1 ms as nominal
+  TaskPeriod_Init(&INS_Period, INS_TASK_PERIOD);
   /* Infinite loop */
   for (;;)
   {
     INS_Task(); // ��������
 
-    osDelay(INS_TASK_PERIOD);
+    INS_Wait();
   }
   /* USER CODE END StartINSTask */
 }
@@ -211,16 +219,21 @@ void StartINSTask(void const *argument)
 void StartDetectTask(void const *argument) // ����Detect ���ٷ���
 {
   /* USER CODE BEGIN StartDetectTask */
+  RC_Type rc;
+
   Detect_Task_Init();
   /* Infinite loop */
   for (;;)
   {
     HAL_IWDG_Refresh(&hiwdg);
-    if ((remote_control.key_code & Key_F) && (remote_control.key_code & Key_E))
+    // 经快照读取, 不直接读中断中改写的 remote_control read through the snapshot, not remote_control rewritten in the interrupt
+    RC_Read(&rc);
+    if ((rc.key_code & Key_F) && (rc.key_code & Key_E))
     {
       resetCount++;
       if (resetCount * DETECT_TASK_PERIOD > 1500)
       {
+        BlackBox_Mark(BLACKBOX_REASON_KEY_RESET);
         __set_FAULTMASK(1);
         HAL_NVIC_SystemReset();
       }
@@ -267,7 +280,11 @@ void StartUITask(void const *argument) // UI
   /* Infinite loop */
   for (;;)
   {
+    PROFILE_BEGIN(PROFILE_UI);
     // UI_Task();
+    // 按 Profile_Dump_Mode 导出计时统计, 默认关闭 dump the profiler table as selected by Profile_Dump_Mode, off by default
+    Profile_Dump();
+    PROFILE_END(PROFILE_UI);
     osDelay(UI_TASK_PERIOD);
   }
   /* USER CODE END StartUITask */
@@ -285,15 +302,19 @@ void StartChassisTask(void const *argument)
   /* USER CODE BEGIN StartChassisTask */
   osDelay(1000);
   Chassis_Init();
+  TaskPeriod_Init(&Chassis_Period, CHASSIS_TASK_PERIOD);
   /* Infinite loop */
   for (;;)
   {
 
     Chassis_Control();
+    // 本周期的估计器与控制量进入遥测队列 queue this tick's estimator and control state for telemetry
+    Telem_Sample();
 
     if (RC_Update)
     {
-      if (resetCount < 2000 && !((remote_control.key_code & Key_R) && (remote_control.key_code & Key_E)))
+      // Chassis.RC 为本周期 Chassis_Control() 经 RC_Read() 读出的一帧 Chassis.RC is the frame RC_Read() returned to Chassis_Control() this tick
+      if (resetCount < 2000 && !((Chassis.RC.key_code & Key_R) && (Chassis.RC.key_code & Key_E)))
       {
         Send_RC_Data(&hcan1, RC_Data_Buffer);
         Send_RC_Data(&hcan2, RC_Data_Buffer);
@@ -323,13 +344,29 @@ void StartChassisTask(void const *argument)
       count_shoot = 0;
     }
     count_shoot++;
-    osDelay(CHASSIS_TASK_PERIOD);
+    TaskPeriod_Wait(&Chassis_Period);
   }
   /* USER CODE END StartChassisTask */
 }
 
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
+/**
+ * @brief Function implementing the TelemTask thread.
+ * @param argument: Not used
+ * @retval None
+ */
+void StartTelemTask(void const *argument)
+{
+  Telem_Init(&huart6);
+  /* Infinite loop */
+  for (;;)
+  {
+    Telem_Task();
+    // 关闭且无文本待发时降低唤醒频率 wake up less often while disabled with no text to send
+    osDelay(Telem_Config.Decimation || Telem_Text_Busy() ? TELEM_TASK_PERIOD : 100);
+  }
+}
 
 /* USER CODE END Application */
 
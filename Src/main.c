@@ -91,6 +91,9 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  // 上次复位前记有原因时转存黑匣子, 须在外设与任务启动之前 dump the black box if the last reset noted a reason, before peripherals and tasks start
+  BlackBox_Boot(RCC->CSR, CHASSIS_TASK_PERIOD * 1000);
+  __HAL_RCC_CLEAR_RESET_FLAGS();
 
   /* USER CODE END SysInit */
 